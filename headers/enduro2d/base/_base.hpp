@@ -18,9 +18,11 @@
 #include <mutex>
 #include <atomic>
 #include <thread>
+#include <condition_variable>
 
 #include <set>
 #include <map>
+#include <deque>
 #include <tuple>
 #include <array>
 #include <bitset>
@@ -76,3 +76,27 @@
 #ifndef E2D_BUILD_MODE
 #  error E2D_BUILD_MODE not detected
 #endif
+
+//
+// E2D_SIMD
+//
+
+#define E2D_SIMD_NONE 1
+#define E2D_SIMD_SSE  2
+#define E2D_SIMD_NEON 3
+
+#ifndef E2D_SIMD
+#  if !defined(E2D_BUILD_WITH_SIMD)
+#    define E2D_SIMD E2D_SIMD_NONE
+#  elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#    define E2D_SIMD E2D_SIMD_SSE
+#  elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#    define E2D_SIMD E2D_SIMD_NEON
+#  else
+#    define E2D_SIMD E2D_SIMD_NONE
+#  endif
+#endif
+
+#ifndef E2D_SIMD
+#  error E2D_SIMD not detected
+#endif
@@ -13,8 +13,10 @@
 #include "deferrer.hpp"
 #include "engine.hpp"
 #include "input.hpp"
+#include "job_system.hpp"
 #include "platform.hpp"
 #include "render.hpp"
 #include "render.inl"
+#include "render_queue.hpp"
 #include "vfs.hpp"
 #include "window.hpp"
@@ -33,8 +33,10 @@ namespace e2d
     class mouse;
     class keyboard;
     class input;
+    class job_system;
     class platform;
     class render;
+    class render_queue;
     class shader;
     class texture;
     class index_buffer;
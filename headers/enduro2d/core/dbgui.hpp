@@ -33,6 +33,10 @@ namespace e2d
         bool visible() const noexcept;
         void toggle_visible(bool yesno) noexcept;
 
+        // named values for the "Debug Render" window,
+        // they are shown until the next update
+        void counter(str_view name, std::size_t value);
+
         void frame_tick();
         void frame_render();
     private:
@@ -7,16 +7,32 @@
 #pragma once
 
 #include "_core.hpp"
+#include "job_system.hpp"
 
 namespace e2d
 {
+    //
+    // deferrer
+    //
+    // upload tasks are main thread tasks with the cost in bytes,
+    // process_upload_tasks runs them in order until the frame budget
+    // is spent and carries the rest over to the next frames
+    //
+
     class deferrer final : public module<deferrer> {
+    public:
+        struct upload_statistics {
+            std::size_t queued_tasks = 0;
+            std::size_t processed_tasks = 0;
+            std::size_t processed_bytes = 0;
+            f32 processed_ms = 0.f;
+        };
     public:
         deferrer();
         ~deferrer() noexcept final;
 
-        stdex::jobber& worker() noexcept;
-        const stdex::jobber& worker() const noexcept;
+        job_system& worker() noexcept;
+        const job_system& worker() const noexcept;
 
         stdex::scheduler& scheduler() noexcept;
         const stdex::scheduler& scheduler() const noexcept;
@@ -28,14 +44,98 @@ namespace e2d
 
         template < typename F
                  , typename... Args
-                 , typename R = stdex::jobber::async_invoke_result_t<F, Args...> >
+                 , typename R = job_system::async_invoke_result_t<F, Args...> >
         stdex::promise<R> do_in_worker_thread(F&& f, Args&&... args);
 
+        template < typename F
+                 , typename... Args
+                 , typename R = stdex::scheduler::schedule_invoke_result_t<F, Args...> >
+        stdex::promise<R> do_upload_in_main_thread(std::size_t upload_bytes, F&& f, Args&&... args);
+
+        // zero means unlimited, the first task of the frame
+        // is always processed so an oversized upload can't stall the queue
+        void upload_budget(std::size_t max_bytes, f32 max_ms) noexcept;
+        std::size_t upload_budget_bytes() const noexcept;
+        f32 upload_budget_ms() const noexcept;
+
+        std::size_t upload_queue_size() const noexcept;
+        const upload_statistics& process_upload_tasks() noexcept;
+        const upload_statistics& last_upload_statistics() const noexcept;
+
         template < typename T >
         void active_safe_wait_promise(const stdex::promise<T>& promise);
     private:
-        stdex::jobber worker_;
+        class upload_task;
+        using upload_task_uptr = std::unique_ptr<upload_task>;
+        template < typename R, typename F, typename... Args >
+        class concrete_upload_task;
+    private:
+        void push_upload_task_(std::size_t upload_bytes, upload_task_uptr task);
+        bool process_one_upload_task_() noexcept;
+    private:
         stdex::scheduler scheduler_;
+        mutable std::mutex upload_mutex_;
+        std::deque<std::pair<std::size_t, upload_task_uptr>> upload_tasks_;
+        std::atomic<std::size_t> upload_budget_bytes_{0u};
+        std::atomic<f32> upload_budget_ms_{0.f};
+        upload_statistics upload_stats_;
+        // declared last, so its threads are joined before
+        // the state their jobs can still touch is destroyed
+        job_system worker_;
+    };
+
+    //
+    // deferrer::upload_task
+    //
+
+    class deferrer::upload_task : private e2d::noncopyable {
+    public:
+        virtual ~upload_task() noexcept = default;
+        virtual void run() noexcept = 0;
+    };
+
+    //
+    // deferrer::concrete_upload_task
+    //
+
+    template < typename R, typename F, typename... Args >
+    class deferrer::concrete_upload_task final : public upload_task {
+    public:
+        template < typename U >
+        concrete_upload_task(const stdex::promise<R>& promise, U&& f, std::tuple<Args...>&& args)
+        : promise_(promise)
+        , f_(std::forward<U>(f))
+        , args_(std::move(args)) {}
+
+        // rejects the promise of the task that has never been run
+        ~concrete_upload_task() noexcept final {
+            if ( !released_ ) {
+                promise_.reject(stdex::scheduler_cancelled_exception());
+            }
+        }
+
+        void run() noexcept final {
+            released_ = true;
+            try {
+                resolve_(std::is_void<R>());
+            } catch (...) {
+                promise_.reject(std::current_exception());
+            }
+        }
+    private:
+        void resolve_(std::true_type) {
+            stdex::apply(std::move(f_), std::move(args_));
+            promise_.resolve();
+        }
+
+        void resolve_(std::false_type) {
+            promise_.resolve(stdex::apply(std::move(f_), std::move(args_)));
+        }
+    private:
+        stdex::promise<R> promise_;
+        F f_;
+        std::tuple<Args...> args_;
+        bool released_{false};
     };
 }
 
@@ -51,12 +151,29 @@ namespace e2d
         return worker_.async(std::forward<F>(f), std::forward<Args>(args)...);
     }
 
+    template < typename F , typename... Args , typename R >
+    stdex::promise<R> deferrer::do_upload_in_main_thread(std::size_t upload_bytes, F&& f, Args&&... args) {
+        using task_t = concrete_upload_task<
+            R,
+            std::decay_t<F>,
+            std::decay_t<Args>...>;
+        stdex::promise<R> result;
+        push_upload_task_(upload_bytes, std::make_unique<task_t>(
+            result,
+            std::forward<F>(f),
+            std::make_tuple(std::forward<Args>(args)...)));
+        return result;
+    }
+
     template < typename T >
     void deferrer::active_safe_wait_promise(const stdex::promise<T>& promise) {
         const auto zero_us = time::to_chrono(make_microseconds(0));
         while ( promise.wait_for(zero_us) == stdex::promise_wait_status::timeout ) {
-            if ( !is_in_main_thread() || 0 == scheduler_.process_one_task().second ) {
-                if ( 0 == worker_.active_wait_one().second ) {
+            // waiting on the main thread ignores the upload budget
+            const bool processed = is_in_main_thread()
+                && (0 != scheduler_.process_one_task().second || process_one_upload_task_());
+            if ( !processed ) {
+                if ( 0 == worker_.active_wait_one() ) {
                     std::this_thread::yield();
                 }
             }
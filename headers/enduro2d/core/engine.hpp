@@ -86,6 +86,27 @@ namespace e2d
             u32 maximal_framerate_{1000u};
         };
 
+        class vfs_parameters {
+        public:
+            vfs_parameters& io_threads(u32 value) noexcept;
+
+            u32 io_threads() const noexcept;
+        private:
+            u32 io_threads_{4u};
+        };
+
+        class upload_parameters {
+        public:
+            upload_parameters& max_frame_bytes(std::size_t value) noexcept;
+            upload_parameters& max_frame_time_ms(f32 value) noexcept;
+
+            std::size_t max_frame_bytes() const noexcept;
+            f32 max_frame_time_ms() const noexcept;
+        private:
+            std::size_t max_frame_bytes_{16u * 1024u * 1024u};
+            f32 max_frame_time_ms_{4.f};
+        };
+
         class parameters {
         public:
             parameters() = delete;
@@ -97,6 +118,8 @@ namespace e2d
             parameters& debug_params(const debug_parameters& value);
             parameters& window_params(const window_parameters& value);
             parameters& timer_params(const timer_parameters& value);
+            parameters& vfs_params(const vfs_parameters& value);
+            parameters& upload_params(const upload_parameters& value);
 
             str& game_name() noexcept;
             str& company_name() noexcept;
@@ -104,6 +127,8 @@ namespace e2d
             debug_parameters& debug_params() noexcept;
             window_parameters& window_params() noexcept;
             timer_parameters& timer_params() noexcept;
+            vfs_parameters& vfs_params() noexcept;
+            upload_parameters& upload_params() noexcept;
 
             const str& game_name() const noexcept;
             const str& company_name() const noexcept;
@@ -111,6 +136,8 @@ namespace e2d
             const debug_parameters& debug_params() const noexcept;
             const window_parameters& window_params() const noexcept;
             const timer_parameters& timer_params() const noexcept;
+            const vfs_parameters& vfs_params() const noexcept;
+            const upload_parameters& upload_params() const noexcept;
         private:
             str game_name_{"noname"};
             str company_name_{"noname"};
@@ -118,6 +145,8 @@ namespace e2d
             debug_parameters debug_params_;
             window_parameters window_params_;
             timer_parameters timer_params_;
+            vfs_parameters vfs_params_;
+            upload_parameters upload_params_;
         };
     public:
         engine(int argc, char *argv[], const parameters& params);
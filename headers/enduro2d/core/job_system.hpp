@@ -0,0 +1,298 @@
+/*******************************************************************************
+ * This file is part of the "Enduro2D"
+ * For conditions of distribution and use, see copyright notice in LICENSE.md
+ * Copyright (C) 2018 Matvey Cherevko
+ ******************************************************************************/
+
+#pragma once
+
+#include "_core.hpp"
+
+namespace e2d
+{
+    //
+    // job_cancelled_exception
+    //
+
+    class job_cancelled_exception final : public exception {
+    public:
+        const char* what() const noexcept final {
+            return "job has been cancelled";
+        }
+    };
+
+    //
+    // job_system
+    //
+    // work-stealing scheduler: every worker thread owns a job deque,
+    // takes jobs from its back and steals from the fronts of the others.
+    // jobs are allocated from a pool and can have child jobs, a parent job
+    // is finished when its function and all of its children are finished.
+    //
+
+    class job_system final : private noncopyable {
+    public:
+        class job;
+        using job_iptr = intrusive_ptr<job>;
+
+        template < typename F, typename... Args >
+        using async_invoke_result_t = stdex::invoke_result_t<
+            std::decay_t<F>,
+            std::decay_t<Args>...>;
+    public:
+        explicit job_system(std::size_t threads);
+        ~job_system() noexcept;
+
+        std::size_t thread_count() const noexcept;
+        std::size_t active_job_count() const noexcept;
+
+        // exceptions of job functions are ignored,
+        // use async() to get them through the promise
+        template < typename F >
+        job_iptr create_job(F&& f);
+
+        // the parent must not be finished yet
+        template < typename F >
+        job_iptr create_child_job(const job_iptr& parent, F&& f);
+
+        void run(const job_iptr& job);
+
+        // executes other jobs while waiting
+        void wait(const job_iptr& job) noexcept;
+        void wait_all() noexcept;
+        std::size_t active_wait_one() noexcept;
+
+        template < typename F, typename... Args
+                 , typename R = async_invoke_result_t<F, Args...> >
+        stdex::promise<R> async(F&& f, Args&&... args);
+
+        // calls f(first, last) for subranges of [begin, end)
+        // and rethrows the first exception after all of them
+        template < typename F >
+        void parallel_for(std::size_t begin, std::size_t end, std::size_t grain, F&& f);
+    private:
+        friend void intrusive_ptr_release(job* j) noexcept;
+        struct worker_data;
+        template < typename R, typename F, typename... Args >
+        class async_task;
+    private:
+        job* allocate_job_();
+        void free_job_(job* j) noexcept;
+        void push_job_(job* j);
+        job* pop_job_() noexcept;
+        void execute_job_(job* j) noexcept;
+        void finish_job_(job* j) noexcept;
+        void release_job_(job* j) noexcept;
+        void worker_main_(std::size_t index) noexcept;
+        std::size_t current_worker_index_() const noexcept;
+    private:
+        vector<std::unique_ptr<worker_data>> workers_;
+        std::atomic<bool> cancelled_{false};
+        std::atomic<std::size_t> next_worker_{0u};
+        std::atomic<std::size_t> pending_count_{0u};
+        std::atomic<std::size_t> active_count_{0u};
+        std::atomic<std::size_t> sleeping_count_{0u};
+        std::mutex sleep_mutex_;
+        std::condition_variable sleep_cond_;
+        std::mutex pool_mutex_;
+        vector<job*> pool_jobs_;
+        vector<std::unique_ptr<job[]>> pool_blocks_;
+    };
+
+    //
+    // job_system::job
+    //
+
+    class job_system::job final : private noncopyable {
+    public:
+        job() = default;
+        ~job() noexcept = default;
+
+        bool finished() const noexcept;
+    private:
+        friend class job_system;
+        friend void intrusive_ptr_add_ref(job* j) noexcept;
+        friend void intrusive_ptr_release(job* j) noexcept;
+
+        template < typename F >
+        void assign_(F&& f);
+        template < typename F >
+        void* construct_(F&& f, std::true_type is_inline);
+        template < typename F >
+        void* construct_(F&& f, std::false_type is_inline);
+        void invoke_() noexcept;
+        void destroy_() noexcept;
+    private:
+        static constexpr std::size_t storage_size = 64u;
+        using invoke_fn = void(*)(void* f);
+        using destroy_fn = void(*)(void* f, bool is_inline) noexcept;
+    private:
+        std::aligned_storage_t<storage_size> storage_;
+        void* function_{nullptr};
+        invoke_fn invoke_fn_{nullptr};
+        destroy_fn destroy_fn_{nullptr};
+        job_system* owner_{nullptr};
+        job* parent_{nullptr};
+        std::atomic<u32> refs_{0u};
+        std::atomic<u32> unfinished_{0u};
+    };
+
+    void intrusive_ptr_add_ref(job_system::job* j) noexcept;
+    void intrusive_ptr_release(job_system::job* j) noexcept;
+
+    //
+    // job_system::async_task
+    //
+
+    template < typename R, typename F, typename... Args >
+    class job_system::async_task final {
+    public:
+        template < typename U >
+        async_task(const stdex::promise<R>& promise, U&& f, std::tuple<Args...>&& args)
+        : promise_(promise)
+        , f_(std::forward<U>(f))
+        , args_(std::move(args)) {}
+
+        async_task(async_task&& other)
+        : promise_(other.promise_)
+        , f_(std::move(other.f_))
+        , args_(std::move(other.args_)) {
+            other.released_ = true;
+        }
+
+        // rejects the promise of the job that has never been run
+        ~async_task() noexcept {
+            if ( !released_ ) {
+                promise_.reject(job_cancelled_exception());
+            }
+        }
+
+        void operator()() {
+            released_ = true;
+            try {
+                resolve_(std::is_void<R>());
+            } catch (...) {
+                promise_.reject(std::current_exception());
+            }
+        }
+    private:
+        void resolve_(std::true_type) {
+            stdex::apply(std::move(f_), std::move(args_));
+            promise_.resolve();
+        }
+
+        void resolve_(std::false_type) {
+            promise_.resolve(stdex::apply(std::move(f_), std::move(args_)));
+        }
+    private:
+        stdex::promise<R> promise_;
+        F f_;
+        std::tuple<Args...> args_;
+        bool released_{false};
+    };
+}
+
+namespace e2d
+{
+    template < typename F >
+    job_system::job_iptr job_system::create_job(F&& f) {
+        job_iptr result(allocate_job_());
+        result->assign_(std::forward<F>(f));
+        return result;
+    }
+
+    template < typename F >
+    job_system::job_iptr job_system::create_child_job(const job_iptr& parent, F&& f) {
+        E2D_ASSERT(parent && !parent->finished());
+        job_iptr result = create_job(std::forward<F>(f));
+        parent->unfinished_.fetch_add(1u);
+        intrusive_ptr_add_ref(parent.get());
+        result->parent_ = parent.get();
+        return result;
+    }
+
+    template < typename F, typename... Args, typename R >
+    stdex::promise<R> job_system::async(F&& f, Args&&... args) {
+        using task_t = async_task<
+            R,
+            std::decay_t<F>,
+            std::decay_t<Args>...>;
+        stdex::promise<R> result;
+        run(create_job(task_t(
+            result,
+            std::forward<F>(f),
+            std::make_tuple(std::forward<Args>(args)...))));
+        return result;
+    }
+
+    template < typename F >
+    void job_system::parallel_for(std::size_t begin, std::size_t end, std::size_t grain, F&& f) {
+        if ( begin >= end ) {
+            return;
+        }
+
+        if ( !grain ) {
+            grain = math::max(std::size_t(1u), (end - begin) / (workers_.size() * 4u));
+        }
+
+        std::mutex exception_mutex;
+        std::exception_ptr exception;
+
+        job_iptr root = create_job([](){});
+        for ( std::size_t first = begin; first < end; first += math::min(grain, end - first) ) {
+            const std::size_t last = first + math::min(grain, end - first);
+            run(create_child_job(root, [&f, &exception_mutex, &exception, first, last](){
+                try {
+                    f(first, last);
+                } catch (...) {
+                    std::lock_guard<std::mutex> guard(exception_mutex);
+                    if ( !exception ) {
+                        exception = std::current_exception();
+                    }
+                }
+            }));
+        }
+        run(root);
+        wait(root);
+
+        if ( exception ) {
+            std::rethrow_exception(exception);
+        }
+    }
+
+    template < typename F >
+    void job_system::job::assign_(F&& f) {
+        using function_t = std::decay_t<F>;
+        constexpr bool is_inline =
+            sizeof(function_t) <= storage_size &&
+            alignof(function_t) <= alignof(decltype(storage_));
+
+        function_ = construct_(
+            std::forward<F>(f),
+            std::integral_constant<bool, is_inline>());
+
+        invoke_fn_ = [](void* fn){
+            (*static_cast<function_t*>(fn))();
+        };
+
+        destroy_fn_ = [](void* fn, bool inl) noexcept {
+            if ( inl ) {
+                static_cast<function_t*>(fn)->~function_t();
+            } else {
+                delete static_cast<function_t*>(fn);
+            }
+        };
+    }
+
+    template < typename F >
+    void* job_system::job::construct_(F&& f, std::true_type) {
+        using function_t = std::decay_t<F>;
+        return new (&storage_) function_t(std::forward<F>(f));
+    }
+
+    template < typename F >
+    void* job_system::job::construct_(F&& f, std::false_type) {
+        using function_t = std::decay_t<F>;
+        return new function_t(std::forward<F>(f));
+    }
+}
@@ -15,6 +15,7 @@ namespace e2d
     class render;
     class shader;
     class texture;
+    class pixel_buffer;
     class index_buffer;
     class vertex_buffer;
     class render_target;
@@ -24,6 +25,7 @@ namespace e2d
 
     using shader_ptr = std::shared_ptr<shader>;
     using texture_ptr = std::shared_ptr<texture>;
+    using pixel_buffer_ptr = std::shared_ptr<pixel_buffer>;
     using index_buffer_ptr = std::shared_ptr<index_buffer>;
     using vertex_buffer_ptr = std::shared_ptr<vertex_buffer>;
     using render_target_ptr = std::shared_ptr<render_target>;
@@ -241,8 +243,47 @@ namespace e2d
         explicit texture(internal_state_uptr);
         ~texture() noexcept;
     public:
+        void update(const image& image, const v2u& offset) noexcept;
+
+        // loads the whole mipmap level from the unmapped pixel buffer,
+        // levels of streaming textures are loaded from the smallest one
+        // and the loaded level becomes the base level of the texture
+        void load_mipmap(
+            u32 level,
+            const pixel_buffer_ptr& src,
+            std::size_t offset,
+            std::size_t size) noexcept;
+
         const v2u& size() const noexcept;
         const pixel_declaration& decl() const noexcept;
+        u32 mipmap_count() const noexcept;
+        u32 base_level() const noexcept;
+    private:
+        internal_state_uptr state_;
+    };
+
+    //
+    // pixel_buffer
+    //
+    // staging memory of texture uploads. it's a pixel unpack buffer
+    // when the device supports them and client memory otherwise.
+    // map and unmap it in the main thread, the mapped memory
+    // can be filled from any thread in between
+    //
+
+    class pixel_buffer final : noncopyable {
+    public:
+        class internal_state;
+        using internal_state_uptr = std::unique_ptr<internal_state>;
+        const internal_state& state() const noexcept;
+    public:
+        explicit pixel_buffer(internal_state_uptr);
+        ~pixel_buffer() noexcept;
+    public:
+        u8* map() noexcept;
+        bool unmap() noexcept;
+        bool mapped() const noexcept;
+        std::size_t buffer_size() const noexcept;
     private:
         internal_state_uptr state_;
     };
@@ -267,6 +308,8 @@ namespace e2d
         ~index_buffer() noexcept;
     public:
         void update(const buffer& indices, std::size_t offset) noexcept;
+        void update(const void* indices, std::size_t size, std::size_t offset) noexcept;
+        void orphan() noexcept;
         std::size_t buffer_size() const noexcept;
         std::size_t index_count() const noexcept;
         const index_declaration& decl() const noexcept;
@@ -294,6 +337,8 @@ namespace e2d
         ~vertex_buffer() noexcept;
     public:
         void update(const buffer& vertices, std::size_t offset) noexcept;
+        void update(const void* vertices, std::size_t size, std::size_t offset) noexcept;
+        void orphan() noexcept;
         std::size_t buffer_size() const noexcept;
         std::size_t vertex_count() const noexcept;
         const vertex_declaration& decl() const noexcept;
@@ -581,6 +626,8 @@ namespace e2d
 
         class sampler_state {
         public:
+            sampler_state() noexcept;
+
             sampler_state& texture(const texture_ptr& texture) noexcept;
 
             sampler_state& wrap(sampler_wrap st) noexcept;
@@ -616,6 +663,22 @@ namespace e2d
             m2f, m3f, m4f>;
 
         class property_block final {
+        public:
+            // a pointer to the value in the block, every access
+            // through it marks the hash of the block dirty
+            template < typename T >
+            class value_ref final {
+            public:
+                value_ref(T* value, bool& dirty_hash) noexcept;
+
+                T* get() const noexcept;
+                T& operator*() const noexcept;
+                T* operator->() const noexcept;
+                explicit operator bool() const noexcept;
+            private:
+                T* value_ = nullptr;
+                bool* dirty_hash_ = nullptr;
+            };
         public:
             property_block() = default;
             ~property_block() noexcept = default;
@@ -631,7 +694,7 @@ namespace e2d
             bool equals(const property_block& other) const noexcept;
 
             property_block& sampler(str_hash name, const sampler_state& s);
-            sampler_state* sampler(str_hash name) noexcept;
+            value_ref<sampler_state> sampler(str_hash name) noexcept;
             const sampler_state* sampler(str_hash name) const noexcept;
 
             template < typename T >
@@ -640,7 +703,7 @@ namespace e2d
             const T* property(str_hash name) const noexcept;
 
             property_block& property(str_hash name, const property_value& v);
-            property_value* property(str_hash name) noexcept;
+            value_ref<property_value> property(str_hash name) noexcept;
             const property_value* property(str_hash name) const noexcept;
 
             template < typename F >
@@ -651,9 +714,59 @@ namespace e2d
 
             std::size_t sampler_count() const noexcept;
             std::size_t property_count() const noexcept;
+
+            std::size_t hash() const noexcept;
+        private:
+            // sorted by name, the first inline_capacity entries
+            // are stored without any heap allocations
+            template < typename T >
+            class flat_map final {
+            public:
+                using value_type = std::pair<str_hash, T>;
+                static constexpr std::size_t inline_capacity = 8;
+            public:
+                flat_map() noexcept;
+                ~flat_map() noexcept;
+
+                flat_map(flat_map&& other) noexcept;
+                flat_map& operator=(flat_map&& other) noexcept;
+
+                flat_map(const flat_map& other);
+                flat_map& operator=(const flat_map& other);
+
+                void clear() noexcept;
+                void merge(const flat_map& other);
+                bool equals(const flat_map& other) const noexcept;
+
+                template < typename U >
+                T& assign(str_hash key, U&& value);
+
+                T* find(str_hash key) noexcept;
+                const T* find(str_hash key) const noexcept;
+
+                const value_type* begin() const noexcept;
+                const value_type* end() const noexcept;
+                std::size_t size() const noexcept;
+            private:
+                value_type* data() noexcept;
+                const value_type* data() const noexcept;
+                value_type* inline_data() noexcept;
+                const value_type* inline_data() const noexcept;
+                void move_to_heap(std::size_t capacity);
+            private:
+                using inline_storage = std::aligned_storage_t<
+                    sizeof(value_type), alignof(value_type)>;
+                inline_storage inline_[inline_capacity];
+                vector<value_type> heap_;
+                std::size_t size_ = 0;
+            };
+            static bool is_same_value(const sampler_state& l, const sampler_state& r) noexcept;
+            static bool is_same_value(const property_value& l, const property_value& r) noexcept;
         private:
-            hash_map<str_hash, sampler_state> samplers_;
-            hash_map<str_hash, property_value> properties_;
+            flat_map<sampler_state> samplers_;
+            flat_map<property_value> properties_;
+            mutable std::size_t hash_ = 0;
+            mutable bool dirty_hash_ = true;
         };
 
         class pass_state final {
@@ -848,6 +961,11 @@ namespace e2d
             std::size_t command_count_ = 0;
         };
 
+        enum class buffer_streaming : u8 {
+            orphaning,
+            triple_buffering
+        };
+
         struct device_caps {
             u32 max_texture_size = 0;
             u32 max_renderbuffer_size = 0;
@@ -866,6 +984,26 @@ namespace e2d
             bool npot_texture_supported = false;
             bool depth_texture_supported = false;
             bool render_target_supported = false;
+            bool pixel_buffer_supported = false;
+            bool texture_base_level_supported = false;
+
+            buffer_streaming buffer_streaming_strategy = buffer_streaming::orphaning;
+        };
+
+        struct frame_statistics {
+            u32 draw_calls = 0;
+
+            u32 applied_state_changes = 0;
+            u32 skipped_state_changes = 0;
+
+            u32 applied_texture_binds = 0;
+            u32 skipped_texture_binds = 0;
+
+            u32 applied_buffer_binds = 0;
+            u32 skipped_buffer_binds = 0;
+
+            u32 issued_uniform_uploads = 0;
+            u32 skipped_uniform_uploads = 0;
         };
     public:
         render(debug& d, window& w);
@@ -889,16 +1027,36 @@ namespace e2d
             const v2u& size,
             const pixel_declaration& decl);
 
+        // creates a texture without level data,
+        // levels are loaded by texture::load_mipmap
+        texture_ptr create_streaming_texture(
+            const v2u& size,
+            image_data_format format,
+            u32 mipmap_count);
+
+        pixel_buffer_ptr create_pixel_buffer(
+            std::size_t size);
+
         index_buffer_ptr create_index_buffer(
             const buffer& indices,
             const index_declaration& decl,
             index_buffer::usage usage);
 
+        index_buffer_ptr create_index_buffer(
+            std::size_t size,
+            const index_declaration& decl,
+            index_buffer::usage usage);
+
         vertex_buffer_ptr create_vertex_buffer(
             const buffer& vertices,
             const vertex_declaration& decl,
             vertex_buffer::usage usage);
 
+        vertex_buffer_ptr create_vertex_buffer(
+            std::size_t size,
+            const vertex_declaration& decl,
+            vertex_buffer::usage usage);
+
         render_target_ptr create_render_target(
             const v2u& size,
             const pixel_declaration& color_decl,
@@ -914,6 +1072,9 @@ namespace e2d
         render& execute(const target_command& command);
         render& execute(const viewport_command& command);
 
+        render& frame_tick() noexcept;
+        const frame_statistics& last_frame_statistics() const noexcept;
+
         const device_caps& device_capabilities() const noexcept;
         bool is_pixel_supported(const pixel_declaration& decl) const noexcept;
         bool is_index_supported(const index_declaration& decl) const noexcept;
@@ -81,15 +81,16 @@ namespace e2d
 
     template < typename T >
     render::property_block& render::property_block::property(str_hash name, T&& v) {
-        properties_[name] = std::forward<T>(v);
+        properties_.assign(name, std::forward<T>(v));
+        dirty_hash_ = true;
         return *this;
     }
 
     template < typename T >
     const T* render::property_block::property(str_hash name) const noexcept {
-        const auto iter = properties_.find(name);
-        return iter != properties_.end()
-            ? stdex::get_if<T>(&iter->second)
+        const property_value* value = properties_.find(name);
+        return value
+            ? stdex::get_if<T>(value)
             : nullptr;
     }
 
@@ -107,6 +108,295 @@ namespace e2d
         }
     }
 
+    //
+    // render::property_block::value_ref
+    //
+
+    template < typename T >
+    render::property_block::value_ref<T>::value_ref(T* value, bool& dirty_hash) noexcept
+    : value_(value)
+    , dirty_hash_(&dirty_hash) {}
+
+    template < typename T >
+    T* render::property_block::value_ref<T>::get() const noexcept {
+        *dirty_hash_ = true;
+        return value_;
+    }
+
+    template < typename T >
+    T& render::property_block::value_ref<T>::operator*() const noexcept {
+        E2D_ASSERT(value_);
+        return *get();
+    }
+
+    template < typename T >
+    T* render::property_block::value_ref<T>::operator->() const noexcept {
+        E2D_ASSERT(value_);
+        return get();
+    }
+
+    template < typename T >
+    render::property_block::value_ref<T>::operator bool() const noexcept {
+        return !!value_;
+    }
+
+    //
+    // render::property_block::flat_map
+    //
+
+    template < typename T >
+    constexpr std::size_t render::property_block::flat_map<T>::inline_capacity;
+
+    // not defaulted in the class, the inline storage
+    // is left uninitialized for const blocks too
+    template < typename T >
+    render::property_block::flat_map<T>::flat_map() noexcept = default;
+
+    template < typename T >
+    render::property_block::flat_map<T>::~flat_map() noexcept {
+        clear();
+    }
+
+    template < typename T >
+    render::property_block::flat_map<T>::flat_map(flat_map&& other) noexcept {
+        *this = std::move(other);
+    }
+
+    template < typename T >
+    render::property_block::flat_map<T>& render::property_block::flat_map<T>::operator=(flat_map&& other) noexcept {
+        if ( this != &other ) {
+            clear();
+            if ( other.heap_.empty() ) {
+                std::uninitialized_copy(
+                    std::make_move_iterator(other.inline_data()),
+                    std::make_move_iterator(other.inline_data() + other.size_),
+                    inline_data());
+                size_ = other.size_;
+                other.clear();
+            } else {
+                heap_.swap(other.heap_);
+                size_ = other.size_;
+                other.size_ = 0;
+            }
+        }
+        return *this;
+    }
+
+    template < typename T >
+    render::property_block::flat_map<T>::flat_map(const flat_map& other) {
+        *this = other;
+    }
+
+    template < typename T >
+    render::property_block::flat_map<T>& render::property_block::flat_map<T>::operator=(const flat_map& other) {
+        if ( this != &other ) {
+            clear();
+            if ( other.size_ > inline_capacity ) {
+                heap_.assign(other.begin(), other.end());
+            } else {
+                std::uninitialized_copy(other.begin(), other.end(), inline_data());
+            }
+            size_ = other.size_;
+        }
+        return *this;
+    }
+
+    template < typename T >
+    void render::property_block::flat_map<T>::clear() noexcept {
+        if ( heap_.empty() ) {
+            value_type* first = inline_data();
+            for ( std::size_t i = 0; i < size_; ++i ) {
+                first[i].~value_type();
+            }
+        } else {
+            heap_.clear();
+        }
+        size_ = 0;
+    }
+
+    template < typename T >
+    void render::property_block::flat_map<T>::merge(const flat_map& other) {
+        if ( this == &other || !other.size_ ) {
+            return;
+        }
+
+        const value_type* r = other.data();
+        std::size_t union_size = 0;
+        {
+            const value_type* l = data();
+            std::size_t li = 0, ri = 0;
+            while ( li < size_ && ri < other.size_ ) {
+                if ( l[li].first < r[ri].first ) {
+                    ++li;
+                } else if ( r[ri].first < l[li].first ) {
+                    ++ri;
+                } else {
+                    ++li;
+                    ++ri;
+                }
+                ++union_size;
+            }
+            union_size += (size_ - li) + (other.size_ - ri);
+        }
+
+        if ( union_size > inline_capacity || !heap_.empty() ) {
+            if ( heap_.empty() ) {
+                move_to_heap(union_size);
+            }
+            heap_.resize(union_size);
+        }
+
+        // merge from the back, so the entries of this map
+        // are moved at most once and always to the right,
+        // inline slots behind the old size are not constructed yet
+        value_type* d = data();
+        const std::size_t constructed = heap_.empty() ? size_ : union_size;
+        const auto put = [d, constructed](std::size_t index, auto&& value) {
+            if ( index < constructed ) {
+                d[index] = std::forward<decltype(value)>(value);
+            } else {
+                new (&d[index]) value_type(std::forward<decltype(value)>(value));
+            }
+        };
+
+        std::size_t li = size_, ri = other.size_, out = union_size;
+        while ( ri > 0 ) {
+            if ( li > 0 && r[ri - 1].first < d[li - 1].first ) {
+                put(--out, std::move(d[--li]));
+            } else {
+                if ( li > 0 && !(d[li - 1].first < r[ri - 1].first) ) {
+                    --li;
+                }
+                put(--out, r[--ri]);
+            }
+        }
+        size_ = union_size;
+    }
+
+    template < typename T >
+    bool render::property_block::flat_map<T>::equals(const flat_map& other) const noexcept {
+        if ( size_ != other.size_ ) {
+            return false;
+        }
+        const value_type* l = data();
+        const value_type* r = other.data();
+        for ( std::size_t i = 0; i < size_; ++i ) {
+            if ( !(l[i].first == r[i].first) || !is_same_value(l[i].second, r[i].second) ) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    template < typename T >
+    template < typename U >
+    T& render::property_block::flat_map<T>::assign(str_hash key, U&& value) {
+        value_type* first = data();
+        value_type* iter = std::lower_bound(first, first + size_, key,
+            [](const value_type& l, str_hash r) noexcept {
+                return l.first < r;
+            });
+        if ( iter != first + size_ && iter->first == key ) {
+            iter->second = std::forward<U>(value);
+            return iter->second;
+        }
+
+        const std::size_t index = math::numeric_cast<std::size_t>(iter - first);
+        if ( heap_.empty() && size_ == inline_capacity ) {
+            move_to_heap(size_ + 1);
+        }
+
+        if ( heap_.empty() ) {
+            value_type* d = inline_data();
+            if ( index == size_ ) {
+                new (&d[size_]) value_type(key, std::forward<U>(value));
+            } else {
+                new (&d[size_]) value_type(std::move(d[size_ - 1]));
+                std::move_backward(d + index, d + size_ - 1, d + size_);
+                d[index] = value_type(key, std::forward<U>(value));
+            }
+        } else {
+            heap_.insert(
+                heap_.begin() + math::numeric_cast<std::ptrdiff_t>(index),
+                value_type(key, std::forward<U>(value)));
+        }
+
+        ++size_;
+        return data()[index].second;
+    }
+
+    template < typename T >
+    T* render::property_block::flat_map<T>::find(str_hash key) noexcept {
+        const flat_map& self = *this;
+        return const_cast<T*>(self.find(key));
+    }
+
+    template < typename T >
+    const T* render::property_block::flat_map<T>::find(str_hash key) const noexcept {
+        const value_type* first = data();
+        const value_type* iter = std::lower_bound(first, first + size_, key,
+            [](const value_type& l, str_hash r) noexcept {
+                return l.first < r;
+            });
+        return iter != first + size_ && iter->first == key
+            ? &iter->second
+            : nullptr;
+    }
+
+    template < typename T >
+    const typename render::property_block::flat_map<T>::value_type*
+    render::property_block::flat_map<T>::begin() const noexcept {
+        return data();
+    }
+
+    template < typename T >
+    const typename render::property_block::flat_map<T>::value_type*
+    render::property_block::flat_map<T>::end() const noexcept {
+        return data() + size_;
+    }
+
+    template < typename T >
+    std::size_t render::property_block::flat_map<T>::size() const noexcept {
+        return size_;
+    }
+
+    template < typename T >
+    typename render::property_block::flat_map<T>::value_type*
+    render::property_block::flat_map<T>::data() noexcept {
+        return heap_.empty() ? inline_data() : heap_.data();
+    }
+
+    template < typename T >
+    const typename render::property_block::flat_map<T>::value_type*
+    render::property_block::flat_map<T>::data() const noexcept {
+        return heap_.empty() ? inline_data() : heap_.data();
+    }
+
+    template < typename T >
+    typename render::property_block::flat_map<T>::value_type*
+    render::property_block::flat_map<T>::inline_data() noexcept {
+        return reinterpret_cast<value_type*>(&inline_[0]);
+    }
+
+    template < typename T >
+    const typename render::property_block::flat_map<T>::value_type*
+    render::property_block::flat_map<T>::inline_data() const noexcept {
+        return reinterpret_cast<const value_type*>(&inline_[0]);
+    }
+
+    template < typename T >
+    void render::property_block::flat_map<T>::move_to_heap(std::size_t capacity) {
+        E2D_ASSERT(heap_.empty() && size_ <= inline_capacity);
+        heap_.reserve(math::max(capacity, inline_capacity * 2u));
+        heap_.assign(
+            std::make_move_iterator(inline_data()),
+            std::make_move_iterator(inline_data() + size_));
+        value_type* first = inline_data();
+        for ( std::size_t i = 0; i < size_; ++i ) {
+            first[i].~value_type();
+        }
+    }
+
     //
     // render::command_block
     //
@@ -0,0 +1,103 @@
+/*******************************************************************************
+ * This file is part of the "Enduro2D"
+ * For conditions of distribution and use, see copyright notice in LICENSE.md
+ * Copyright (C) 2018 Matvey Cherevko
+ ******************************************************************************/
+
+#pragma once
+
+#include "_core.hpp"
+#include "render.hpp"
+
+namespace e2d
+{
+    //
+    // render_queue
+    //
+
+    class render_queue final : private noncopyable {
+    public:
+        // key layout (from high to low bits):
+        // sorted:  layer:8 | 0:1 | shader:12 | material:12 | textures:16 | depth:15
+        // ordered: layer:8 | 1:1 | 0:23 | sequence:32
+        // only opaque depth tested draws are sorted by state, they are
+        // executed first in their layer. blended draws and draws without
+        // depth testing keep the scene order by their sequence numbers
+        using key_type = u64;
+
+        class statistics final {
+        public:
+            std::size_t command_count = 0;
+            std::size_t shader_switches = 0;
+            std::size_t material_switches = 0;
+            std::size_t texture_switches = 0;
+        };
+    public:
+        render_queue();
+        ~render_queue() noexcept;
+
+        static bool is_ordered(const render::material& mat) noexcept;
+
+        static key_type make_key(
+            u8 layer,
+            const render::material& mat,
+            const render::property_block& props,
+            f32 depth,
+            u32 sequence) noexcept;
+
+        // sequence numbers of ordered draws, draws of one sequence
+        // number are executed in their enqueue order
+        u32 next_sequence() noexcept;
+        u32 sequence() const noexcept;
+
+        render_queue& enqueue(
+            key_type key,
+            const render::draw_command& command);
+
+        render_queue& sort();
+        render_queue& flush(render& render);
+
+        template < typename F >
+        void foreach_by_sorted_commands(F&& f);
+        render_queue& clear() noexcept;
+
+        std::size_t command_count() const noexcept;
+        const statistics& last_statistics() const noexcept;
+    private:
+        struct command_type {
+            std::size_t first_index{0u};
+            std::size_t index_count{0u};
+            const render::material* material{nullptr};
+            render::geometry geometry;
+            std::size_t properties{0u};
+        };
+        using sort_item = std::pair<key_type, u32>;
+    private:
+        std::size_t intern_properties(const render::property_block& props);
+    private:
+        vector<command_type> commands_;
+        // property blocks are interned, consecutive commands
+        // with equal blocks share one copy of the block
+        vector<render::property_block> properties_;
+        std::size_t property_count_{0u};
+        vector<sort_item> sort_items_;
+        vector<sort_item> sort_temp_;
+        std::size_t command_count_{0u};
+        u32 sequence_{0u};
+        bool sorted_{true};
+        statistics statistics_;
+    };
+}
+
+namespace e2d
+{
+    template < typename F >
+    void render_queue::foreach_by_sorted_commands(F&& f) {
+        sort();
+        for ( const sort_item& item : sort_items_ ) {
+            const command_type& cmd = commands_[item.second];
+            f(render::draw_command(*cmd.material, cmd.geometry, properties_[cmd.properties])
+                .index_range(cmd.first_index, cmd.index_count));
+        }
+    }
+}
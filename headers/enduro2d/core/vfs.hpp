@@ -24,8 +24,15 @@ namespace e2d
     };
 
     class vfs final : public module<vfs> {
+    public:
+        enum class io_priority : u8 {
+            low,
+            normal,
+            high
+        };
     public:
         vfs();
+        explicit vfs(std::size_t io_threads);
         ~vfs() noexcept final;
 
         class file_source : private e2d::noncopyable {
@@ -36,6 +43,10 @@ namespace e2d
             virtual input_stream_uptr read(str_view path) const = 0;
             virtual output_stream_uptr write(str_view path, bool append) const = 0;
             virtual bool trace(str_view path, filesystem::trace_func func) const = 0;
+
+            // reads the whole file into memory by default,
+            // sources with addressable content can map it without copying
+            virtual mapped_input_stream_uptr map(str_view path) const;
         };
         using file_source_uptr = std::unique_ptr<file_source>;
 
@@ -52,17 +63,29 @@ namespace e2d
         input_stream_uptr read(const url& url) const;
         output_stream_uptr write(const url& url, bool append) const;
 
+        // the view of the result is valid while the result is alive
+        mapped_input_stream_uptr map(const url& url) const;
+        stdex::promise<std::shared_ptr<mapped_input_stream>> map_async(
+            const url& url,
+            io_priority priority = io_priority::normal) const;
+
         bool load(const url& url, buffer& dst) const;
-        stdex::promise<buffer> load_async(const url& url) const;
+        stdex::promise<buffer> load_async(
+            const url& url,
+            io_priority priority = io_priority::normal) const;
 
         bool load_as_string(const url& url, str& dst) const;
-        stdex::promise<str> load_as_string_async(const url& url) const;
+        stdex::promise<str> load_as_string_async(
+            const url& url,
+            io_priority priority = io_priority::normal) const;
 
         template < typename Iter >
         bool extract(const url& url, Iter result_iter) const;
         bool trace(const url& url, filesystem::trace_func func) const;
 
         url resolve_scheme_aliases(const url& url) const;
+
+        std::size_t io_thread_count() const noexcept;
     private:
         class state;
         std::unique_ptr<state> state_;
@@ -77,6 +100,31 @@ namespace e2d
         input_stream_uptr read(str_view path) const final;
         output_stream_uptr write(str_view path, bool append) const final;
         bool trace(str_view path, filesystem::trace_func func) const final;
+        mapped_input_stream_uptr map(str_view path) const final;
+    private:
+        class state;
+        std::unique_ptr<state> state_;
+    };
+
+    //
+    // bundle_file_source
+    //
+    // engine bundle created by bundles::try_save_bundle, the directory
+    // of a mapped bundle is used in place and its stored entries are
+    // mapped without copying, compressed entries are decompressed
+    // chunk by chunk on the calling thread
+    //
+
+    class bundle_file_source final : public vfs::file_source {
+    public:
+        bundle_file_source(input_stream_uptr stream);
+        ~bundle_file_source() noexcept final;
+        bool valid() const noexcept final;
+        bool exists(str_view path) const final;
+        input_stream_uptr read(str_view path) const final;
+        output_stream_uptr write(str_view path, bool append) const final;
+        bool trace(str_view path, filesystem::trace_func func) const final;
+        mapped_input_stream_uptr map(str_view path) const final;
     private:
         class state;
         std::unique_ptr<state> state_;
@@ -91,6 +139,7 @@ namespace e2d
         input_stream_uptr read(str_view path) const final;
         output_stream_uptr write(str_view path, bool append) const final;
         bool trace(str_view path, filesystem::trace_func func) const final;
+        mapped_input_stream_uptr map(str_view path) const final;
     };
 }
 
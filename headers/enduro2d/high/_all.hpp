@@ -26,12 +26,17 @@
 #include "components/sprite_renderer.hpp"
 
 #include "systems/render_system.hpp"
+#include "systems/transform_system.hpp"
 
 #include "library.hpp"
 #include "library.inl"
 #include "model.hpp"
 #include "node.hpp"
 #include "node.inl"
+#include "spatial_index.hpp"
+#include "spatial_index.inl"
 #include "sprite.hpp"
 #include "starter.hpp"
+#include "texture_atlas.hpp"
+#include "transform_pass.hpp"
 #include "world.hpp"
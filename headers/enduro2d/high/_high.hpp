@@ -51,7 +51,10 @@ namespace e2d
 
     class model;
     class node;
+    class spatial_index;
     class sprite;
     class starter;
+    class texture_atlas;
+    class transform_pass;
     class world;
 }
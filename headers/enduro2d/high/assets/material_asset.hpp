@@ -15,6 +15,7 @@ namespace e2d
     public:
         material_asset(content_type content)
         : content_asset<material_asset, render::material>(std::move(content)) {}
+        static const char* type_name() noexcept;
         static load_async_result load_async(library& library, str_view address);
     };
 }
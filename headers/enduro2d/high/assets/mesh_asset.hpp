@@ -13,8 +13,14 @@ namespace e2d
 {
     class mesh_asset final : public content_asset<mesh_asset, mesh> {
     public:
-        mesh_asset(content_type content)
-        : content_asset<mesh_asset, mesh>(std::move(content)) {}
+        mesh_asset(content_type content);
+        static const char* type_name() noexcept;
+        std::size_t cpu_memory_usage() const noexcept final;
         static load_async_result load_async(library& library, str_view address);
+
+        // local bounds of the mesh vertices
+        const b3f& bounds() const noexcept;
+    private:
+        b3f bounds_;
     };
 }
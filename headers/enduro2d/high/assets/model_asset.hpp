@@ -17,6 +17,8 @@ namespace e2d
     public:
         model_asset(content_type content)
         : content_asset<model_asset, model>(std::move(content)) {}
+        static const char* type_name() noexcept;
+        std::size_t gpu_memory_usage() const noexcept final;
         static load_async_result load_async(library& library, str_view address);
     };
 }
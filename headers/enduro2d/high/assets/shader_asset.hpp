@@ -15,6 +15,7 @@ namespace e2d
     public:
         shader_asset(content_type content)
         : content_asset<shader_asset, shader_ptr>(std::move(content)) {}
+        static const char* type_name() noexcept;
         static load_async_result load_async(library& library, str_view address);
     };
 }
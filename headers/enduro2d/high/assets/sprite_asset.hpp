@@ -17,6 +17,7 @@ namespace e2d
     public:
         sprite_asset(content_type content)
         : content_asset<sprite_asset, sprite>(std::move(content)) {}
+        static const char* type_name() noexcept;
         static load_async_result load_async(library& library, str_view address);
     };
 }
@@ -15,6 +15,8 @@ namespace e2d
     public:
         text_asset(content_type content)
         : content_asset<text_asset, str>(std::move(content)) {}
+        static const char* type_name() noexcept;
+        std::size_t cpu_memory_usage() const noexcept final;
         static load_async_result load_async(library& library, str_view address);
     };
 }
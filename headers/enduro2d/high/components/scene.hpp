@@ -13,8 +13,8 @@ namespace e2d
 {
     class scene final {
     public:
-        scene() = default;
-        scene(const node_iptr& root) noexcept;
+        scene();
+        scene(const node_iptr& root);
 
         scene& depth(i32 value) noexcept;
         scene& root(const node_iptr& value) noexcept;
@@ -22,15 +22,25 @@ namespace e2d
         i32 depth() const noexcept;
         node_iptr root() noexcept;
         const_node_iptr root() const noexcept;
+
+        // flattened depth-first list of the root hierarchy,
+        // rebuilt only after hierarchy changes, not thread-safe
+        const vector<const node*>& draw_list() const;
+        bool draw_list_outdated() const noexcept;
     private:
         i32 depth_ = 0;
         node_iptr root_;
+        mutable const node* draw_list_root_{nullptr};
+        mutable u32 draw_list_version_{0u};
+        mutable vector<const node*> draw_list_;
     };
 }
 
 namespace e2d
 {
-    inline scene::scene(const node_iptr& root) noexcept
+    inline scene::scene() = default;
+
+    inline scene::scene(const node_iptr& root)
     : root_(root) {}
 
     inline scene& scene::depth(i32 value) noexcept {
@@ -39,7 +49,10 @@ namespace e2d
     }
 
     inline scene& scene::root(const node_iptr& value) noexcept {
+        // a new root may reuse the address of the old one
         root_ = value;
+        draw_list_root_ = nullptr;
+        draw_list_.clear();
         return *this;
     }
 
@@ -54,4 +67,22 @@ namespace e2d
     inline const_node_iptr scene::root() const noexcept {
         return root_;
     }
+
+    inline const vector<const node*>& scene::draw_list() const {
+        if ( draw_list_outdated() ) {
+            draw_list_.clear();
+            if ( root_ ) {
+                root_->extract_all_node_pointers(std::back_inserter(draw_list_));
+            }
+            draw_list_root_ = root_.get();
+            draw_list_version_ = root_ ? root_->hierarchy_version() : 0u;
+        }
+        return draw_list_;
+    }
+
+    inline bool scene::draw_list_outdated() const noexcept {
+        const u32 version = root_ ? root_->hierarchy_version() : 0u;
+        return draw_list_root_ != root_.get()
+            || draw_list_version_ != version;
+    }
 }
@@ -31,6 +31,15 @@ namespace e2d
         const char* what() const noexcept override = 0;
     };
 
+    //
+    // asset_memory_usage
+    //
+
+    struct asset_memory_usage {
+        std::size_t cpu_bytes{0u};
+        std::size_t gpu_bytes{0u};
+    };
+
     //
     // content_asset_base
     //
@@ -41,6 +50,11 @@ namespace e2d
     public:
         content_asset_base() = default;
         virtual ~content_asset_base() noexcept = default;
+
+        // bytes owned by the asset itself,
+        // referenced assets report their own sizes
+        virtual std::size_t cpu_memory_usage() const noexcept;
+        virtual std::size_t gpu_memory_usage() const noexcept;
     };
 
     //
@@ -88,8 +102,34 @@ namespace e2d
 
         template < typename Asset >
         typename Asset::load_async_result load_asset_async(str_view address);
+
+        // loads the asset as a dependency of the parent
+        // and records the edge in the dependency graph
+        template < typename Asset >
+        typename Asset::load_async_result load_dependency_async(
+            str_view parent_address,
+            str_view address);
+
+        // issues loads of the assets and all of their recorded
+        // dependencies at once, leaves first. the result is
+        // the number of assets that have been loaded successfully
+        stdex::promise<std::size_t> prefetch(const vector<str>& addresses);
+
+        // for dependencies that are not loaded through the library
+        void add_asset_dependency(str_view parent_address, str_view address);
+
+        vector<str> asset_types(str_view address) const;
+        vector<str> asset_dependencies(str_view address) const;
+
+        bool load_dependency_manifest(const url& manifest_url);
+        bool save_dependency_manifest(const url& manifest_url) const;
+    private:
+        void add_asset_type_(str_view address, str_view type);
+        void remove_asset_type_(str_view address, str_view type);
     private:
+        class dependency_graph;
         url root_;
+        std::unique_ptr<dependency_graph> dependencies_;
     };
 
     //
@@ -103,7 +143,50 @@ namespace e2d
 
         static std::size_t unload_all_unused_assets() noexcept;
         virtual std::size_t unload_self_unused_assets() noexcept = 0;
+
+        static vector<asset_cache_base*> all_caches();
+        static vector<asset_cache_base*> find_caches(str_view asset_type);
+        virtual const char* asset_type_name() const noexcept = 0;
+        virtual stdex::promise<void> prefetch_asset(str_view address) = 0;
+
+        // budgets limit memory of the cached assets, zero means unlimited.
+        // unreferenced assets over budget are evicted in least recently
+        // used order by evict_all_over_budget_assets on the frame end
+        static void global_memory_budget(const asset_memory_usage& budget) noexcept;
+        static asset_memory_usage global_memory_budget() noexcept;
+        static asset_memory_usage global_memory_usage() noexcept;
+        static std::size_t evict_all_over_budget_assets();
+
+        void memory_budget(const asset_memory_usage& budget) noexcept;
+        asset_memory_usage memory_budget() const noexcept;
+        virtual asset_memory_usage memory_usage() const noexcept = 0;
+        std::size_t evict_self_over_budget_assets();
+    protected:
+        struct eviction_candidate {
+            u64 last_use{0u};
+            asset_memory_usage usage;
+        };
+
+        static u64 next_use_tick() noexcept;
+
+        // unreferenced assets that can be evicted right now
+        virtual void collect_eviction_candidates(
+            vector<eviction_candidate>& candidates) = 0;
+
+        // evicts unreferenced assets that have not been used after last_use
+        virtual std::size_t evict_unused_assets_until(u64 last_use) noexcept = 0;
+    private:
+        static bool find_eviction_cutoff_(
+            vector<eviction_candidate>& candidates,
+            const asset_memory_usage& usage,
+            const asset_memory_usage& budget,
+            u64& last_use) noexcept;
     private:
+        std::atomic<std::size_t> cpu_budget_{0u};
+        std::atomic<std::size_t> gpu_budget_{0u};
+        static std::atomic<std::size_t> global_cpu_budget_;
+        static std::atomic<std::size_t> global_gpu_budget_;
+        static std::atomic<u64> use_tick_;
         static std::mutex mutex_;
         static hash_set<asset_cache_base*> caches_;
     };
@@ -117,6 +200,7 @@ namespace e2d
                       , public module<asset_cache<Asset>> {
     public:
         using asset_result = typename Asset::load_result;
+        using async_asset_result = typename Asset::load_async_result;
     public:
         asset_cache(library& l);
         ~asset_cache() noexcept final;
@@ -124,14 +208,39 @@ namespace e2d
         asset_result find(str_hash address) const;
         void store(str_hash address, const asset_result& asset);
 
+        // returns true with the cached or the in-flight load result,
+        // otherwise registers the result as in-flight and returns false
+        bool find_or_add_pending(str_hash address, async_asset_result& result);
+        void remove_pending(str_hash address) noexcept;
+
         void clear() noexcept;
         std::size_t asset_count() const noexcept;
+        std::size_t pending_count() const noexcept;
+        std::size_t coalesced_count() const noexcept;
 
         std::size_t unload_self_unused_assets() noexcept override;
+
+        const char* asset_type_name() const noexcept override;
+        stdex::promise<void> prefetch_asset(str_view address) override;
+
+        asset_memory_usage memory_usage() const noexcept override;
+    protected:
+        void collect_eviction_candidates(
+            vector<eviction_candidate>& candidates) override;
+        std::size_t evict_unused_assets_until(u64 last_use) noexcept override;
+    private:
+        struct asset_entry {
+            asset_result asset;
+            asset_memory_usage usage;
+            mutable u64 last_use{0u};
+        };
     private:
         library& library_;
         mutable std::mutex mutex_;
-        hash_map<str_hash, asset_result> assets_;
+        hash_map<str_hash, asset_entry> assets_;
+        asset_memory_usage usage_;
+        hash_map<str_hash, async_asset_result> pending_;
+        std::size_t coalesced_count_{0u};
     };
 }
 
@@ -30,23 +30,59 @@ namespace e2d
 
     template < typename Asset >
     typename Asset::load_async_result library::load_asset_async(str_view address) {
+        // the graph is updated by real loads only, cache hits and
+        // coalesced requests have been recorded by their first load
         if ( !modules::is_initialized<asset_cache<Asset>>() ) {
-            return Asset::load_async(*this, address);
+            add_asset_type_(address, Asset::type_name());
+            try {
+                return Asset::load_async(*this, address)
+                    .except([this, address_str = str(address)](std::exception_ptr e)
+                        -> typename Asset::load_result
+                    {
+                        remove_asset_type_(address_str, Asset::type_name());
+                        std::rethrow_exception(e);
+                    });
+            } catch (...) {
+                remove_asset_type_(address, Asset::type_name());
+                throw;
+            }
         }
 
         auto& cache = the<asset_cache<Asset>>();
-        if ( auto cached_asset = cache.find(address) ) {
-            return stdex::make_resolved_promise(std::move(cached_asset));
+        const str_hash address_hash = make_hash(address);
+
+        typename Asset::load_async_result result;
+        if ( cache.find_or_add_pending(address_hash, result) ) {
+            return result;
+        }
+
+        try {
+            add_asset_type_(address, Asset::type_name());
+            Asset::load_async(*this, address)
+                .then([&cache, address_hash, result](auto&& new_asset) mutable {
+                    cache.store(address_hash, new_asset);
+                    result.resolve(new_asset);
+                }, [this, &cache, address_hash, address_str = str(address), result](std::exception_ptr e) mutable {
+                    cache.remove_pending(address_hash);
+                    result.reject(e);
+                    remove_asset_type_(address_str, Asset::type_name());
+                });
+        } catch (...) {
+            cache.remove_pending(address_hash);
+            result.reject(std::current_exception());
+            remove_asset_type_(address, Asset::type_name());
         }
 
-        return Asset::load_async(*this, address)
-            .then([
-                &cache,
-                address_hash = make_hash(address)
-            ](auto&& new_asset){
-                cache.store(address_hash, new_asset);
-                return new_asset;
-            });
+        return result;
+    }
+
+    template < typename Asset >
+    typename Asset::load_async_result library::load_dependency_async(
+        str_view parent_address,
+        str_view address)
+    {
+        add_asset_dependency(parent_address, address);
+        return load_asset_async<Asset>(address);
     }
 
     //
@@ -64,21 +100,62 @@ namespace e2d
     typename asset_cache<T>::asset_result asset_cache<T>::find(str_hash address) const {
         std::lock_guard<std::mutex> guard(mutex_);
         const auto iter = assets_.find(address);
-        return iter != assets_.end()
-            ? iter->second
-            : nullptr;
+        if ( iter == assets_.end() ) {
+            return nullptr;
+        }
+        iter->second.last_use = next_use_tick();
+        return iter->second.asset;
     }
 
     template < typename T >
     void asset_cache<T>::store(str_hash address, const asset_result& asset) {
+        asset_memory_usage asset_usage;
+        if ( asset ) {
+            asset_usage.cpu_bytes = asset->cpu_memory_usage();
+            asset_usage.gpu_bytes = asset->gpu_memory_usage();
+        }
         std::lock_guard<std::mutex> guard(mutex_);
-        assets_[address] = asset;
+        asset_entry& entry = assets_[address];
+        usage_.cpu_bytes -= entry.usage.cpu_bytes;
+        usage_.gpu_bytes -= entry.usage.gpu_bytes;
+        entry.asset = asset;
+        entry.usage = asset_usage;
+        entry.last_use = next_use_tick();
+        usage_.cpu_bytes += entry.usage.cpu_bytes;
+        usage_.gpu_bytes += entry.usage.gpu_bytes;
+        pending_.erase(address);
+    }
+
+    template < typename T >
+    bool asset_cache<T>::find_or_add_pending(str_hash address, async_asset_result& result) {
+        std::lock_guard<std::mutex> guard(mutex_);
+        const auto asset_iter = assets_.find(address);
+        if ( asset_iter != assets_.end() ) {
+            asset_iter->second.last_use = next_use_tick();
+            result = stdex::make_resolved_promise(asset_iter->second.asset);
+            return true;
+        }
+        const auto pending_iter = pending_.find(address);
+        if ( pending_iter != pending_.end() ) {
+            result = pending_iter->second;
+            ++coalesced_count_;
+            return true;
+        }
+        pending_.emplace(address, result);
+        return false;
+    }
+
+    template < typename T >
+    void asset_cache<T>::remove_pending(str_hash address) noexcept {
+        std::lock_guard<std::mutex> guard(mutex_);
+        pending_.erase(address);
     }
 
     template < typename T >
     void asset_cache<T>::clear() noexcept {
         std::lock_guard<std::mutex> guard(mutex_);
         assets_.clear();
+        usage_ = asset_memory_usage();
     }
 
     template < typename T >
@@ -87,12 +164,79 @@ namespace e2d
         return assets_.size();
     }
 
+    template < typename T >
+    std::size_t asset_cache<T>::pending_count() const noexcept {
+        std::lock_guard<std::mutex> guard(mutex_);
+        return pending_.size();
+    }
+
+    template < typename T >
+    std::size_t asset_cache<T>::coalesced_count() const noexcept {
+        std::lock_guard<std::mutex> guard(mutex_);
+        return coalesced_count_;
+    }
+
+    template < typename T >
+    const char* asset_cache<T>::asset_type_name() const noexcept {
+        return T::type_name();
+    }
+
+    template < typename T >
+    stdex::promise<void> asset_cache<T>::prefetch_asset(str_view address) {
+        return library_.load_asset_async<T>(address)
+            .then([](const asset_result&){});
+    }
+
+    template < typename T >
+    asset_memory_usage asset_cache<T>::memory_usage() const noexcept {
+        std::lock_guard<std::mutex> guard(mutex_);
+        return usage_;
+    }
+
+    template < typename T >
+    void asset_cache<T>::collect_eviction_candidates(
+        vector<eviction_candidate>& candidates)
+    {
+        std::lock_guard<std::mutex> guard(mutex_);
+        for ( const auto& p : assets_ ) {
+            const asset_entry& entry = p.second;
+            if ( !entry.asset || 1 == entry.asset->use_count() ) {
+                eviction_candidate candidate;
+                candidate.last_use = entry.last_use;
+                candidate.usage = entry.usage;
+                candidates.push_back(candidate);
+            }
+        }
+    }
+
+    template < typename T >
+    std::size_t asset_cache<T>::evict_unused_assets_until(u64 last_use) noexcept {
+        std::lock_guard<std::mutex> guard(mutex_);
+        std::size_t result = 0u;
+        for ( auto iter = assets_.begin(); iter != assets_.end(); ) {
+            const asset_entry& entry = iter->second;
+            const bool unused = !entry.asset || 1 == entry.asset->use_count();
+            if ( unused && entry.last_use <= last_use ) {
+                usage_.cpu_bytes -= entry.usage.cpu_bytes;
+                usage_.gpu_bytes -= entry.usage.gpu_bytes;
+                iter = assets_.erase(iter);
+                ++result;
+            } else {
+                ++iter;
+            }
+        }
+        return result;
+    }
+
     template < typename T >
     std::size_t asset_cache<T>::unload_self_unused_assets() noexcept {
         std::lock_guard<std::mutex> guard(mutex_);
         std::size_t result = 0u;
         for ( auto iter = assets_.begin(); iter != assets_.end(); ) {
-            if ( !iter->second || 1 == iter->second->use_count() ) {
+            const asset_entry& entry = iter->second;
+            if ( !entry.asset || 1 == entry.asset->use_count() ) {
+                usage_.cpu_bytes -= entry.usage.cpu_bytes;
+                usage_.gpu_bytes -= entry.usage.gpu_bytes;
                 iter = assets_.erase(iter);
                 ++result;
             } else {
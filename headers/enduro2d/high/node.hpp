@@ -18,6 +18,9 @@ namespace e2d
 
     class node_children_ilist_tag {};
     using node_children = intrusive_list<node, node_children_ilist_tag>;
+
+    class node_spatial_moved_ilist_tag {};
+    using node_spatial_moved = intrusive_list<node, node_spatial_moved_ilist_tag>;
 }
 
 namespace e2d
@@ -25,7 +28,8 @@ namespace e2d
     class node
         : private noncopyable
         , public ref_counter<node>
-        , public intrusive_list_hook<node_children_ilist_tag> {
+        , public intrusive_list_hook<node_children_ilist_tag>
+        , public intrusive_list_hook<node_spatial_moved_ilist_tag> {
     public:
         virtual ~node() noexcept;
 
@@ -50,8 +54,13 @@ namespace e2d
         void scale(const v3f& scale) noexcept;
         const v3f& scale() const noexcept;
 
-        const m4f& local_matrix() const noexcept;
-        const m4f& world_matrix() const noexcept;
+        const a3f& local_affine() const noexcept;
+        const a3f& world_affine() const noexcept;
+
+        // expanded from the affine forms on each call and returned
+        // by value, so keep the result instead of calling it per use
+        m4f local_matrix() const noexcept;
+        m4f world_matrix() const noexcept;
 
         node_iptr root() noexcept;
         const_node_iptr root() const noexcept;
@@ -73,6 +82,9 @@ namespace e2d
         std::size_t child_count() const noexcept;
         std::size_t child_count_recursive() const noexcept;
 
+        // changes whenever the hierarchy of the node subtree changes
+        u32 hierarchy_version() const noexcept;
+
         bool add_child(
             const node_iptr& child) noexcept;
 
@@ -128,14 +140,27 @@ namespace e2d
 
         template < typename Iter >
         std::size_t extract_all_nodes(Iter iter) const;
+
+        template < typename Iter >
+        std::size_t extract_all_node_pointers(Iter iter) const;
     protected:
         node(world& world);
         node(const ecs::entity& entity);
+    private:
+        friend class spatial_index;
+        void join_spatial_index_(spatial_index* index) noexcept;
+        void leave_spatial_index_() noexcept;
+    private:
+        friend class transform_pass;
+        void join_transform_pass_(transform_pass* pass) noexcept;
+        void leave_transform_pass_() noexcept;
     private:
         enum flag_masks : u32 {
             fm_dirty_local_matrix = 1u << 0,
             fm_dirty_world_matrix = 1u << 1,
+            fm_spatial_moved = 1u << 2,
         };
+        void mark_dirty_hierarchy_() noexcept;
         void mark_dirty_local_matrix_() noexcept;
         void mark_dirty_world_matrix_() noexcept;
         void update_local_matrix_() const noexcept;
@@ -145,10 +170,15 @@ namespace e2d
         ecs::entity entity_;
         node* parent_{nullptr};
         node_children children_;
+        spatial_index* spatial_index_{nullptr};
+        u32 spatial_proxy_{std::numeric_limits<u32>::max()};
+        transform_pass* transform_pass_{nullptr};
+        u32 transform_index_{std::numeric_limits<u32>::max()};
+        u32 hierarchy_version_{0u};
     private:
         mutable u32 flags_{0u};
-        mutable m4f local_matrix_;
-        mutable m4f world_matrix_;
+        mutable a3f local_affine_;
+        mutable a3f world_affine_;
     };
 }
 
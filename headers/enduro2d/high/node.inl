@@ -45,6 +45,16 @@ namespace e2d
         });
         return count;
     }
+
+    template < typename Iter >
+    std::size_t node::extract_all_node_pointers(Iter iter) const {
+        std::size_t count{1u};
+        iter++ = this;
+        for ( const node& child : children_ ) {
+            count += child.extract_all_node_pointers(iter);
+        }
+        return count;
+    }
 }
 
 #endif
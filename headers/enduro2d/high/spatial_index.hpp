@@ -0,0 +1,116 @@
+/*******************************************************************************
+ * This file is part of the "Enduro2D"
+ * For conditions of distribution and use, see copyright notice in LICENSE.md
+ * Copyright (C) 2018 Matvey Cherevko
+ ******************************************************************************/
+
+#ifndef E2D_INCLUDE_GUARD_5F0B7C1D2E8A4B6C9D3E7F1A2B4C6D8E
+#define E2D_INCLUDE_GUARD_5F0B7C1D2E8A4B6C9D3E7F1A2B4C6D8E
+#pragma once
+
+#include "_high.hpp"
+#include "node.hpp"
+
+namespace e2d
+{
+    class bad_spatial_index_operation final : public exception {
+    public:
+        const char* what() const noexcept final {
+            return "bad spatial index operation";
+        }
+    };
+
+    //
+    // spatial_index
+    //
+    // dynamic aabb tree over the world bounds of all nodes of the root hierarchy.
+    // nodes join and leave the index with the hierarchy, nodes with changed
+    // world matrices are re-inserted by update() only if they leave their fat bounds.
+    // bounds come from the node renderers, changes of renderers are not tracked,
+    // so such nodes must be passed to invalidate(). the index is opt-in, the
+    // render system updates an index rooted at a scene root and culls the
+    // scene nodes by it. the hierarchy must not be changed from query callbacks.
+    //
+
+    class spatial_index final : private noncopyable {
+    public:
+        spatial_index(const node_iptr& root, f32 margin = 0.f);
+        ~spatial_index() noexcept;
+
+        node_iptr root() noexcept;
+        const_node_iptr root() const noexcept;
+
+        void update();
+        void invalidate(const node_iptr& node);
+
+        std::size_t node_count() const noexcept;
+        std::size_t pending_count() const noexcept;
+        std::size_t tree_height() const noexcept;
+
+        bool find_bounds(const const_node_iptr& node, b3f& result) const noexcept;
+
+        // marks the nodes in the frustum, is_visible() reports them
+        // until the next call, nodes without bounds are visible
+        void cull_frustum(const m4f& view_proj);
+        bool is_visible(const node& node) const noexcept;
+
+        static spatial_index* find(const const_node_iptr& root) noexcept;
+
+        template < typename F >
+        void query_point(const v3f& point, F&& f);
+
+        template < typename F >
+        void query_aabb(const b3f& bounds, F&& f);
+
+        template < typename F >
+        void query_rect(const b2f& rect, F&& f);
+
+        template < typename F >
+        void query_ray(const v3f& origin, const v3f& direction, F&& f);
+
+        template < typename F >
+        void query_frustum(const m4f& view_proj, F&& f);
+    private:
+        friend class node;
+        friend class transform_pass;
+        void on_join_(node* n) noexcept;
+        void on_leave_(node* n) noexcept;
+        void on_moved_(node* n) noexcept;
+    private:
+        static constexpr u32 null_proxy = std::numeric_limits<u32>::max();
+
+        struct tree_node {
+            v3f min;
+            v3f max;
+            node* data{nullptr};
+            u32 parent{null_proxy};
+            u32 child1{null_proxy};
+            u32 child2{null_proxy};
+            i32 height{-1};
+            u32 visible_stamp{0u};
+            bool is_leaf() const noexcept;
+        };
+
+        u32 allocate_proxy_();
+        void free_proxy_(u32 proxy) noexcept;
+        void insert_leaf_(u32 leaf);
+        void remove_leaf_(u32 leaf) noexcept;
+        u32 balance_(u32 a) noexcept;
+
+        template < typename Pred, typename F >
+        void query_(Pred&& pred, F&& f);
+    private:
+        node_iptr root_;
+        f32 margin_{0.f};
+        vector<tree_node> nodes_;
+        vector<u32> query_stack_;
+        node_spatial_moved moved_;
+        u32 root_proxy_{null_proxy};
+        u32 free_list_{null_proxy};
+        std::size_t leaf_count_{0u};
+        u32 visible_stamp_{0u};
+    };
+}
+
+#include "spatial_index.inl"
+#endif
@@ -0,0 +1,125 @@
+/*******************************************************************************
+ * This file is part of the "Enduro2D"
+ * For conditions of distribution and use, see copyright notice in LICENSE.md
+ * Copyright (C) 2018 Matvey Cherevko
+ ******************************************************************************/
+
+#ifndef E2D_INCLUDE_GUARD_9A3C5E7B1D2F4A6C8E0B2D4F6A8C0E2B
+#define E2D_INCLUDE_GUARD_9A3C5E7B1D2F4A6C8E0B2D4F6A8C0E2B
+#pragma once
+
+#include "spatial_index.hpp"
+
+namespace e2d
+{
+    inline bool spatial_index::tree_node::is_leaf() const noexcept {
+        return child1 == null_proxy;
+    }
+
+    template < typename F >
+    void spatial_index::query_point(const v3f& point, F&& f) {
+        query_([&point](const v3f& min, const v3f& max){
+            return point.x >= min.x && point.x <= max.x
+                && point.y >= min.y && point.y <= max.y
+                && point.z >= min.z && point.z <= max.z;
+        }, std::forward<F>(f));
+    }
+
+    template < typename F >
+    void spatial_index::query_aabb(const b3f& bounds, F&& f) {
+        const v3f b_min = bounds.position;
+        const v3f b_max = bounds.position + bounds.size;
+        query_([&b_min, &b_max](const v3f& min, const v3f& max){
+            return b_min.x <= max.x && b_max.x >= min.x
+                && b_min.y <= max.y && b_max.y >= min.y
+                && b_min.z <= max.z && b_max.z >= min.z;
+        }, std::forward<F>(f));
+    }
+
+    template < typename F >
+    void spatial_index::query_rect(const b2f& rect, F&& f) {
+        const v2f r_min = rect.position;
+        const v2f r_max = rect.position + rect.size;
+        query_([&r_min, &r_max](const v3f& min, const v3f& max){
+            return r_min.x <= max.x && r_max.x >= min.x
+                && r_min.y <= max.y && r_max.y >= min.y;
+        }, std::forward<F>(f));
+    }
+
+    template < typename F >
+    void spatial_index::query_ray(const v3f& origin, const v3f& direction, F&& f) {
+        query_([&origin, &direction](const v3f& min, const v3f& max){
+            f32 t_min = 0.f;
+            f32 t_max = std::numeric_limits<f32>::max();
+            for ( std::size_t i = 0; i < 3; ++i ) {
+                if ( math::approximately(direction[i], 0.f, 0.f) ) {
+                    if ( origin[i] < min[i] || origin[i] > max[i] ) {
+                        return false;
+                    }
+                } else {
+                    const f32 inv_d = 1.f / direction[i];
+                    f32 t1 = (min[i] - origin[i]) * inv_d;
+                    f32 t2 = (max[i] - origin[i]) * inv_d;
+                    if ( t1 > t2 ) {
+                        std::swap(t1, t2);
+                    }
+                    t_min = math::max(t_min, t1);
+                    t_max = math::min(t_max, t2);
+                    if ( t_min > t_max ) {
+                        return false;
+                    }
+                }
+            }
+            return true;
+        }, std::forward<F>(f));
+    }
+
+    template < typename F >
+    void spatial_index::query_frustum(const m4f& view_proj, F&& f) {
+        // clip planes of the row-vector view_proj matrix
+        v4f planes[6];
+        for ( std::size_t i = 0; i < 3; ++i ) {
+            for ( std::size_t j = 0; j < 4; ++j ) {
+                planes[i * 2 + 0][j] = view_proj[j][3] + view_proj[j][i];
+                planes[i * 2 + 1][j] = view_proj[j][3] - view_proj[j][i];
+            }
+        }
+        query_([&planes](const v3f& min, const v3f& max){
+            for ( const v4f& p : planes ) {
+                const f32 d =
+                    p.x * (p.x > 0.f ? max.x : min.x) +
+                    p.y * (p.y > 0.f ? max.y : min.y) +
+                    p.z * (p.z > 0.f ? max.z : min.z) + p.w;
+                if ( d < 0.f ) {
+                    return false;
+                }
+            }
+            return true;
+        }, std::forward<F>(f));
+    }
+
+    template < typename Pred, typename F >
+    void spatial_index::query_(Pred&& pred, F&& f) {
+        if ( root_proxy_ == null_proxy ) {
+            return;
+        }
+        query_stack_.clear();
+        query_stack_.push_back(root_proxy_);
+        while ( !query_stack_.empty() ) {
+            const u32 proxy = query_stack_.back();
+            query_stack_.pop_back();
+            const tree_node& tn = nodes_[proxy];
+            if ( !pred(tn.min, tn.max) ) {
+                continue;
+            }
+            if ( tn.is_leaf() ) {
+                f(*tn.data);
+            } else {
+                query_stack_.push_back(tn.child1);
+                query_stack_.push_back(tn.child2);
+            }
+        }
+    }
+}
+
+#endif
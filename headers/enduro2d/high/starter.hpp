@@ -8,6 +8,8 @@
 
 #include "_high.hpp"
 
+#include "texture_atlas.hpp"
+
 namespace e2d
 {
     //
@@ -36,15 +38,27 @@ namespace e2d
 
             parameters& library_root(const url& value);
             parameters& engine_params(const engine::parameters& value);
+            parameters& use_texture_atlas(bool value);
+            parameters& texture_atlas_params(const texture_atlas::parameters& value);
+            parameters& asset_memory_budget(const asset_memory_usage& value);
 
             url& library_root() noexcept;
             engine::parameters& engine_params() noexcept;
+            bool& use_texture_atlas() noexcept;
+            texture_atlas::parameters& texture_atlas_params() noexcept;
+            asset_memory_usage& asset_memory_budget() noexcept;
 
             const url& library_root() const noexcept;
             const engine::parameters& engine_params() const noexcept;
+            const bool& use_texture_atlas() const noexcept;
+            const texture_atlas::parameters& texture_atlas_params() const noexcept;
+            const asset_memory_usage& asset_memory_budget() const noexcept;
         private:
             url library_root_{"resources://bin/library"};
             engine::parameters engine_params_;
+            bool use_texture_atlas_{false};
+            texture_atlas::parameters texture_atlas_params_;
+            asset_memory_usage asset_memory_budget_;
         };
     public:
         starter(int argc, char *argv[], const parameters& params);
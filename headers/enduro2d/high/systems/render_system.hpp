@@ -11,10 +11,18 @@
 namespace e2d
 {
     class render_system final : public ecs::system {
+    public:
+        struct frame_statistics {
+            std::size_t batch_count = 0;
+            std::size_t saved_batch_count = 0;
+            std::size_t visible_count = 0;
+            std::size_t culled_count = 0;
+        };
     public:
         render_system();
         ~render_system() noexcept final;
         void process(ecs::registry& owner) override;
+        const frame_statistics& last_frame_statistics() const noexcept;
     private:
         class internal_state;
         std::unique_ptr<internal_state> state_;
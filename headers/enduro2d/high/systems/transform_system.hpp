@@ -0,0 +1,29 @@
+/*******************************************************************************
+ * This file is part of the "Enduro2D"
+ * For conditions of distribution and use, see copyright notice in LICENSE.md
+ * Copyright (C) 2018 Matvey Cherevko
+ ******************************************************************************/
+
+#pragma once
+
+#include "../_high.hpp"
+
+namespace e2d
+{
+    //
+    // transform_system
+    //
+    // keeps a transform pass for every scene root that is not in a pass yet
+    // and updates them, outer hierarchies first, before the render systems
+    //
+
+    class transform_system final : public ecs::system {
+    public:
+        transform_system();
+        ~transform_system() noexcept final;
+        void process(ecs::registry& owner) override;
+    private:
+        class internal_state;
+        std::unique_ptr<internal_state> state_;
+    };
+}
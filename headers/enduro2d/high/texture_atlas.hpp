@@ -0,0 +1,110 @@
+/*******************************************************************************
+ * This file is part of the "Enduro2D"
+ * For conditions of distribution and use, see copyright notice in LICENSE.md
+ * Copyright (C) 2018 Matvey Cherevko
+ ******************************************************************************/
+
+#pragma once
+
+#include "_high.hpp"
+
+#include "library.hpp"
+#include "assets/texture_asset.hpp"
+
+namespace e2d
+{
+    //
+    // texture_atlas
+    //
+
+    class texture_atlas final : public asset_cache_base
+                              , public module<texture_atlas> {
+    public:
+        class parameters {
+        public:
+            parameters& page_size(const v2u& value) noexcept;
+            parameters& max_image_size(u32 value) noexcept;
+            parameters& padding(u32 value) noexcept;
+
+            v2u& page_size() noexcept;
+            u32& max_image_size() noexcept;
+            u32& padding() noexcept;
+
+            const v2u& page_size() const noexcept;
+            const u32& max_image_size() const noexcept;
+            const u32& padding() const noexcept;
+        private:
+            v2u page_size_{1024u, 1024u};
+            u32 max_image_size_{256u};
+            u32 padding_{1u};
+        };
+
+        // texrect is in the sprite texture space
+        class region final {
+        public:
+            texture_asset::ptr page;
+            b2f texrect;
+        public:
+            b2f remap(const b2f& sprite_texrect) const noexcept;
+        };
+    public:
+        texture_atlas(library& l);
+        texture_atlas(library& l, const parameters& params);
+        ~texture_atlas() noexcept final;
+
+        // resolves with an empty region if the image can't be packed
+        stdex::promise<region> load_region_async(str_view address);
+
+        bool find(str_hash address, region& result) const;
+        bool insert(str_hash address, const image& image, region& result);
+
+        void clear() noexcept;
+        std::size_t page_count() const noexcept;
+        std::size_t region_count() const noexcept;
+        f32 occupancy() const noexcept;
+
+        // evicts pages that are not used by anybody else
+        std::size_t unload_self_unused_assets() noexcept override;
+
+        // size of the image with its padding in a page
+        static v2u padded_image_size(const v2u& image_size, u32 padding) noexcept;
+
+        // texrect of the image packed into 'packed_rect' of a page
+        static b2f packed_image_texrect(
+            const v2u& page_size,
+            const b2u& packed_rect,
+            const v2u& image_size,
+            u32 padding) noexcept;
+
+        // rgba8 image with its edges extruded into the padding
+        static image make_padded_image(const image& src, u32 padding);
+
+        const char* asset_type_name() const noexcept override;
+        stdex::promise<void> prefetch_asset(str_view address) override;
+
+        asset_memory_usage memory_usage() const noexcept override;
+    protected:
+        void collect_eviction_candidates(
+            vector<eviction_candidate>& candidates) override;
+        std::size_t evict_unused_assets_until(u64 last_use) noexcept override;
+    private:
+        struct page_type {
+            texture_asset::ptr texture;
+            skyline_packer packer;
+            mutable u64 last_use{0u};
+        };
+        struct region_type {
+            u32 page_id{0u};
+            b2f texrect;
+        };
+        bool find_(str_hash address, region& result) const;
+        void erase_page_regions_(u32 page_id) noexcept;
+    private:
+        library& library_;
+        parameters params_;
+        mutable std::mutex mutex_;
+        u32 next_page_id_{0u};
+        hash_map<u32, page_type> pages_;
+        hash_map<str_hash, region_type> regions_;
+    };
+}
@@ -0,0 +1,80 @@
+/*******************************************************************************
+ * This file is part of the "Enduro2D"
+ * For conditions of distribution and use, see copyright notice in LICENSE.md
+ * Copyright (C) 2018 Matvey Cherevko
+ ******************************************************************************/
+
+#ifndef E2D_INCLUDE_GUARD_9C2E4A7B1D3F4E5A8B6C0D2E4F6A8B1C
+#define E2D_INCLUDE_GUARD_9C2E4A7B1D3F4E5A8B6C0D2E4F6A8B1C
+#pragma once
+
+#include "_high.hpp"
+#include "node.hpp"
+
+namespace e2d
+{
+    class bad_transform_pass_operation final : public exception {
+    public:
+        const char* what() const noexcept final {
+            return "bad transform pass operation";
+        }
+    };
+
+    //
+    // transform_pass
+    //
+    // keeps local and world transforms of the root hierarchy in parallel
+    // arrays in depth-first order. transform setters of the hierarchy nodes
+    // only mark the changed node, update() recomputes the changed local
+    // transforms and the world ones of their subtrees in one linear sweep.
+    // matrix accessors of the nodes sweep pending changes on read, and
+    // after hierarchy changes compute the matrices through the parent
+    // chain until the arrays are rebuilt by update(), the transform
+    // system does it for every scene root before rendering.
+    //
+
+    class transform_pass final : private noncopyable {
+    public:
+        transform_pass(const node_iptr& root);
+        ~transform_pass() noexcept;
+
+        node_iptr root() noexcept;
+        const_node_iptr root() const noexcept;
+
+        void update();
+        bool up_to_date() const noexcept;
+
+        static bool is_joined(const const_node_iptr& node) noexcept;
+
+        std::size_t node_count() const noexcept;
+        std::size_t pending_count() const noexcept;
+        std::size_t last_updated_count() const noexcept;
+    private:
+        friend class node;
+        void on_join_(node* n) noexcept;
+        void on_leave_(node* n) noexcept;
+        void on_moved_(node* n) noexcept;
+        const a3f& local_affine_(const node& n) noexcept;
+        const a3f& world_affine_(const node& n) noexcept;
+        bool has_index_(const node& n) const noexcept;
+    private:
+        static constexpr u32 null_index = std::numeric_limits<u32>::max();
+
+        void rebuild_();
+        void update_moved_() noexcept;
+        void update_range_(u32 first, u32 last) noexcept;
+    private:
+        node_iptr root_;
+        bool dirty_hierarchy_{true};
+        vector<node*> nodes_;
+        vector<u32> parents_;
+        vector<u32> subtree_ends_;
+        vector<a3f> local_affines_;
+        vector<a3f> world_affines_;
+        vector<std::pair<u32, node*>> external_children_;
+        vector<node*> moved_;
+        std::size_t last_updated_count_{0u};
+    };
+}
+
+#endif
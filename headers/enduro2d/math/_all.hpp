@@ -9,11 +9,13 @@
 #include "_math.hpp"
 
 #include "aabb.hpp"
+#include "affine3.hpp"
 #include "mat2.hpp"
 #include "mat3.hpp"
 #include "mat4.hpp"
 #include "quat.hpp"
 #include "rect.hpp"
+#include "simd.hpp"
 #include "trig.hpp"
 #include "trs2.hpp"
 #include "trs3.hpp"
@@ -37,6 +37,9 @@ namespace e2d
     template < typename T >
     class aabb;
 
+    template < typename T >
+    class affine3;
+
     template < typename T >
     class trs2;
 
@@ -115,6 +118,13 @@ namespace e2d
     using b3hi = aabb<i16>;
     using b3hu = aabb<u16>;
 
+    using a3d = affine3<f64>;
+    using a3f = affine3<f32>;
+    using a3i = affine3<i32>;
+    using a3u = affine3<u32>;
+    using a3hi = affine3<i16>;
+    using a3hu = affine3<u16>;
+
     using t2d = trs2<f64>;
     using t2f = trs2<f32>;
     using t2i = trs2<i32>;
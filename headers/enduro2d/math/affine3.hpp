@@ -0,0 +1,450 @@
+/*******************************************************************************
+ * This file is part of the "Enduro2D"
+ * For conditions of distribution and use, see copyright notice in LICENSE.md
+ * Copyright (C) 2018 Matvey Cherevko
+ ******************************************************************************/
+
+#pragma once
+
+#include "_math.hpp"
+#include "mat4.hpp"
+#include "quat.hpp"
+#include "simd.hpp"
+#include "trig.hpp"
+#include "trs2.hpp"
+#include "trs3.hpp"
+#include "unit.hpp"
+#include "vec2.hpp"
+#include "vec3.hpp"
+#include "vec4.hpp"
+
+namespace e2d
+{
+    //
+    // affine3
+    //
+    // mat4 without the last column, which is always (0, 0, 0, 1)
+    // for affine transforms. rows[0..2] is the linear part and
+    // rows[3] is the translation, the same layout as in mat4.
+    //
+
+    template < typename T >
+    class affine3 final {
+        static_assert(
+            std::is_arithmetic<T>::value,
+            "type of 'affine3' must be arithmetic");
+    public:
+        using self_type = affine3;
+        using value_type = T;
+    public:
+        vec3<T> rows[4] = {
+            {1, 0, 0},
+            {0, 1, 0},
+            {0, 0, 1},
+            {0, 0, 0}};
+    public:
+        static const affine3& zero() noexcept;
+        static const affine3& identity() noexcept;
+    public:
+        affine3() noexcept = default;
+        affine3(const affine3& other) noexcept = default;
+        affine3& operator=(const affine3& other) noexcept = default;
+
+        affine3(const vec3<T>& row0,
+                const vec3<T>& row1,
+                const vec3<T>& row2,
+                const vec3<T>& row3) noexcept;
+
+        affine3(T m11, T m12, T m13,
+                T m21, T m22, T m23,
+                T m31, T m32, T m33,
+                T m41, T m42, T m43) noexcept;
+
+        template < typename To >
+        affine3<To> cast_to() const noexcept;
+
+        T* data() noexcept;
+        const T* data() const noexcept;
+
+        vec3<T>& operator[](std::size_t row) noexcept;
+        const vec3<T>& operator[](std::size_t row) const noexcept;
+
+        affine3& operator*=(const affine3& other) noexcept;
+    };
+}
+
+namespace e2d
+{
+    template < typename T >
+    const affine3<T>& affine3<T>::zero() noexcept {
+        static const affine3<T> zero{
+            0, 0, 0,
+            0, 0, 0,
+            0, 0, 0,
+            0, 0, 0};
+        return zero;
+    }
+
+    template < typename T >
+    const affine3<T>& affine3<T>::identity() noexcept {
+        static const affine3<T> identity{
+            1, 0, 0,
+            0, 1, 0,
+            0, 0, 1,
+            0, 0, 0};
+        return identity;
+    }
+
+    template < typename T >
+    affine3<T>::affine3(
+        const vec3<T>& row0,
+        const vec3<T>& row1,
+        const vec3<T>& row2,
+        const vec3<T>& row3) noexcept
+    : rows{row0, row1, row2, row3} {}
+
+    template < typename T >
+    affine3<T>::affine3(
+        T m11, T m12, T m13,
+        T m21, T m22, T m23,
+        T m31, T m32, T m33,
+        T m41, T m42, T m43) noexcept
+    : rows{{m11, m12, m13},
+           {m21, m22, m23},
+           {m31, m32, m33},
+           {m41, m42, m43}} {}
+
+    template < typename T >
+    template < typename To >
+    affine3<To> affine3<T>::cast_to() const noexcept {
+        return {
+            rows[0].template cast_to<To>(),
+            rows[1].template cast_to<To>(),
+            rows[2].template cast_to<To>(),
+            rows[3].template cast_to<To>()};
+    }
+
+    template < typename T >
+    T* affine3<T>::data() noexcept {
+        return rows[0].data();
+    }
+
+    template < typename T >
+    const T* affine3<T>::data() const noexcept {
+        return rows[0].data();
+    }
+
+    template < typename T >
+    vec3<T>& affine3<T>::operator[](std::size_t row) noexcept {
+        E2D_ASSERT(row < 4);
+        return rows[row];
+    }
+
+    template < typename T >
+    const vec3<T>& affine3<T>::operator[](std::size_t row) const noexcept {
+        E2D_ASSERT(row < 4);
+        return rows[row];
+    }
+
+    template < typename T >
+    affine3<T>& affine3<T>::operator*=(const affine3& other) noexcept {
+        return *this = *this * other;
+    }
+}
+
+namespace e2d
+{
+    //
+    // make_affine3
+    //
+
+    template < typename T >
+    affine3<T> make_affine3(
+        const vec3<T>& row0,
+        const vec3<T>& row1,
+        const vec3<T>& row2,
+        const vec3<T>& row3) noexcept
+    {
+        return affine3<T>(row0, row1, row2, row3);
+    }
+
+    template < typename T >
+    affine3<T> make_affine3(
+        T m11, T m12, T m13,
+        T m21, T m22, T m23,
+        T m31, T m32, T m33,
+        T m41, T m42, T m43) noexcept
+    {
+        return affine3<T>(
+            m11, m12, m13,
+            m21, m22, m23,
+            m31, m32, m33,
+            m41, m42, m43);
+    }
+
+    template < typename T >
+    affine3<T> make_affine3(const mat4<T>& m) noexcept {
+        return affine3<T>(
+            vec3<T>(m.rows[0]),
+            vec3<T>(m.rows[1]),
+            vec3<T>(m.rows[2]),
+            vec3<T>(m.rows[3]));
+    }
+
+    //
+    // affine3 (==,!=) affine3
+    //
+
+    template < typename T >
+    bool operator==(const affine3<T>& l, const affine3<T>& r) noexcept {
+        return
+            l.rows[0] == r.rows[0] &&
+            l.rows[1] == r.rows[1] &&
+            l.rows[2] == r.rows[2] &&
+            l.rows[3] == r.rows[3];
+    }
+
+    template < typename T >
+    bool operator!=(const affine3<T>& l, const affine3<T>& r) noexcept {
+        return !(l == r);
+    }
+
+    //
+    // affine3 (*) affine3
+    //
+
+    template < typename T >
+    affine3<T> operator*(const affine3<T>& l, const affine3<T>& r) noexcept {
+        const T* const lm = l.data();
+        const T* const rm = r.data();
+        return {
+            lm[ 0] * rm[0] + lm[ 1] * rm[3] + lm[ 2] * rm[6],
+            lm[ 0] * rm[1] + lm[ 1] * rm[4] + lm[ 2] * rm[7],
+            lm[ 0] * rm[2] + lm[ 1] * rm[5] + lm[ 2] * rm[8],
+
+            lm[ 3] * rm[0] + lm[ 4] * rm[3] + lm[ 5] * rm[6],
+            lm[ 3] * rm[1] + lm[ 4] * rm[4] + lm[ 5] * rm[7],
+            lm[ 3] * rm[2] + lm[ 4] * rm[5] + lm[ 5] * rm[8],
+
+            lm[ 6] * rm[0] + lm[ 7] * rm[3] + lm[ 8] * rm[6],
+            lm[ 6] * rm[1] + lm[ 7] * rm[4] + lm[ 8] * rm[7],
+            lm[ 6] * rm[2] + lm[ 7] * rm[5] + lm[ 8] * rm[8],
+
+            lm[ 9] * rm[0] + lm[10] * rm[3] + lm[11] * rm[6] + rm[ 9],
+            lm[ 9] * rm[1] + lm[10] * rm[4] + lm[11] * rm[7] + rm[10],
+            lm[ 9] * rm[2] + lm[10] * rm[5] + lm[11] * rm[8] + rm[11]};
+    }
+
+    //
+    // vec4 (*) affine3
+    //
+
+    template < typename T >
+    vec4<T> operator*(const vec4<T>& l, const affine3<T>& r) noexcept {
+        const T* const rm = r.data();
+        return {
+            l.x * rm[0] + l.y * rm[3] + l.z * rm[6] + l.w * rm[ 9],
+            l.x * rm[1] + l.y * rm[4] + l.z * rm[7] + l.w * rm[10],
+            l.x * rm[2] + l.y * rm[5] + l.z * rm[8] + l.w * rm[11],
+            l.w};
+    }
+}
+
+namespace e2d { namespace math
+{
+    //
+    // transform_point
+    //
+
+    template < typename T >
+    vec3<T> transform_point(const vec3<T>& p, const affine3<T>& m) noexcept {
+        const T* const mm = m.data();
+        return {
+            p.x * mm[0] + p.y * mm[3] + p.z * mm[6] + mm[ 9],
+            p.x * mm[1] + p.y * mm[4] + p.z * mm[7] + mm[10],
+            p.x * mm[2] + p.y * mm[5] + p.z * mm[8] + mm[11]};
+    }
+
+    template < typename T >
+    vec3<T> transform_point(const vec2<T>& p, const affine3<T>& m) noexcept {
+        const T* const mm = m.data();
+        return {
+            p.x * mm[0] + p.y * mm[3] + mm[ 9],
+            p.x * mm[1] + p.y * mm[4] + mm[10],
+            p.x * mm[2] + p.y * mm[5] + mm[11]};
+    }
+
+    //
+    // transform_direction
+    //
+
+    template < typename T >
+    vec3<T> transform_direction(const vec3<T>& d, const affine3<T>& m) noexcept {
+        const T* const mm = m.data();
+        return {
+            d.x * mm[0] + d.y * mm[3] + d.z * mm[6],
+            d.x * mm[1] + d.y * mm[4] + d.z * mm[7],
+            d.x * mm[2] + d.y * mm[5] + d.z * mm[8]};
+    }
+
+    //
+    // transform_points
+    //
+
+    template < typename T >
+    void transform_points(
+        const vec3<T>* src,
+        vec3<T>* dst,
+        std::size_t count,
+        const affine3<T>& m) noexcept
+    {
+        for ( std::size_t i = 0; i < count; ++i ) {
+            dst[i] = transform_point(src[i], m);
+        }
+    }
+
+    template < typename T >
+    void transform_points(
+        const vec2<T>* src,
+        vec3<T>* dst,
+        std::size_t count,
+        const affine3<T>& m) noexcept
+    {
+        for ( std::size_t i = 0; i < count; ++i ) {
+            dst[i] = transform_point(src[i], m);
+        }
+    }
+
+    //
+    // make_trs_affine3
+    //
+
+    template < typename T >
+    std::enable_if_t<std::is_floating_point<T>::value, affine3<T>>
+    make_trs_affine3(const trs2<T>& trs) noexcept {
+        const T cs = math::cos(trs.rotation);
+        const T sn = math::sin(trs.rotation);
+        const T sx = trs.scale.x;
+        const T sy = trs.scale.y;
+        return {
+            sx * cs,  sx * sn, T(0),
+            -sy * sn, sy * cs, T(0),
+            T(0),     T(0),    T(1),
+            trs.translation.x, trs.translation.y, T(0)};
+    }
+
+    template < typename T >
+    affine3<T> make_trs_affine3(const trs3<T>& trs) noexcept {
+        const T x = trs.rotation.x;
+        const T y = trs.rotation.y;
+        const T z = trs.rotation.z;
+        const T w = trs.rotation.w;
+
+        const T xx = x * x;
+        const T xy = x * y;
+        const T xz = x * z;
+        const T xw = x * w;
+
+        const T yy = y * y;
+        const T yz = y * z;
+        const T yw = y * w;
+
+        const T zz = z * z;
+        const T zw = z * w;
+
+        const T sx = trs.scale.x;
+        const T sy = trs.scale.y;
+        const T sz = trs.scale.z;
+
+        return {
+            sx * (T(1) - T(2) * (yy + zz)), sx * (T(2) * (xy + zw)),        sx * (T(2) * (xz - yw)),
+            sy * (T(2) * (xy - zw)),        sy * (T(1) - T(2) * (xx + zz)), sy * (T(2) * (yz + xw)),
+            sz * (T(2) * (xz + yw)),        sz * (T(2) * (yz - xw)),        sz * (T(1) - T(2) * (xx + yy)),
+            trs.translation.x,              trs.translation.y,              trs.translation.z};
+    }
+
+    //
+    // make_affine_matrix4
+    //
+
+    template < typename T >
+    mat4<T> make_affine_matrix4(const affine3<T>& m) noexcept {
+        return {
+            m.rows[0].x, m.rows[0].y, m.rows[0].z, T(0),
+            m.rows[1].x, m.rows[1].y, m.rows[1].z, T(0),
+            m.rows[2].x, m.rows[2].y, m.rows[2].z, T(0),
+            m.rows[3].x, m.rows[3].y, m.rows[3].z, T(1)};
+    }
+
+    //
+    // inversed
+    //
+
+    template < typename T >
+    std::enable_if_t<std::is_floating_point<T>::value, std::pair<affine3<T>, bool>>
+    inversed(
+        const affine3<T>& m,
+        T precision = math::default_precision<T>()) noexcept
+    {
+        const T* const mm = m.data();
+        const T c0 = mm[4] * mm[8] - mm[5] * mm[7];
+        const T c1 = mm[5] * mm[6] - mm[3] * mm[8];
+        const T c2 = mm[3] * mm[7] - mm[4] * mm[6];
+        const T det = mm[0] * c0 + mm[1] * c1 + mm[2] * c2;
+        if ( math::is_near_zero(det, precision) ) {
+            return std::make_pair(affine3<T>::identity(), false);
+        }
+        const T inv_det = T(1) / det;
+        const vec3<T> r0(
+            c0 * inv_det,
+            (mm[2] * mm[7] - mm[1] * mm[8]) * inv_det,
+            (mm[1] * mm[5] - mm[2] * mm[4]) * inv_det);
+        const vec3<T> r1(
+            c1 * inv_det,
+            (mm[0] * mm[8] - mm[2] * mm[6]) * inv_det,
+            (mm[2] * mm[3] - mm[0] * mm[5]) * inv_det);
+        const vec3<T> r2(
+            c2 * inv_det,
+            (mm[1] * mm[6] - mm[0] * mm[7]) * inv_det,
+            (mm[0] * mm[4] - mm[1] * mm[3]) * inv_det);
+        const vec3<T> t(mm[9], mm[10], mm[11]);
+        return std::make_pair(affine3<T>(
+            r0,
+            r1,
+            r2,
+            -(t.x * r0 + t.y * r1 + t.z * r2)), true);
+    }
+
+    //
+    // approximately
+    //
+
+    template < typename T >
+    bool approximately(
+        const affine3<T>& l,
+        const affine3<T>& r,
+        T precision = math::default_precision<T>()) noexcept
+    {
+        return math::approximately(l.rows[0], r.rows[0], precision)
+            && math::approximately(l.rows[1], r.rows[1], precision)
+            && math::approximately(l.rows[2], r.rows[2], precision)
+            && math::approximately(l.rows[3], r.rows[3], precision);
+    }
+}}
+
+#if E2D_SIMD != E2D_SIMD_NONE
+
+namespace e2d
+{
+    //
+    // affine3<f32> (*) affine3<f32>
+    //
+
+    inline affine3<f32> operator*(const affine3<f32>& l, const affine3<f32>& r) noexcept {
+        affine3<f32> m;
+        math::simd::mul_affine3(l.data(), r.data(), m.data());
+        return m;
+    }
+}
+
+#endif
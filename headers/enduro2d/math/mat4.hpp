@@ -7,7 +7,9 @@
 #pragma once
 
 #include "_math.hpp"
+#include "aabb.hpp"
 #include "quat.hpp"
+#include "simd.hpp"
 #include "trig.hpp"
 #include "trs2.hpp"
 #include "trs3.hpp"
@@ -497,18 +499,50 @@ namespace e2d { namespace math
     // make_trs_matrix4
     //
 
+    // scale * rotation * translation, built without multiplications
+    // of the intermediate matrices
+
     template < typename T >
     mat4<T> make_trs_matrix4(const trs2<T>& trs) noexcept {
-        return make_scale_matrix4(trs.scale)
-             * make_rotation_matrix4(trs.rotation, v4f::unit_z())
-             * make_translation_matrix4(trs.translation);
+        const T cs = math::cos(trs.rotation);
+        const T sn = math::sin(trs.rotation);
+        const T sx = trs.scale.x;
+        const T sy = trs.scale.y;
+        return {
+            sx * cs,           sx * sn,           T(0), T(0),
+            -sy * sn,          sy * cs,           T(0), T(0),
+            T(0),              T(0),              T(1), T(0),
+            trs.translation.x, trs.translation.y, T(0), T(1)};
     }
 
     template < typename T >
     mat4<T> make_trs_matrix4(const trs3<T>& trs) noexcept {
-        return make_scale_matrix4(trs.scale)
-             * make_rotation_matrix4(trs.rotation)
-             * make_translation_matrix4(trs.translation);
+        const T x = trs.rotation.x;
+        const T y = trs.rotation.y;
+        const T z = trs.rotation.z;
+        const T w = trs.rotation.w;
+
+        const T xx = x * x;
+        const T xy = x * y;
+        const T xz = x * z;
+        const T xw = x * w;
+
+        const T yy = y * y;
+        const T yz = y * z;
+        const T yw = y * w;
+
+        const T zz = z * z;
+        const T zw = z * w;
+
+        const T sx = trs.scale.x;
+        const T sy = trs.scale.y;
+        const T sz = trs.scale.z;
+
+        return {
+            sx * (T(1) - T(2) * (yy + zz)), sx * (T(2) * (xy + zw)),        sx * (T(2) * (xz - yw)),        T(0),
+            sy * (T(2) * (xy - zw)),        sy * (T(1) - T(2) * (xx + zz)), sy * (T(2) * (yz + xw)),        T(0),
+            sz * (T(2) * (xz + yw)),        sz * (T(2) * (yz - xw)),        sz * (T(1) - T(2) * (xx + yy)), T(0),
+            trs.translation.x,              trs.translation.y,              trs.translation.z,              T(1)};
     }
 
     //
@@ -733,4 +767,148 @@ namespace e2d { namespace math
             mm[2], mm[6], mm[10], mm[14],
             mm[3], mm[7], mm[11], mm[15]};
     }
+
+    //
+    // transform_points
+    //
+
+    template < typename T >
+    void transform_points(
+        const vec4<T>* src,
+        vec4<T>* dst,
+        std::size_t count,
+        const mat4<T>& m) noexcept
+    {
+        for ( std::size_t i = 0; i < count; ++i ) {
+            dst[i] = src[i] * m;
+        }
+    }
+
+    template < typename T >
+    void transform_points(
+        const vec3<T>* src,
+        vec4<T>* dst,
+        std::size_t count,
+        const mat4<T>& m) noexcept
+    {
+        for ( std::size_t i = 0; i < count; ++i ) {
+            dst[i] = vec4<T>(src[i], T(1)) * m;
+        }
+    }
+}}
+
+#if E2D_SIMD != E2D_SIMD_NONE
+
+namespace e2d
+{
+    //
+    // mat4<f32> (*) mat4<f32>
+    //
+
+    inline mat4<f32> operator*(const mat4<f32>& l, const mat4<f32>& r) noexcept {
+        mat4<f32> m;
+        math::simd::mul_mat4(l.data(), r.data(), m.data());
+        return m;
+    }
+
+    //
+    // vec4<f32> (*) mat4<f32>
+    //
+
+    inline vec4<f32> operator*(const vec4<f32>& l, const mat4<f32>& r) noexcept {
+        vec4<f32> v;
+        math::simd::mul_vec4_mat4(l.data(), r.data(), v.data());
+        return v;
+    }
+}
+
+namespace e2d { namespace math
+{
+    //
+    // inversed
+    //
+
+    inline std::pair<mat4<f32>, bool> inversed(
+        const mat4<f32>& m,
+        f32 precision = math::default_precision<f32>()) noexcept
+    {
+        mat4<f32> inv_m;
+        if ( !math::simd::inverse_mat4(m.data(), inv_m.data(), precision) ) {
+            return std::make_pair(mat4<f32>::identity(), false);
+        }
+        return std::make_pair(inv_m, true);
+    }
+
+    //
+    // transform_points
+    //
+
+    inline void transform_points(
+        const vec4<f32>* src,
+        vec4<f32>* dst,
+        std::size_t count,
+        const mat4<f32>& m) noexcept
+    {
+        if ( count > 0 ) {
+            math::simd::transform_vec4_mat4(src->data(), dst->data(), count, m.data());
+        }
+    }
+
+    inline void transform_points(
+        const vec3<f32>* src,
+        vec4<f32>* dst,
+        std::size_t count,
+        const mat4<f32>& m) noexcept
+    {
+        if ( count > 0 ) {
+            math::simd::transform_vec3_mat4(src->data(), dst->data(), count, m.data());
+        }
+    }
+}}
+
+#endif
+
+namespace e2d { namespace math
+{
+    //
+    // outside_clip_volume
+    //
+
+    // true if all the clip space points are on the outer side of one of the clip planes
+    template < typename T >
+    bool outside_clip_volume(const vec4<T>* points, std::size_t count) noexcept {
+        u32 outside_all = 0x3Fu;
+        for ( std::size_t i = 0; i < count; ++i ) {
+            const vec4<T>& p = points[i];
+            u32 outside = 0u;
+            outside |= (p.x < -p.w) ? 0x01u : 0u;
+            outside |= (p.x >  p.w) ? 0x02u : 0u;
+            outside |= (p.y < -p.w) ? 0x04u : 0u;
+            outside |= (p.y >  p.w) ? 0x08u : 0u;
+            outside |= (p.z < -p.w) ? 0x10u : 0u;
+            outside |= (p.z >  p.w) ? 0x20u : 0u;
+            outside_all &= outside;
+        }
+        return outside_all != 0u;
+    }
+
+    // true if all the corners of the bounds are transformed by mvp
+    // to the outer side of one of the clip planes
+    template < typename T >
+    bool outside_clip_volume(const aabb<T>& bounds, const mat4<T>& mvp) noexcept {
+        const vec3<T> min = bounds.position;
+        const vec3<T> max = bounds.position + bounds.size;
+        const vec3<T> corners[] = {
+            {min.x, min.y, min.z},
+            {max.x, min.y, min.z},
+            {min.x, max.y, min.z},
+            {max.x, max.y, min.z},
+            {min.x, min.y, max.z},
+            {max.x, min.y, max.z},
+            {min.x, max.y, max.z},
+            {max.x, max.y, max.z}};
+        vec4<T> points[8];
+        transform_points(corners, points, 8u, mvp);
+        return outside_clip_volume(points, 8u);
+    }
 }}
@@ -7,6 +7,7 @@
 #pragma once
 
 #include "_math.hpp"
+#include "simd.hpp"
 #include "trig.hpp"
 #include "unit.hpp"
 #include "vec3.hpp"
@@ -472,3 +473,20 @@ namespace e2d { namespace math
             !math::is_finite(v.w);
     }
 }}
+
+#if E2D_SIMD != E2D_SIMD_NONE
+
+namespace e2d
+{
+    //
+    // quat<f32> (*) quat<f32>
+    //
+
+    inline quat<f32> operator*(const quat<f32>& l, const quat<f32>& r) noexcept {
+        quat<f32> q;
+        math::simd::mul_quat(l.data(), r.data(), q.data());
+        return q;
+    }
+}
+
+#endif
@@ -0,0 +1,320 @@
+/*******************************************************************************
+ * This file is part of the "Enduro2D"
+ * For conditions of distribution and use, see copyright notice in LICENSE.md
+ * Copyright (C) 2018 Matvey Cherevko
+ ******************************************************************************/
+
+#pragma once
+
+#include "_math.hpp"
+
+#if E2D_SIMD == E2D_SIMD_SSE
+#  include <xmmintrin.h>
+#elif E2D_SIMD == E2D_SIMD_NEON
+#  include <arm_neon.h>
+#endif
+
+#if E2D_SIMD != E2D_SIMD_NONE
+
+//
+// kernels for f32 matrices, vectors and quaternions.
+// all of them work with unaligned row-major data and
+// can be used with the same source and destination.
+//
+
+namespace e2d { namespace math { namespace simd
+{
+#if E2D_SIMD == E2D_SIMD_SSE
+    using f32x4 = __m128;
+
+    inline f32x4 load(const f32* p) noexcept {
+        return _mm_loadu_ps(p);
+    }
+
+    inline void store(f32* p, f32x4 v) noexcept {
+        _mm_storeu_ps(p, v);
+    }
+
+    inline f32x4 set(f32 x, f32 y, f32 z, f32 w) noexcept {
+        return _mm_setr_ps(x, y, z, w);
+    }
+
+    inline f32x4 splat(f32 v) noexcept {
+        return _mm_set1_ps(v);
+    }
+
+    inline f32x4 add(f32x4 l, f32x4 r) noexcept {
+        return _mm_add_ps(l, r);
+    }
+
+    inline f32x4 sub(f32x4 l, f32x4 r) noexcept {
+        return _mm_sub_ps(l, r);
+    }
+
+    inline f32x4 mul(f32x4 l, f32x4 r) noexcept {
+        return _mm_mul_ps(l, r);
+    }
+
+    inline f32x4 madd(f32x4 l, f32x4 r, f32x4 a) noexcept {
+        return _mm_add_ps(_mm_mul_ps(l, r), a);
+    }
+
+    inline f32 first(f32x4 v) noexcept {
+        return _mm_cvtss_f32(v);
+    }
+
+    // (l[X], l[Y], r[Z], r[W])
+    template < int X, int Y, int Z, int W >
+    f32x4 shuffle(f32x4 l, f32x4 r) noexcept {
+        return _mm_shuffle_ps(l, r, _MM_SHUFFLE(W, Z, Y, X));
+    }
+#elif E2D_SIMD == E2D_SIMD_NEON
+    using f32x4 = float32x4_t;
+
+    inline f32x4 load(const f32* p) noexcept {
+        return vld1q_f32(p);
+    }
+
+    inline void store(f32* p, f32x4 v) noexcept {
+        vst1q_f32(p, v);
+    }
+
+    inline f32x4 set(f32 x, f32 y, f32 z, f32 w) noexcept {
+        const f32 v[4] = {x, y, z, w};
+        return vld1q_f32(v);
+    }
+
+    inline f32x4 splat(f32 v) noexcept {
+        return vdupq_n_f32(v);
+    }
+
+    inline f32x4 add(f32x4 l, f32x4 r) noexcept {
+        return vaddq_f32(l, r);
+    }
+
+    inline f32x4 sub(f32x4 l, f32x4 r) noexcept {
+        return vsubq_f32(l, r);
+    }
+
+    inline f32x4 mul(f32x4 l, f32x4 r) noexcept {
+        return vmulq_f32(l, r);
+    }
+
+    inline f32x4 madd(f32x4 l, f32x4 r, f32x4 a) noexcept {
+        return vmlaq_f32(a, l, r);
+    }
+
+    inline f32 first(f32x4 v) noexcept {
+        return vgetq_lane_f32(v, 0);
+    }
+
+    // (l[X], l[Y], r[Z], r[W])
+    template < int X, int Y, int Z, int W >
+    f32x4 shuffle(f32x4 l, f32x4 r) noexcept {
+        return set(
+            vgetq_lane_f32(l, X),
+            vgetq_lane_f32(l, Y),
+            vgetq_lane_f32(r, Z),
+            vgetq_lane_f32(r, W));
+    }
+#endif
+
+    template < int X, int Y, int Z, int W >
+    f32x4 swizzle(f32x4 v) noexcept {
+        return shuffle<X, Y, Z, W>(v, v);
+    }
+
+    template < int I >
+    f32x4 splat(f32x4 v) noexcept {
+        return swizzle<I, I, I, I>(v);
+    }
+
+    //
+    // 2x2 matrices packed as (m00, m01, m10, m11)
+    //
+
+    // l * r
+    inline f32x4 mul_mat2(f32x4 l, f32x4 r) noexcept {
+        return madd(l, swizzle<0,3,0,3>(r),
+            mul(swizzle<1,0,3,2>(l), swizzle<2,1,2,1>(r)));
+    }
+
+    // adjugate(l) * r
+    inline f32x4 adj_mul_mat2(f32x4 l, f32x4 r) noexcept {
+        return sub(
+            mul(swizzle<3,3,0,0>(l), r),
+            mul(swizzle<1,1,2,2>(l), swizzle<2,3,0,1>(r)));
+    }
+
+    // l * adjugate(r)
+    inline f32x4 mul_adj_mat2(f32x4 l, f32x4 r) noexcept {
+        return sub(
+            mul(l, swizzle<3,0,3,0>(r)),
+            mul(swizzle<1,0,3,2>(l), swizzle<2,1,2,1>(r)));
+    }
+
+    //
+    // row * m, m is four loaded rows
+    //
+
+    inline f32x4 transform(f32x4 v, const f32x4 (&m)[4]) noexcept {
+        f32x4 r = mul(splat<0>(v), m[0]);
+        r = madd(splat<1>(v), m[1], r);
+        r = madd(splat<2>(v), m[2], r);
+        return madd(splat<3>(v), m[3], r);
+    }
+
+    //
+    // mat4 kernels
+    //
+
+    inline void mul_mat4(const f32* l, const f32* r, f32* dst) noexcept {
+        const f32x4 rm[4] = {
+            load(r + 0), load(r + 4), load(r + 8), load(r + 12)};
+        const f32x4 r0 = transform(load(l + 0), rm);
+        const f32x4 r1 = transform(load(l + 4), rm);
+        const f32x4 r2 = transform(load(l + 8), rm);
+        const f32x4 r3 = transform(load(l + 12), rm);
+        store(dst + 0, r0);
+        store(dst + 4, r1);
+        store(dst + 8, r2);
+        store(dst + 12, r3);
+    }
+
+    inline void mul_vec4_mat4(const f32* v, const f32* m, f32* dst) noexcept {
+        const f32x4 rm[4] = {
+            load(m + 0), load(m + 4), load(m + 8), load(m + 12)};
+        store(dst, transform(load(v), rm));
+    }
+
+    // blockwise inversion of the 2x2 blocks | A B |
+    //                                       | C D |
+    inline bool inverse_mat4(const f32* m, f32* dst, f32 precision) noexcept {
+        const f32x4 m0 = load(m + 0);
+        const f32x4 m1 = load(m + 4);
+        const f32x4 m2 = load(m + 8);
+        const f32x4 m3 = load(m + 12);
+
+        const f32x4 a = shuffle<0,1,0,1>(m0, m1);
+        const f32x4 b = shuffle<2,3,2,3>(m0, m1);
+        const f32x4 c = shuffle<0,1,0,1>(m2, m3);
+        const f32x4 d = shuffle<2,3,2,3>(m2, m3);
+
+        // (det(A), det(B), det(C), det(D))
+        const f32x4 dets = sub(
+            mul(shuffle<0,2,0,2>(m0, m2), shuffle<1,3,1,3>(m1, m3)),
+            mul(shuffle<1,3,1,3>(m0, m2), shuffle<0,2,0,2>(m1, m3)));
+        const f32x4 det_a = splat<0>(dets);
+        const f32x4 det_b = splat<1>(dets);
+        const f32x4 det_c = splat<2>(dets);
+        const f32x4 det_d = splat<3>(dets);
+
+        const f32x4 d_c = adj_mul_mat2(d, c);
+        const f32x4 a_b = adj_mul_mat2(a, b);
+
+        f32x4 x = sub(mul(det_d, a), mul_mat2(b, d_c));
+        f32x4 w = sub(mul(det_a, d), mul_mat2(c, a_b));
+        f32x4 y = sub(mul(det_b, c), mul_adj_mat2(d, a_b));
+        f32x4 z = sub(mul(det_c, b), mul_adj_mat2(a, d_c));
+
+        f32x4 tr = mul(a_b, swizzle<0,2,1,3>(d_c));
+        tr = add(tr, swizzle<2,3,0,1>(tr));
+        tr = add(tr, swizzle<1,0,3,2>(tr));
+
+        const f32x4 det = sub(madd(det_a, det_d, mul(det_b, det_c)), tr);
+        if ( math::is_near_zero(first(det), precision) ) {
+            return false;
+        }
+
+        const f32x4 inv_det = mul(set(1.f, -1.f, -1.f, 1.f), splat(1.f / first(det)));
+        x = mul(x, inv_det);
+        y = mul(y, inv_det);
+        z = mul(z, inv_det);
+        w = mul(w, inv_det);
+
+        store(dst + 0, shuffle<3,1,3,1>(x, y));
+        store(dst + 4, shuffle<2,0,2,0>(x, y));
+        store(dst + 8, shuffle<3,1,3,1>(z, w));
+        store(dst + 12, shuffle<2,0,2,0>(z, w));
+        return true;
+    }
+
+    // src is 'count' vec4, dst is 'count' vec4
+    inline void transform_vec4_mat4(
+        const f32* src, f32* dst, std::size_t count, const f32* m) noexcept
+    {
+        const f32x4 rm[4] = {
+            load(m + 0), load(m + 4), load(m + 8), load(m + 12)};
+        for ( std::size_t i = 0; i < count; ++i, src += 4, dst += 4 ) {
+            store(dst, transform(load(src), rm));
+        }
+    }
+
+    // src is 'count' vec3 with implicit w = 1, dst is 'count' vec4
+    inline void transform_vec3_mat4(
+        const f32* src, f32* dst, std::size_t count, const f32* m) noexcept
+    {
+        const f32x4 rm[4] = {
+            load(m + 0), load(m + 4), load(m + 8), load(m + 12)};
+        for ( std::size_t i = 0; i < count; ++i, src += 3, dst += 4 ) {
+            f32x4 r = madd(splat(src[0]), rm[0], rm[3]);
+            r = madd(splat(src[1]), rm[1], r);
+            r = madd(splat(src[2]), rm[2], r);
+            store(dst, r);
+        }
+    }
+
+    //
+    // affine3 kernels
+    //
+
+    // rows are three floats wide, so the first three rows are loaded
+    // with the next float and stored in order, each store overwrites
+    // the extra lane of the previous one
+    inline void mul_affine3(const f32* l, const f32* r, f32* dst) noexcept {
+        const f32x4 r0 = load(r + 0);
+        const f32x4 r1 = load(r + 3);
+        const f32x4 r2 = load(r + 6);
+        const f32x4 r3 = set(r[9], r[10], r[11], 0.f);
+
+        const auto row = [&r0, &r1, &r2](const f32* lr, f32x4 a) noexcept {
+            a = madd(splat(lr[0]), r0, a);
+            a = madd(splat(lr[1]), r1, a);
+            return madd(splat(lr[2]), r2, a);
+        };
+
+        const f32x4 zero = splat(0.f);
+        const f32x4 d0 = row(l + 0, zero);
+        const f32x4 d1 = row(l + 3, zero);
+        const f32x4 d2 = row(l + 6, zero);
+        const f32x4 d3 = row(l + 9, r3);
+
+        f32 last[4];
+        store(last, d3);
+        store(dst + 0, d0);
+        store(dst + 3, d1);
+        store(dst + 6, d2);
+        dst[9] = last[0];
+        dst[10] = last[1];
+        dst[11] = last[2];
+    }
+
+    //
+    // quat kernels
+    //
+
+    inline void mul_quat(const f32* l, const f32* r, f32* dst) noexcept {
+        const f32x4 lq = load(l);
+        const f32x4 rq = load(r);
+        const f32x4 sign = set(1.f, 1.f, 1.f, -1.f);
+
+        const f32x4 a = mul(splat<3>(lq), rq);
+        const f32x4 b = mul(swizzle<0,1,2,0>(lq), swizzle<3,3,3,0>(rq));
+        const f32x4 c = mul(swizzle<1,2,0,1>(lq), swizzle<2,0,1,1>(rq));
+        const f32x4 d = mul(swizzle<2,0,1,2>(lq), swizzle<1,2,0,2>(rq));
+
+        store(dst, sub(madd(add(b, c), sign, a), d));
+    }
+}}}
+
+#endif
@@ -9,6 +9,8 @@
 #include "_utils.hpp"
 
 #include "buffer.hpp"
+#include "buffer_view.hpp"
+#include "bundle.hpp"
 #include "color.hpp"
 #include "color32.hpp"
 #include "filesystem.hpp"
@@ -19,6 +21,7 @@
 #include "mesh.hpp"
 #include "module.hpp"
 #include "path.hpp"
+#include "skyline_packer.hpp"
 #include "streams.hpp"
 #include "strfmts.hpp"
 #include "strings.hpp"
@@ -12,11 +12,14 @@
 namespace e2d
 {
     class buffer;
+    class buffer_view;
+    class bundle;
     class color;
     class color32;
     class image;
     class mesh;
     class input_stream;
+    class mapped_input_stream;
     class output_stream;
     class input_sequence;
     class output_sequence;
@@ -0,0 +1,45 @@
+/*******************************************************************************
+ * This file is part of the "Enduro2D"
+ * For conditions of distribution and use, see copyright notice in LICENSE.md
+ * Copyright (C) 2018 Matvey Cherevko
+ ******************************************************************************/
+
+#pragma once
+
+#include "_utils.hpp"
+
+namespace e2d
+{
+    //
+    // buffer_view
+    //
+    // non-owning read-only view of a memory range,
+    // the memory must outlive all views to it
+    //
+
+    class buffer_view final {
+    public:
+        buffer_view() noexcept = default;
+
+        buffer_view(const buffer_view&) noexcept = default;
+        buffer_view& operator=(const buffer_view&) noexcept = default;
+
+        buffer_view(const buffer& src) noexcept;
+        buffer_view(const void* src, std::size_t size) noexcept;
+
+        void swap(buffer_view& other) noexcept;
+        void clear() noexcept;
+        bool empty() const noexcept;
+
+        const u8* data() const noexcept;
+        std::size_t size() const noexcept;
+    private:
+        const u8* data_ = nullptr;
+        std::size_t size_ = 0;
+    };
+
+    void swap(buffer_view& l, buffer_view& r) noexcept;
+    bool operator<(const buffer_view& l, const buffer_view& r) noexcept;
+    bool operator==(const buffer_view& l, const buffer_view& r) noexcept;
+    bool operator!=(const buffer_view& l, const buffer_view& r) noexcept;
+}
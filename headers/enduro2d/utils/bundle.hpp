@@ -0,0 +1,152 @@
+/*******************************************************************************
+ * This file is part of the "Enduro2D"
+ * For conditions of distribution and use, see copyright notice in LICENSE.md
+ * Copyright (C) 2018 Matvey Cherevko
+ ******************************************************************************/
+
+#pragma once
+
+#include "_utils.hpp"
+
+#include "buffer.hpp"
+#include "buffer_view.hpp"
+#include "streams.hpp"
+
+namespace e2d
+{
+    //
+    // bundle
+    //
+    // in-memory content of an engine bundle, files are stored
+    // by relative paths and compressed while saving if it pays off
+    //
+
+    class bundle final {
+    public:
+        struct entry {
+            str name;
+            buffer content;
+            bool directory = false;
+            bool compress = false;
+        };
+    public:
+        bundle() = default;
+
+        bundle(bundle&& other) noexcept;
+        bundle& operator=(bundle&& other) noexcept;
+
+        bundle(const bundle& other);
+        bundle& operator=(const bundle& other);
+
+        bundle& assign(bundle&& other) noexcept;
+        bundle& assign(const bundle& other);
+
+        bool add_directory(str_view name);
+        bool add_file(str_view name, buffer&& content, bool compress);
+        bool add_file(str_view name, const buffer& content, bool compress);
+
+        void swap(bundle& other) noexcept;
+        void clear() noexcept;
+        bool empty() const noexcept;
+
+        bool exists(str_view name) const noexcept;
+        const vector<entry>& entries() const noexcept;
+    private:
+        vector<entry> entries_;
+    };
+
+    void swap(bundle& l, bundle& r) noexcept;
+}
+
+namespace e2d { namespace bundles
+{
+    //
+    // file layout
+    //
+    // header | directory | names | entries
+    //
+    // the directory is sorted by str_hash of entry names, so a mapped
+    // bundle is searched in place. entries are aligned to data_alignment,
+    // compressed entries start with the end offsets of independent
+    // lz4 blocks of chunk_size bytes each. headers and tables are copied
+    // as is, so the format is little-endian and so must be the host.
+    //
+
+#if defined(__BYTE_ORDER__) && defined(__ORDER_LITTLE_ENDIAN__)
+    static_assert(
+        __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__,
+        "bundles are only supported on little-endian hosts");
+#endif
+
+    const std::size_t data_alignment = 64u;
+    const std::size_t chunk_size = 64u * 1024u;
+    const u32 file_version = 1u;
+
+    enum file_entry_flags : u32 {
+        file_entry_directory = 1u << 0,
+        file_entry_compressed = 1u << 1
+    };
+
+    struct file_header {
+        u8 signature[8];
+        u32 version;
+        u32 entry_count;
+        u64 directory_offset;
+        u64 names_offset;
+        u64 names_size;
+        u8 reserved[24];
+    };
+
+    struct file_entry {
+        u32 name_hash;
+        u32 flags;
+        u32 name_offset;
+        u32 name_size;
+        u64 data_offset;
+        u64 stored_size;
+        u64 size;
+        u32 chunk_size;
+        u32 chunk_count;
+    };
+
+    static_assert(sizeof(file_header) == 64u, "unexpected bundle header size");
+    static_assert(sizeof(file_entry) == 48u, "unexpected bundle entry size");
+
+    bool is_valid_header(const file_header& header) noexcept;
+
+    // decompresses one chunk of the entry data to its place in dst,
+    // dst must have room for the whole uncompressed entry
+    bool try_decompress_chunk(
+        const file_entry& entry,
+        buffer_view data,
+        std::size_t chunk,
+        u8* dst) noexcept;
+
+    bool try_pack_directory(
+        bundle& dst,
+        str_view path,
+        bool compress);
+
+    bool try_save_bundle(
+        const bundle& src,
+        buffer& dst) noexcept;
+
+    bool try_save_bundle(
+        const bundle& src,
+        const output_stream_uptr& dst) noexcept;
+}}
+
+namespace e2d { namespace lz4
+{
+    // raw lz4 block format without frames
+    std::size_t compress_bound(std::size_t size) noexcept;
+
+    bool try_compress(
+        buffer& dst,
+        buffer_view src);
+
+    bool try_decompress(
+        u8* dst,
+        std::size_t dst_size,
+        buffer_view src) noexcept;
+}}
@@ -30,6 +30,7 @@ namespace e2d
 {
     read_file_uptr make_read_file(str_view path) noexcept;
     write_file_uptr make_write_file(str_view path, bool append) noexcept;
+    mapped_input_stream_uptr make_mapped_file(str_view path) noexcept;
 }
 
 namespace e2d { namespace filesystem
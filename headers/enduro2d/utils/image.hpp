@@ -9,6 +9,7 @@
 #include "_utils.hpp"
 
 #include "buffer.hpp"
+#include "buffer_view.hpp"
 #include "color.hpp"
 #include "color32.hpp"
 #include "streams.hpp"
@@ -64,12 +65,18 @@ namespace e2d
         image(const v2u& size, image_data_format format, buffer&& data) noexcept;
         image(const v2u& size, image_data_format format, const buffer& data);
 
+        image(const v2u& size, image_data_format format, u32 mipmap_count, buffer&& data) noexcept;
+        image(const v2u& size, image_data_format format, u32 mipmap_count, const buffer& data);
+
         image& assign(image&& other) noexcept;
         image& assign(const image& other);
 
         image& assign(const v2u& size, image_data_format format, buffer&& data) noexcept;
         image& assign(const v2u& size, image_data_format format, const buffer& data);
 
+        image& assign(const v2u& size, image_data_format format, u32 mipmap_count, buffer&& data) noexcept;
+        image& assign(const v2u& size, image_data_format format, u32 mipmap_count, const buffer& data);
+
         void swap(image& other) noexcept;
         void clear() noexcept;
         bool empty() const noexcept;
@@ -82,10 +89,17 @@ namespace e2d
         const v2u& size() const noexcept;
         image_data_format format() const noexcept;
         const buffer& data() const noexcept;
+
+        // mipmap levels are stored one after another in the data,
+        // from the full size level down to the smallest one
+        u32 mipmap_count() const noexcept;
+        v2u mipmap_size(u32 level) const noexcept;
+        buffer_view mipmap_data(u32 level) const noexcept;
     private:
         buffer data_;
         v2u size_;
         image_data_format format_ = image_data_format::rgba8;
+        u32 mipmap_count_ = 1;
     };
 
     void swap(image& l, image& r) noexcept;
@@ -95,10 +109,28 @@ namespace e2d
 
 namespace e2d { namespace images
 {
+    bool is_compressed_format(image_data_format format) noexcept;
+    std::size_t bits_per_pixel(image_data_format format) noexcept;
+
+    // bytes of one level including the block padding of compressed formats
+    std::size_t mipmap_data_size(const v2u& size, image_data_format format) noexcept;
+    std::size_t mipmap_chain_data_size(const v2u& size, image_data_format format, u32 mipmap_count) noexcept;
+    u32 max_mipmap_count(const v2u& size) noexcept;
+
+    // builds the full mipmap chain of the first level with a box filter,
+    // compressed formats are not supported
+    bool try_generate_mipmaps(
+        image& dst,
+        const image& src) noexcept;
+
     bool try_load_image(
         image& dst,
         const buffer& src) noexcept;
 
+    bool try_load_image(
+        image& dst,
+        buffer_view src) noexcept;
+
     bool try_load_image(
         image& dst,
         const input_stream_uptr& src) noexcept;
@@ -9,6 +9,7 @@
 #include "_utils.hpp"
 
 #include "buffer.hpp"
+#include "buffer_view.hpp"
 #include "color32.hpp"
 #include "streams.hpp"
 
@@ -103,6 +104,10 @@ namespace e2d { namespace meshes
         mesh& dst,
         const buffer& src) noexcept;
 
+    bool try_load_mesh(
+        mesh& dst,
+        buffer_view src) noexcept;
+
     bool try_load_mesh(
         mesh& dst,
         const input_stream_uptr& src) noexcept;
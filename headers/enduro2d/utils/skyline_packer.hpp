@@ -0,0 +1,61 @@
+/*******************************************************************************
+ * This file is part of the "Enduro2D"
+ * For conditions of distribution and use, see copyright notice in LICENSE.md
+ * Copyright (C) 2018 Matvey Cherevko
+ ******************************************************************************/
+
+#pragma once
+
+#include "_utils.hpp"
+
+namespace e2d
+{
+    //
+    // skyline_packer
+    //
+    // packs rectangles into a fixed size area using the
+    // skyline bottom-left heuristic, rectangles can be added
+    // incrementally, but can't be removed (use clear instead)
+    //
+
+    class skyline_packer final {
+    public:
+        skyline_packer() = default;
+        ~skyline_packer() noexcept = default;
+
+        skyline_packer(skyline_packer&& other) noexcept;
+        skyline_packer& operator=(skyline_packer&& other) noexcept;
+
+        skyline_packer(const skyline_packer& other);
+        skyline_packer& operator=(const skyline_packer& other);
+
+        explicit skyline_packer(const v2u& size);
+
+        skyline_packer& assign(skyline_packer&& other) noexcept;
+        skyline_packer& assign(const skyline_packer& other);
+
+        void swap(skyline_packer& other) noexcept;
+        void clear() noexcept;
+        void reset(const v2u& size);
+
+        bool insert(const v2u& size, b2u& result);
+
+        const v2u& size() const noexcept;
+        u64 used_area() const noexcept;
+        f32 occupancy() const noexcept;
+    private:
+        struct segment {
+            u32 x = 0;
+            u32 y = 0;
+            u32 width = 0;
+        };
+        bool fit_(std::size_t index, const v2u& size, u32& y) const noexcept;
+        void place_(std::size_t index, const b2u& rect);
+    private:
+        vector<segment> skyline_;
+        v2u size_;
+        u64 used_area_ = 0;
+    };
+
+    void swap(skyline_packer& l, skyline_packer& r) noexcept;
+}
@@ -9,6 +9,7 @@
 #pragma once
 
 #include "_utils.hpp"
+#include "buffer_view.hpp"
 
 namespace e2d
 {
@@ -29,6 +30,25 @@ namespace e2d
     };
     using input_stream_uptr = std::unique_ptr<input_stream>;
 
+    //
+    // mapped_input_stream
+    //
+    // input stream over memory that stays valid for the stream lifetime,
+    // view() gives direct access to the whole content without copying
+    //
+
+    class mapped_input_stream : public input_stream {
+    public:
+        std::size_t read(void* dst, std::size_t size) final;
+        std::size_t seek(std::ptrdiff_t offset, bool relative) final;
+        std::size_t tell() const final;
+        std::size_t length() const noexcept final;
+        virtual buffer_view view() const noexcept = 0;
+    private:
+        std::size_t pos_ = 0;
+    };
+    using mapped_input_stream_uptr = std::unique_ptr<mapped_input_stream>;
+
     class output_stream : private noncopyable {
     public:
         virtual ~output_stream() noexcept = default;
@@ -97,6 +117,8 @@ namespace e2d
 namespace e2d
 {
     input_stream_uptr make_memory_stream(buffer data) noexcept;
+    mapped_input_stream_uptr make_mapped_memory_stream(buffer data) noexcept;
+    mapped_input_stream_uptr make_memory_view_stream(buffer_view data) noexcept;
 }
 
 namespace e2d { namespace streams
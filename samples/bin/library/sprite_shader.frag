@@ -1,11 +1,26 @@
 #version 120
 
-uniform sampler2D u_texture;
+uniform sampler2D u_texture0;
+uniform sampler2D u_texture1;
+uniform sampler2D u_texture2;
+uniform sampler2D u_texture3;
 
 varying vec4 v_tint;
 varying vec2 v_st;
+varying float v_texture_slot;
+
+vec4 texture_slot(vec2 st) {
+    if ( v_texture_slot < 0.5 ) {
+        return texture2D(u_texture0, st);
+    } else if ( v_texture_slot < 1.5 ) {
+        return texture2D(u_texture1, st);
+    } else if ( v_texture_slot < 2.5 ) {
+        return texture2D(u_texture2, st);
+    }
+    return texture2D(u_texture3, st);
+}
 
 void main() {
     vec2 st = vec2(v_st.s, 1.0 - v_st.t);
-    gl_FragColor = texture2D(u_texture, st) * v_tint;
+    gl_FragColor = texture_slot(st) * v_tint;
 }
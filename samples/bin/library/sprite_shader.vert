@@ -5,12 +5,15 @@ uniform mat4 u_matrix_vp;
 attribute vec3 a_vertex;
 attribute vec4 a_tint;
 attribute vec2 a_st;
+attribute float a_texture_slot;
 
 varying vec4 v_tint;
 varying vec2 v_st;
+varying float v_texture_slot;
 
 void main() {
     v_st = a_st;
     v_tint = a_tint;
+    v_texture_slot = a_texture_slot;
     gl_Position = vec4(a_vertex, 1.0) * u_matrix_vp;
 }
@@ -93,6 +93,22 @@ namespace e2d
             visible_ = yesno;
         }
 
+        void counter(str_view name, std::size_t value) {
+            const auto iter = std::find_if(counters_.begin(), counters_.end(),
+                [&name](const std::pair<str, std::size_t>& c){
+                    return c.first == name;
+                });
+            if ( iter != counters_.end() ) {
+                iter->second = value;
+            } else {
+                counters_.emplace_back(name, value);
+            }
+        }
+
+        const vector<std::pair<str, std::size_t>>& counters() const noexcept {
+            return counters_;
+        }
+
         void frame_tick() {
             ImGuiIO& io = bind_context();
             const mouse& m = input_.mouse();
@@ -361,6 +377,7 @@ namespace e2d
         render& render_;
         window& window_;
         bool visible_{false};
+        vector<std::pair<str, std::size_t>> counters_;
         ImGuiContext* context_{nullptr};
         window::event_listener& listener_;
     private:
@@ -387,11 +404,15 @@ namespace e2d
         state_->toggle_visible(yesno);
     }
 
+    void dbgui::counter(str_view name, std::size_t value) {
+        state_->counter(name, value);
+    }
+
     void dbgui::frame_tick() {
         state_->frame_tick();
 
         if ( visible() ) {
-            dbgui_widgets::show_main_menu();
+            dbgui_widgets::show_main_menu(state_->counters());
         }
     }
 
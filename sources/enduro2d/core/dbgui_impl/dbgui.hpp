@@ -24,5 +24,5 @@ namespace e2d { namespace dbgui_shaders
 
 namespace e2d { namespace dbgui_widgets
 {
-    void show_main_menu();
+    void show_main_menu(const vector<std::pair<str, std::size_t>>& counters);
 }}
@@ -42,6 +42,49 @@ namespace
         ImGui::End();
     }
 
+    void show_debug_render(bool* open, const vector<std::pair<str, std::size_t>>& counters) {
+        if ( !modules::is_initialized<render>() ) {
+            if ( open ) {
+                *open = false;
+            }
+            return;
+        }
+        render& r = the<render>();
+        const char* window_title = "Debug Render";
+        if ( !ImGui::Begin(window_title, open, ImGuiWindowFlags_NoResize) ) {
+            ImGui::End();
+            return;
+        }
+        try {
+            const render::frame_statistics& stats = r.last_frame_statistics();
+            {
+                ImGui::Text("%s", strings::rformat("draw calls: %0", stats.draw_calls).c_str());
+            }
+            ImGui::Separator();
+            {
+                ImGui::Text("%s", strings::rformat("state changes: %0 (skipped: %1)",
+                    stats.applied_state_changes, stats.skipped_state_changes).c_str());
+                ImGui::Text("%s", strings::rformat("texture binds: %0 (skipped: %1)",
+                    stats.applied_texture_binds, stats.skipped_texture_binds).c_str());
+                ImGui::Text("%s", strings::rformat("buffer binds: %0 (skipped: %1)",
+                    stats.applied_buffer_binds, stats.skipped_buffer_binds).c_str());
+                ImGui::Text("%s", strings::rformat("uniform uploads: %0 (skipped: %1)",
+                    stats.issued_uniform_uploads, stats.skipped_uniform_uploads).c_str());
+            }
+            if ( !counters.empty() ) {
+                ImGui::Separator();
+                for ( const auto& c : counters ) {
+                    ImGui::Text("%s", strings::rformat("%0: %1", c.first, c.second).c_str());
+                }
+            }
+            ImGui::SetWindowSize(window_title, v2f::zero());
+        } catch (...) {
+            ImGui::End();
+            throw;
+        }
+        ImGui::End();
+    }
+
     void show_debug_window(bool* open) {
         if ( !modules::is_initialized<window>() ) {
             if ( open ) {
@@ -121,13 +164,15 @@ namespace
 
 namespace e2d { namespace dbgui_widgets
 {
-    void show_main_menu() {
+    void show_main_menu(const vector<std::pair<str, std::size_t>>& counters) {
         static bool show_engine = false;
+        static bool show_render = false;
         static bool show_window = false;
 
         if ( ImGui::BeginMainMenuBar() ) {
             if ( ImGui::BeginMenu("Debug") ) {
                 ImGui::MenuItem("Engine...", nullptr, &show_engine);
+                ImGui::MenuItem("Render...", nullptr, &show_render);
                 ImGui::MenuItem("Window...", nullptr, &show_window);
                 ImGui::Separator();
                 if ( ImGui::MenuItem("Quit") ) {
@@ -144,6 +189,10 @@ namespace e2d { namespace dbgui_widgets
             show_debug_engine(&show_engine);
         }
 
+        if ( show_render ) {
+            show_debug_render(&show_render, counters);
+        }
+
         if ( show_window ) {
             show_debug_window(&show_window);
         }
@@ -13,11 +13,11 @@ namespace e2d
 
     deferrer::~deferrer() noexcept = default;
 
-    stdex::jobber& deferrer::worker() noexcept {
+    job_system& deferrer::worker() noexcept {
         return worker_;
     }
 
-    const stdex::jobber& deferrer::worker() const noexcept {
+    const job_system& deferrer::worker() const noexcept {
         return worker_;
     }
 
@@ -28,4 +28,87 @@ namespace e2d
     const stdex::scheduler& deferrer::scheduler() const noexcept {
         return scheduler_;
     }
+
+    void deferrer::upload_budget(std::size_t max_bytes, f32 max_ms) noexcept {
+        upload_budget_bytes_ = max_bytes;
+        upload_budget_ms_ = max_ms;
+    }
+
+    std::size_t deferrer::upload_budget_bytes() const noexcept {
+        return upload_budget_bytes_;
+    }
+
+    f32 deferrer::upload_budget_ms() const noexcept {
+        return upload_budget_ms_;
+    }
+
+    std::size_t deferrer::upload_queue_size() const noexcept {
+        std::lock_guard<std::mutex> guard(upload_mutex_);
+        return upload_tasks_.size();
+    }
+
+    const deferrer::upload_statistics& deferrer::process_upload_tasks() noexcept {
+        E2D_ASSERT(is_in_main_thread());
+
+        const std::size_t max_bytes = upload_budget_bytes_;
+        const f32 max_ms = upload_budget_ms_;
+        const auto begin_us = time::now_us<u64>();
+
+        upload_statistics stats;
+        while ( true ) {
+            std::pair<std::size_t, upload_task_uptr> task;
+            {
+                std::lock_guard<std::mutex> guard(upload_mutex_);
+                if ( upload_tasks_.empty() ) {
+                    break;
+                }
+                const std::size_t task_bytes = upload_tasks_.front().first;
+                if ( max_bytes && stats.processed_tasks
+                    && stats.processed_bytes + task_bytes > max_bytes )
+                {
+                    break;
+                }
+                task = std::move(upload_tasks_.front());
+                upload_tasks_.pop_front();
+            }
+
+            task.second->run();
+            ++stats.processed_tasks;
+            stats.processed_bytes += task.first;
+
+            const auto delta_us = time::now_us<u64>() - begin_us;
+            stats.processed_ms = time::to_milliseconds(delta_us.cast_to<f32>()).value;
+            if ( max_ms > 0.f && stats.processed_ms >= max_ms ) {
+                break;
+            }
+        }
+
+        stats.queued_tasks = upload_queue_size();
+        upload_stats_ = stats;
+        return upload_stats_;
+    }
+
+    const deferrer::upload_statistics& deferrer::last_upload_statistics() const noexcept {
+        return upload_stats_;
+    }
+
+    void deferrer::push_upload_task_(std::size_t upload_bytes, upload_task_uptr task) {
+        std::lock_guard<std::mutex> guard(upload_mutex_);
+        upload_tasks_.emplace_back(upload_bytes, std::move(task));
+    }
+
+    bool deferrer::process_one_upload_task_() noexcept {
+        E2D_ASSERT(is_in_main_thread());
+        upload_task_uptr task;
+        {
+            std::lock_guard<std::mutex> guard(upload_mutex_);
+            if ( upload_tasks_.empty() ) {
+                return false;
+            }
+            task = std::move(upload_tasks_.front().second);
+            upload_tasks_.pop_front();
+        }
+        task->run();
+        return true;
+    }
 }
@@ -111,6 +111,41 @@ namespace e2d
         return maximal_framerate_;
     }
 
+    //
+    // engine::vfs_parameters
+    //
+
+    engine::vfs_parameters& engine::vfs_parameters::io_threads(u32 value) noexcept {
+        io_threads_ = value;
+        return *this;
+    }
+
+    u32 engine::vfs_parameters::io_threads() const noexcept {
+        return io_threads_;
+    }
+
+    //
+    // engine::upload_parameters
+    //
+
+    engine::upload_parameters& engine::upload_parameters::max_frame_bytes(std::size_t value) noexcept {
+        max_frame_bytes_ = value;
+        return *this;
+    }
+
+    engine::upload_parameters& engine::upload_parameters::max_frame_time_ms(f32 value) noexcept {
+        max_frame_time_ms_ = value;
+        return *this;
+    }
+
+    std::size_t engine::upload_parameters::max_frame_bytes() const noexcept {
+        return max_frame_bytes_;
+    }
+
+    f32 engine::upload_parameters::max_frame_time_ms() const noexcept {
+        return max_frame_time_ms_;
+    }
+
     //
     // engine::window_parameters
     //
@@ -189,6 +224,16 @@ namespace e2d
         return *this;
     }
 
+    engine::parameters& engine::parameters::vfs_params(const vfs_parameters& value) {
+        vfs_params_ = value;
+        return *this;
+    }
+
+    engine::parameters& engine::parameters::upload_params(const upload_parameters& value) {
+        upload_params_ = value;
+        return *this;
+    }
+
     str& engine::parameters::game_name() noexcept {
         return game_name_;
     }
@@ -213,6 +258,14 @@ namespace e2d
         return timer_params_;
     }
 
+    engine::vfs_parameters& engine::parameters::vfs_params() noexcept {
+        return vfs_params_;
+    }
+
+    engine::upload_parameters& engine::parameters::upload_params() noexcept {
+        return upload_params_;
+    }
+
     const str& engine::parameters::game_name() const noexcept {
         return game_name_;
     }
@@ -237,6 +290,14 @@ namespace e2d
         return timer_params_;
     }
 
+    const engine::vfs_parameters& engine::parameters::vfs_params() const noexcept {
+        return vfs_params_;
+    }
+
+    const engine::upload_parameters& engine::parameters::upload_params() const noexcept {
+        return upload_params_;
+    }
+
     //
     // engine
     //
@@ -342,6 +403,10 @@ namespace e2d
 
         safe_module_initialize<deferrer>();
 
+        the<deferrer>().upload_budget(
+            params.upload_params().max_frame_bytes(),
+            params.upload_params().max_frame_time_ms());
+
         // setup debug
 
         safe_module_initialize<debug>();
@@ -352,7 +417,8 @@ namespace e2d
 
         // setup vfs
 
-        safe_module_initialize<vfs>();
+        safe_module_initialize<vfs>(
+            math::numeric_cast<std::size_t>(params.vfs_params().io_threads()));
 
         the<vfs>().register_scheme<filesystem_file_source>("file");
         safe_register_predef_path(the<vfs>(), "home", filesystem::predef_path::home);
@@ -430,6 +496,13 @@ namespace e2d
                 the<dbgui>().frame_tick();
                 the<deferrer>().scheduler().process_all_tasks();
 
+                const deferrer::upload_statistics& upload_stats =
+                    the<deferrer>().process_upload_tasks();
+                the<dbgui>().counter("upload queue", upload_stats.queued_tasks);
+                the<dbgui>().counter("upload kb", upload_stats.processed_bytes / 1024u);
+                the<dbgui>().counter("upload us", static_cast<std::size_t>(
+                    upload_stats.processed_ms * 1000.f));
+
                 if ( !app->frame_tick() ) {
                     break;
                 }
@@ -438,6 +511,7 @@ namespace e2d
                     app->frame_render();
                     the<dbgui>().frame_render();
                     the<window>().swap_buffers();
+                    the<render>().frame_tick();
                 }
 
                 state_->calculate_end_frame_timers();
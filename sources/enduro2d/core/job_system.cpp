@@ -0,0 +1,316 @@
+/*******************************************************************************
+ * This file is part of the "Enduro2D"
+ * For conditions of distribution and use, see copyright notice in LICENSE.md
+ * Copyright (C) 2018 Matvey Cherevko
+ ******************************************************************************/
+
+#include <enduro2d/core/job_system.hpp>
+
+namespace
+{
+    using namespace e2d;
+
+    const std::size_t pool_block_size = 256u;
+    const std::size_t max_worker_free_jobs = 1024u;
+
+    thread_local const job_system* current_job_system = nullptr;
+    thread_local std::size_t current_worker_index = 0u;
+}
+
+namespace e2d
+{
+    //
+    // job_system::worker_data
+    //
+
+    struct job_system::worker_data {
+        std::thread thread;
+        std::mutex jobs_mutex;
+        std::deque<job*> jobs;
+        vector<job*> free_jobs;
+    };
+
+    //
+    // job_system::job
+    //
+
+    bool job_system::job::finished() const noexcept {
+        return 0u == unfinished_.load();
+    }
+
+    void job_system::job::invoke_() noexcept {
+        if ( function_ ) {
+            try {
+                invoke_fn_(function_);
+            } catch (...) {
+                // nothing
+            }
+            destroy_();
+        }
+    }
+
+    void job_system::job::destroy_() noexcept {
+        if ( function_ ) {
+            destroy_fn_(function_, function_ == static_cast<void*>(&storage_));
+            function_ = nullptr;
+            invoke_fn_ = nullptr;
+            destroy_fn_ = nullptr;
+        }
+    }
+
+    void intrusive_ptr_add_ref(job_system::job* j) noexcept {
+        j->refs_.fetch_add(1u);
+    }
+
+    void intrusive_ptr_release(job_system::job* j) noexcept {
+        j->owner_->release_job_(j);
+    }
+
+    //
+    // job_system
+    //
+
+    job_system::job_system(std::size_t threads) {
+        try {
+            workers_.resize(math::max(std::size_t(1u), threads));
+            for ( auto& w : workers_ ) {
+                w = std::make_unique<worker_data>();
+                w->free_jobs.reserve(max_worker_free_jobs);
+            }
+            for ( std::size_t i = 0; i < workers_.size(); ++i ) {
+                workers_[i]->thread = std::thread(&job_system::worker_main_, this, i);
+            }
+        } catch (...) {
+            cancelled_.store(true);
+            {
+                std::lock_guard<std::mutex> guard(sleep_mutex_);
+                sleep_cond_.notify_all();
+            }
+            for ( auto& w : workers_ ) {
+                if ( w && w->thread.joinable() ) {
+                    w->thread.join();
+                }
+            }
+            throw;
+        }
+    }
+
+    job_system::~job_system() noexcept {
+        cancelled_.store(true);
+        {
+            std::lock_guard<std::mutex> guard(sleep_mutex_);
+            sleep_cond_.notify_all();
+        }
+        for ( auto& w : workers_ ) {
+            if ( w->thread.joinable() ) {
+                w->thread.join();
+            }
+        }
+
+        // cancel jobs that have never been run,
+        // their functions are destroyed without invoking
+        while ( job* j = pop_job_() ) {
+            --active_count_;
+            release_job_(j);
+        }
+    }
+
+    std::size_t job_system::thread_count() const noexcept {
+        return workers_.size();
+    }
+
+    std::size_t job_system::active_job_count() const noexcept {
+        return active_count_.load();
+    }
+
+    void job_system::run(const job_iptr& job) {
+        E2D_ASSERT(job && job->owner_ == this);
+        intrusive_ptr_add_ref(job.get());
+        try {
+            push_job_(job.get());
+        } catch (...) {
+            intrusive_ptr_release(job.get());
+            throw;
+        }
+    }
+
+    void job_system::wait(const job_iptr& job) noexcept {
+        while ( job && !job->finished() ) {
+            if ( !active_wait_one() ) {
+                std::this_thread::yield();
+            }
+        }
+    }
+
+    void job_system::wait_all() noexcept {
+        while ( active_count_.load() ) {
+            if ( !active_wait_one() ) {
+                std::this_thread::yield();
+            }
+        }
+    }
+
+    std::size_t job_system::active_wait_one() noexcept {
+        job* j = pop_job_();
+        if ( !j ) {
+            return 0u;
+        }
+        execute_job_(j);
+        return 1u;
+    }
+
+    job_system::job* job_system::allocate_job_() {
+        job* result = nullptr;
+
+        const std::size_t index = current_worker_index_();
+        if ( index < workers_.size() && !workers_[index]->free_jobs.empty() ) {
+            result = workers_[index]->free_jobs.back();
+            workers_[index]->free_jobs.pop_back();
+        } else {
+            std::lock_guard<std::mutex> guard(pool_mutex_);
+            if ( pool_jobs_.empty() ) {
+                pool_jobs_.reserve((pool_blocks_.size() + 1u) * pool_block_size);
+                pool_blocks_.reserve(pool_blocks_.size() + 1u);
+                pool_blocks_.push_back(std::make_unique<job[]>(pool_block_size));
+                for ( std::size_t i = 0; i < pool_block_size; ++i ) {
+                    pool_jobs_.push_back(&pool_blocks_.back()[i]);
+                }
+            }
+            result = pool_jobs_.back();
+            pool_jobs_.pop_back();
+        }
+
+        result->owner_ = this;
+        result->parent_ = nullptr;
+        result->unfinished_.store(1u);
+        return result;
+    }
+
+    void job_system::free_job_(job* j) noexcept {
+        const std::size_t index = current_worker_index_();
+        if ( index < workers_.size() ) {
+            vector<job*>& free_jobs = workers_[index]->free_jobs;
+            if ( free_jobs.size() < free_jobs.capacity() ) {
+                free_jobs.push_back(j);
+                return;
+            }
+        }
+        std::lock_guard<std::mutex> guard(pool_mutex_);
+        // the capacity is reserved for all allocated jobs, so it doesn't throw
+        pool_jobs_.push_back(j);
+    }
+
+    void job_system::push_job_(job* j) {
+        const std::size_t index = current_worker_index_();
+        worker_data& w = index < workers_.size()
+            ? *workers_[index]
+            : *workers_[next_worker_.fetch_add(1u) % workers_.size()];
+        ++active_count_;
+        try {
+            std::lock_guard<std::mutex> guard(w.jobs_mutex);
+            w.jobs.push_back(j);
+        } catch (...) {
+            --active_count_;
+            throw;
+        }
+        ++pending_count_;
+        if ( sleeping_count_.load() ) {
+            std::lock_guard<std::mutex> guard(sleep_mutex_);
+            sleep_cond_.notify_one();
+        }
+    }
+
+    job_system::job* job_system::pop_job_() noexcept {
+        if ( !pending_count_.load() ) {
+            return nullptr;
+        }
+
+        // own jobs are taken from the back
+        const std::size_t index = current_worker_index_();
+        if ( index < workers_.size() ) {
+            worker_data& w = *workers_[index];
+            std::lock_guard<std::mutex> guard(w.jobs_mutex);
+            if ( !w.jobs.empty() ) {
+                job* j = w.jobs.back();
+                w.jobs.pop_back();
+                --pending_count_;
+                return j;
+            }
+        }
+
+        // and the others' jobs are stolen from the front
+        const std::size_t first = index < workers_.size()
+            ? index + 1u
+            : next_worker_.load();
+        for ( std::size_t i = 0; i < workers_.size(); ++i ) {
+            worker_data& w = *workers_[(first + i) % workers_.size()];
+            std::lock_guard<std::mutex> guard(w.jobs_mutex);
+            if ( !w.jobs.empty() ) {
+                job* j = w.jobs.front();
+                w.jobs.pop_front();
+                --pending_count_;
+                return j;
+            }
+        }
+
+        return nullptr;
+    }
+
+    void job_system::execute_job_(job* j) noexcept {
+        j->invoke_();
+        finish_job_(j);
+        --active_count_;
+        release_job_(j);
+    }
+
+    void job_system::finish_job_(job* j) noexcept {
+        for ( ; j; j = j->parent_ ) {
+            if ( 1u != j->unfinished_.fetch_sub(1u) ) {
+                break;
+            }
+        }
+    }
+
+    void job_system::release_job_(job* j) noexcept {
+        if ( 1u != j->refs_.fetch_sub(1u) ) {
+            return;
+        }
+
+        // the job has never been run
+        if ( j->function_ ) {
+            j->destroy_();
+            finish_job_(j);
+        }
+
+        job* parent = j->parent_;
+        j->parent_ = nullptr;
+        free_job_(j);
+
+        if ( parent ) {
+            release_job_(parent);
+        }
+    }
+
+    void job_system::worker_main_(std::size_t index) noexcept {
+        current_job_system = this;
+        current_worker_index = index;
+        while ( !cancelled_.load() ) {
+            if ( active_wait_one() ) {
+                continue;
+            }
+            std::unique_lock<std::mutex> lock(sleep_mutex_);
+            ++sleeping_count_;
+            sleep_cond_.wait(lock, [this](){
+                return cancelled_.load() || pending_count_.load();
+            });
+            --sleeping_count_;
+        }
+        current_job_system = nullptr;
+    }
+
+    std::size_t job_system::current_worker_index_() const noexcept {
+        return current_job_system == this
+            ? current_worker_index
+            : workers_.size();
+    }
+}
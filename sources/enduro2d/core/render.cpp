@@ -122,6 +122,23 @@ namespace
     private:
         render& render_;
     };
+
+    std::size_t combine_hash(std::size_t l, std::size_t r) noexcept {
+        return l ^ (r + 0x9e3779b9 + (l << 6) + (l >> 2));
+    }
+
+    template < typename T >
+    std::size_t hash_words(const T& value) noexcept {
+        // all property values consist of 32-bit scalars
+        static_assert(sizeof(T) % sizeof(u32) == 0, "unexpected value size");
+        u32 words[sizeof(T) / sizeof(u32)];
+        std::memcpy(words, &value, sizeof(T));
+        u64 result = 14695981039346656037ull;
+        for ( u32 word : words ) {
+            result = (result ^ word) * 1099511628211ull;
+        }
+        return static_cast<std::size_t>(result);
+    }
 }
 
 namespace e2d
@@ -639,6 +656,8 @@ namespace e2d
     // render::property_block::sampler
     //
 
+    render::sampler_state::sampler_state() noexcept = default;
+
     render::sampler_state& render::sampler_state::texture(const texture_ptr& texture) noexcept {
         texture_ = texture;
         return *this;
@@ -713,60 +732,59 @@ namespace e2d
     render::property_block& render::property_block::clear() noexcept {
         properties_.clear();
         samplers_.clear();
+        dirty_hash_ = true;
         return *this;
     }
 
     render::property_block& render::property_block::merge(const property_block& pb) {
-        pb.foreach_by_properties([this](str_hash name, const property_value& v){
-            property(name, v);
-        });
-        pb.foreach_by_samplers([this](str_hash name, const sampler_state& s){
-            sampler(name, s);
-        });
+        properties_.merge(pb.properties_);
+        samplers_.merge(pb.samplers_);
+        dirty_hash_ = true;
         return *this;
     }
 
     bool render::property_block::equals(const property_block& other) const noexcept {
-        return properties_ == other.properties_
-            && samplers_ == other.samplers_;
+        if ( this == &other ) {
+            return true;
+        }
+        if ( property_count() != other.property_count()
+            || sampler_count() != other.sampler_count()
+            || hash() != other.hash() )
+        {
+            return false;
+        }
+        return properties_.equals(other.properties_)
+            && samplers_.equals(other.samplers_);
     }
 
     render::property_block& render::property_block::sampler(str_hash name, const sampler_state& s) {
-        samplers_[name] = s;
+        samplers_.assign(name, s);
+        dirty_hash_ = true;
         return *this;
     }
 
-    render::sampler_state* render::property_block::sampler(str_hash name) noexcept {
-        const auto iter = samplers_.find(name);
-        return iter != samplers_.end()
-            ? &iter->second
-            : nullptr;
+    render::property_block::value_ref<render::sampler_state>
+    render::property_block::sampler(str_hash name) noexcept {
+        return value_ref<sampler_state>(samplers_.find(name), dirty_hash_);
     }
 
     const render::sampler_state* render::property_block::sampler(str_hash name) const noexcept {
-        const auto iter = samplers_.find(name);
-        return iter != samplers_.end()
-            ? &iter->second
-            : nullptr;
+        return samplers_.find(name);
     }
 
     render::property_block& render::property_block::property(str_hash name, const property_value& v) {
-        properties_[name] = v;
+        properties_.assign(name, v);
+        dirty_hash_ = true;
         return *this;
     }
 
-    render::property_value* render::property_block::property(str_hash name) noexcept {
-        const auto iter = properties_.find(name);
-        return iter != properties_.end()
-            ? &iter->second
-            : nullptr;
+    render::property_block::value_ref<render::property_value>
+    render::property_block::property(str_hash name) noexcept {
+        return value_ref<property_value>(properties_.find(name), dirty_hash_);
     }
 
     const render::property_value* render::property_block::property(str_hash name) const noexcept {
-        const auto iter = properties_.find(name);
-        return iter != properties_.end()
-            ? &iter->second
-            : nullptr;
+        return properties_.find(name);
     }
 
     std::size_t render::property_block::sampler_count() const noexcept {
@@ -777,6 +795,46 @@ namespace e2d
         return properties_.size();
     }
 
+    std::size_t render::property_block::hash() const noexcept {
+        if ( !dirty_hash_ ) {
+            return hash_;
+        }
+        std::size_t result = 0;
+        for ( const auto& p : properties_ ) {
+            result = combine_hash(result, p.first.hash());
+            result = combine_hash(result, p.second.index());
+            stdex::visit([&result](const auto& v) noexcept {
+                result = combine_hash(result, hash_words(v));
+            }, p.second);
+        }
+        for ( const auto& p : samplers_ ) {
+            result = combine_hash(result, p.first.hash());
+            result = combine_hash(result, std::hash<texture_ptr>()(p.second.texture()));
+            result = combine_hash(result, math::enum_to_number(p.second.s_wrap()));
+            result = combine_hash(result, math::enum_to_number(p.second.t_wrap()));
+            result = combine_hash(result, math::enum_to_number(p.second.r_wrap()));
+            result = combine_hash(result, math::enum_to_number(p.second.min_filter()));
+            result = combine_hash(result, math::enum_to_number(p.second.mag_filter()));
+        }
+        hash_ = result;
+        dirty_hash_ = false;
+        return hash_;
+    }
+
+    bool render::property_block::is_same_value(const sampler_state& l, const sampler_state& r) noexcept {
+        return l == r;
+    }
+
+    bool render::property_block::is_same_value(const property_value& l, const property_value& r) noexcept {
+        // values are compared bitwise to stay consistent with the content
+        // hash, the approximate comparison of math types is not transitive
+        return stdex::visit([&r](const auto& lv) noexcept {
+            using value_type = std::decay_t<decltype(lv)>;
+            const value_type* rv = stdex::get_if<value_type>(&r);
+            return rv && 0 == std::memcmp(&lv, rv, sizeof(value_type));
+        }, l);
+    }
+
     //
     // pass_state
     //
@@ -25,6 +25,21 @@ namespace e2d
     //
 
     class texture::internal_state final : private e2d::noncopyable {
+    public:
+        v2u size;
+        pixel_declaration decl;
+    public:
+        internal_state(const v2u& nsize, const pixel_declaration& ndecl) noexcept
+        : size(nsize)
+        , decl(ndecl) {}
+        ~internal_state() noexcept = default;
+    };
+
+    //
+    // pixel_buffer::internal_state
+    //
+
+    class pixel_buffer::internal_state final : private e2d::noncopyable {
     public:
         internal_state() noexcept = default;
         ~internal_state() noexcept = default;
@@ -36,7 +51,12 @@ namespace e2d
 
     class index_buffer::internal_state final : private e2d::noncopyable {
     public:
-        internal_state() noexcept = default;
+        buffer content;
+        index_declaration decl;
+    public:
+        internal_state(buffer ncontent, const index_declaration& ndecl) noexcept
+        : content(std::move(ncontent))
+        , decl(ndecl) {}
         ~internal_state() noexcept = default;
     };
 
@@ -46,7 +66,12 @@ namespace e2d
 
     class vertex_buffer::internal_state final : private e2d::noncopyable {
     public:
-        internal_state() noexcept = default;
+        buffer content;
+        vertex_declaration decl;
+    public:
+        internal_state(buffer ncontent, const vertex_declaration& ndecl) noexcept
+        : content(std::move(ncontent))
+        , decl(ndecl) {}
         ~internal_state() noexcept = default;
     };
 
@@ -64,10 +89,20 @@ namespace e2d
     // render::internal_state
     //
 
+    // buffers keep their content and textures their size in memory, draw commands only
+    // update the frame statistics, so the higher level code can be
+    // checked against this backend without a graphics device
     class render::internal_state final : private e2d::noncopyable {
     public:
         debug& debug_;
         window& window_;
+        frame_statistics statistics_;
+        frame_statistics last_statistics_;
+        bool has_states_ = false;
+        state_block last_states_;
+        vector<texture_ptr> last_textures_;
+        const index_buffer* last_indices_ = nullptr;
+        const vertex_buffer* last_vertices_ = nullptr;
     public:
         internal_state(debug& debug, window& window) noexcept
         : debug_(debug)
@@ -99,14 +134,61 @@ namespace e2d
     : state_(std::move(state)) {}
     texture::~texture() noexcept = default;
 
+    void texture::update(const image& image, const v2u& offset) noexcept {
+        E2D_UNUSED(image, offset);
+    }
+
     const v2u& texture::size() const noexcept {
-        static v2u size;
-        return size;
+        return state_->size;
+    }
+
+    void texture::load_mipmap(
+        u32 level,
+        const pixel_buffer_ptr& src,
+        std::size_t offset,
+        std::size_t size) noexcept
+    {
+        E2D_UNUSED(level, src, offset, size);
     }
 
     const pixel_declaration& texture::decl() const noexcept {
-        static pixel_declaration decl;
-        return decl;
+        return state_->decl;
+    }
+
+    u32 texture::mipmap_count() const noexcept {
+        return 1u;
+    }
+
+    u32 texture::base_level() const noexcept {
+        return 0u;
+    }
+
+    //
+    // pixel_buffer
+    //
+
+    const pixel_buffer::internal_state& pixel_buffer::state() const noexcept {
+        return *state_;
+    }
+
+    pixel_buffer::pixel_buffer(internal_state_uptr state)
+    : state_(std::move(state)) {}
+    pixel_buffer::~pixel_buffer() noexcept = default;
+
+    u8* pixel_buffer::map() noexcept {
+        return nullptr;
+    }
+
+    bool pixel_buffer::unmap() noexcept {
+        return false;
+    }
+
+    bool pixel_buffer::mapped() const noexcept {
+        return false;
+    }
+
+    std::size_t pixel_buffer::buffer_size() const noexcept {
+        return 0u;
     }
 
     //
@@ -122,11 +204,32 @@ namespace e2d
     index_buffer::~index_buffer() noexcept = default;
 
     void index_buffer::update(const buffer& indices, std::size_t offset) noexcept {
-        E2D_UNUSED(indices, offset);
+        update(indices.data(), indices.size(), offset);
+    }
+
+    void index_buffer::update(const void* indices, std::size_t size, std::size_t offset) noexcept {
+        const std::size_t buffer_offset = offset * state_->decl.bytes_per_index();
+        E2D_ASSERT(buffer_offset <= state_->content.size() && size <= state_->content.size() - buffer_offset);
+        E2D_ASSERT(size % state_->decl.bytes_per_index() == 0);
+        if ( size ) {
+            std::memcpy(state_->content.data() + buffer_offset, indices, size);
+        }
+    }
+
+    void index_buffer::orphan() noexcept {
     }
 
     std::size_t index_buffer::buffer_size() const noexcept {
-        return 0u;
+        return state_->content.size();
+    }
+
+    std::size_t index_buffer::index_count() const noexcept {
+        E2D_ASSERT(state_->content.size() % state_->decl.bytes_per_index() == 0);
+        return state_->content.size() / state_->decl.bytes_per_index();
+    }
+
+    const index_declaration& index_buffer::decl() const noexcept {
+        return state_->decl;
     }
 
     //
@@ -142,11 +245,27 @@ namespace e2d
     vertex_buffer::~vertex_buffer() noexcept = default;
 
     void vertex_buffer::update(const buffer& vertices, std::size_t offset) noexcept {
-        E2D_UNUSED(vertices, offset);
+        update(vertices.data(), vertices.size(), offset);
+    }
+
+    void vertex_buffer::update(const void* vertices, std::size_t size, std::size_t offset) noexcept {
+        const std::size_t buffer_offset = offset * state_->decl.bytes_per_vertex();
+        E2D_ASSERT(buffer_offset <= state_->content.size() && size <= state_->content.size() - buffer_offset);
+        E2D_ASSERT(size % state_->decl.bytes_per_vertex() == 0);
+        if ( size ) {
+            std::memcpy(state_->content.data() + buffer_offset, vertices, size);
+        }
+    }
+
+    void vertex_buffer::orphan() noexcept {
     }
 
     std::size_t vertex_buffer::buffer_size() const noexcept {
-        return 0u;
+        return state_->content.size();
+    }
+
+    const vertex_declaration& vertex_buffer::decl() const noexcept {
+        return state_->decl;
     }
 
     //
@@ -207,7 +326,21 @@ namespace e2d
     }
 
     texture_ptr render::create_texture(const v2u& size, const pixel_declaration& decl) {
-        E2D_UNUSED(size, decl);
+        return std::make_shared<texture>(
+            std::make_unique<texture::internal_state>(size, decl));
+    }
+
+    texture_ptr render::create_streaming_texture(
+        const v2u& size,
+        image_data_format format,
+        u32 mipmap_count)
+    {
+        E2D_UNUSED(size, format, mipmap_count);
+        return nullptr;
+    }
+
+    pixel_buffer_ptr render::create_pixel_buffer(std::size_t size) {
+        E2D_UNUSED(size);
         return nullptr;
     }
 
@@ -216,8 +349,19 @@ namespace e2d
         const index_declaration& decl,
         index_buffer::usage usage)
     {
-        E2D_UNUSED(indices, decl, usage);
-        return nullptr;
+        E2D_UNUSED(usage);
+        return std::make_shared<index_buffer>(
+            std::make_unique<index_buffer::internal_state>(indices, decl));
+    }
+
+    index_buffer_ptr render::create_index_buffer(
+        std::size_t size,
+        const index_declaration& decl,
+        index_buffer::usage usage)
+    {
+        E2D_UNUSED(usage);
+        return std::make_shared<index_buffer>(
+            std::make_unique<index_buffer::internal_state>(buffer(size), decl));
     }
 
     vertex_buffer_ptr render::create_vertex_buffer(
@@ -225,8 +369,19 @@ namespace e2d
         const vertex_declaration& decl,
         vertex_buffer::usage usage)
     {
-        E2D_UNUSED(vertices, decl, usage);
-        return nullptr;
+        E2D_UNUSED(usage);
+        return std::make_shared<vertex_buffer>(
+            std::make_unique<vertex_buffer::internal_state>(vertices, decl));
+    }
+
+    vertex_buffer_ptr render::create_vertex_buffer(
+        std::size_t size,
+        const vertex_declaration& decl,
+        vertex_buffer::usage usage)
+    {
+        E2D_UNUSED(usage);
+        return std::make_shared<vertex_buffer>(
+            std::make_unique<vertex_buffer::internal_state>(buffer(size), decl));
     }
 
     render_target_ptr render::create_render_target(
@@ -240,7 +395,54 @@ namespace e2d
     }
 
     render& render::execute(const draw_command& command) {
-        E2D_UNUSED(command);
+        internal_state& st = *state_;
+        frame_statistics& stats = st.statistics_;
+        const material& mat = command.material_ref();
+        const geometry& geo = command.geometry_ref();
+
+        for ( std::size_t i = 0, e = mat.pass_count(); i < e; ++i ) {
+            const pass_state& pass = mat.pass(i);
+
+            if ( !st.has_states_ || st.last_states_ != pass.states() ) {
+                st.has_states_ = true;
+                st.last_states_ = pass.states();
+                ++stats.applied_state_changes;
+            } else {
+                ++stats.skipped_state_changes;
+            }
+
+            std::size_t unit = 0;
+            const auto bind_sampler = [&st, &stats, &unit](str_hash name, const sampler_state& sampler){
+                E2D_UNUSED(name);
+                if ( unit == st.last_textures_.size() ) {
+                    st.last_textures_.emplace_back();
+                }
+                if ( st.last_textures_[unit] != sampler.texture() ) {
+                    st.last_textures_[unit] = sampler.texture();
+                    ++stats.applied_texture_binds;
+                } else {
+                    ++stats.skipped_texture_binds;
+                }
+                ++unit;
+            };
+            mat.properties().foreach_by_samplers(bind_sampler);
+            pass.properties().foreach_by_samplers(bind_sampler);
+            command.properties_ref().foreach_by_samplers(bind_sampler);
+
+            const index_buffer* ib = geo.indices().get();
+            const vertex_buffer* vb = geo.vertices_count()
+                ? geo.vertices(0).get()
+                : nullptr;
+            if ( st.last_indices_ != ib || st.last_vertices_ != vb ) {
+                st.last_indices_ = ib;
+                st.last_vertices_ = vb;
+                ++stats.applied_buffer_binds;
+            } else {
+                ++stats.skipped_buffer_binds;
+            }
+
+            ++stats.draw_calls;
+        }
         return *this;
     }
 
@@ -259,6 +461,16 @@ namespace e2d
         return *this;
     }
 
+    render& render::frame_tick() noexcept {
+        state_->last_statistics_ = state_->statistics_;
+        state_->statistics_ = frame_statistics();
+        return *this;
+    }
+
+    const render::frame_statistics& render::last_frame_statistics() const noexcept {
+        return state_->last_statistics_;
+    }
+
     const render::device_caps& render::device_capabilities() const noexcept {
         static device_caps caps;
         return caps;
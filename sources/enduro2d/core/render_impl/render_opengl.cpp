@@ -105,76 +105,53 @@ namespace
         uniform_info ui_;
     };
 
-    void bind_property_block(
+    template < typename F >
+    bool bind_property_block(
         debug& debug,
+        render::frame_statistics& stats,
         const shader_ptr& ps,
-        const render::property_block& pb) noexcept
+        const render::property_block& pb,
+        std::size_t max_units,
+        F&& bind_sampler) noexcept
     {
         E2D_ASSERT(ps && gl_program_id::current(debug) == ps->state().id());
-        pb.foreach_by_properties([&debug, &ps](str_hash name, const render::property_value& value) noexcept {
-            ps->state().with_uniform_location(name, [&debug, &value](const uniform_info& ui) noexcept {
-                E2D_ASSERT(!value.valueless_by_exception());
-                stdex::visit(property_block_value_visitor(debug, ui), value);
-            });
-        });
-        GLint unit = 0;
-        pb.foreach_by_samplers([&debug, &ps, &unit](str_hash name, const render::sampler_state& sampler) noexcept {
-            ps->state().with_uniform_location(name, [&debug, &sampler, &unit](const uniform_info& ui) noexcept {
-                GL_CHECK_CODE(debug, glActiveTexture(
-                    math::numeric_cast<GLenum>(GL_TEXTURE0 + unit)));
-                GL_CHECK_CODE(debug, glUniform1i(
-                    ui.location, math::numeric_cast<GLint>(unit)));
-                if ( sampler.texture() ) {
-                    const gl_texture_id& texture_id = sampler.texture()->state().id();
-                    GL_CHECK_CODE(debug, glBindTexture(
-                        texture_id.target(), *texture_id));
-                    GL_CHECK_CODE(debug, glTexParameteri(
-                        texture_id.target(),
-                        GL_TEXTURE_WRAP_S,
-                        convert_sampler_wrap(sampler.s_wrap())));
-                    GL_CHECK_CODE(debug, glTexParameteri(
-                        texture_id.target(),
-                        GL_TEXTURE_WRAP_T,
-                        convert_sampler_wrap(sampler.t_wrap())));
-                    GL_CHECK_CODE(debug, glTexParameteri(
-                        texture_id.target(),
-                        GL_TEXTURE_WRAP_R,
-                        convert_sampler_wrap(sampler.r_wrap())));
-                    GL_CHECK_CODE(debug, glTexParameteri(
-                        texture_id.target(),
-                        GL_TEXTURE_MIN_FILTER,
-                        convert_sampler_filter(sampler.min_filter())));
-                    GL_CHECK_CODE(debug, glTexParameteri(
-                        texture_id.target(),
-                        GL_TEXTURE_MAG_FILTER,
-                        convert_sampler_filter(sampler.mag_filter())));
+        pb.foreach_by_properties([&debug, &stats, &ps](str_hash name, const render::property_value& value) noexcept {
+            E2D_ASSERT(!value.valueless_by_exception());
+            ps->state().with_uniform_value(name, value, [&debug, &stats, &value](const uniform_info& ui, bool changed) noexcept {
+                if ( changed ) {
+                    stdex::visit(property_block_value_visitor(debug, ui), value);
+                    ++stats.issued_uniform_uploads;
                 } else {
-                    GL_CHECK_CODE(debug, glBindTexture(GL_TEXTURE_2D, 0));
-                    GL_CHECK_CODE(debug, glBindTexture(GL_TEXTURE_CUBE_MAP, 0));
+                    ++stats.skipped_uniform_uploads;
                 }
-                ++unit;
             });
         });
-    }
-
-    void unbind_property_block(
-        debug& debug,
-        const shader_ptr& ps,
-        const render::property_block& pb) noexcept
-    {
-        E2D_ASSERT(ps && gl_program_id::current(debug) == ps->state().id());
-        GLint unit = 0;
-        pb.foreach_by_samplers([&debug, &ps, &unit](str_hash name, const render::sampler_state& sampler) noexcept {
-            E2D_UNUSED(sampler);
-            ps->state().with_uniform_location(name, [&debug, &unit](const uniform_info& ui) noexcept {
-                E2D_UNUSED(ui);
-                GL_CHECK_CODE(debug, glActiveTexture(
-                    math::numeric_cast<GLenum>(GL_TEXTURE0 + unit)));
-                GL_CHECK_CODE(debug, glBindTexture(GL_TEXTURE_2D, 0));
-                GL_CHECK_CODE(debug, glBindTexture(GL_TEXTURE_CUBE_MAP, 0));
+        std::size_t unit = 0;
+        bool success = true;
+        pb.foreach_by_samplers([&debug, &stats, &ps, &unit, &success, max_units, &bind_sampler](str_hash name, const render::sampler_state& sampler) noexcept {
+            const render::property_value unit_value = math::numeric_cast<i32>(unit);
+            ps->state().with_uniform_value(name, unit_value, [&debug, &stats, &sampler, &unit, &success, max_units, &bind_sampler](const uniform_info& ui, bool changed) noexcept {
+                if ( unit >= max_units ) {
+                    debug.error("RENDER: Out of texture units:\n"
+                        "--> Sampler: %0\n"
+                        "--> Max units: %1",
+                        ui.name.hash(),
+                        max_units);
+                    success = false;
+                    return;
+                }
+                if ( changed ) {
+                    GL_CHECK_CODE(debug, glUniform1i(
+                        ui.location, math::numeric_cast<GLint>(unit)));
+                    ++stats.issued_uniform_uploads;
+                } else {
+                    ++stats.skipped_uniform_uploads;
+                }
+                bind_sampler(unit, sampler);
                 ++unit;
             });
         });
+        return success;
     }
 
     void bind_vertex_declaration(
@@ -183,26 +160,24 @@ namespace
         const vertex_buffer_ptr& vb) noexcept
     {
         E2D_ASSERT(ps && vb);
-        opengl::with_gl_bind_buffer(debug, vb->state().id(), [&debug, &ps, &vb]() noexcept {
-            const vertex_declaration& decl = vb->decl();
-            for ( std::size_t i = 0, e = decl.attribute_count(); i < e; ++i ) {
-                const vertex_declaration::attribute_info& vai = decl.attribute(i);
-                ps->state().with_attribute_location(vai.name, [&debug, &decl, &vai](const attribute_info& ai) noexcept {
-                    const GLuint rows = math::numeric_cast<GLuint>(vai.rows);
-                    for ( GLuint row = 0; row < rows; ++row ) {
-                        GL_CHECK_CODE(debug, glEnableVertexAttribArray(
-                            math::numeric_cast<GLuint>(ai.location) + row));
-                        GL_CHECK_CODE(debug, glVertexAttribPointer(
-                            math::numeric_cast<GLuint>(ai.location) + row,
-                            math::numeric_cast<GLint>(vai.columns),
-                            convert_attribute_type(vai.type),
-                            vai.normalized ? GL_TRUE : GL_FALSE,
-                            math::numeric_cast<GLsizei>(decl.bytes_per_vertex()),
-                            reinterpret_cast<const GLvoid*>(vai.stride + row * vai.row_size())));
-                    }
-                });
-            }
-        });
+        const vertex_declaration& decl = vb->decl();
+        for ( std::size_t i = 0, e = decl.attribute_count(); i < e; ++i ) {
+            const vertex_declaration::attribute_info& vai = decl.attribute(i);
+            ps->state().with_attribute_location(vai.name, [&debug, &decl, &vai](const attribute_info& ai) noexcept {
+                const GLuint rows = math::numeric_cast<GLuint>(vai.rows);
+                for ( GLuint row = 0; row < rows; ++row ) {
+                    GL_CHECK_CODE(debug, glEnableVertexAttribArray(
+                        math::numeric_cast<GLuint>(ai.location) + row));
+                    GL_CHECK_CODE(debug, glVertexAttribPointer(
+                        math::numeric_cast<GLuint>(ai.location) + row,
+                        math::numeric_cast<GLint>(vai.columns),
+                        convert_attribute_type(vai.type),
+                        vai.normalized ? GL_TRUE : GL_FALSE,
+                        math::numeric_cast<GLsizei>(decl.bytes_per_vertex()),
+                        reinterpret_cast<const GLvoid*>(vai.stride + row * vai.row_size())));
+                }
+            });
+        }
     }
 
     void unbind_vertex_declaration(
@@ -232,49 +207,29 @@ namespace
         std::size_t count) noexcept
     {
         E2D_ASSERT(ib);
-        with_gl_bind_buffer(debug, ib->state().id(), [&debug, &tp, &ib, &first, &count]() noexcept {
-            const index_declaration& decl = ib->decl();
-            if ( first < ib->index_count() ) {
-                GL_CHECK_CODE(debug, glDrawElements(
-                    convert_topology(tp),
-                    math::numeric_cast<GLsizei>(math::min(count, ib->index_count() - first)),
-                    convert_index_type(decl.type()),
-                    reinterpret_cast<const GLvoid*>(first * decl.bytes_per_index())));
-            }
-        });
-    }
-
-    template < typename F, typename... Args >
-    void with_material_shader(
-        debug& debug,
-        const shader_ptr& ps,
-        const render::property_block& pb,
-        F&& f,
-        Args&&... args)
-    {
-        bind_property_block(debug, ps, pb);
-        try {
-            stdex::invoke(
-                std::forward<F>(f),
-                std::forward<Args>(args)...);
-        } catch (...) {
-            unbind_property_block(debug, ps, pb);
-            throw;
+        const index_declaration& decl = ib->decl();
+        if ( first < ib->index_count() ) {
+            GL_CHECK_CODE(debug, glDrawElements(
+                convert_topology(tp),
+                math::numeric_cast<GLsizei>(math::min(count, ib->index_count() - first)),
+                convert_index_type(decl.type()),
+                reinterpret_cast<const GLvoid*>(first * decl.bytes_per_index())));
         }
-        unbind_property_block(debug, ps, pb);
     }
 
-    template < typename F, typename... Args >
+    template < typename B, typename F, typename... Args >
     void with_geometry_vertices(
         debug& debug,
         const shader_ptr& ps,
         const render::geometry& geo,
+        B&& bind_buffer,
         F&& f,
         Args&&... args)
     {
         for ( std::size_t i = 0, e = geo.vertices_count(); i < e; ++i ) {
             const vertex_buffer_ptr& vb = geo.vertices(i);
             if ( vb ) {
+                bind_buffer(vb);
                 bind_vertex_declaration(debug, ps, vb);
             }
         }
@@ -297,6 +252,101 @@ namespace
         }
     }
 
+    index_buffer_ptr create_gl_index_buffer(
+        debug& debug,
+        const void* indices,
+        std::size_t size,
+        const index_declaration& decl,
+        index_buffer::usage usage)
+    {
+        gl_buffer_id id = gl_buffer_id::create(debug, GL_ELEMENT_ARRAY_BUFFER);
+        if ( id.empty() ) {
+            debug.error("RENDER: Failed to create index buffer:\n"
+                "--> Info: failed to create index buffer id");
+            return nullptr;
+        }
+
+        with_gl_bind_buffer(debug, id, [&debug, &id, &indices, &size, &usage]() {
+            GL_CHECK_CODE(debug, glBufferData(
+                id.target(),
+                math::numeric_cast<GLsizeiptr>(size),
+                indices,
+                convert_buffer_usage(usage)));
+        });
+
+        return std::make_shared<index_buffer>(
+            std::make_unique<index_buffer::internal_state>(
+                debug, std::move(id), size, decl, convert_buffer_usage(usage)));
+    }
+
+    vertex_buffer_ptr create_gl_vertex_buffer(
+        debug& debug,
+        const void* vertices,
+        std::size_t size,
+        const vertex_declaration& decl,
+        vertex_buffer::usage usage)
+    {
+        gl_buffer_id id = gl_buffer_id::create(debug, GL_ARRAY_BUFFER);
+        if ( id.empty() ) {
+            debug.error("RENDER: Failed to create vertex buffer:\n"
+                "--> Info: failed to create vertex buffer id");
+            return nullptr;
+        }
+
+        with_gl_bind_buffer(debug, id, [&debug, &id, &vertices, &size, &usage]() {
+            GL_CHECK_CODE(debug, glBufferData(
+                id.target(),
+                math::numeric_cast<GLsizeiptr>(size),
+                vertices,
+                convert_buffer_usage(usage)));
+        });
+
+        return std::make_shared<vertex_buffer>(
+            std::make_unique<vertex_buffer::internal_state>(
+                debug, std::move(id), size, decl, convert_buffer_usage(usage)));
+    }
+
+    v2u texture_level_size(const v2u& size, u32 level) noexcept {
+        return v2u(
+            math::max(size.x >> level, 1u),
+            math::max(size.y >> level, 1u));
+    }
+
+    void load_texture_level(
+        debug& debug,
+        const gl_texture_id& id,
+        const pixel_declaration& decl,
+        GLenum external_format,
+        GLenum external_data_type,
+        u32 level,
+        const v2u& size,
+        const void* data,
+        std::size_t data_size) noexcept
+    {
+        if ( decl.is_compressed() ) {
+            GL_CHECK_CODE(debug, glCompressedTexImage2D(
+                id.target(),
+                math::numeric_cast<GLint>(level),
+                convert_pixel_type_to_internal_format_e(decl.type()),
+                math::numeric_cast<GLsizei>(size.x),
+                math::numeric_cast<GLsizei>(size.y),
+                0,
+                math::numeric_cast<GLsizei>(data_size),
+                data));
+        } else {
+            GL_CHECK_CODE(debug, glTexImage2D(
+                id.target(),
+                math::numeric_cast<GLint>(level),
+                convert_pixel_type_to_internal_format(decl.type()),
+                math::numeric_cast<GLsizei>(size.x),
+                math::numeric_cast<GLsizei>(size.y),
+                0,
+                external_format,
+                external_data_type,
+                data));
+        }
+    }
+
     render::property_block& main_property_cache() {
         static render::property_block props;
         return props;
@@ -333,6 +383,65 @@ namespace e2d
     }
     texture::~texture() noexcept = default;
 
+    void texture::update(const image& image, const v2u& offset) noexcept {
+        E2D_ASSERT(!state_->decl().is_compressed());
+        E2D_ASSERT(state_->decl() == convert_image_data_format_to_pixel_declaration(image.format()));
+        E2D_ASSERT(offset.x <= state_->size().x && image.size().x <= state_->size().x - offset.x);
+        E2D_ASSERT(offset.y <= state_->size().y && image.size().y <= state_->size().y - offset.y);
+        opengl::with_gl_bind_texture(state_->dbg(), state_->id(),
+            [this, &image, &offset]() noexcept {
+                GL_CHECK_CODE(state_->dbg(), glTexSubImage2D(
+                    state_->id().target(),
+                    0,
+                    math::numeric_cast<GLint>(offset.x),
+                    math::numeric_cast<GLint>(offset.y),
+                    math::numeric_cast<GLsizei>(image.size().x),
+                    math::numeric_cast<GLsizei>(image.size().y),
+                    convert_image_data_format_to_external_format(image.format()),
+                    convert_image_data_format_to_external_data_type(image.format()),
+                    image.data().data()));
+            });
+    }
+
+    void texture::load_mipmap(
+        u32 level,
+        const pixel_buffer_ptr& src,
+        std::size_t offset,
+        std::size_t size) noexcept
+    {
+        E2D_ASSERT(src && !src->mapped());
+        E2D_ASSERT(level < state_->mipmap_count());
+        E2D_ASSERT(offset <= src->buffer_size() && size <= src->buffer_size() - offset);
+        const pixel_buffer::internal_state& src_state = src->state();
+        const v2u level_size = texture_level_size(state_->size(), level);
+        opengl::with_gl_bind_texture(state_->dbg(), state_->id(),
+            [this, &src_state, level, &level_size, offset, size]() noexcept {
+                if ( src_state.id().empty() ) {
+                    load_texture_level(
+                        state_->dbg(), state_->id(), state_->decl(),
+                        state_->external_format(), state_->external_data_type(),
+                        level, level_size, src_state.client_data() + offset, size);
+                } else {
+                    opengl::with_gl_bind_buffer(state_->dbg(), src_state.id(),
+                        [this, level, &level_size, offset, size]() noexcept {
+                            load_texture_level(
+                                state_->dbg(), state_->id(), state_->decl(),
+                                state_->external_format(), state_->external_data_type(),
+                                level, level_size, reinterpret_cast<const GLvoid*>(offset), size);
+                        });
+                }
+            #if E2D_RENDER_MODE == E2D_RENDER_MODE_OPENGL
+                if ( level < state_->base_level() ) {
+                    GL_CHECK_CODE(state_->dbg(), glTexParameteri(
+                        state_->id().target(),
+                        GL_TEXTURE_BASE_LEVEL,
+                        math::numeric_cast<GLint>(level)));
+                }
+            #endif
+            });
+        state_->base_level(math::min(level, state_->base_level()));
+    }
+
     const v2u& texture::size() const noexcept {
         return state_->size();
     }
@@ -341,6 +450,86 @@ namespace e2d
         return state_->decl();
     }
 
+    u32 texture::mipmap_count() const noexcept {
+        return state_->mipmap_count();
+    }
+
+    u32 texture::base_level() const noexcept {
+        return state_->base_level();
+    }
+
+    //
+    // pixel_buffer
+    //
+
+    const pixel_buffer::internal_state& pixel_buffer::state() const noexcept {
+        return *state_;
+    }
+
+    pixel_buffer::pixel_buffer(internal_state_uptr state)
+    : state_(std::move(state)) {
+        E2D_ASSERT(state_);
+    }
+
+    pixel_buffer::~pixel_buffer() noexcept {
+        if ( state_->mapped_data() ) {
+            unmap();
+        }
+    }
+
+    u8* pixel_buffer::map() noexcept {
+        E2D_ASSERT(!state_->mapped_data());
+        if ( state_->id().empty() ) {
+            state_->mapped_data(state_->client_data());
+            return state_->mapped_data();
+        }
+    #if E2D_RENDER_MODE == E2D_RENDER_MODE_OPENGL
+        opengl::with_gl_bind_buffer(state_->dbg(), state_->id(),
+            [this]() noexcept {
+                // orphans the previous storage, so mapping
+                // does not wait for uploads that still read it
+                GL_CHECK_CODE(state_->dbg(), glBufferData(
+                    state_->id().target(),
+                    math::numeric_cast<GLsizeiptr>(state_->size()),
+                    nullptr,
+                    GL_STREAM_DRAW));
+                void* data = nullptr;
+                GL_CHECK_CODE(state_->dbg(), data = glMapBuffer(
+                    state_->id().target(),
+                    GL_WRITE_ONLY));
+                state_->mapped_data(static_cast<u8*>(data));
+            });
+    #endif
+        return state_->mapped_data();
+    }
+
+    bool pixel_buffer::unmap() noexcept {
+        E2D_ASSERT(state_->mapped_data());
+        state_->mapped_data(nullptr);
+        if ( state_->id().empty() ) {
+            return true;
+        }
+        bool success = false;
+    #if E2D_RENDER_MODE == E2D_RENDER_MODE_OPENGL
+        opengl::with_gl_bind_buffer(state_->dbg(), state_->id(),
+            [this, &success]() noexcept {
+                GLboolean result = GL_FALSE;
+                GL_CHECK_CODE(state_->dbg(), result = glUnmapBuffer(
+                    state_->id().target()));
+                success = result == GL_TRUE;
+            });
+    #endif
+        return success;
+    }
+
+    bool pixel_buffer::mapped() const noexcept {
+        return !!state_->mapped_data();
+    }
+
+    std::size_t pixel_buffer::buffer_size() const noexcept {
+        return state_->size();
+    }
+
     //
     // index_buffer
     //
@@ -356,16 +545,33 @@ namespace e2d
     index_buffer::~index_buffer() noexcept = default;
 
     void index_buffer::update(const buffer& indices, std::size_t offset) noexcept {
+        update(indices.data(), indices.size(), offset);
+    }
+
+    void index_buffer::update(const void* indices, std::size_t size, std::size_t offset) noexcept {
         const std::size_t buffer_offset = offset * state_->decl().bytes_per_index();
-        E2D_ASSERT(indices.size() + buffer_offset <= state_->size());
-        E2D_ASSERT(indices.size() % state_->decl().bytes_per_index() == 0);
+        E2D_ASSERT(size + buffer_offset <= state_->size());
+        E2D_ASSERT(size % state_->decl().bytes_per_index() == 0);
         opengl::with_gl_bind_buffer(state_->dbg(), state_->id(),
-            [this, &indices, &buffer_offset]() noexcept {
+            [this, &indices, &size, &buffer_offset]() noexcept {
                 GL_CHECK_CODE(state_->dbg(), glBufferSubData(
                     state_->id().target(),
                     math::numeric_cast<GLintptr>(buffer_offset),
-                    math::numeric_cast<GLsizeiptr>(indices.size()),
-                    indices.data()));
+                    math::numeric_cast<GLsizeiptr>(size),
+                    indices));
+            });
+    }
+
+    void index_buffer::orphan() noexcept {
+        // the driver allocates new storage for the buffer, so next updates
+        // do not wait for draw calls that still read the old contents
+        opengl::with_gl_bind_buffer(state_->dbg(), state_->id(),
+            [this]() noexcept {
+                GL_CHECK_CODE(state_->dbg(), glBufferData(
+                    state_->id().target(),
+                    math::numeric_cast<GLsizeiptr>(state_->size()),
+                    nullptr,
+                    state_->usage()));
             });
     }
 
@@ -397,16 +603,33 @@ namespace e2d
     vertex_buffer::~vertex_buffer() noexcept = default;
 
     void vertex_buffer::update(const buffer& vertices, std::size_t offset) noexcept {
+        update(vertices.data(), vertices.size(), offset);
+    }
+
+    void vertex_buffer::update(const void* vertices, std::size_t size, std::size_t offset) noexcept {
         const std::size_t buffer_offset = offset * state_->decl().bytes_per_vertex();
-        E2D_ASSERT(vertices.size() + buffer_offset <= state_->size());
-        E2D_ASSERT(vertices.size() % state_->decl().bytes_per_vertex() == 0);
+        E2D_ASSERT(size + buffer_offset <= state_->size());
+        E2D_ASSERT(size % state_->decl().bytes_per_vertex() == 0);
         opengl::with_gl_bind_buffer(state_->dbg(), state_->id(),
-            [this, &vertices, &buffer_offset]() noexcept {
+            [this, &vertices, &size, &buffer_offset]() noexcept {
                 GL_CHECK_CODE(state_->dbg(), glBufferSubData(
                     state_->id().target(),
                     math::numeric_cast<GLintptr>(buffer_offset),
-                    math::numeric_cast<GLsizeiptr>(vertices.size()),
-                    vertices.data()));
+                    math::numeric_cast<GLsizeiptr>(size),
+                    vertices));
+            });
+    }
+
+    void vertex_buffer::orphan() noexcept {
+        // the driver allocates new storage for the buffer, so next updates
+        // do not wait for draw calls that still read the old contents
+        opengl::with_gl_bind_buffer(state_->dbg(), state_->id(),
+            [this]() noexcept {
+                GL_CHECK_CODE(state_->dbg(), glBufferData(
+                    state_->id().target(),
+                    math::numeric_cast<GLsizeiptr>(state_->size()),
+                    nullptr,
+                    state_->usage()));
             });
     }
 
@@ -550,33 +773,20 @@ namespace e2d
         }
 
         with_gl_bind_texture(state_->dbg(), id, [this, &id, &image, &decl]() noexcept {
-            if ( decl.is_compressed() ) {
-                GL_CHECK_CODE(state_->dbg(), glCompressedTexImage2D(
-                    id.target(),
-                    0,
-                    convert_pixel_type_to_internal_format_e(decl.type()),
-                    math::numeric_cast<GLsizei>(image.size().x),
-                    math::numeric_cast<GLsizei>(image.size().y),
-                    0,
-                    math::numeric_cast<GLsizei>(image.data().size()),
-                    image.data().data()));
-            } else {
-                GL_CHECK_CODE(state_->dbg(), glTexImage2D(
-                    id.target(),
-                    0,
-                    convert_pixel_type_to_internal_format(decl.type()),
-                    math::numeric_cast<GLsizei>(image.size().x),
-                    math::numeric_cast<GLsizei>(image.size().y),
-                    0,
+            for ( u32 level = 0; level < image.mipmap_count(); ++level ) {
+                const buffer_view level_data = image.mipmap_data(level);
+                load_texture_level(
+                    state_->dbg(), id, decl,
                     convert_image_data_format_to_external_format(image.format()),
                     convert_image_data_format_to_external_data_type(image.format()),
-                    image.data().data()));
+                    level, image.mipmap_size(level),
+                    level_data.data(), level_data.size());
             }
         #if E2D_RENDER_MODE == E2D_RENDER_MODE_OPENGL
             GL_CHECK_CODE(state_->dbg(), glTexParameteri(
                 id.target(),
                 GL_TEXTURE_MAX_LEVEL,
-                0));
+                math::numeric_cast<GLint>(image.mipmap_count() - 1u)));
             GL_CHECK_CODE(state_->dbg(), glTexParameteri(
                 id.target(),
                 GL_TEXTURE_BASE_LEVEL,
@@ -586,7 +796,10 @@ namespace e2d
 
         return std::make_shared<texture>(
             std::make_unique<texture::internal_state>(
-                state_->dbg(), std::move(id), image.size(), decl));
+                state_->dbg(), std::move(id), image.size(), decl,
+                convert_image_data_format_to_external_format(image.format()),
+                convert_image_data_format_to_external_data_type(image.format()),
+                image.mipmap_count()));
     }
 
     texture_ptr render::create_texture(
@@ -685,7 +898,117 @@ namespace e2d
 
         return std::make_shared<texture>(
             std::make_unique<texture::internal_state>(
-                state_->dbg(), std::move(id), size, decl));
+                state_->dbg(), std::move(id), size, decl,
+                convert_pixel_type_to_external_format(decl.type()),
+                convert_pixel_type_to_external_data_type(decl.type())));
+    }
+
+    texture_ptr render::create_streaming_texture(
+        const v2u& size,
+        image_data_format format,
+        u32 mipmap_count)
+    {
+        E2D_ASSERT(is_in_main_thread());
+
+        const pixel_declaration decl =
+            convert_image_data_format_to_pixel_declaration(format);
+
+        if ( !is_pixel_supported(decl) ) {
+            state_->dbg().error("RENDER: Failed to create streaming texture:\n"
+                "--> Info: unsupported pixel declaration\n"
+                "--> Pixel type: %0",
+                pixel_declaration::pixel_type_to_cstr(decl.type()));
+            return nullptr;
+        }
+
+        if ( math::maximum(size) > device_capabilities().max_texture_size ) {
+            state_->dbg().error("RENDER: Failed to create streaming texture:\n"
+                "--> Info: unsupported texture size: %0\n"
+                "--> Max size: %1",
+                size, device_capabilities().max_texture_size);
+            return nullptr;
+        }
+
+        if ( !mipmap_count || mipmap_count > images::max_mipmap_count(size) ) {
+            state_->dbg().error("RENDER: Failed to create streaming texture:\n"
+                "--> Info: unsupported mipmap count: %0\n"
+                "--> Size: %1",
+                mipmap_count, size);
+            return nullptr;
+        }
+
+        if ( !device_capabilities().npot_texture_supported ) {
+            if ( !math::is_power_of_2(size.x) || !math::is_power_of_2(size.y) ) {
+                state_->dbg().error("RENDER: Failed to create streaming texture:\n"
+                    "--> Info: non power of two texture is unsupported\n"
+                    "--> Size: %0",
+                    size);
+            }
+        }
+
+        gl_texture_id id = gl_texture_id::create(state_->dbg(), GL_TEXTURE_2D);
+        if ( id.empty() ) {
+            state_->dbg().error("RENDER: Failed to create streaming texture:\n"
+                "--> Info: failed to create texture id");
+            return nullptr;
+        }
+
+        // levels are not allocated here, the texture stays incomplete
+        // until its smallest level is loaded by texture::load_mipmap
+    #if E2D_RENDER_MODE == E2D_RENDER_MODE_OPENGL
+        with_gl_bind_texture(state_->dbg(), id, [this, &id, mipmap_count]() noexcept {
+            GL_CHECK_CODE(state_->dbg(), glTexParameteri(
+                id.target(),
+                GL_TEXTURE_MAX_LEVEL,
+                math::numeric_cast<GLint>(mipmap_count - 1u)));
+            GL_CHECK_CODE(state_->dbg(), glTexParameteri(
+                id.target(),
+                GL_TEXTURE_BASE_LEVEL,
+                math::numeric_cast<GLint>(mipmap_count - 1u)));
+        });
+    #endif
+
+        return std::make_shared<texture>(
+            std::make_unique<texture::internal_state>(
+                state_->dbg(), std::move(id), size, decl,
+                convert_image_data_format_to_external_format(format),
+                convert_image_data_format_to_external_data_type(format),
+                mipmap_count, mipmap_count - 1u));
+    }
+
+    pixel_buffer_ptr render::create_pixel_buffer(
+        std::size_t size)
+    {
+        E2D_ASSERT(is_in_main_thread());
+
+        if ( !device_capabilities().pixel_buffer_supported ) {
+            return std::make_shared<pixel_buffer>(
+                std::make_unique<pixel_buffer::internal_state>(
+                    state_->dbg(), buffer(size)));
+        }
+
+    #if E2D_RENDER_MODE == E2D_RENDER_MODE_OPENGL
+        gl_buffer_id id = gl_buffer_id::create(state_->dbg(), GL_PIXEL_UNPACK_BUFFER);
+        if ( id.empty() ) {
+            state_->dbg().error("RENDER: Failed to create pixel buffer:\n"
+                "--> Info: failed to create pixel buffer id");
+            return nullptr;
+        }
+
+        with_gl_bind_buffer(state_->dbg(), id, [this, &id, size]() noexcept {
+            GL_CHECK_CODE(state_->dbg(), glBufferData(
+                id.target(),
+                math::numeric_cast<GLsizeiptr>(size),
+                nullptr,
+                GL_STREAM_DRAW));
+        });
+
+        return std::make_shared<pixel_buffer>(
+            std::make_unique<pixel_buffer::internal_state>(
+                state_->dbg(), std::move(id), size));
+    #else
+        return nullptr;
+    #endif
     }
 
     index_buffer_ptr render::create_index_buffer(
@@ -704,24 +1027,26 @@ namespace e2d
             return nullptr;
         }
 
-        gl_buffer_id id = gl_buffer_id::create(state_->dbg(), GL_ELEMENT_ARRAY_BUFFER);
-        if ( id.empty() ) {
+        return create_gl_index_buffer(state_->dbg(), indices.data(), indices.size(), decl, usage);
+    }
+
+    index_buffer_ptr render::create_index_buffer(
+        std::size_t size,
+        const index_declaration& decl,
+        index_buffer::usage usage)
+    {
+        E2D_ASSERT(is_in_main_thread());
+        E2D_ASSERT(size % decl.bytes_per_index() == 0);
+
+        if ( !is_index_supported(decl) ) {
             state_->dbg().error("RENDER: Failed to create index buffer:\n"
-                "--> Info: failed to create index buffer id");
+                "--> Info: unsupported index declaration\n"
+                "--> Index type: %0",
+                index_declaration::index_type_to_cstr(decl.type()));
             return nullptr;
         }
 
-        with_gl_bind_buffer(state_->dbg(), id, [this, &id, &indices, &usage]() {
-            GL_CHECK_CODE(state_->dbg(), glBufferData(
-                id.target(),
-                math::numeric_cast<GLsizeiptr>(indices.size()),
-                indices.data(),
-                convert_buffer_usage(usage)));
-        });
-
-        return std::make_shared<index_buffer>(
-            std::make_unique<index_buffer::internal_state>(
-                state_->dbg(), std::move(id), indices.size(), decl));
+        return create_gl_index_buffer(state_->dbg(), nullptr, size, decl, usage);
     }
 
     vertex_buffer_ptr render::create_vertex_buffer(
@@ -738,24 +1063,24 @@ namespace e2d
             return nullptr;
         }
 
-        gl_buffer_id id = gl_buffer_id::create(state_->dbg(), GL_ARRAY_BUFFER);
-        if ( id.empty() ) {
+        return create_gl_vertex_buffer(state_->dbg(), vertices.data(), vertices.size(), decl, usage);
+    }
+
+    vertex_buffer_ptr render::create_vertex_buffer(
+        std::size_t size,
+        const vertex_declaration& decl,
+        vertex_buffer::usage usage)
+    {
+        E2D_ASSERT(is_in_main_thread());
+        E2D_ASSERT(size % decl.bytes_per_vertex() == 0);
+
+        if ( !is_vertex_supported(decl) ) {
             state_->dbg().error("RENDER: Failed to create vertex buffer:\n"
-                "--> Info: failed to create vertex buffer id");
+                "--> Info: unsupported vertex declaration");
             return nullptr;
         }
 
-        with_gl_bind_buffer(state_->dbg(), id, [this, &id, &vertices, &usage]() {
-            GL_CHECK_CODE(state_->dbg(), glBufferData(
-                id.target(),
-                math::numeric_cast<GLsizeiptr>(vertices.size()),
-                vertices.data(),
-                convert_buffer_usage(usage)));
-        });
-
-        return std::make_shared<vertex_buffer>(
-            std::make_unique<vertex_buffer::internal_state>(
-                state_->dbg(), std::move(id), vertices.size(), decl));
+        return create_gl_vertex_buffer(state_->dbg(), nullptr, size, decl, usage);
     }
 
     render_target_ptr render::create_render_target(
@@ -902,16 +1227,29 @@ namespace e2d
                     .merge(props);
                 state_->set_states(pass.states());
                 state_->set_shader_program(pass.shader());
-                with_material_shader(state_->dbg(), pass.shader(), main_props, [this, &command, &pass, &geo]() noexcept {
-                    with_geometry_vertices(state_->dbg(), pass.shader(), command.geometry_ref(), [this, &command, &geo]() noexcept {
+                const bool bound = bind_property_block(
+                    state_->dbg(), state_->statistics(), pass.shader(), main_props,
+                    state_->texture_unit_count(),
+                    [this](std::size_t unit, const sampler_state& sampler) noexcept {
+                        state_->set_texture(unit, sampler);
+                    });
+                if ( !bound ) {
+                    throw bad_render_operation();
+                }
+                with_geometry_vertices(state_->dbg(), pass.shader(), geo,
+                    [this](const vertex_buffer_ptr& vb) noexcept {
+                        state_->set_vertex_buffer(vb);
+                    },
+                    [this, &command, &geo]() noexcept {
+                        state_->set_index_buffer(geo.indices());
                         draw_indexed_primitive(
                             state_->dbg(),
                             geo.topo(),
                             geo.indices(),
                             command.first_index(),
                             command.index_count());
+                        ++state_->statistics().draw_calls;
                     });
-                });
             } catch (...) {
                 main_property_cache().clear();
                 throw;
@@ -1001,6 +1339,17 @@ namespace e2d
         return *this;
     }
 
+    render& render::frame_tick() noexcept {
+        E2D_ASSERT(is_in_main_thread());
+        state_->frame_tick();
+        return *this;
+    }
+
+    const render::frame_statistics& render::last_frame_statistics() const noexcept {
+        E2D_ASSERT(is_in_main_thread());
+        return state_->last_statistics();
+    }
+
     const render::device_caps& render::device_capabilities() const noexcept {
         E2D_ASSERT(is_in_main_thread());
         return state_->device_capabilities();
@@ -112,9 +112,16 @@ namespace e2d { namespace opengl
     }
 
     gl_buffer_id gl_buffer_id::create(debug& debug, GLenum target) noexcept {
+    #if E2D_RENDER_MODE == E2D_RENDER_MODE_OPENGL
+        const bool pixel_buffer_target = target == GL_PIXEL_UNPACK_BUFFER;
+    #else
+        const bool pixel_buffer_target = false;
+    #endif
         E2D_ASSERT(
             target == GL_ARRAY_BUFFER ||
-            target == GL_ELEMENT_ARRAY_BUFFER);
+            target == GL_ELEMENT_ARRAY_BUFFER ||
+            pixel_buffer_target);
+        E2D_UNUSED(pixel_buffer_target);
         GLuint id = 0;
         GL_CHECK_CODE(debug, glGenBuffers(1, &id));
         if ( !id ) {
@@ -1166,6 +1173,9 @@ namespace e2d { namespace opengl
         switch ( t ) {
             DEFINE_CASE(GL_ARRAY_BUFFER, GL_ARRAY_BUFFER_BINDING);
             DEFINE_CASE(GL_ELEMENT_ARRAY_BUFFER, GL_ELEMENT_ARRAY_BUFFER_BINDING);
+        #if E2D_RENDER_MODE == E2D_RENDER_MODE_OPENGL
+            DEFINE_CASE(GL_PIXEL_UNPACK_BUFFER, GL_PIXEL_UNPACK_BUFFER_BINDING);
+        #endif
             DEFINE_CASE(GL_TEXTURE_2D, GL_TEXTURE_BINDING_2D);
             DEFINE_CASE(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_BINDING_CUBE_MAP);
             DEFINE_CASE(GL_FRAMEBUFFER, GL_FRAMEBUFFER_BINDING);
@@ -1310,6 +1320,30 @@ namespace e2d { namespace opengl
             GLEW_OES_framebuffer_object ||
             GLEW_ARB_framebuffer_object ||
             GLEW_EXT_framebuffer_object;
+
+        // texture uploads from pixel buffers and partial mipmap chains
+        // are not available in OpenGL ES 2.0 without extensions
+    #if E2D_RENDER_MODE == E2D_RENDER_MODE_OPENGLES
+        caps.pixel_buffer_supported = false;
+        caps.texture_base_level_supported = false;
+    #elif E2D_RENDER_MODE == E2D_RENDER_MODE_OPENGL
+        caps.pixel_buffer_supported =
+            GLEW_VERSION_2_1 ||
+            GLEW_ARB_pixel_buffer_object;
+        caps.texture_base_level_supported = true;
+    #else
+    #   error unknown render mode
+    #endif
+
+        // mobile drivers tend to handle buffer orphaning poorly,
+        // so rotate over several buffers there instead
+    #if E2D_RENDER_MODE == E2D_RENDER_MODE_OPENGLES
+        caps.buffer_streaming_strategy = render::buffer_streaming::triple_buffering;
+    #elif E2D_RENDER_MODE == E2D_RENDER_MODE_OPENGL
+        caps.buffer_streaming_strategy = render::buffer_streaming::orphaning;
+    #else
+    #   error unknown render mode
+    #endif
     }
 
     gl_shader_id gl_compile_shader(debug& debug, const str& source, GLenum type) noexcept {
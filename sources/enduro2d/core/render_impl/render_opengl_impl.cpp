@@ -51,6 +51,19 @@ namespace e2d
         return id_;
     }
 
+    bool shader::internal_state::is_same_uniform_value(
+        const render::property_value& l,
+        const render::property_value& r) noexcept
+    {
+        // uniform values are compared bitwise, the approximate
+        // comparison of math types would hide small changes
+        return stdex::visit([&r](const auto& lv) noexcept {
+            using value_type = std::decay_t<decltype(lv)>;
+            const value_type* rv = stdex::get_if<value_type>(&r);
+            return rv && 0 == std::memcmp(&lv, rv, sizeof(value_type));
+        }, l);
+    }
+
     //
     // texture::internal_state
     //
@@ -59,12 +72,21 @@ namespace e2d
         debug& debug,
         gl_texture_id id,
         const v2u& size,
-        const pixel_declaration& decl)
+        const pixel_declaration& decl,
+        GLenum external_format,
+        GLenum external_data_type,
+        u32 mipmap_count,
+        u32 base_level)
     : debug_(debug)
     , id_(std::move(id))
     , size_(size)
-    , decl_(decl){
+    , decl_(decl)
+    , external_format_(external_format)
+    , external_data_type_(external_data_type)
+    , mipmap_count_(mipmap_count)
+    , base_level_(base_level) {
         E2D_ASSERT(!id_.empty());
+        E2D_ASSERT(mipmap_count_ > 0 && base_level_ < mipmap_count_);
     }
 
     debug& texture::internal_state::dbg() const noexcept {
@@ -83,6 +105,81 @@ namespace e2d
         return decl_;
     }
 
+    GLenum texture::internal_state::external_format() const noexcept {
+        return external_format_;
+    }
+
+    GLenum texture::internal_state::external_data_type() const noexcept {
+        return external_data_type_;
+    }
+
+    u32 texture::internal_state::mipmap_count() const noexcept {
+        return mipmap_count_;
+    }
+
+    u32 texture::internal_state::base_level() const noexcept {
+        return base_level_;
+    }
+
+    void texture::internal_state::base_level(u32 level) noexcept {
+        E2D_ASSERT(level < mipmap_count_);
+        base_level_ = level;
+    }
+
+    texture::internal_state::sampler_params& texture::internal_state::applied_sampler() const noexcept {
+        return applied_sampler_;
+    }
+
+    //
+    // pixel_buffer::internal_state
+    //
+
+    pixel_buffer::internal_state::internal_state(
+        debug& debug,
+        gl_buffer_id id,
+        std::size_t size)
+    : debug_(debug)
+    , id_(std::move(id))
+    , size_(size) {
+        E2D_ASSERT(!id_.empty());
+    }
+
+    pixel_buffer::internal_state::internal_state(
+        debug& debug,
+        buffer&& client_data)
+    : debug_(debug)
+    , id_(debug)
+    , size_(client_data.size())
+    , client_data_(std::move(client_data)) {}
+
+    debug& pixel_buffer::internal_state::dbg() const noexcept {
+        return debug_;
+    }
+
+    const gl_buffer_id& pixel_buffer::internal_state::id() const noexcept {
+        return id_;
+    }
+
+    std::size_t pixel_buffer::internal_state::size() const noexcept {
+        return size_;
+    }
+
+    u8* pixel_buffer::internal_state::client_data() noexcept {
+        return client_data_.data();
+    }
+
+    const u8* pixel_buffer::internal_state::client_data() const noexcept {
+        return client_data_.data();
+    }
+
+    u8* pixel_buffer::internal_state::mapped_data() const noexcept {
+        return mapped_data_;
+    }
+
+    void pixel_buffer::internal_state::mapped_data(u8* data) noexcept {
+        mapped_data_ = data;
+    }
+
     //
     // index_buffer::internal_state
     //
@@ -91,11 +188,13 @@ namespace e2d
         debug& debug,
         gl_buffer_id id,
         std::size_t size,
-        const index_declaration& decl)
+        const index_declaration& decl,
+        GLenum usage)
     : debug_(debug)
     , id_(std::move(id))
     , size_(size)
-    , decl_(decl) {
+    , decl_(decl)
+    , usage_(usage) {
         E2D_ASSERT(!id_.empty());
     }
 
@@ -115,6 +214,10 @@ namespace e2d
         return decl_;
     }
 
+    GLenum index_buffer::internal_state::usage() const noexcept {
+        return usage_;
+    }
+
     //
     // vertex_buffer::internal_state
     //
@@ -123,11 +226,13 @@ namespace e2d
         debug& debug,
         gl_buffer_id id,
         std::size_t size,
-        const vertex_declaration& decl)
+        const vertex_declaration& decl,
+        GLenum usage)
     : debug_(debug)
     , id_(std::move(id))
     , size_(size)
-    , decl_(decl) {
+    , decl_(decl)
+    , usage_(usage) {
         E2D_ASSERT(!id_.empty());
     }
 
@@ -147,6 +252,10 @@ namespace e2d
         return decl_;
     }
 
+    GLenum vertex_buffer::internal_state::usage() const noexcept {
+        return usage_;
+    }
+
     //
     // render_target::internal_state
     //
@@ -217,9 +326,15 @@ namespace e2d
         GL_CHECK_CODE(debug_, glPixelStorei(GL_PACK_ALIGNMENT, 1));
         GL_CHECK_CODE(debug_, glPixelStorei(GL_UNPACK_ALIGNMENT, 1));
 
-        set_states(state_block_);
-        set_shader_program(shader_program_);
-        set_render_target(render_target_);
+        texture_units_.resize(math::max(
+            device_caps_.max_combined_texture_image_units, 1u));
+        GL_CHECK_CODE(debug_, glActiveTexture(GL_TEXTURE0));
+
+        apply_depth_state(state_block_.depth());
+        apply_stencil_state(state_block_.stencil());
+        apply_culling_state(state_block_.culling());
+        apply_blending_state(state_block_.blending());
+        apply_capabilities_state(state_block_.capabilities());
     }
 
     debug& render::internal_state::dbg() const noexcept {
@@ -238,6 +353,24 @@ namespace e2d
         return render_target_;
     }
 
+    std::size_t render::internal_state::texture_unit_count() const noexcept {
+        return texture_units_.size();
+    }
+
+    render::frame_statistics& render::internal_state::statistics() noexcept {
+        return statistics_;
+    }
+
+    const render::frame_statistics& render::internal_state::last_statistics() const noexcept {
+        return last_statistics_;
+    }
+
+    render::internal_state& render::internal_state::frame_tick() noexcept {
+        last_statistics_ = statistics_;
+        statistics_ = frame_statistics();
+        return *this;
+    }
+
     render::internal_state& render::internal_state::set_states(const state_block& sb) noexcept {
         set_depth_state(sb.depth());
         set_stencil_state(sb.stencil());
@@ -249,9 +382,143 @@ namespace e2d
 
     render::internal_state& render::internal_state::set_depth_state(const depth_state& ds) noexcept {
         if ( ds == state_block_.depth() ) {
+            ++statistics_.skipped_state_changes;
+            return *this;
+        }
+        apply_depth_state(ds);
+        ++statistics_.applied_state_changes;
+        return *this;
+    }
+
+    render::internal_state& render::internal_state::set_stencil_state(const stencil_state& ss) noexcept {
+        if ( ss == state_block_.stencil() ) {
+            ++statistics_.skipped_state_changes;
+            return *this;
+        }
+        apply_stencil_state(ss);
+        ++statistics_.applied_state_changes;
+        return *this;
+    }
+
+    render::internal_state& render::internal_state::set_culling_state(const culling_state& cs) noexcept {
+        if ( cs == state_block_.culling() ) {
+            ++statistics_.skipped_state_changes;
+            return *this;
+        }
+        apply_culling_state(cs);
+        ++statistics_.applied_state_changes;
+        return *this;
+    }
+
+    render::internal_state& render::internal_state::set_blending_state(const blending_state& bs) noexcept {
+        if ( bs == state_block_.blending() ) {
+            ++statistics_.skipped_state_changes;
+            return *this;
+        }
+        apply_blending_state(bs);
+        ++statistics_.applied_state_changes;
+        return *this;
+    }
+
+    render::internal_state& render::internal_state::set_capabilities_state(const capabilities_state& cs) noexcept {
+        if ( cs == state_block_.capabilities() ) {
+            ++statistics_.skipped_state_changes;
+            return *this;
+        }
+        apply_capabilities_state(cs);
+        ++statistics_.applied_state_changes;
+        return *this;
+    }
+
+    render::internal_state& render::internal_state::set_shader_program(const shader_ptr& sp) noexcept {
+        if ( sp == shader_program_ ) {
+            ++statistics_.skipped_state_changes;
+            return *this;
+        }
+
+        const gl_program_id& sp_id = sp
+            ? sp->state().id()
+            : default_sp_;
+        GL_CHECK_CODE(debug_, glUseProgram(*sp_id));
+
+        shader_program_ = sp;
+        ++statistics_.applied_state_changes;
+        return *this;
+    }
+
+    render::internal_state& render::internal_state::set_render_target(const render_target_ptr& rt) noexcept {
+        if ( rt == render_target_ ) {
+            ++statistics_.skipped_state_changes;
             return *this;
         }
 
+        const gl_framebuffer_id& rt_id = rt
+            ? rt->state().id()
+            : default_fb_;
+        GL_CHECK_CODE(debug_, glBindFramebuffer(rt_id.target(), *rt_id));
+
+        render_target_ = rt;
+        ++statistics_.applied_state_changes;
+        return *this;
+    }
+
+    render::internal_state& render::internal_state::set_texture(std::size_t unit, const sampler_state& ss) noexcept {
+        E2D_ASSERT(unit < texture_units_.size());
+        const texture_ptr bound = texture_units_[unit].lock();
+
+        if ( ss.texture() == bound ) {
+            ++statistics_.skipped_texture_binds;
+        } else {
+            activate_texture_unit(unit);
+            if ( ss.texture() ) {
+                const gl_texture_id& texture_id = ss.texture()->state().id();
+                GL_CHECK_CODE(debug_, glBindTexture(
+                    texture_id.target(), *texture_id));
+            } else {
+                GL_CHECK_CODE(debug_, glBindTexture(
+                    bound->state().id().target(), 0));
+            }
+            texture_units_[unit] = ss.texture();
+            ++statistics_.applied_texture_binds;
+        }
+
+        if ( ss.texture() ) {
+            apply_texture_sampler(unit, ss.texture(), ss);
+        }
+        return *this;
+    }
+
+    render::internal_state& render::internal_state::set_index_buffer(const index_buffer_ptr& ib) noexcept {
+        if ( ib == index_buffer_.lock() ) {
+            ++statistics_.skipped_buffer_binds;
+            return *this;
+        }
+
+        GL_CHECK_CODE(debug_, glBindBuffer(
+            GL_ELEMENT_ARRAY_BUFFER,
+            ib ? *ib->state().id() : 0));
+
+        index_buffer_ = ib;
+        ++statistics_.applied_buffer_binds;
+        return *this;
+    }
+
+    render::internal_state& render::internal_state::set_vertex_buffer(const vertex_buffer_ptr& vb) noexcept {
+        if ( vb == vertex_buffer_.lock() ) {
+            ++statistics_.skipped_buffer_binds;
+            return *this;
+        }
+
+        GL_CHECK_CODE(debug_, glBindBuffer(
+            GL_ARRAY_BUFFER,
+            vb ? *vb->state().id() : 0));
+
+        vertex_buffer_ = vb;
+        ++statistics_.applied_buffer_binds;
+        return *this;
+    }
+
+    void render::internal_state::apply_depth_state(const depth_state& ds) noexcept {
         GL_CHECK_CODE(debug_, glDepthRange(
             math::numeric_cast<GLclampd>(math::saturate(ds.range_near())),
             math::numeric_cast<GLclampd>(math::saturate(ds.range_far()))));
@@ -259,16 +526,10 @@ namespace e2d
             ds.write() ? GL_TRUE : GL_FALSE));
         GL_CHECK_CODE(debug_, glDepthFunc(
             convert_compare_func(ds.func())));
-
         state_block_.depth(ds);
-        return *this;
     }
 
-    render::internal_state& render::internal_state::set_stencil_state(const stencil_state& ss) noexcept {
-        if ( ss == state_block_.stencil() ) {
-            return *this;
-        }
-
+    void render::internal_state::apply_stencil_state(const stencil_state& ss) noexcept {
         GL_CHECK_CODE(debug_, glStencilMask(
             math::numeric_cast<GLuint>(ss.write())));
         GL_CHECK_CODE(debug_, glStencilFunc(
@@ -279,30 +540,18 @@ namespace e2d
             convert_stencil_op(ss.sfail()),
             convert_stencil_op(ss.zfail()),
             convert_stencil_op(ss.pass())));
-
         state_block_.stencil(ss);
-        return *this;
     }
 
-    render::internal_state& render::internal_state::set_culling_state(const culling_state& cs) noexcept {
-        if ( cs == state_block_.culling() ) {
-            return *this;
-        }
-
+    void render::internal_state::apply_culling_state(const culling_state& cs) noexcept {
         GL_CHECK_CODE(debug_, glFrontFace(
             convert_culling_mode(cs.mode())));
         GL_CHECK_CODE(debug_, glCullFace(
             convert_culling_face(cs.face())));
-
         state_block_.culling(cs);
-        return *this;
     }
 
-    render::internal_state& render::internal_state::set_blending_state(const blending_state& bs) noexcept {
-        if ( bs == state_block_.blending() ) {
-            return *this;
-        }
-
+    void render::internal_state::apply_blending_state(const blending_state& bs) noexcept {
         GL_CHECK_CODE(debug_, glBlendColor(
             math::numeric_cast<GLclampf>(math::saturate(bs.constant_color().r)),
             math::numeric_cast<GLclampf>(math::saturate(bs.constant_color().g)),
@@ -321,12 +570,10 @@ namespace e2d
             (math::enum_to_number(bs.color_mask()) & math::enum_to_number(blending_color_mask::g)) != 0,
             (math::enum_to_number(bs.color_mask()) & math::enum_to_number(blending_color_mask::b)) != 0,
             (math::enum_to_number(bs.color_mask()) & math::enum_to_number(blending_color_mask::a)) != 0));
-
         state_block_.blending(bs);
-        return *this;
     }
 
-    render::internal_state& render::internal_state::set_capabilities_state(const capabilities_state& cs) noexcept {
+    void render::internal_state::apply_capabilities_state(const capabilities_state& cs) noexcept {
         const auto enable_or_disable = [](GLenum cap, bool enable) noexcept {
             if ( enable ) {
                 glEnable(cap);
@@ -335,45 +582,63 @@ namespace e2d
             }
         };
 
-        if ( cs == state_block_.capabilities() ) {
-            return *this;
-        }
-
         GL_CHECK_CODE(debug_, enable_or_disable(GL_CULL_FACE, cs.culling()));
         GL_CHECK_CODE(debug_, enable_or_disable(GL_BLEND, cs.blending()));
         GL_CHECK_CODE(debug_, enable_or_disable(GL_DEPTH_TEST, cs.depth_test()));
         GL_CHECK_CODE(debug_, enable_or_disable(GL_STENCIL_TEST, cs.stencil_test()));
-
         state_block_.capabilities(cs);
-        return *this;
     }
 
-    render::internal_state& render::internal_state::set_shader_program(const shader_ptr& sp) noexcept {
-        if ( sp == shader_program_ ) {
-            return *this;
+    void render::internal_state::apply_texture_sampler(
+        std::size_t unit,
+        const texture_ptr& tex,
+        const sampler_state& ss) noexcept
+    {
+        // sampler parameters are stored in the texture object itself,
+        // so they are tracked per texture instead of per texture unit
+        texture::internal_state::sampler_params& applied = tex->state().applied_sampler();
+
+        texture::internal_state::sampler_params params;
+        params.s_wrap = convert_sampler_wrap(ss.s_wrap());
+        params.t_wrap = convert_sampler_wrap(ss.t_wrap());
+        params.r_wrap = convert_sampler_wrap(ss.r_wrap());
+        params.min_filter = convert_sampler_filter(ss.min_filter());
+        params.mag_filter = convert_sampler_filter(ss.mag_filter());
+
+        if ( params.s_wrap == applied.s_wrap
+            && params.t_wrap == applied.t_wrap
+            && params.r_wrap == applied.r_wrap
+            && params.min_filter == applied.min_filter
+            && params.mag_filter == applied.mag_filter )
+        {
+            ++statistics_.skipped_state_changes;
+            return;
         }
 
-        const gl_program_id& sp_id = sp
-            ? sp->state().id()
-            : default_sp_;
-        GL_CHECK_CODE(debug_, glUseProgram(*sp_id));
-
-        shader_program_ = sp;
-        return *this;
-    }
-
-    render::internal_state& render::internal_state::set_render_target(const render_target_ptr& rt) noexcept {
-        if ( rt == render_target_ ) {
-            return *this;
+        activate_texture_unit(unit);
+        const gl_texture_id& texture_id = tex->state().id();
+        GL_CHECK_CODE(debug_, glTexParameteri(
+            texture_id.target(), GL_TEXTURE_WRAP_S, params.s_wrap));
+        GL_CHECK_CODE(debug_, glTexParameteri(
+            texture_id.target(), GL_TEXTURE_WRAP_T, params.t_wrap));
+        GL_CHECK_CODE(debug_, glTexParameteri(
+            texture_id.target(), GL_TEXTURE_WRAP_R, params.r_wrap));
+        GL_CHECK_CODE(debug_, glTexParameteri(
+            texture_id.target(), GL_TEXTURE_MIN_FILTER, params.min_filter));
+        GL_CHECK_CODE(debug_, glTexParameteri(
+            texture_id.target(), GL_TEXTURE_MAG_FILTER, params.mag_filter));
+
+        applied = params;
+        ++statistics_.applied_state_changes;
+    }
+
+    void render::internal_state::activate_texture_unit(std::size_t unit) noexcept {
+        if ( unit == active_texture_unit_ ) {
+            return;
         }
-
-        const gl_framebuffer_id& rt_id = rt
-            ? rt->state().id()
-            : default_fb_;
-        GL_CHECK_CODE(debug_, glBindFramebuffer(rt_id.target(), *rt_id));
-
-        render_target_ = rt;
-        return *this;
+        GL_CHECK_CODE(debug_, glActiveTexture(
+            math::numeric_cast<GLenum>(GL_TEXTURE0 + unit)));
+        active_texture_unit_ = unit;
     }
 }
 
@@ -31,11 +31,25 @@ namespace e2d
         template < typename F >
         void with_uniform_location(str_hash name, F&& f) const;
         template < typename F >
+        void with_uniform_value(str_hash name, const render::property_value& value, F&& f) const;
+        template < typename F >
         void with_attribute_location(str_hash name, F&& f) const;
+    private:
+        struct uniform_state {
+            opengl::uniform_info info;
+            bool uploaded = false;
+            render::property_value value;
+        public:
+            uniform_state(const opengl::uniform_info& ninfo)
+            : info(ninfo) {}
+        };
+        static bool is_same_uniform_value(
+            const render::property_value& l,
+            const render::property_value& r) noexcept;
     private:
         debug& debug_;
         opengl::gl_program_id id_;
-        hash_map<str_hash, opengl::uniform_info> uniforms_;
+        mutable hash_map<str_hash, uniform_state> uniforms_;
         hash_map<str_hash, opengl::attribute_info> attributes_;
     };
 
@@ -43,7 +57,21 @@ namespace e2d
     void shader::internal_state::with_uniform_location(str_hash name, F&& f) const {
         const auto iter = uniforms_.find(name);
         if ( iter != uniforms_.end() ) {
-            stdex::invoke(std::forward<F>(f), iter->second);
+            stdex::invoke(std::forward<F>(f), iter->second.info);
+        }
+    }
+
+    template < typename F >
+    void shader::internal_state::with_uniform_value(str_hash name, const render::property_value& value, F&& f) const {
+        const auto iter = uniforms_.find(name);
+        if ( iter != uniforms_.end() ) {
+            uniform_state& us = iter->second;
+            const bool changed = !us.uploaded || !is_same_uniform_value(us.value, value);
+            if ( changed ) {
+                us.uploaded = true;
+                us.value = value;
+            }
+            stdex::invoke(std::forward<F>(f), us.info, changed);
         }
     }
 
@@ -60,23 +88,76 @@ namespace e2d
     //
 
     class texture::internal_state final : private e2d::noncopyable {
+    public:
+        struct sampler_params {
+            GLint s_wrap = 0;
+            GLint t_wrap = 0;
+            GLint r_wrap = 0;
+            GLint min_filter = 0;
+            GLint mag_filter = 0;
+        };
     public:
         internal_state(
             debug& debug,
             opengl::gl_texture_id id,
             const v2u& size,
-            const pixel_declaration& decl);
+            const pixel_declaration& decl,
+            GLenum external_format,
+            GLenum external_data_type,
+            u32 mipmap_count = 1,
+            u32 base_level = 0);
         ~internal_state() noexcept = default;
     public:
         debug& dbg() const noexcept;
         const opengl::gl_texture_id& id() const noexcept;
         const v2u& size() const noexcept;
         const pixel_declaration& decl() const noexcept;
+        GLenum external_format() const noexcept;
+        GLenum external_data_type() const noexcept;
+        u32 mipmap_count() const noexcept;
+        u32 base_level() const noexcept;
+        void base_level(u32 level) noexcept;
+        sampler_params& applied_sampler() const noexcept;
     private:
         debug& debug_;
         opengl::gl_texture_id id_;
         v2u size_;
         pixel_declaration decl_;
+        GLenum external_format_ = 0;
+        GLenum external_data_type_ = 0;
+        u32 mipmap_count_ = 1;
+        u32 base_level_ = 0;
+        mutable sampler_params applied_sampler_;
+    };
+
+    //
+    // pixel_buffer::internal_state
+    //
+
+    class pixel_buffer::internal_state final : private e2d::noncopyable {
+    public:
+        internal_state(
+            debug& debug,
+            opengl::gl_buffer_id id,
+            std::size_t size);
+        internal_state(
+            debug& debug,
+            buffer&& client_data);
+        ~internal_state() noexcept = default;
+    public:
+        debug& dbg() const noexcept;
+        const opengl::gl_buffer_id& id() const noexcept;
+        std::size_t size() const noexcept;
+        u8* client_data() noexcept;
+        const u8* client_data() const noexcept;
+        u8* mapped_data() const noexcept;
+        void mapped_data(u8* data) noexcept;
+    private:
+        debug& debug_;
+        opengl::gl_buffer_id id_;
+        std::size_t size_ = 0;
+        buffer client_data_;
+        u8* mapped_data_ = nullptr;
     };
 
     //
@@ -89,18 +170,21 @@ namespace e2d
             debug& debug,
             opengl::gl_buffer_id id,
             std::size_t size,
-            const index_declaration& decl);
+            const index_declaration& decl,
+            GLenum usage);
         ~internal_state() noexcept = default;
     public:
         debug& dbg() const noexcept;
         const opengl::gl_buffer_id& id() const noexcept;
         std::size_t size() const noexcept;
         const index_declaration& decl() const noexcept;
+        GLenum usage() const noexcept;
     private:
         debug& debug_;
         opengl::gl_buffer_id id_;
         std::size_t size_ = 0;
         index_declaration decl_;
+        GLenum usage_ = GL_STATIC_DRAW;
     };
 
     //
@@ -113,18 +197,21 @@ namespace e2d
             debug& debug,
             opengl::gl_buffer_id id,
             std::size_t size,
-            const vertex_declaration& decl);
+            const vertex_declaration& decl,
+            GLenum usage);
         ~internal_state() noexcept = default;
     public:
         debug& dbg() const noexcept;
         const opengl::gl_buffer_id& id() const noexcept;
         std::size_t size() const noexcept;
         const vertex_declaration& decl() const noexcept;
+        GLenum usage() const noexcept;
     private:
         debug& debug_;
         opengl::gl_buffer_id id_;
         std::size_t size_ = 0;
         vertex_declaration decl_;
+        GLenum usage_ = GL_STATIC_DRAW;
     };
 
     //
@@ -175,6 +262,11 @@ namespace e2d
         window& wnd() const noexcept;
         const device_caps& device_capabilities() const noexcept;
         const render_target_ptr& render_target() const noexcept;
+        std::size_t texture_unit_count() const noexcept;
+
+        frame_statistics& statistics() noexcept;
+        const frame_statistics& last_statistics() const noexcept;
+        internal_state& frame_tick() noexcept;
     public:
         internal_state& set_states(const state_block& sb) noexcept;
         internal_state& set_depth_state(const depth_state& ds) noexcept;
@@ -185,6 +277,18 @@ namespace e2d
 
         internal_state& set_shader_program(const shader_ptr& sp) noexcept;
         internal_state& set_render_target(const render_target_ptr& rt) noexcept;
+
+        internal_state& set_texture(std::size_t unit, const sampler_state& ss) noexcept;
+        internal_state& set_index_buffer(const index_buffer_ptr& ib) noexcept;
+        internal_state& set_vertex_buffer(const vertex_buffer_ptr& vb) noexcept;
+    private:
+        void apply_depth_state(const depth_state& ds) noexcept;
+        void apply_stencil_state(const stencil_state& ss) noexcept;
+        void apply_culling_state(const culling_state& cs) noexcept;
+        void apply_blending_state(const blending_state& bs) noexcept;
+        void apply_capabilities_state(const capabilities_state& cs) noexcept;
+        void apply_texture_sampler(std::size_t unit, const texture_ptr& tex, const sampler_state& ss) noexcept;
+        void activate_texture_unit(std::size_t unit) noexcept;
     private:
         debug& debug_;
         window& window_;
@@ -194,6 +298,14 @@ namespace e2d
         render_target_ptr render_target_;
         opengl::gl_program_id default_sp_;
         opengl::gl_framebuffer_id default_fb_;
+        // bound resources are tracked weakly: the state cache must not keep
+        // evicted assets alive, and an expired entry is already unbound by GL
+        vector<std::weak_ptr<texture>> texture_units_;
+        std::size_t active_texture_unit_ = 0;
+        std::weak_ptr<index_buffer> index_buffer_;
+        std::weak_ptr<vertex_buffer> vertex_buffer_;
+        frame_statistics statistics_;
+        frame_statistics last_statistics_;
     };
 }
 
@@ -0,0 +1,249 @@
+/*******************************************************************************
+ * This file is part of the "Enduro2D"
+ * For conditions of distribution and use, see copyright notice in LICENSE.md
+ * Copyright (C) 2018 Matvey Cherevko
+ ******************************************************************************/
+
+#include <enduro2d/core/render_queue.hpp>
+
+namespace
+{
+    using namespace e2d;
+
+    using key_type = render_queue::key_type;
+
+    const u32 layer_bits = 8u;
+    const u32 ordered_bits = 1u;
+    const u32 shader_bits = 12u;
+    const u32 material_bits = 12u;
+    const u32 textures_bits = 16u;
+    const u32 depth_bits = 15u;
+
+    const u32 depth_shift = 0u;
+    const u32 textures_shift = depth_shift + depth_bits;
+    const u32 material_shift = textures_shift + textures_bits;
+    const u32 shader_shift = material_shift + material_bits;
+    const u32 ordered_shift = shader_shift + shader_bits;
+    const u32 layer_shift = ordered_shift + ordered_bits;
+
+    static_assert(
+        layer_shift + layer_bits == sizeof(key_type) * 8u,
+        "unexpected render queue key layout");
+
+    key_type fold_to_bits(u64 value, u32 bits) noexcept {
+        // Fibonacci hashing: the high bits of the product are well mixed
+        return (value * 11400714819323198485ull) >> (64u - bits);
+    }
+
+    key_type fold_pointer(const void* ptr, u32 bits) noexcept {
+        return ptr
+            ? fold_to_bits(reinterpret_cast<std::uintptr_t>(ptr), bits)
+            : 0u;
+    }
+
+    key_type depth_to_bits(f32 depth) noexcept {
+        u32 bits = 0u;
+        std::memcpy(&bits, &depth, sizeof(bits));
+        bits = (bits & 0x80000000u) ? ~bits : (bits | 0x80000000u);
+        return bits >> (32u - depth_bits);
+    }
+
+    u64 textures_signature(
+        const render::material& mat,
+        const render::property_block& props) noexcept
+    {
+        u64 signature = 0u;
+        const auto fold = [&signature](str_hash name, const render::sampler_state& sampler) noexcept {
+            E2D_UNUSED(name);
+            const std::uintptr_t ptr = reinterpret_cast<std::uintptr_t>(sampler.texture().get());
+            signature = (signature ^ ptr) * 1099511628211ull;
+        };
+        mat.properties().foreach_by_samplers(fold);
+        props.foreach_by_samplers(fold);
+        return signature;
+    }
+
+    // LSD radix sort, items with equal keys keep their order
+    template < typename Item >
+    void radix_sort(vector<Item>& items, vector<Item>& temp) {
+        temp.resize(items.size());
+        for ( u32 shift = 0; shift < sizeof(key_type) * 8u; shift += 8u ) {
+            std::size_t counts[256] = {0};
+            for ( const Item& item : items ) {
+                ++counts[(item.first >> shift) & 0xFFu];
+            }
+            if ( counts[(items.front().first >> shift) & 0xFFu] == items.size() ) {
+                continue;
+            }
+            std::size_t offset = 0u;
+            for ( std::size_t& count : counts ) {
+                const std::size_t bucket_count = count;
+                count = offset;
+                offset += bucket_count;
+            }
+            for ( const Item& item : items ) {
+                temp[counts[(item.first >> shift) & 0xFFu]++] = item;
+            }
+            items.swap(temp);
+        }
+    }
+}
+
+namespace e2d
+{
+    //
+    // render_queue
+    //
+
+    render_queue::render_queue() = default;
+
+    render_queue::~render_queue() noexcept = default;
+
+    bool render_queue::is_ordered(const render::material& mat) noexcept {
+        for ( std::size_t i = 0; i < mat.pass_count(); ++i ) {
+            const render::capabilities_state& caps = mat.pass(i).states().capabilities();
+            if ( caps.blending() || !caps.depth_test() ) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    render_queue::key_type render_queue::make_key(
+        u8 layer,
+        const render::material& mat,
+        const render::property_block& props,
+        f32 depth,
+        u32 sequence) noexcept
+    {
+        if ( is_ordered(mat) ) {
+            // painter order must be kept for ordered draws
+            return (key_type(layer) << layer_shift)
+                | (key_type(1) << ordered_shift)
+                | key_type(sequence);
+        }
+        const shader* shd = mat.pass_count()
+            ? mat.pass(0).shader().get()
+            : nullptr;
+        return (key_type(layer) << layer_shift)
+            | (fold_pointer(shd, shader_bits) << shader_shift)
+            | (fold_pointer(&mat, material_bits) << material_shift)
+            | (fold_to_bits(textures_signature(mat, props), textures_bits) << textures_shift)
+            | (depth_to_bits(depth) << depth_shift);
+    }
+
+    u32 render_queue::next_sequence() noexcept {
+        return sequence_++;
+    }
+
+    u32 render_queue::sequence() const noexcept {
+        return sequence_;
+    }
+
+    render_queue& render_queue::enqueue(
+        key_type key,
+        const render::draw_command& command)
+    {
+        if ( command_count_ == commands_.size() ) {
+            commands_.emplace_back();
+        }
+        command_type& cmd = commands_[command_count_];
+        cmd.first_index = command.first_index();
+        cmd.index_count = command.index_count();
+        cmd.material = &command.material_ref();
+        cmd.geometry = command.geometry_ref();
+        cmd.properties = intern_properties(command.properties_ref());
+        sort_items_.emplace_back(key, math::numeric_cast<u32>(command_count_));
+        ++command_count_;
+        sorted_ = false;
+        return *this;
+    }
+
+    std::size_t render_queue::intern_properties(const render::property_block& props) {
+        if ( property_count_ > 0u && properties_[property_count_ - 1u] == props ) {
+            return property_count_ - 1u;
+        }
+        if ( property_count_ == properties_.size() ) {
+            properties_.emplace_back();
+        }
+        properties_[property_count_] = props;
+        return property_count_++;
+    }
+
+    render_queue& render_queue::sort() {
+        if ( sorted_ ) {
+            return *this;
+        }
+
+        radix_sort(sort_items_, sort_temp_);
+
+        statistics_ = statistics();
+        const shader* last_shader = nullptr;
+        const render::material* last_material = nullptr;
+        u64 last_textures = 0u;
+
+        for ( std::size_t i = 0; i < sort_items_.size(); ++i ) {
+            const command_type& cmd = commands_[sort_items_[i].second];
+
+            const shader* cmd_shader = cmd.material->pass_count()
+                ? cmd.material->pass(0).shader().get()
+                : nullptr;
+            const u64 cmd_textures = textures_signature(*cmd.material, properties_[cmd.properties]);
+
+            if ( i == 0 || cmd_shader != last_shader ) {
+                ++statistics_.shader_switches;
+            }
+            if ( i == 0 || cmd.material != last_material ) {
+                ++statistics_.material_switches;
+            }
+            if ( i == 0 || cmd_textures != last_textures ) {
+                ++statistics_.texture_switches;
+            }
+
+            last_shader = cmd_shader;
+            last_material = cmd.material;
+            last_textures = cmd_textures;
+        }
+
+        statistics_.command_count = sort_items_.size();
+        sorted_ = true;
+        return *this;
+    }
+
+    render_queue& render_queue::flush(render& render) {
+        try {
+            foreach_by_sorted_commands([&render](const render::draw_command& command){
+                render.execute(command);
+            });
+        } catch (...) {
+            clear();
+            throw;
+        }
+        clear();
+        return *this;
+    }
+
+    render_queue& render_queue::clear() noexcept {
+        for ( std::size_t i = 0; i < command_count_; ++i ) {
+            commands_[i].material = nullptr;
+            commands_[i].geometry.clear();
+        }
+        for ( std::size_t i = 0; i < property_count_; ++i ) {
+            properties_[i].clear();
+        }
+        command_count_ = 0u;
+        property_count_ = 0u;
+        sequence_ = 0u;
+        sort_items_.clear();
+        sorted_ = true;
+        return *this;
+    }
+
+    std::size_t render_queue::command_count() const noexcept {
+        return command_count_;
+    }
+
+    const render_queue::statistics& render_queue::last_statistics() const noexcept {
+        return statistics_;
+    }
+}
@@ -12,166 +12,683 @@ namespace
 {
     using namespace e2d;
 
-    template < typename OwnedState >
-    class archive_stream final : public input_stream {
-        using iter_state_uptr = std::unique_ptr<
-            mz_zip_reader_extract_iter_state,
-            void(*)(mz_zip_reader_extract_iter_state*)>;
-        std::size_t iter_pos_ = 0;
-        OwnedState owned_state_;
-        iter_state_uptr iter_state_;
+    const std::size_t archive_local_header_size = 30u;
+    const u32 archive_local_header_signature = 0x04034b50u;
+    const std::size_t archive_inflate_buffer_size = 16u * 1024u;
+
+    std::size_t seek_stream_position(
+        std::size_t pos,
+        std::size_t length,
+        std::ptrdiff_t offset,
+        bool relative)
+    {
+        const std::size_t uoffset = math::abs_to_unsigned(offset);
+        if ( offset < 0 ) {
+            if ( !relative || uoffset > pos ) {
+                throw bad_stream_operation();
+            }
+            return pos - uoffset;
+        }
+        const std::size_t base = relative ? pos : 0u;
+        if ( uoffset > length - base ) {
+            throw bad_stream_operation();
+        }
+        return base + uoffset;
+    }
+
+    //
+    // archive_data
+    //
+    // shared by all entry streams of an archive, mapped archives
+    // are read without locking, others are seeked and read under the mutex
+    //
+
+    class archive_data final : private noncopyable {
     public:
-        archive_stream(const OwnedState& owned_state, mz_zip_archive* archive, const char* filename)
-        : owned_state_(owned_state)
-        , iter_state_(open_iter_state_(archive, filename))
-        {
-            if ( !iter_state_ ) {
-                throw bad_vfs_operation();
+        archive_data(input_stream_uptr stream) noexcept
+        : stream_(std::move(stream))
+        , mapped_(dynamic_cast<const mapped_input_stream*>(stream_.get())) {}
+
+        bool valid() const noexcept {
+            return !!stream_;
+        }
+
+        std::size_t length() const noexcept {
+            return stream_ ? stream_->length() : 0u;
+        }
+
+        const mapped_input_stream* mapped() const noexcept {
+            return mapped_;
+        }
+
+        bool read_at(std::size_t pos, void* dst, std::size_t size) const noexcept {
+            if ( pos > length() || size > length() - pos ) {
+                return false;
+            }
+            if ( !size ) {
+                return true;
+            }
+            if ( mapped_ ) {
+                std::memcpy(dst, mapped_->view().data() + pos, size);
+                return true;
+            }
+            std::lock_guard<std::mutex> guard(mutex_);
+            return input_sequence(*stream_)
+                .seek(math::numeric_cast<std::ptrdiff_t>(pos), false)
+                .read(dst, size)
+                .success();
+        }
+    private:
+        mutable std::mutex mutex_;
+        input_stream_uptr stream_;
+        const mapped_input_stream* mapped_{nullptr};
+    };
+    using archive_data_cptr = std::shared_ptr<const archive_data>;
+
+    //
+    // archive_crc_status
+    //
+    // result of the entry checksum verification,
+    // copyable to keep the entries in a vector
+    //
+
+    class archive_crc_status final {
+    public:
+        enum values : u8 {
+            unknown,
+            valid,
+            invalid
+        };
+    public:
+        archive_crc_status() noexcept = default;
+
+        archive_crc_status(const archive_crc_status& other) noexcept
+        : value_(other.value_.load()) {}
+
+        archive_crc_status& operator=(const archive_crc_status& other) noexcept {
+            value_.store(other.value_.load());
+            return *this;
+        }
+
+        values load() const noexcept {
+            return static_cast<values>(value_.load());
+        }
+
+        void store(values value) const noexcept {
+            value_.store(static_cast<u8>(value));
+        }
+    private:
+        mutable std::atomic<u8> value_{unknown};
+    };
+
+    //
+    // archive_entry
+    //
+
+    struct archive_entry {
+        str name;
+        bool directory{false};
+        bool supported{false};
+        bool compressed{false};
+        std::size_t header_offset{0u};
+        std::size_t compressed_size{0u};
+        std::size_t uncompressed_size{0u};
+        u32 crc32{0u};
+        archive_crc_status crc_status;
+    };
+
+    //
+    // archive_crc_check
+    //
+    // checksum of entry bytes read in order from the start,
+    // verified when the last byte is read, out of order reads are not checked
+    //
+
+    class archive_crc_check final {
+    public:
+        archive_crc_check() noexcept = default;
+
+        archive_crc_check(u32 expected, std::size_t size) noexcept
+        : enabled_(true)
+        , expected_(expected)
+        , size_(size) {}
+
+        void reset() noexcept {
+            crc_ = MZ_CRC32_INIT;
+            checked_ = 0u;
+        }
+
+        void update(std::size_t pos, const u8* data, std::size_t size) {
+            if ( !enabled_ || !size || pos != checked_ ) {
+                return;
             }
+            crc_ = static_cast<u32>(mz_crc32(crc_, data, size));
+            checked_ += size;
+            if ( checked_ == size_ && crc_ != expected_ ) {
+                throw bad_stream_operation();
+            }
+        }
+
+        static bool check(u32 expected, buffer_view data) noexcept {
+            return expected == static_cast<u32>(mz_crc32(MZ_CRC32_INIT, data.data(), data.size()));
         }
+    private:
+        bool enabled_{false};
+        u32 expected_{0u};
+        u32 crc_{MZ_CRC32_INIT};
+        std::size_t size_{0u};
+        std::size_t checked_{0u};
+    };
 
-        ~archive_stream() noexcept final {
-            // reset iter state before owned state
-            iter_state_.reset();
+    //
+    // archive_view_stream
+    //
+    // stored entry of a mapped archive, served without copying
+    //
+
+    class archive_view_stream final : public mapped_input_stream {
+    public:
+        archive_view_stream(archive_data_cptr archive, std::size_t offset, std::size_t size) noexcept
+        : archive_(std::move(archive))
+        , view_(archive_->mapped()->view().data() + offset, size) {}
+
+        buffer_view view() const noexcept final {
+            return view_;
         }
+    private:
+        archive_data_cptr archive_;
+        buffer_view view_;
+    };
+
+    //
+    // archive_stored_stream
+    //
+
+    class archive_stored_stream final : public input_stream {
+    public:
+        archive_stored_stream(
+            archive_data_cptr archive,
+            std::size_t offset,
+            std::size_t size,
+            const archive_crc_check& crc = archive_crc_check()) noexcept
+        : archive_(std::move(archive))
+        , offset_(offset)
+        , size_(size)
+        , crc_(crc) {}
 
         std::size_t read(void* dst, std::size_t size) final {
-            E2D_ASSERT(iter_state_);
-            std::size_t read_bytes = mz_zip_reader_extract_iter_read(iter_state_.get(), dst, size);
-            iter_pos_ += read_bytes;
+            const std::size_t read_bytes = dst
+                ? math::min(size, size_ - pos_)
+                : 0u;
+            if ( !archive_->read_at(offset_ + pos_, dst, read_bytes) ) {
+                throw bad_stream_operation();
+            }
+            crc_.update(pos_, static_cast<const u8*>(dst), read_bytes);
+            pos_ += read_bytes;
             return read_bytes;
         }
 
         std::size_t seek(std::ptrdiff_t offset, bool relative) final {
-            E2D_UNUSED(offset, relative);
-            throw bad_vfs_operation();
+            pos_ = seek_stream_position(pos_, size_, offset, relative);
+            return pos_;
         }
 
         std::size_t tell() const final {
-            return iter_pos_;
+            return pos_;
         }
 
         std::size_t length() const noexcept final {
-            return math::numeric_cast<std::size_t>(
-                iter_state_->file_stat.m_uncomp_size);
+            return size_;
         }
     private:
-        static iter_state_uptr open_iter_state_(mz_zip_archive* archive, const char* filename) noexcept {
-            mz_zip_reader_extract_iter_state* iter_state = mz_zip_reader_extract_file_iter_new(
-                archive, filename, MZ_ZIP_FLAG_CASE_SENSITIVE);
-            return iter_state_uptr(iter_state, state_deleter_);
+        archive_data_cptr archive_;
+        std::size_t offset_{0u};
+        std::size_t size_{0u};
+        std::size_t pos_{0u};
+        archive_crc_check crc_;
+    };
+
+    //
+    // archive_inflate_stream
+    //
+    // owns its decompressor, so streams of different entries
+    // are decompressed in parallel, backward seeks restart inflating
+    //
+
+    class archive_inflate_stream final : public input_stream {
+    public:
+        archive_inflate_stream(
+            archive_data_cptr archive,
+            std::size_t offset,
+            std::size_t compressed_size,
+            std::size_t size,
+            const archive_crc_check& crc)
+        : archive_(std::move(archive))
+        , offset_(offset)
+        , compressed_size_(compressed_size)
+        , size_(size)
+        , crc_(crc)
+        , dictionary_(std::make_unique<u8[]>(TINFL_LZ_DICT_SIZE))
+        {
+            if ( !archive_->mapped() ) {
+                input_buffer_ = std::make_unique<u8[]>(archive_inflate_buffer_size);
+            }
+            restart_();
+        }
+
+        std::size_t read(void* dst, std::size_t size) final {
+            return dst
+                ? consume_(static_cast<u8*>(dst), size)
+                : 0u;
+        }
+
+        std::size_t seek(std::ptrdiff_t offset, bool relative) final {
+            const std::size_t new_pos = seek_stream_position(pos_, size_, offset, relative);
+            if ( new_pos < pos_ ) {
+                restart_();
+            }
+            while ( pos_ < new_pos ) {
+                consume_(nullptr, new_pos - pos_);
+            }
+            return pos_;
+        }
+
+        std::size_t tell() const final {
+            return pos_;
+        }
+
+        std::size_t length() const noexcept final {
+            return size_;
+        }
+    private:
+        void restart_() noexcept {
+            tinfl_init(&inflator_);
+            crc_.reset();
+            pos_ = 0u;
+            output_avail_ = 0u;
+            if ( archive_->mapped() ) {
+                input_ = archive_->mapped()->view().data() + offset_;
+                input_avail_ = compressed_size_;
+                compressed_left_ = 0u;
+            } else {
+                input_ = nullptr;
+                input_avail_ = 0u;
+                compressed_left_ = compressed_size_;
+            }
+        }
+
+        // copies to dst or skips when dst is null
+        std::size_t consume_(u8* dst, std::size_t size) {
+            const std::size_t dictionary_mask = TINFL_LZ_DICT_SIZE - 1u;
+            std::size_t consumed = 0u;
+            while ( consumed < size && pos_ < size_ ) {
+                if ( !output_avail_ ) {
+                    inflate_next_();
+                }
+                const std::size_t bytes = math::min(
+                    math::min(size - consumed, output_avail_),
+                    size_ - pos_);
+                const u8* output = dictionary_.get() + (pos_ & dictionary_mask);
+                crc_.update(pos_, output, bytes);
+                if ( dst ) {
+                    std::memcpy(dst + consumed, output, bytes);
+                }
+                output_avail_ -= bytes;
+                consumed += bytes;
+                pos_ += bytes;
+            }
+            return consumed;
         }
 
-        static void state_deleter_(mz_zip_reader_extract_iter_state* state) noexcept {
-            if ( state ) {
-                mz_zip_reader_extract_iter_free(state);
+        void inflate_next_() {
+            if ( !input_avail_ && compressed_left_ ) {
+                const std::size_t bytes = math::min(archive_inflate_buffer_size, compressed_left_);
+                const std::size_t bytes_offset = offset_ + (compressed_size_ - compressed_left_);
+                if ( !archive_->read_at(bytes_offset, input_buffer_.get(), bytes) ) {
+                    throw bad_stream_operation();
+                }
+                input_ = input_buffer_.get();
+                input_avail_ = bytes;
+                compressed_left_ -= bytes;
+            }
+
+            const std::size_t dictionary_mask = TINFL_LZ_DICT_SIZE - 1u;
+            std::size_t input_size = input_avail_;
+            std::size_t output_size = TINFL_LZ_DICT_SIZE - (pos_ & dictionary_mask);
+            const tinfl_status status = tinfl_decompress(
+                &inflator_,
+                input_,
+                &input_size,
+                dictionary_.get(),
+                dictionary_.get() + (pos_ & dictionary_mask),
+                &output_size,
+                compressed_left_ ? TINFL_FLAG_HAS_MORE_INPUT : 0);
+
+            input_ += input_size;
+            input_avail_ -= input_size;
+            output_avail_ = output_size;
+
+            const bool no_progress = !output_size && (
+                status == TINFL_STATUS_DONE ||
+                (!input_avail_ && !compressed_left_));
+            if ( status < TINFL_STATUS_DONE || no_progress ) {
+                throw bad_stream_operation();
             }
         }
+    private:
+        archive_data_cptr archive_;
+        std::size_t offset_{0u};
+        std::size_t compressed_size_{0u};
+        std::size_t size_{0u};
+        std::size_t pos_{0u};
+        archive_crc_check crc_;
+        tinfl_decompressor inflator_;
+        std::unique_ptr<u8[]> dictionary_;
+        std::unique_ptr<u8[]> input_buffer_;
+        const u8* input_{nullptr};
+        std::size_t input_avail_{0u};
+        std::size_t compressed_left_{0u};
+        std::size_t output_avail_{0u};
     };
 }
 
 namespace e2d
 {
+    //
+    // vfs::file_source
+    //
+
+    mapped_input_stream_uptr vfs::file_source::map(str_view path) const {
+        buffer content;
+        const input_stream_uptr stream = read(path);
+        return stream && streams::try_read_tail(content, stream)
+            ? make_mapped_memory_stream(std::move(content))
+            : nullptr;
+    }
+
     //
     // vfs
     //
 
     class vfs::state final : private e2d::noncopyable {
     public:
-        std::mutex mutex;
-        stdex::jobber worker{1};
-        hash_map<str, url> aliases;
-        hash_map<str, file_source_uptr> schemes;
+        using file_source_sptr = std::shared_ptr<file_source>;
+
+        // immutable snapshot of registered schemes and aliases,
+        // readers use it without locking and writers replace it
+        struct scheme_table {
+            hash_map<str, url> aliases;
+            hash_map<str, file_source_sptr> schemes;
+        };
+        using scheme_table_cptr = std::shared_ptr<const scheme_table>;
     public:
-        url resolve_url(const url& url, u8 level = 0) const {
-            if ( level > 32 ) {
-                throw bad_vfs_operation();
+        state(std::size_t io_threads)
+        : table_(std::make_shared<scheme_table>())
+        , io_pool_(io_threads) {}
+
+        ~state() noexcept = default;
+
+        scheme_table_cptr table() const noexcept {
+            return std::atomic_load(&table_);
+        }
+
+        template < typename F >
+        bool modify_table(F&& f) {
+            std::lock_guard<std::mutex> guard(table_mutex_);
+            auto new_table = std::make_shared<scheme_table>(*table());
+            if ( !stdex::invoke(std::forward<F>(f), *new_table) ) {
+                return false;
             }
-            const auto alias_iter = aliases.find(url.scheme());
-            return alias_iter != aliases.cend()
-                ? resolve_url(alias_iter->second / url.path(), level + 1)
-                : url;
+            std::atomic_store(&table_, scheme_table_cptr(std::move(new_table)));
+            return true;
         }
 
         template < typename F, typename R >
         R with_file_source(const url& url, F&& f, R&& fallback_result) const {
-            const auto resolved_url = resolve_url(url);
-            const auto scheme_iter = schemes.find(resolved_url.scheme());
-            return (scheme_iter != schemes.cend() && scheme_iter->second)
+            const scheme_table_cptr snapshot = table();
+            const auto resolved_url = resolve_url(*snapshot, url);
+            const auto scheme_iter = snapshot->schemes.find(resolved_url.scheme());
+            return (scheme_iter != snapshot->schemes.cend() && scheme_iter->second)
                 ? stdex::invoke(
                     std::forward<F>(f),
-                    scheme_iter->second,
+                    *scheme_iter->second,
                     resolved_url.path())
                 : std::forward<R>(fallback_result);
         }
+
+        static url resolve_url(const scheme_table& table, const url& url, u8 level = 0) {
+            if ( level > 32 ) {
+                throw bad_vfs_operation();
+            }
+            const auto alias_iter = table.aliases.find(url.scheme());
+            return alias_iter != table.aliases.cend()
+                ? resolve_url(table, alias_iter->second / url.path(), level + 1)
+                : url;
+        }
+
+        template < typename F, typename R = stdex::invoke_result_t<std::decay_t<F>> >
+        stdex::promise<R> async(io_priority priority, F&& f) {
+            return io_pool_.async(priority, std::forward<F>(f));
+        }
+
+        std::size_t io_thread_count() const noexcept {
+            return io_pool_.thread_count();
+        }
+    private:
+        //
+        // io_pool
+        //
+        // fixed set of reader threads with a priority queue,
+        // requests of the same priority are served in fifo order
+        //
+
+        class io_pool final : private e2d::noncopyable {
+        public:
+            using task_fn = std::function<void(bool cancelled)>;
+        public:
+            io_pool(std::size_t threads) {
+                try {
+                    threads_.reserve(math::max(std::size_t(1u), threads));
+                    for ( std::size_t i = 0; i < threads_.capacity(); ++i ) {
+                        threads_.emplace_back(&io_pool::worker_main_, this);
+                    }
+                } catch (...) {
+                    shutdown_();
+                    throw;
+                }
+            }
+
+            ~io_pool() noexcept {
+                shutdown_();
+            }
+
+            std::size_t thread_count() const noexcept {
+                return threads_.size();
+            }
+
+            template < typename F, typename R = stdex::invoke_result_t<std::decay_t<F>> >
+            stdex::promise<R> async(io_priority priority, F&& f) {
+                stdex::promise<R> result;
+                push_(priority, [result, f = std::forward<F>(f)](bool cancelled) mutable {
+                    if ( cancelled ) {
+                        result.reject(vfs_load_async_exception());
+                        return;
+                    }
+                    try {
+                        result.resolve(f());
+                    } catch (...) {
+                        result.reject(std::current_exception());
+                    }
+                });
+                return result;
+            }
+        private:
+            struct task {
+                io_priority priority;
+                u64 index;
+                task_fn fn;
+            };
+
+            struct task_less {
+                bool operator()(const task& l, const task& r) const noexcept {
+                    return l.priority != r.priority
+                        ? l.priority < r.priority
+                        : l.index > r.index;
+                }
+            };
+        private:
+            void push_(io_priority priority, task_fn fn) {
+                {
+                    std::lock_guard<std::mutex> guard(mutex_);
+                    tasks_.push_back(task{priority, next_index_++, std::move(fn)});
+                    std::push_heap(tasks_.begin(), tasks_.end(), task_less());
+                }
+                cond_var_.notify_one();
+            }
+
+            void worker_main_() noexcept {
+                for (;;) {
+                    task_fn fn;
+                    {
+                        std::unique_lock<std::mutex> lock(mutex_);
+                        cond_var_.wait(lock, [this](){
+                            return cancelled_ || !tasks_.empty();
+                        });
+                        if ( cancelled_ ) {
+                            return;
+                        }
+                        std::pop_heap(tasks_.begin(), tasks_.end(), task_less());
+                        fn = std::move(tasks_.back().fn);
+                        tasks_.pop_back();
+                    }
+                    fn(false);
+                }
+            }
+
+            void shutdown_() noexcept {
+                {
+                    std::lock_guard<std::mutex> guard(mutex_);
+                    cancelled_ = true;
+                }
+                cond_var_.notify_all();
+                for ( std::thread& t : threads_ ) {
+                    if ( t.joinable() ) {
+                        t.join();
+                    }
+                }
+                // reject requests that have never been started
+                for ( task& t : tasks_ ) {
+                    t.fn(true);
+                }
+                tasks_.clear();
+            }
+        private:
+            std::mutex mutex_;
+            std::condition_variable cond_var_;
+            vector<task> tasks_;
+            u64 next_index_{0u};
+            bool cancelled_{false};
+            vector<std::thread> threads_;
+        };
+    private:
+        std::mutex table_mutex_;
+        scheme_table_cptr table_;
+        io_pool io_pool_;
     };
 
     vfs::vfs()
-    : state_(new state()){}
+    : vfs(4u) {}
+
+    vfs::vfs(std::size_t io_threads)
+    : state_(new state(io_threads)) {}
 
     vfs::~vfs() noexcept = default;
 
     bool vfs::register_scheme(str_view scheme, file_source_uptr source) {
-        std::lock_guard<std::mutex> guard(state_->mutex);
-        return (source && source->valid())
-            ? state_->schemes.insert(
-                std::make_pair(scheme, std::move(source))).second
-            : false;
+        if ( !source || !source->valid() ) {
+            return false;
+        }
+        state::file_source_sptr shared_source(std::move(source));
+        return state_->modify_table([scheme, &shared_source](state::scheme_table& table){
+            return table.schemes.insert(
+                std::make_pair(scheme, std::move(shared_source))).second;
+        });
     }
 
     bool vfs::unregister_scheme(str_view scheme) {
-        std::lock_guard<std::mutex> guard(state_->mutex);
-        return state_->schemes.erase(scheme) > 0;
+        return state_->modify_table([scheme](state::scheme_table& table){
+            return table.schemes.erase(scheme) > 0;
+        });
     }
 
     bool vfs::register_scheme_alias(str_view scheme, url alias) {
-        std::lock_guard<std::mutex> guard(state_->mutex);
-        return state_->aliases.insert(
-            std::make_pair(scheme, alias)).second;
+        return state_->modify_table([scheme, &alias](state::scheme_table& table){
+            return table.aliases.insert(
+                std::make_pair(scheme, std::move(alias))).second;
+        });
     }
 
     bool vfs::unregister_scheme_alias(str_view scheme) {
-        std::lock_guard<std::mutex> guard(state_->mutex);
-        return state_->aliases.erase(scheme) > 0;
+        return state_->modify_table([scheme](state::scheme_table& table){
+            return table.aliases.erase(scheme) > 0;
+        });
     }
 
     bool vfs::exists(const url& url) const {
-        std::lock_guard<std::mutex> guard(state_->mutex);
         return state_->with_file_source(url,
-            [](const file_source_uptr& source, const str& path) {
-                return source->exists(path);
+            [](const file_source& source, const str& path) {
+                return source.exists(path);
             }, false);
     }
 
     input_stream_uptr vfs::read(const url& url) const {
-        std::lock_guard<std::mutex> guard(state_->mutex);
         return state_->with_file_source(url,
-            [](const file_source_uptr& source, const str& path) {
-                return source->read(path);
+            [](const file_source& source, const str& path) {
+                return source.read(path);
             }, input_stream_uptr());
     }
 
+    mapped_input_stream_uptr vfs::map(const url& url) const {
+        return state_->with_file_source(url,
+            [](const file_source& source, const str& path) {
+                return source.map(path);
+            }, mapped_input_stream_uptr());
+    }
+
+    stdex::promise<std::shared_ptr<mapped_input_stream>> vfs::map_async(
+        const url& url,
+        io_priority priority) const
+    {
+        return state_->async(priority, [this, url](){
+            std::shared_ptr<mapped_input_stream> content = map(url);
+            if ( !content ) {
+                throw vfs_load_async_exception();
+            }
+            return content;
+        });
+    }
+
     output_stream_uptr vfs::write(const url& url, bool append) const {
-        std::lock_guard<std::mutex> guard(state_->mutex);
         return state_->with_file_source(url,
-            [&append](const file_source_uptr& source, const str& path) {
-                return source->write(path, append);
+            [&append](const file_source& source, const str& path) {
+                return source.write(path, append);
             }, output_stream_uptr());
     }
 
     bool vfs::load(const url& url, buffer& dst) const {
-        return load_async(url)
-            .then([&dst](auto&& src){
-                dst = std::forward<decltype(src)>(src);
-                return true;
-            }).get_or_default(false);
+        buffer content;
+        const input_stream_uptr stream = read(url);
+        if ( !stream || !streams::try_read_tail(content, stream) ) {
+            return false;
+        }
+        dst.swap(content);
+        return true;
     }
 
-    stdex::promise<buffer> vfs::load_async(const url& url) const {
-        return state_->worker.async([this, url](){
+    stdex::promise<buffer> vfs::load_async(const url& url, io_priority priority) const {
+        return state_->async(priority, [this, url](){
             buffer content;
-            const input_stream_uptr stream = read(url);
-            if ( !stream || !streams::try_read_tail(content, stream) ) {
+            if ( !load(url, content) ) {
                 throw vfs_load_async_exception();
             }
             return content;
@@ -179,18 +696,19 @@ namespace e2d
     }
 
     bool vfs::load_as_string(const url& url, str& dst) const {
-        return load_as_string_async(url)
-            .then([&dst](auto&& src){
-                dst = std::forward<decltype(src)>(src);
-                return true;
-            }).get_or_default(false);
+        str content;
+        const input_stream_uptr stream = read(url);
+        if ( !stream || !streams::try_read_tail(content, stream) ) {
+            return false;
+        }
+        dst.swap(content);
+        return true;
     }
 
-    stdex::promise<str> vfs::load_as_string_async(const url& url) const {
-        return state_->worker.async([this, url](){
+    stdex::promise<str> vfs::load_as_string_async(const url& url, io_priority priority) const {
+        return state_->async(priority, [this, url](){
             str content;
-            const input_stream_uptr stream = read(url);
-            if ( !stream || !streams::try_read_tail(content, stream) ) {
+            if ( !load_as_string(url, content) ) {
                 throw vfs_load_async_exception();
             }
             return content;
@@ -198,16 +716,18 @@ namespace e2d
     }
 
     bool vfs::trace(const url& url, filesystem::trace_func func) const {
-        std::lock_guard<std::mutex> guard(state_->mutex);
         return state_->with_file_source(url,
-            [&func](const file_source_uptr& source, const str& path) {
-                return source->trace(path, func);
+            [&func](const file_source& source, const str& path) {
+                return source.trace(path, func);
             }, false);
     }
 
     url vfs::resolve_scheme_aliases(const url& url) const {
-        std::lock_guard<std::mutex> guard(state_->mutex);
-        return state_->resolve_url(url);
+        return state::resolve_url(*state_->table(), url);
+    }
+
+    std::size_t vfs::io_thread_count() const noexcept {
+        return state_->io_thread_count();
     }
 
     //
@@ -216,45 +736,134 @@ namespace e2d
 
     class archive_file_source::state final : private e2d::noncopyable {
     public:
-        using archive_ptr = std::shared_ptr<mz_zip_archive>;
-        using stream_ptr = std::shared_ptr<input_stream>;
-        archive_ptr archive;
-        stream_ptr stream;
+        archive_data_cptr archive;
+        vector<archive_entry> entries;
+        hash_map<str, std::size_t> entry_index;
+        vector<std::size_t> sorted_entries;
     public:
-        state(input_stream_uptr nstream)
-        : archive(open_archive_(nstream))
-        , stream(std::move(nstream)) {}
+        state(input_stream_uptr stream)
+        : archive(std::make_shared<archive_data>(std::move(stream)))
+        {
+            if ( !build_index_() ) {
+                archive.reset();
+                entries.clear();
+                entry_index.clear();
+                sorted_entries.clear();
+            }
+        }
+
         ~state() noexcept = default;
+
+        const archive_entry* find_entry(str_view path) const {
+            const auto iter = entry_index.find(path);
+            return iter != entry_index.end()
+                ? &entries[iter->second]
+                : nullptr;
+        }
+
+        bool find_entry_data(const archive_entry& entry, std::size_t& offset) const noexcept {
+            u8 header[archive_local_header_size];
+            if ( !archive->read_at(entry.header_offset, header, sizeof(header)) ) {
+                return false;
+            }
+            const auto read_u16 = [&header](std::size_t pos) noexcept {
+                return static_cast<std::size_t>(header[pos] | (header[pos + 1] << 8u));
+            };
+            const u32 signature =
+                static_cast<u32>(read_u16(0)) |
+                (static_cast<u32>(read_u16(2)) << 16u);
+            if ( signature != archive_local_header_signature ) {
+                return false;
+            }
+            offset = entry.header_offset + sizeof(header) + read_u16(26) + read_u16(28);
+            return offset <= archive->length()
+                && entry.compressed_size <= archive->length() - offset;
+        }
+
+        // mapped stored entries are served as a whole,
+        // so they are checked up front by their first open
+        bool check_entry_view(const archive_entry& entry, std::size_t offset) const noexcept {
+            archive_crc_status::values status = entry.crc_status.load();
+            if ( status == archive_crc_status::unknown ) {
+                const bool valid = archive_crc_check::check(
+                    entry.crc32,
+                    buffer_view(
+                        archive->mapped()->view().data() + offset,
+                        entry.uncompressed_size));
+                status = valid
+                    ? archive_crc_status::valid
+                    : archive_crc_status::invalid;
+                entry.crc_status.store(status);
+            }
+            return status == archive_crc_status::valid;
+        }
+
+        // entries verified by an open are not checked by their streams
+        static archive_crc_check make_crc_check(const archive_entry& entry) noexcept {
+            return entry.crc_status.load() == archive_crc_status::valid
+                ? archive_crc_check()
+                : archive_crc_check(entry.crc32, entry.uncompressed_size);
+        }
     private:
-        static archive_ptr open_archive_(const input_stream_uptr& stream) noexcept {
-            if ( stream ) {
-                mz_zip_archive* archive = static_cast<mz_zip_archive*>(
-                    std::calloc(1, sizeof(mz_zip_archive)));
-                if ( archive ) {
-                    archive->m_pRead = archive_reader_;
-                    archive->m_pIO_opaque = stream.get();
-                    if ( mz_zip_reader_init(archive, stream->length(), 0) ) {
-                        return archive_ptr(archive, archive_deleter_);
+        bool build_index_() noexcept {
+            if ( !archive->valid() ) {
+                return false;
+            }
+
+            mz_zip_archive zip;
+            mz_zip_zero_struct(&zip);
+            zip.m_pRead = archive_reader_;
+            zip.m_pIO_opaque = const_cast<archive_data*>(archive.get());
+            if ( !mz_zip_reader_init(&zip, archive->length(), 0) ) {
+                return false;
+            }
+
+            bool success = true;
+            try {
+                const mz_uint num_files = mz_zip_reader_get_num_files(&zip);
+                entries.reserve(num_files);
+                entry_index.reserve(num_files);
+                for ( mz_uint i = 0; i < num_files && success; ++i ) {
+                    mz_zip_archive_file_stat file_stat;
+                    if ( !mz_zip_reader_file_stat(&zip, i, &file_stat) ) {
+                        success = false;
+                        break;
                     }
-                    std::free(archive);
+                    archive_entry entry;
+                    entry.name = file_stat.m_filename;
+                    entry.directory = !!file_stat.m_is_directory;
+                    entry.compressed = file_stat.m_method == MZ_DEFLATED;
+                    entry.supported = file_stat.m_is_supported
+                        && !file_stat.m_is_encrypted
+                        && (file_stat.m_method == 0 || entry.compressed);
+                    entry.header_offset = math::numeric_cast<std::size_t>(file_stat.m_local_header_ofs);
+                    entry.compressed_size = math::numeric_cast<std::size_t>(file_stat.m_comp_size);
+                    entry.uncompressed_size = math::numeric_cast<std::size_t>(file_stat.m_uncomp_size);
+                    entry.crc32 = static_cast<u32>(file_stat.m_crc32);
+                    entry_index.insert(std::make_pair(entry.name, entries.size()));
+                    entries.push_back(std::move(entry));
                 }
-            }
-            return archive_ptr();
-        }
 
-        static void archive_deleter_(mz_zip_archive* archive) noexcept {
-            if ( archive ) {
-                mz_zip_reader_end(archive);
-                std::free(archive);
+                sorted_entries.resize(entries.size());
+                std::iota(sorted_entries.begin(), sorted_entries.end(), std::size_t(0u));
+                std::sort(sorted_entries.begin(), sorted_entries.end(),
+                    [this](std::size_t l, std::size_t r){
+                        return entries[l].name < entries[r].name;
+                    });
+            } catch (...) {
+                success = false;
             }
+
+            mz_zip_reader_end(&zip);
+            return success;
         }
 
         static size_t archive_reader_(void* opaque, mz_uint64 pos, void* dst, size_t size) noexcept {
-            input_stream* stream = static_cast<input_stream*>(opaque);
-            return input_sequence(*stream)
-                .seek(math::numeric_cast<std::ptrdiff_t>(pos), false)
-                .read(dst, size)
-                .success() ? size : 0;
+            const archive_data* archive = static_cast<const archive_data*>(opaque);
+            return pos <= std::numeric_limits<std::size_t>::max()
+                && archive->read_at(static_cast<std::size_t>(pos), dst, size)
+                ? size
+                : 0;
         }
     };
 
@@ -267,23 +876,42 @@ namespace e2d
     }
 
     bool archive_file_source::exists(str_view path) const {
-        return -1 != mz_zip_reader_locate_file(
-            state_->archive.get(),
-            make_utf8(path).c_str(),
-            nullptr,
-            MZ_ZIP_FLAG_CASE_SENSITIVE);
+        return !!state_->find_entry(path);
     }
 
     input_stream_uptr archive_file_source::read(str_view path) const {
+        const archive_entry* entry = state_->find_entry(path);
+        if ( !entry || entry->directory || !entry->supported
+            || entry->crc_status.load() == archive_crc_status::invalid )
+        {
+            return nullptr;
+        }
+        std::size_t offset = 0;
+        if ( !state_->find_entry_data(*entry, offset) ) {
+            return nullptr;
+        }
         try {
-            struct owned_state_t {
-                state::archive_ptr archive;
-                state::stream_ptr stream;
-            } owned_state{state_->archive, state_->stream};
-            return std::make_unique<archive_stream<owned_state_t>>(
-                std::move(owned_state),
-                state_->archive.get(),
-                make_utf8(path).c_str());
+            if ( entry->compressed ) {
+                return std::make_unique<archive_inflate_stream>(
+                    state_->archive,
+                    offset,
+                    entry->compressed_size,
+                    entry->uncompressed_size,
+                    state::make_crc_check(*entry));
+            }
+            if ( state_->archive->mapped() ) {
+                return state_->check_entry_view(*entry, offset)
+                    ? std::make_unique<archive_view_stream>(
+                        state_->archive,
+                        offset,
+                        entry->uncompressed_size)
+                    : nullptr;
+            }
+            return std::make_unique<archive_stored_stream>(
+                state_->archive,
+                offset,
+                entry->uncompressed_size,
+                state::make_crc_check(*entry));
         } catch (...) {
             return nullptr;
         }
@@ -300,40 +928,374 @@ namespace e2d
             if ( parent.back() != '/' ) {
                 parent += '/';
             }
-            mz_uint32 dir_index = 0;
-            if ( !mz_zip_reader_locate_file_v2(
-                state_->archive.get(),
-                parent.c_str(),
-                nullptr,
-                MZ_ZIP_FLAG_CASE_SENSITIVE,
-                &dir_index) )
+            const archive_entry* dir_entry = state_->find_entry(parent);
+            if ( !dir_entry || !dir_entry->directory ) {
+                return false;
+            }
+        }
+
+        // children are found by a prefix range of sorted names
+        // and reported in the archive order
+        const auto first = std::lower_bound(
+            state_->sorted_entries.begin(),
+            state_->sorted_entries.end(),
+            parent,
+            [this](std::size_t index, const str& name){
+                return state_->entries[index].name < name;
+            });
+        vector<std::size_t> children;
+        for ( auto iter = first; iter != state_->sorted_entries.end(); ++iter ) {
+            const str_view filename = state_->entries[*iter].name;
+            if ( !filename.starts_with(parent) ) {
+                break;
+            }
+            if ( filename.length() > parent.length() ) {
+                children.push_back(*iter);
+            }
+        }
+        std::sort(children.begin(), children.end());
+
+        for ( std::size_t index : children ) {
+            const archive_entry& entry = state_->entries[index];
+            func(entry.name, entry.directory);
+        }
+        return true;
+    }
+
+    mapped_input_stream_uptr archive_file_source::map(str_view path) const {
+        const archive_entry* entry = state_->find_entry(path);
+        if ( !entry || entry->directory || !entry->supported
+            || entry->crc_status.load() == archive_crc_status::invalid )
+        {
+            return nullptr;
+        }
+        std::size_t offset = 0;
+        if ( entry->compressed
+            || !state_->archive->mapped()
+            || !state_->find_entry_data(*entry, offset) )
+        {
+            return file_source::map(path);
+        }
+        if ( !state_->check_entry_view(*entry, offset) ) {
+            return nullptr;
+        }
+        try {
+            return std::make_unique<archive_view_stream>(
+                state_->archive,
+                offset,
+                entry->uncompressed_size);
+        } catch (...) {
+            return nullptr;
+        }
+    }
+
+    //
+    // bundle_file_source
+    //
+
+    class bundle_file_source::state final : private e2d::noncopyable {
+    public:
+        archive_data_cptr archive;
+        bundles::file_header header = bundles::file_header();
+        buffer directory_content;
+        buffer_view directory;
+        vector<u32> name_order;
+    public:
+        state(input_stream_uptr stream)
+        : archive(std::make_shared<archive_data>(std::move(stream)))
+        {
+            if ( !load_directory_() ) {
+                archive.reset();
+                directory_content.clear();
+                directory.clear();
+                name_order.clear();
+            }
+        }
+
+        ~state() noexcept = default;
+
+        std::size_t entry_count() const noexcept {
+            return archive ? header.entry_count : 0u;
+        }
+
+        bundles::file_entry entry_at(std::size_t index) const noexcept {
+            E2D_ASSERT(index < entry_count());
+            bundles::file_entry entry;
+            std::memcpy(
+                &entry,
+                directory.data() + index * sizeof(bundles::file_entry),
+                sizeof(bundles::file_entry));
+            return entry;
+        }
+
+        str_view entry_name(const bundles::file_entry& entry) const noexcept {
+            return str_view(
+                reinterpret_cast<const char*>(directory.data())
+                    + entry_count() * sizeof(bundles::file_entry)
+                    + entry.name_offset,
+                entry.name_size);
+        }
+
+        bool find_entry(str_view path, bundles::file_entry& dst) const noexcept {
+            while ( !path.empty() && path.back() == '/' ) {
+                path.remove_suffix(1u);
+            }
+
+            // lower bound of the hash, names resolve collisions
+            const u32 hash = str_hash(path).hash();
+            std::size_t first = 0u;
+            std::size_t count = entry_count();
+            while ( count > 0u ) {
+                const std::size_t step = count / 2u;
+                if ( entry_at(first + step).name_hash < hash ) {
+                    first += step + 1u;
+                    count -= step + 1u;
+                } else {
+                    count = step;
+                }
+            }
+            for ( std::size_t i = first; i < entry_count(); ++i ) {
+                const bundles::file_entry entry = entry_at(i);
+                if ( entry.name_hash != hash ) {
+                    break;
+                }
+                if ( entry_name(entry) == path ) {
+                    dst = entry;
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        buffer_view mapped_entry_data(const bundles::file_entry& entry) const noexcept {
+            E2D_ASSERT(archive->mapped());
+            return buffer_view(
+                archive->mapped()->view().data() + entry.data_offset,
+                math::numeric_cast<std::size_t>(entry.stored_size));
+        }
+
+        bool decompress_entry(const bundles::file_entry& entry, buffer& dst) const {
+            buffer stored;
+            buffer_view data;
+            if ( archive->mapped() ) {
+                data = mapped_entry_data(entry);
+            } else {
+                stored.resize(math::numeric_cast<std::size_t>(entry.stored_size));
+                if ( !archive->read_at(
+                    math::numeric_cast<std::size_t>(entry.data_offset),
+                    stored.data(),
+                    stored.size()) )
+                {
+                    return false;
+                }
+                data = stored;
+            }
+
+            // chunks are decompressed inline: this runs on vfs I/O threads,
+            // and waiting for the deferrer there would run unrelated jobs
+            buffer content(math::numeric_cast<std::size_t>(entry.size));
+            for ( std::size_t i = 0; i < entry.chunk_count; ++i ) {
+                if ( !bundles::try_decompress_chunk(entry, data, i, content.data()) ) {
+                    return false;
+                }
+            }
+            dst.swap(content);
+            return true;
+        }
+    private:
+        bool load_directory_() noexcept {
+            if ( !archive->valid() ) {
+                return false;
+            }
+
+            if ( !archive->read_at(0u, &header, sizeof(header))
+                || !bundles::is_valid_header(header) )
             {
                 return false;
             }
-            mz_zip_archive_file_stat dir_stat;
-            if ( !mz_zip_reader_file_stat(
-                state_->archive.get(),
-                dir_index, &dir_stat) )
+
+            const u64 length = archive->length();
+            const u64 entries_size = u64(header.entry_count) * sizeof(bundles::file_entry);
+            if ( header.names_offset != header.directory_offset + entries_size
+                || header.names_offset > length
+                || header.names_size > length - header.names_offset )
             {
                 return false;
             }
-            if ( !dir_stat.m_is_directory ) {
+
+            const std::size_t directory_size = math::numeric_cast<std::size_t>(
+                entries_size + header.names_size);
+            if ( archive->mapped() ) {
+                directory = buffer_view(
+                    archive->mapped()->view().data() + header.directory_offset,
+                    directory_size);
+            } else {
+                try {
+                    directory_content.resize(directory_size);
+                } catch (...) {
+                    return false;
+                }
+                if ( !archive->read_at(
+                    math::numeric_cast<std::size_t>(header.directory_offset),
+                    directory_content.data(),
+                    directory_content.size()) )
+                {
+                    return false;
+                }
+                directory = directory_content;
+            }
+
+            // only bounds are checked, names are trusted to match their hashes
+            u32 last_hash = 0u;
+            for ( std::size_t i = 0; i < header.entry_count; ++i ) {
+                const bundles::file_entry entry = entry_at(i);
+                if ( entry.name_hash < last_hash
+                    || u64(entry.name_offset) + entry.name_size > header.names_size
+                    || entry.data_offset % bundles::data_alignment
+                    || entry.data_offset > length
+                    || entry.stored_size > length - entry.data_offset )
+                {
+                    return false;
+                }
+                if ( entry.flags & bundles::file_entry_compressed ) {
+                    if ( !entry.chunk_size
+                        || entry.chunk_count != (entry.size + entry.chunk_size - 1u) / entry.chunk_size
+                        || entry.stored_size < u64(entry.chunk_count) * sizeof(u32) )
+                    {
+                        return false;
+                    }
+                } else if ( entry.stored_size != entry.size ) {
+                    return false;
+                }
+                last_hash = entry.name_hash;
+            }
+
+            // the directory is ordered by hashes, trace needs the name order
+            try {
+                name_order.resize(header.entry_count);
+            } catch (...) {
                 return false;
             }
+            for ( std::size_t i = 0; i < name_order.size(); ++i ) {
+                name_order[i] = math::numeric_cast<u32>(i);
+            }
+            std::sort(name_order.begin(), name_order.end(), [this](u32 l, u32 r) noexcept {
+                return entry_name(entry_at(l)) < entry_name(entry_at(r));
+            });
+            return true;
         }
-        mz_uint num_files = mz_zip_reader_get_num_files(state_->archive.get());
-        for ( mz_uint i = 0; i < num_files; ++i ) {
-            mz_zip_archive_file_stat file_stat;
-            if ( mz_zip_reader_file_stat(state_->archive.get(), i, &file_stat) ) {
-                const str_view filename{file_stat.m_filename};
-                if ( filename.length() > parent.length() && filename.starts_with(parent) ) {
-                    func(file_stat.m_filename, file_stat.m_is_directory);
-                }
+    };
+
+    bundle_file_source::bundle_file_source(input_stream_uptr stream)
+    : state_(new state(std::move(stream))) {}
+    bundle_file_source::~bundle_file_source() noexcept = default;
+
+    bool bundle_file_source::valid() const noexcept {
+        return !!state_->archive;
+    }
+
+    bool bundle_file_source::exists(str_view path) const {
+        bundles::file_entry entry;
+        return state_->find_entry(path, entry);
+    }
+
+    input_stream_uptr bundle_file_source::read(str_view path) const {
+        bundles::file_entry entry;
+        if ( !state_->find_entry(path, entry)
+            || (entry.flags & bundles::file_entry_directory) )
+        {
+            return nullptr;
+        }
+        try {
+            if ( entry.flags & bundles::file_entry_compressed ) {
+                buffer content;
+                return state_->decompress_entry(entry, content)
+                    ? make_memory_stream(std::move(content))
+                    : nullptr;
+            }
+            if ( state_->archive->mapped() ) {
+                return std::make_unique<archive_view_stream>(
+                    state_->archive,
+                    math::numeric_cast<std::size_t>(entry.data_offset),
+                    math::numeric_cast<std::size_t>(entry.size));
+            }
+            return std::make_unique<archive_stored_stream>(
+                state_->archive,
+                math::numeric_cast<std::size_t>(entry.data_offset),
+                math::numeric_cast<std::size_t>(entry.size));
+        } catch (...) {
+            return nullptr;
+        }
+    }
+
+    output_stream_uptr bundle_file_source::write(str_view path, bool append) const {
+        E2D_UNUSED(path, append);
+        return nullptr;
+    }
+
+    bool bundle_file_source::trace(str_view path, filesystem::trace_func func) const {
+        str parent = make_utf8(path);
+        while ( !parent.empty() && parent.back() == '/' ) {
+            parent.pop_back();
+        }
+        if ( !parent.empty() ) {
+            bundles::file_entry dir_entry;
+            if ( !state_->find_entry(parent, dir_entry)
+                || !(dir_entry.flags & bundles::file_entry_directory) )
+            {
+                return false;
+            }
+            parent += '/';
+        }
+
+        // children share the parent prefix, so they are
+        // a contiguous range of the name ordered index
+        const auto first = std::lower_bound(
+            state_->name_order.begin(),
+            state_->name_order.end(),
+            str_view(parent),
+            [this](u32 index, str_view name) noexcept {
+                return state_->entry_name(state_->entry_at(index)) < name;
+            });
+        for ( auto iter = first; iter != state_->name_order.end(); ++iter ) {
+            const bundles::file_entry entry = state_->entry_at(*iter);
+            const str_view filename = state_->entry_name(entry);
+            if ( !filename.starts_with(parent) ) {
+                break;
+            }
+            if ( filename.length() > parent.length() ) {
+                func(filename, !!(entry.flags & bundles::file_entry_directory));
             }
         }
         return true;
     }
 
+    mapped_input_stream_uptr bundle_file_source::map(str_view path) const {
+        bundles::file_entry entry;
+        if ( !state_->find_entry(path, entry)
+            || (entry.flags & bundles::file_entry_directory) )
+        {
+            return nullptr;
+        }
+        try {
+            if ( entry.flags & bundles::file_entry_compressed ) {
+                buffer content;
+                return state_->decompress_entry(entry, content)
+                    ? make_mapped_memory_stream(std::move(content))
+                    : nullptr;
+            }
+            if ( !state_->archive->mapped() ) {
+                return file_source::map(path);
+            }
+            return std::make_unique<archive_view_stream>(
+                state_->archive,
+                math::numeric_cast<std::size_t>(entry.data_offset),
+                math::numeric_cast<std::size_t>(entry.size));
+        } catch (...) {
+            return nullptr;
+        }
+    }
+
     //
     // filesystem_file_source
     //
@@ -363,4 +1325,8 @@ namespace e2d
     bool filesystem_file_source::trace(str_view path, filesystem::trace_func func) const {
         return filesystem::trace_directory_recursive(path, func);
     }
+
+    mapped_input_stream_uptr filesystem_file_source::map(str_view path) const {
+        return make_mapped_file(path);
+    }
 }
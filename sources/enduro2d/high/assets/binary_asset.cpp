@@ -19,6 +19,14 @@ namespace
 
 namespace e2d
 {
+    const char* binary_asset::type_name() noexcept {
+        return "binary_asset";
+    }
+
+    std::size_t binary_asset::cpu_memory_usage() const noexcept {
+        return content().size();
+    }
+
     binary_asset::load_async_result binary_asset::load_async(
         library& library, str_view address)
     {
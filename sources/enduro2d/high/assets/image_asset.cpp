@@ -5,7 +5,6 @@
  ******************************************************************************/
 
 #include <enduro2d/high/assets/image_asset.hpp>
-#include <enduro2d/high/assets/binary_asset.hpp>
 
 namespace
 {
@@ -20,14 +19,23 @@ namespace
 
 namespace e2d
 {
+    const char* image_asset::type_name() noexcept {
+        return "image_asset";
+    }
+
+    std::size_t image_asset::cpu_memory_usage() const noexcept {
+        return content().data().size();
+    }
+
     image_asset::load_async_result image_asset::load_async(
         library& library, str_view address)
     {
-        return library.load_asset_async<binary_asset>(address)
-            .then([](const binary_asset::load_result& image_data){
+        const auto image_url = library.root() / address;
+        return the<vfs>().map_async(image_url)
+            .then([](const std::shared_ptr<mapped_input_stream>& image_data){
                 return the<deferrer>().do_in_worker_thread([image_data](){
                     image content;
-                    if ( !images::try_load_image(content, image_data->content()) ) {
+                    if ( !images::try_load_image(content, image_data->view()) ) {
                         throw image_asset_loading_exception();
                     }
                     return image_asset::create(std::move(content));
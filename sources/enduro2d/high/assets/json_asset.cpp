@@ -21,6 +21,10 @@ namespace
 
 namespace e2d
 {
+    const char* json_asset::type_name() noexcept {
+        return "json_asset";
+    }
+
     json_asset::load_async_result json_asset::load_async(
         library& library, str_view address)
     {
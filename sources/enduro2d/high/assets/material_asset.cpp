@@ -493,13 +493,13 @@ namespace
 
     stdex::promise<shader_ptr> parse_shader_block(
         library& library,
-        str_view parent_address,
+        str_view address,
         const rapidjson::Value& root)
     {
         E2D_ASSERT(root.IsString());
         const auto shader_address =
-            path::combine(parent_address, root.GetString());
-        return library.load_asset_async<shader_asset>(shader_address)
+            path::combine(path::parent_path(address), root.GetString());
+        return library.load_dependency_async<shader_asset>(address, shader_address)
             .then([](const shader_asset::load_result& shader){
                 return shader->content();
             });
@@ -507,13 +507,13 @@ namespace
 
     stdex::promise<texture_ptr> parse_texture_block(
         library& library,
-        str_view parent_address,
+        str_view address,
         const rapidjson::Value& root)
     {
         E2D_ASSERT(root.IsString());
         const auto texture_address =
-            path::combine(parent_address, root.GetString());
-        return library.load_asset_async<texture_asset>(texture_address)
+            path::combine(path::parent_path(address), root.GetString());
+        return library.load_dependency_async<texture_asset>(address, texture_address)
             .then([](const texture_asset::load_result& texture){
                 return texture->content();
             });
@@ -521,7 +521,7 @@ namespace
 
     stdex::promise<std::pair<str_hash,render::sampler_state>> parse_sampler_state(
         library& library,
-        str_view parent_address,
+        str_view address,
         const rapidjson::Value& root)
     {
         render::sampler_state content;
@@ -530,7 +530,7 @@ namespace
         auto name_hash = make_hash(root["name"].GetString());
 
         auto texture_p = root.HasMember("texture")
-            ? parse_texture_block(library, parent_address, root["texture"])
+            ? parse_texture_block(library, address, root["texture"])
             : stdex::make_resolved_promise<texture_ptr>(nullptr);
 
         if ( root.HasMember("wrap") ) {
@@ -670,7 +670,7 @@ namespace
 
     stdex::promise<render::property_block> parse_property_block(
         library& library,
-        str_view parent_address,
+        str_view address,
         const rapidjson::Value& root)
     {
         render::property_block content;
@@ -686,7 +686,7 @@ namespace
                 E2D_ASSERT(samplers_json[i].IsObject());
                 const auto& sampler_json = samplers_json[i];
                 samplers_p.emplace_back(
-                    parse_sampler_state(library, parent_address, sampler_json));
+                    parse_sampler_state(library, address, sampler_json));
             }
         }
 
@@ -1093,11 +1093,11 @@ namespace
 
     stdex::promise<render::pass_state> parse_pass_state(
         library& library,
-        str_view parent_address,
+        str_view address,
         const rapidjson::Value& root)
     {
         auto shader_p = root.HasMember("shader")
-            ? parse_shader_block(library, parent_address, root["shader"])
+            ? parse_shader_block(library, address, root["shader"])
             : stdex::make_resolved_promise<shader_ptr>(nullptr);
 
         auto state_block_p = root.HasMember("state_block")
@@ -1105,7 +1105,7 @@ namespace
             : stdex::make_resolved_promise<render::state_block>(render::state_block());
 
         auto property_block_p = root.HasMember("property_block")
-            ? parse_property_block(library, parent_address, root["property_block"])
+            ? parse_property_block(library, address, root["property_block"])
             : stdex::make_resolved_promise<render::property_block>(render::property_block());
 
         return stdex::make_tuple_promise(std::make_tuple(
@@ -1127,7 +1127,7 @@ namespace
 
     stdex::promise<render::material> parse_material(
         library& library,
-        str_view parent_address,
+        str_view address,
         const rapidjson::Value& root)
     {
         vector<stdex::promise<render::pass_state>> passes_p;
@@ -1141,12 +1141,12 @@ namespace
                 E2D_ASSERT(passes_json[i].IsObject());
                 const auto& pass_json = passes_json[i];
                 passes_p.emplace_back(
-                    parse_pass_state(library, parent_address, pass_json));
+                    parse_pass_state(library, address, pass_json));
             }
         }
 
         auto property_block_p = root.HasMember("property_block")
-            ? parse_property_block(library, parent_address, root["property_block"])
+            ? parse_property_block(library, address, root["property_block"])
             : stdex::make_resolved_promise(render::property_block());
 
         return stdex::make_tuple_promise(std::make_tuple(
@@ -1168,13 +1168,17 @@ namespace
 
 namespace e2d
 {
+    const char* material_asset::type_name() noexcept {
+        return "material_asset";
+    }
+
     material_asset::load_async_result material_asset::load_async(
         library& library, str_view address)
     {
         return library.load_asset_async<json_asset>(address)
             .then([
                 &library,
-                parent_address = path::parent_path(address)
+                address = str(address)
             ](const json_asset::load_result& material_data){
                 return the<deferrer>().do_in_worker_thread([material_data](){
                     const rapidjson::Document& doc = material_data->content();
@@ -1183,9 +1187,9 @@ namespace e2d
                         throw material_asset_loading_exception();
                     }
                 })
-                .then([&library, parent_address, material_data](){
+                .then([&library, address, material_data](){
                     return parse_material(
-                        library, parent_address, material_data->content());
+                        library, address, material_data->content());
                 })
                 .then([](const render::material& material){
                     return material_asset::create(material);
@@ -5,7 +5,6 @@
  ******************************************************************************/
 
 #include <enduro2d/high/assets/mesh_asset.hpp>
-#include <enduro2d/high/assets/binary_asset.hpp>
 
 namespace
 {
@@ -16,22 +15,68 @@ namespace
             return "mesh asset loading exception";
         }
     };
+
+    b3f calculate_mesh_bounds(const mesh& mesh) noexcept {
+        const vector<v3f>& vertices = mesh.vertices();
+        if ( vertices.empty() ) {
+            return b3f();
+        }
+        v3f min = vertices.front();
+        v3f max = vertices.front();
+        for ( const v3f& v : vertices ) {
+            min = math::minimized(min, v);
+            max = math::maximized(max, v);
+        }
+        return math::make_minmax_aabb(min, max);
+    }
 }
 
 namespace e2d
 {
+    mesh_asset::mesh_asset(content_type content)
+    : content_asset<mesh_asset, mesh>(std::move(content))
+    , bounds_(calculate_mesh_bounds(this->content())) {}
+
+    const char* mesh_asset::type_name() noexcept {
+        return "mesh_asset";
+    }
+
+    std::size_t mesh_asset::cpu_memory_usage() const noexcept {
+        const mesh& m = content();
+        std::size_t result =
+            m.vertices().size() * sizeof(v3f) +
+            m.normals().size() * sizeof(v3f) +
+            m.tangents().size() * sizeof(v3f) +
+            m.bitangents().size() * sizeof(v3f);
+        for ( std::size_t i = 0; i < m.uvs_channel_count(); ++i ) {
+            result += m.uvs(i).size() * sizeof(v2f);
+        }
+        for ( std::size_t i = 0; i < m.colors_channel_count(); ++i ) {
+            result += m.colors(i).size() * sizeof(color32);
+        }
+        for ( std::size_t i = 0; i < m.indices_submesh_count(); ++i ) {
+            result += m.indices(i).size() * sizeof(u32);
+        }
+        return result;
+    }
+
     mesh_asset::load_async_result mesh_asset::load_async(
         library& library, str_view address)
     {
-        return library.load_asset_async<binary_asset>(address)
-            .then([](const binary_asset::load_result& mesh_data){
+        const auto mesh_url = library.root() / address;
+        return the<vfs>().map_async(mesh_url)
+            .then([](const std::shared_ptr<mapped_input_stream>& mesh_data){
                 return the<deferrer>().do_in_worker_thread([mesh_data](){
                     mesh content;
-                    if ( !meshes::try_load_mesh(content, mesh_data->content()) ) {
+                    if ( !meshes::try_load_mesh(content, mesh_data->view()) ) {
                         throw mesh_asset_loading_exception();
                     }
                     return mesh_asset::create(std::move(content));
                 });
             });
     }
+
+    const b3f& mesh_asset::bounds() const noexcept {
+        return bounds_;
+    }
 }
@@ -52,11 +52,14 @@ namespace
 
     stdex::promise<model> parse_model(
         library& library,
-        str_view parent_address,
+        str_view address,
         const rapidjson::Value& root)
     {
+        const str parent_address = path::parent_path(address);
+
         E2D_ASSERT(root.HasMember("mesh") && root["mesh"].IsString());
-        auto mesh_p = library.load_asset_async<mesh_asset>(
+        auto mesh_p = library.load_dependency_async<mesh_asset>(
+            address,
             path::combine(parent_address, root["mesh"].GetString()));
 
         vector<stdex::promise<material_asset::load_result>> materials_p;
@@ -69,7 +72,8 @@ namespace
             for ( rapidjson::SizeType i = 0; i < materials_json.Size(); ++i ) {
                 E2D_ASSERT(materials_json[i].IsString());
                 materials_p.emplace_back(
-                    library.load_asset_async<material_asset>(
+                    library.load_dependency_async<material_asset>(
+                        address,
                         path::combine(parent_address, materials_json[i].GetString())));
             }
         }
@@ -84,7 +88,10 @@ namespace
             model content;
             content.set_mesh(std::get<0>(results));
             content.set_materials(std::get<1>(results));
-            return the<deferrer>().do_in_main_thread([
+            const std::size_t upload_bytes = content.mesh()
+                ? content.mesh()->cpu_memory_usage()
+                : 0u;
+            return the<deferrer>().do_upload_in_main_thread(upload_bytes, [
                 content = std::move(content)
             ]() mutable {
                 content.regenerate_geometry();
@@ -96,13 +103,30 @@ namespace
 
 namespace e2d
 {
+    const char* model_asset::type_name() noexcept {
+        return "model_asset";
+    }
+
+    std::size_t model_asset::gpu_memory_usage() const noexcept {
+        const render::geometry& geo = content().geometry();
+        std::size_t result = geo.indices()
+            ? geo.indices()->buffer_size()
+            : 0u;
+        for ( std::size_t i = 0; i < geo.vertices_count(); ++i ) {
+            if ( geo.vertices(i) ) {
+                result += geo.vertices(i)->buffer_size();
+            }
+        }
+        return result;
+    }
+
     model_asset::load_async_result model_asset::load_async(
         library& library, str_view address)
     {
         return library.load_asset_async<json_asset>(address)
         .then([
             &library,
-            parent_address = path::parent_path(address)
+            address = str(address)
         ](const json_asset::load_result& model_data){
             return the<deferrer>().do_in_worker_thread([model_data](){
                 const rapidjson::Document& doc = model_data->content();
@@ -111,9 +135,9 @@ namespace e2d
                     throw model_asset_loading_exception();
                 }
             })
-            .then([&library, parent_address, model_data](){
+            .then([&library, address, model_data](){
                 return parse_model(
-                    library, parent_address, model_data->content());
+                    library, address, model_data->content());
             })
             .then([](auto&& content){
                 return model_asset::create(
@@ -50,15 +50,19 @@ namespace
 
     stdex::promise<shader_ptr> parse_shader(
         library& library,
-        str_view parent_address,
+        str_view address,
         const rapidjson::Value& root)
     {
+        const str parent_address = path::parent_path(address);
+
         E2D_ASSERT(root.HasMember("vertex") && root["vertex"].IsString());
-        auto vertex_p = library.load_asset_async<text_asset>(
+        auto vertex_p = library.load_dependency_async<text_asset>(
+            address,
             path::combine(parent_address, root["vertex"].GetString()));
 
         E2D_ASSERT(root.HasMember("fragment") && root["fragment"].IsString());
-        auto fragment_p = library.load_asset_async<text_asset>(
+        auto fragment_p = library.load_dependency_async<text_asset>(
+            address,
             path::combine(parent_address, root["fragment"].GetString()));
 
         return stdex::make_tuple_promise(std::make_tuple(
@@ -83,13 +87,17 @@ namespace
 
 namespace e2d
 {
+    const char* shader_asset::type_name() noexcept {
+        return "shader_asset";
+    }
+
     shader_asset::load_async_result shader_asset::load_async(
         library& library, str_view address)
     {
         return library.load_asset_async<json_asset>(address)
             .then([
                 &library,
-                parent_address = path::parent_path(address)
+                address = str(address)
             ](const json_asset::load_result& shader_data){
                 return the<deferrer>().do_in_worker_thread([shader_data](){
                     const rapidjson::Document& doc = shader_data->content();
@@ -98,9 +106,9 @@ namespace e2d
                         throw shader_asset_loading_exception();
                     }
                 })
-                .then([&library, parent_address, shader_data](){
+                .then([&library, address, shader_data](){
                     return parse_shader(
-                        library, parent_address, shader_data->content());
+                        library, address, shader_data->content());
                 })
                 .then([](auto&& content){
                     return shader_asset::create(
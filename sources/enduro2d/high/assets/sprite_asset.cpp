@@ -5,6 +5,7 @@
  ******************************************************************************/
 
 #include <enduro2d/high/assets/sprite_asset.hpp>
+#include <enduro2d/high/texture_atlas.hpp>
 
 #include "json_asset.hpp"
 
@@ -50,11 +51,41 @@ namespace
         return *schema;
     }
 
+    using texture_with_texrect = std::pair<texture_asset::load_result, b2f>;
+
+    stdex::promise<texture_with_texrect> load_sprite_texture(
+        library& library,
+        const str& sprite_address,
+        const str& address,
+        const b2f& texrect)
+    {
+        const auto load_texture = [&library, sprite_address, address, texrect](){
+            return library.load_dependency_async<texture_asset>(sprite_address, address)
+                .then([texrect](const texture_asset::load_result& texture){
+                    return std::make_pair(texture, texrect);
+                });
+        };
+
+        if ( !modules::is_initialized<texture_atlas>() ) {
+            return load_texture();
+        }
+
+        library.add_asset_dependency(sprite_address, address);
+        return the<texture_atlas>().load_region_async(address)
+            .then([load_texture, texrect](const texture_atlas::region& region){
+                return region.page
+                    ? stdex::make_resolved_promise(std::make_pair(region.page, region.remap(texrect)))
+                    : load_texture();
+            });
+    }
+
     stdex::promise<sprite> parse_sprite(
         library& library,
-        str_view parent_address,
+        str_view address,
         const rapidjson::Value& root)
     {
+        const str parent_address = path::parent_path(address);
+
         v2f size;
         E2D_ASSERT(root.HasMember("size"));
         if ( !json_utils::try_parse_value(root["size"], size) ) {
@@ -78,14 +109,14 @@ namespace
 
         E2D_ASSERT(!root.HasMember("texture") || root["texture"].IsString());
         auto texture_p = root.HasMember("texture")
-            ? library.load_asset_async<texture_asset>(path::combine(
+            ? load_sprite_texture(library, address, path::combine(
                 parent_address,
-                root["texture"].GetString()))
-            : stdex::make_resolved_promise(texture_asset::ptr());
+                root["texture"].GetString()), texrect)
+            : stdex::make_resolved_promise(std::make_pair(texture_asset::ptr(), texrect));
 
         E2D_ASSERT(!root.HasMember("material") || root["material"].IsString());
         auto material_p = root.HasMember("material")
-            ? library.load_asset_async<material_asset>(path::combine(
+            ? library.load_dependency_async<material_asset>(address, path::combine(
                 parent_address,
                 root["material"].GetString()))
             : stdex::make_resolved_promise(material_asset::ptr());
@@ -93,15 +124,15 @@ namespace
         return stdex::make_tuple_promise(std::make_tuple(
             std::move(texture_p),
             std::move(material_p)
-        )).then([size, pivot, texrect](const std::tuple<
-            texture_asset::load_result,
+        )).then([size, pivot](const std::tuple<
+            texture_with_texrect,
             material_asset::load_result
         >& results){
             sprite content;
             content.set_size(size);
             content.set_pivot(pivot);
-            content.set_texrect(texrect);
-            content.set_texture(std::get<0>(results));
+            content.set_texrect(std::get<0>(results).second);
+            content.set_texture(std::get<0>(results).first);
             content.set_material(std::get<1>(results));
             return content;
         });
@@ -110,13 +141,17 @@ namespace
 
 namespace e2d
 {
+    const char* sprite_asset::type_name() noexcept {
+        return "sprite_asset";
+    }
+
     sprite_asset::load_async_result sprite_asset::load_async(
         library& library, str_view address)
     {
         return library.load_asset_async<json_asset>(address)
         .then([
             &library,
-            parent_address = path::parent_path(address)
+            address = str(address)
         ](const json_asset::load_result& sprite_data){
             return the<deferrer>().do_in_worker_thread([sprite_data](){
                 const rapidjson::Document& doc = sprite_data->content();
@@ -125,9 +160,9 @@ namespace e2d
                     throw sprite_asset_loading_exception();
                 }
             })
-            .then([&library, parent_address, sprite_data](){
+            .then([&library, address, sprite_data](){
                 return parse_sprite(
-                    library, parent_address, sprite_data->content());
+                    library, address, sprite_data->content());
             })
             .then([](auto&& content){
                 return sprite_asset::create(
@@ -19,6 +19,14 @@ namespace
 
 namespace e2d
 {
+    const char* text_asset::type_name() noexcept {
+        return "text_asset";
+    }
+
+    std::size_t text_asset::cpu_memory_usage() const noexcept {
+        return content().size();
+    }
+
     text_asset::load_async_result text_asset::load_async(
         library& library, str_view address)
     {
@@ -16,22 +16,187 @@ namespace
             return "texture asset loading exception";
         }
     };
+
+    struct texture_streaming {
+        texture_ptr content;
+        pixel_buffer_ptr staging;
+        u8* staging_data = nullptr;
+        v2u size;
+        image_data_format format = image_data_format::rgba8;
+        u32 mipmap_count = 1;
+        bool generate_mipmaps = false;
+        bool progressive = false;
+    };
+
+    std::size_t mipmap_offset(const texture_streaming& streaming, u32 level) noexcept {
+        return images::mipmap_chain_data_size(streaming.size, streaming.format, level);
+    }
+
+    std::size_t mipmap_bytes(const texture_streaming& streaming, u32 level) noexcept {
+        return mipmap_offset(streaming, level + 1u) - mipmap_offset(streaming, level);
+    }
+
+    void load_mipmap(const texture_streaming& streaming, u32 level) noexcept {
+        streaming.content->load_mipmap(
+            level,
+            streaming.staging,
+            mipmap_offset(streaming, level),
+            mipmap_bytes(streaming, level));
+    }
+
+    // main thread: creates the texture without level data and
+    // maps the staging buffer for the worker thread
+
+    texture_streaming begin_texture_streaming(const image& texture_data) {
+        const render::device_caps& caps = the<render>().device_capabilities();
+
+        texture_streaming streaming;
+        streaming.size = texture_data.size();
+        streaming.format = texture_data.format();
+        streaming.mipmap_count = texture_data.mipmap_count();
+        streaming.generate_mipmaps =
+            streaming.mipmap_count == 1u &&
+            !images::is_compressed_format(streaming.format) &&
+            (caps.npot_texture_supported ||
+                (math::is_power_of_2(streaming.size.x) && math::is_power_of_2(streaming.size.y)));
+        if ( streaming.generate_mipmaps ) {
+            streaming.mipmap_count = images::max_mipmap_count(streaming.size);
+        }
+        streaming.progressive = caps.texture_base_level_supported;
+
+        streaming.content = the<render>().create_streaming_texture(
+            streaming.size, streaming.format, streaming.mipmap_count);
+        streaming.staging = the<render>().create_pixel_buffer(
+            mipmap_offset(streaming, streaming.mipmap_count));
+        if ( !streaming.content || !streaming.staging ) {
+            throw texture_asset_loading_exception();
+        }
+
+        streaming.staging_data = streaming.staging->map();
+        if ( !streaming.staging_data ) {
+            throw texture_asset_loading_exception();
+        }
+        return streaming;
+    }
+
+    // worker thread: the staging buffer has the same layout as image data
+
+    texture_streaming fill_texture_streaming(
+        texture_streaming streaming,
+        const image& texture_data)
+    {
+        try {
+            image mipmaps;
+            const image* src = &texture_data;
+            if ( streaming.generate_mipmaps ) {
+                if ( !images::try_generate_mipmaps(mipmaps, texture_data) ) {
+                    throw texture_asset_loading_exception();
+                }
+                src = &mipmaps;
+            }
+            E2D_ASSERT(src->data().size() == streaming.staging->buffer_size());
+            std::memcpy(streaming.staging_data, src->data().data(), src->data().size());
+        } catch (...) {
+            // the staging buffer was mapped in the main thread,
+            // so it has to be unmapped there too
+            const pixel_buffer_ptr staging = streaming.staging;
+            the<deferrer>().do_upload_in_main_thread(0u, [staging](){
+                staging->unmap();
+            });
+            throw;
+        }
+        return streaming;
+    }
+
+    void unmap_texture_streaming(const texture_streaming& streaming) {
+        if ( !streaming.staging->unmap() ) {
+            throw texture_asset_loading_exception();
+        }
+    }
+
+    // main thread: the next larger level is queued after the previous one,
+    // so the texture gets sharper over frames within the upload budget
+
+    void stream_texture_mipmap(texture_streaming streaming, u32 level) {
+        the<deferrer>().do_upload_in_main_thread(
+            mipmap_bytes(streaming, level),
+            [streaming, level](){
+                load_mipmap(streaming, level);
+                if ( level > 0u ) {
+                    stream_texture_mipmap(streaming, level - 1u);
+                }
+            });
+    }
+
+    stdex::promise<texture_asset::load_result> finish_texture_streaming(
+        const texture_streaming& streaming)
+    {
+        // without base level support the texture is incomplete
+        // until all its levels are loaded, so load them at once
+        if ( !streaming.progressive ) {
+            return the<deferrer>().do_upload_in_main_thread(
+                streaming.staging->buffer_size(),
+                [streaming](){
+                    unmap_texture_streaming(streaming);
+                    for ( u32 level = 0; level < streaming.mipmap_count; ++level ) {
+                        load_mipmap(streaming, level);
+                    }
+                    return texture_asset::create(streaming.content);
+                });
+        }
+
+        const u32 smallest_level = streaming.mipmap_count - 1u;
+        return the<deferrer>().do_upload_in_main_thread(
+            mipmap_bytes(streaming, smallest_level),
+            [streaming, smallest_level](){
+                unmap_texture_streaming(streaming);
+                load_mipmap(streaming, smallest_level);
+                if ( smallest_level > 0u ) {
+                    stream_texture_mipmap(streaming, smallest_level - 1u);
+                }
+                return texture_asset::create(streaming.content);
+            });
+    }
 }
 
 namespace e2d
 {
+    const char* texture_asset::type_name() noexcept {
+        return "texture_asset";
+    }
+
+    // counts the full mipmap chain, streamed levels are not loaded
+    // yet when the asset gets to the cache, but they will be
+    std::size_t texture_asset::gpu_memory_usage() const noexcept {
+        if ( !content() ) {
+            return 0u;
+        }
+        std::size_t result = 0u;
+        const v2u& size = content()->size();
+        for ( u32 level = 0; level < content()->mipmap_count(); ++level ) {
+            const v2u level_size = math::maximized(
+                v2u(size.x >> level, size.y >> level),
+                v2u::unit());
+            result += std::size_t(level_size.x) * level_size.y * content()->decl().bits_per_pixel() / 8u;
+        }
+        return result;
+    }
+
     texture_asset::load_async_result texture_asset::load_async(
         library& library, str_view address)
     {
         return library.load_asset_async<image_asset>(address)
             .then([](const image_asset::load_result& texture_data){
-                return the<deferrer>().do_in_main_thread([texture_data](){
-                    const texture_ptr content = the<render>().create_texture(
-                        texture_data->content());
-                    if ( !content ) {
-                        throw texture_asset_loading_exception();
-                    }
-                    return texture_asset::create(content);
+                return the<deferrer>().do_upload_in_main_thread(0u, [texture_data](){
+                    return begin_texture_streaming(texture_data->content());
+                })
+                .then([texture_data](const texture_streaming& streaming){
+                    return the<deferrer>().do_in_worker_thread([texture_data, streaming](){
+                        return fill_texture_streaming(streaming, texture_data->content());
+                    });
+                })
+                .then([](const texture_streaming& streaming){
+                    return finish_texture_streaming(streaming);
                 });
             });
     }
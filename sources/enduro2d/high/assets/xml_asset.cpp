@@ -21,6 +21,10 @@ namespace
 
 namespace e2d
 {
+    const char* xml_asset::type_name() noexcept {
+        return "xml_asset";
+    }
+
     xml_asset::load_async_result xml_asset::load_async(
         library& library, str_view address)
     {
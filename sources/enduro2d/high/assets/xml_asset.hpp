@@ -15,6 +15,7 @@ namespace e2d
     class xml_asset final : public content_asset<xml_asset, pugi::xml_document> {
     public:
         using content_asset<xml_asset, pugi::xml_document>::content_asset;
+        static const char* type_name() noexcept;
         static load_async_result load_async(library& library, str_view address);
     };
 }
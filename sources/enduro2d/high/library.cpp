@@ -6,9 +6,62 @@
 
 #include <enduro2d/high/library.hpp>
 
+#include <3rdparty/rapidjson/document.h>
+#include <3rdparty/rapidjson/stringbuffer.h>
+#include <3rdparty/rapidjson/writer.h>
+
 namespace
 {
     using namespace e2d;
+
+    void add_unique_value(vector<str>& values, str_view value) {
+        if ( values.end() == std::find(values.begin(), values.end(), value) ) {
+            values.emplace_back(value);
+        }
+    }
+
+    bool try_parse_strings(const rapidjson::Value& root, vector<str>& dst) {
+        if ( !root.IsArray() ) {
+            return false;
+        }
+        for ( rapidjson::SizeType i = 0; i < root.Size(); ++i ) {
+            if ( !root[i].IsString() ) {
+                return false;
+            }
+            add_unique_value(dst, str_view(root[i].GetString(), root[i].GetStringLength()));
+        }
+        return true;
+    }
+
+    template < typename Writer >
+    void write_strings(Writer& writer, const vector<str>& values) {
+        writer.StartArray();
+        for ( const str& value : values ) {
+            writer.String(value.c_str(), math::numeric_cast<rapidjson::SizeType>(value.size()));
+        }
+        writer.EndArray();
+    }
+}
+
+namespace e2d
+{
+    //
+    // library::dependency_graph
+    //
+    // addresses with types they have been loaded as
+    // and addresses of assets they depend on
+    //
+
+    class library::dependency_graph final : private e2d::noncopyable {
+    public:
+        struct asset_node {
+            vector<str> types;
+            vector<str> dependencies;
+        };
+    public:
+        mutable std::mutex mutex;
+        hash_map<str, asset_node> nodes;
+    };
 }
 
 namespace e2d
@@ -18,7 +71,8 @@ namespace e2d
     //
 
     library::library(const url& root)
-    : root_(root) {}
+    : root_(root)
+    , dependencies_(new dependency_graph()) {}
 
     library::~library() noexcept = default;
 
@@ -30,10 +84,242 @@ namespace e2d
         return asset_cache_base::unload_all_unused_assets();
     }
 
+    stdex::promise<std::size_t> library::prefetch(const vector<str>& addresses) {
+        // dependencies are collected in post-order,
+        // so leaves are requested before their parents
+        vector<std::pair<str, str>> loads;
+        {
+            std::lock_guard<std::mutex> guard(dependencies_->mutex);
+            hash_set<str> visited;
+            vector<std::pair<str, std::size_t>> stack;
+            for ( const str& address : addresses ) {
+                if ( !visited.insert(address).second ) {
+                    continue;
+                }
+                stack.emplace_back(address, 0u);
+                while ( !stack.empty() ) {
+                    const auto iter = dependencies_->nodes.find(stack.back().first);
+                    if ( iter == dependencies_->nodes.end() ) {
+                        stack.pop_back();
+                        continue;
+                    }
+                    const vector<str>& dependencies = iter->second.dependencies;
+                    if ( stack.back().second < dependencies.size() ) {
+                        const str& dependency = dependencies[stack.back().second++];
+                        if ( visited.insert(dependency).second ) {
+                            stack.emplace_back(dependency, 0u);
+                        }
+                        continue;
+                    }
+                    for ( const str& type : iter->second.types ) {
+                        loads.emplace_back(iter->first, type);
+                    }
+                    stack.pop_back();
+                }
+            }
+        }
+
+        // assets without caches are only parsers of their dependencies
+        hash_map<str, vector<asset_cache_base*>> caches;
+        vector<stdex::promise<void>> results;
+        results.reserve(loads.size());
+        for ( const auto& load : loads ) {
+            auto iter = caches.find(load.second);
+            if ( iter == caches.end() ) {
+                iter = caches.emplace(
+                    load.second,
+                    asset_cache_base::find_caches(load.second)).first;
+            }
+            for ( asset_cache_base* cache : iter->second ) {
+                results.push_back(cache->prefetch_asset(load.first));
+            }
+        }
+
+        if ( results.empty() ) {
+            return stdex::make_resolved_promise(std::size_t(0u));
+        }
+
+        struct prefetch_state {
+            std::atomic<std::size_t> left{0u};
+            std::atomic<std::size_t> loaded{0u};
+            stdex::promise<std::size_t> result;
+        };
+
+        auto state = std::make_shared<prefetch_state>();
+        state->left = results.size();
+        const auto finish_one = [state](){
+            if ( 1u == state->left.fetch_sub(1u) ) {
+                state->result.resolve(state->loaded.load());
+            }
+        };
+
+        for ( auto& result : results ) {
+            result.then([state, finish_one](){
+                ++state->loaded;
+                finish_one();
+            }, [finish_one](std::exception_ptr){
+                finish_one();
+            });
+        }
+
+        return state->result;
+    }
+
+    vector<str> library::asset_types(str_view address) const {
+        std::lock_guard<std::mutex> guard(dependencies_->mutex);
+        const auto iter = dependencies_->nodes.find(address);
+        return iter != dependencies_->nodes.end()
+            ? iter->second.types
+            : vector<str>();
+    }
+
+    vector<str> library::asset_dependencies(str_view address) const {
+        std::lock_guard<std::mutex> guard(dependencies_->mutex);
+        const auto iter = dependencies_->nodes.find(address);
+        return iter != dependencies_->nodes.end()
+            ? iter->second.dependencies
+            : vector<str>();
+    }
+
+    bool library::load_dependency_manifest(const url& manifest_url) {
+        str manifest_data;
+        if ( !the<vfs>().load_as_string(manifest_url, manifest_data) ) {
+            return false;
+        }
+
+        rapidjson::Document doc;
+        if ( doc.Parse(manifest_data.c_str()).HasParseError()
+            || !doc.IsObject()
+            || !doc.HasMember("assets")
+            || !doc["assets"].IsArray() )
+        {
+            return false;
+        }
+
+        hash_map<str, dependency_graph::asset_node> nodes;
+        const rapidjson::Value& assets_json = doc["assets"];
+        for ( rapidjson::SizeType i = 0; i < assets_json.Size(); ++i ) {
+            const rapidjson::Value& asset_json = assets_json[i];
+            if ( !asset_json.IsObject()
+                || !asset_json.HasMember("address")
+                || !asset_json["address"].IsString() )
+            {
+                return false;
+            }
+            dependency_graph::asset_node& node = nodes[asset_json["address"].GetString()];
+            if ( asset_json.HasMember("types")
+                && !try_parse_strings(asset_json["types"], node.types) )
+            {
+                return false;
+            }
+            if ( asset_json.HasMember("dependencies")
+                && !try_parse_strings(asset_json["dependencies"], node.dependencies) )
+            {
+                return false;
+            }
+        }
+
+        std::lock_guard<std::mutex> guard(dependencies_->mutex);
+        for ( const auto& node : nodes ) {
+            dependency_graph::asset_node& dst = dependencies_->nodes[node.first];
+            for ( const str& type : node.second.types ) {
+                add_unique_value(dst.types, type);
+            }
+            for ( const str& dependency : node.second.dependencies ) {
+                add_unique_value(dst.dependencies, dependency);
+            }
+        }
+        return true;
+    }
+
+    bool library::save_dependency_manifest(const url& manifest_url) const {
+        rapidjson::StringBuffer manifest_data;
+        {
+            rapidjson::Writer<rapidjson::StringBuffer> writer(manifest_data);
+            std::lock_guard<std::mutex> guard(dependencies_->mutex);
+
+            // sorted by addresses to keep manifests diffable
+            vector<const std::pair<const str, dependency_graph::asset_node>*> nodes;
+            nodes.reserve(dependencies_->nodes.size());
+            for ( const auto& node : dependencies_->nodes ) {
+                nodes.push_back(&node);
+            }
+            std::sort(nodes.begin(), nodes.end(), [](auto l, auto r){
+                return l->first < r->first;
+            });
+
+            writer.StartObject();
+            writer.Key("assets");
+            writer.StartArray();
+            for ( const auto* node : nodes ) {
+                writer.StartObject();
+                writer.Key("address");
+                writer.String(
+                    node->first.c_str(),
+                    math::numeric_cast<rapidjson::SizeType>(node->first.size()));
+                writer.Key("types");
+                write_strings(writer, node->second.types);
+                writer.Key("dependencies");
+                write_strings(writer, node->second.dependencies);
+                writer.EndObject();
+            }
+            writer.EndArray();
+            writer.EndObject();
+        }
+
+        const output_stream_uptr stream = the<vfs>().write(manifest_url, false);
+        return stream && output_sequence(*stream)
+            .write(manifest_data.GetString(), manifest_data.GetSize())
+            .flush()
+            .success();
+    }
+
+    void library::add_asset_type_(str_view address, str_view type) {
+        std::lock_guard<std::mutex> guard(dependencies_->mutex);
+        add_unique_value(dependencies_->nodes[address].types, type);
+    }
+
+    // a failed load forgets the address as the type, the address
+    // itself is forgotten with its edges if it has no types left
+    void library::remove_asset_type_(str_view address, str_view type) {
+        std::lock_guard<std::mutex> guard(dependencies_->mutex);
+        const auto iter = dependencies_->nodes.find(address);
+        if ( iter == dependencies_->nodes.end() ) {
+            return;
+        }
+        vector<str>& types = iter->second.types;
+        types.erase(
+            std::remove(types.begin(), types.end(), type),
+            types.end());
+        if ( types.empty() ) {
+            dependencies_->nodes.erase(iter);
+        }
+    }
+
+    void library::add_asset_dependency(str_view parent_address, str_view address) {
+        std::lock_guard<std::mutex> guard(dependencies_->mutex);
+        add_unique_value(dependencies_->nodes[parent_address].dependencies, address);
+    }
+
+    //
+    // content_asset_base
+    //
+
+    std::size_t content_asset_base::cpu_memory_usage() const noexcept {
+        return 0u;
+    }
+
+    std::size_t content_asset_base::gpu_memory_usage() const noexcept {
+        return 0u;
+    }
+
     //
     // asset_cache_base
     //
 
+    std::atomic<std::size_t> asset_cache_base::global_cpu_budget_{0u};
+    std::atomic<std::size_t> asset_cache_base::global_gpu_budget_{0u};
+    std::atomic<u64> asset_cache_base::use_tick_{0u};
     std::mutex asset_cache_base::mutex_;
     hash_set<asset_cache_base*> asset_cache_base::caches_;
 
@@ -47,6 +333,27 @@ namespace e2d
         caches_.erase(this);
     }
 
+    vector<asset_cache_base*> asset_cache_base::all_caches() {
+        std::lock_guard<std::mutex> guard(mutex_);
+        vector<asset_cache_base*> result(caches_.begin(), caches_.end());
+        std::sort(result.begin(), result.end(),
+            [](const asset_cache_base* l, const asset_cache_base* r) noexcept {
+                return std::strcmp(l->asset_type_name(), r->asset_type_name()) < 0;
+            });
+        return result;
+    }
+
+    vector<asset_cache_base*> asset_cache_base::find_caches(str_view asset_type) {
+        std::lock_guard<std::mutex> guard(mutex_);
+        vector<asset_cache_base*> result;
+        for ( asset_cache_base* cache : caches_ ) {
+            if ( asset_type == cache->asset_type_name() ) {
+                result.push_back(cache);
+            }
+        }
+        return result;
+    }
+
     std::size_t asset_cache_base::unload_all_unused_assets() noexcept {
         std::lock_guard<std::mutex> guard(mutex_);
         return std::accumulate( caches_.begin(), caches_.end(), std::size_t(0),
@@ -54,4 +361,128 @@ namespace e2d
                 return acc + cache->unload_self_unused_assets();
             });
     }
+
+    void asset_cache_base::global_memory_budget(const asset_memory_usage& budget) noexcept {
+        global_cpu_budget_ = budget.cpu_bytes;
+        global_gpu_budget_ = budget.gpu_bytes;
+    }
+
+    asset_memory_usage asset_cache_base::global_memory_budget() noexcept {
+        asset_memory_usage result;
+        result.cpu_bytes = global_cpu_budget_;
+        result.gpu_bytes = global_gpu_budget_;
+        return result;
+    }
+
+    asset_memory_usage asset_cache_base::global_memory_usage() noexcept {
+        std::lock_guard<std::mutex> guard(mutex_);
+        asset_memory_usage result;
+        for ( const asset_cache_base* cache : caches_ ) {
+            const asset_memory_usage usage = cache->memory_usage();
+            result.cpu_bytes += usage.cpu_bytes;
+            result.gpu_bytes += usage.gpu_bytes;
+        }
+        return result;
+    }
+
+    std::size_t asset_cache_base::evict_all_over_budget_assets() {
+        std::lock_guard<std::mutex> guard(mutex_);
+        std::size_t result = 0u;
+        for ( asset_cache_base* cache : caches_ ) {
+            result += cache->evict_self_over_budget_assets();
+        }
+        // evicted assets can release their dependencies,
+        // so repeat while something has been evicted
+        vector<eviction_candidate> candidates;
+        while ( true ) {
+            asset_memory_usage usage;
+            candidates.clear();
+            for ( asset_cache_base* cache : caches_ ) {
+                const asset_memory_usage cache_usage = cache->memory_usage();
+                usage.cpu_bytes += cache_usage.cpu_bytes;
+                usage.gpu_bytes += cache_usage.gpu_bytes;
+                cache->collect_eviction_candidates(candidates);
+            }
+            u64 last_use = 0u;
+            if ( !find_eviction_cutoff_(candidates, usage, global_memory_budget(), last_use) ) {
+                break;
+            }
+            std::size_t evicted = 0u;
+            for ( asset_cache_base* cache : caches_ ) {
+                evicted += cache->evict_unused_assets_until(last_use);
+            }
+            if ( !evicted ) {
+                break;
+            }
+            result += evicted;
+        }
+        return result;
+    }
+
+    void asset_cache_base::memory_budget(const asset_memory_usage& budget) noexcept {
+        cpu_budget_ = budget.cpu_bytes;
+        gpu_budget_ = budget.gpu_bytes;
+    }
+
+    asset_memory_usage asset_cache_base::memory_budget() const noexcept {
+        asset_memory_usage result;
+        result.cpu_bytes = cpu_budget_;
+        result.gpu_bytes = gpu_budget_;
+        return result;
+    }
+
+    std::size_t asset_cache_base::evict_self_over_budget_assets() {
+        std::size_t result = 0u;
+        vector<eviction_candidate> candidates;
+        while ( true ) {
+            candidates.clear();
+            collect_eviction_candidates(candidates);
+            u64 last_use = 0u;
+            if ( !find_eviction_cutoff_(candidates, memory_usage(), memory_budget(), last_use) ) {
+                break;
+            }
+            const std::size_t evicted = evict_unused_assets_until(last_use);
+            if ( !evicted ) {
+                break;
+            }
+            result += evicted;
+        }
+        return result;
+    }
+
+    u64 asset_cache_base::next_use_tick() noexcept {
+        return ++use_tick_;
+    }
+
+    bool asset_cache_base::find_eviction_cutoff_(
+        vector<eviction_candidate>& candidates,
+        const asset_memory_usage& usage,
+        const asset_memory_usage& budget,
+        u64& last_use) noexcept
+    {
+        const auto within_budget = [&budget](const asset_memory_usage& u) noexcept {
+            return (!budget.cpu_bytes || u.cpu_bytes <= budget.cpu_bytes)
+                && (!budget.gpu_bytes || u.gpu_bytes <= budget.gpu_bytes);
+        };
+
+        if ( within_budget(usage) || candidates.empty() ) {
+            return false;
+        }
+
+        std::sort(candidates.begin(), candidates.end(),
+            [](const eviction_candidate& l, const eviction_candidate& r) noexcept {
+                return l.last_use < r.last_use;
+            });
+
+        asset_memory_usage left = usage;
+        for ( const eviction_candidate& candidate : candidates ) {
+            left.cpu_bytes -= math::min(left.cpu_bytes, candidate.usage.cpu_bytes);
+            left.gpu_bytes -= math::min(left.gpu_bytes, candidate.usage.gpu_bytes);
+            last_use = candidate.last_use;
+            if ( within_budget(left) ) {
+                break;
+            }
+        }
+        return true;
+    }
 }
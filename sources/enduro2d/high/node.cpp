@@ -6,6 +6,8 @@
 
 #include <enduro2d/high/node.hpp>
 #include <enduro2d/high/world.hpp>
+#include <enduro2d/high/spatial_index.hpp>
+#include <enduro2d/high/transform_pass.hpp>
 
 namespace e2d
 {
@@ -88,18 +90,32 @@ namespace e2d
         return transform_.scale;
     }
 
-    const m4f& node::local_matrix() const noexcept {
+    const a3f& node::local_affine() const noexcept {
+        if ( transform_pass_ ) {
+            return transform_pass_->local_affine_(*this);
+        }
         if ( math::check_and_clear_any_flags(flags_, fm_dirty_local_matrix) ) {
             update_local_matrix_();
         }
-        return local_matrix_;
+        return local_affine_;
     }
 
-    const m4f& node::world_matrix() const noexcept {
+    const a3f& node::world_affine() const noexcept {
+        if ( transform_pass_ ) {
+            return transform_pass_->world_affine_(*this);
+        }
         if ( math::check_and_clear_any_flags(flags_, fm_dirty_world_matrix) ) {
             update_world_matrix_();
         }
-        return world_matrix_;
+        return world_affine_;
+    }
+
+    m4f node::local_matrix() const noexcept {
+        return math::make_affine_matrix4(local_affine());
+    }
+
+    m4f node::world_matrix() const noexcept {
+        return math::make_affine_matrix4(world_affine());
     }
 
     node_iptr node::root() noexcept {
@@ -179,6 +195,10 @@ namespace e2d
         return count;
     }
 
+    u32 node::hierarchy_version() const noexcept {
+        return hierarchy_version_;
+    }
+
     bool node::add_child(const node_iptr& child) noexcept {
         return add_child_to_front(child);
     }
@@ -198,7 +218,10 @@ namespace e2d
         child->remove_from_parent();
         children_.push_front(*child);
         child->parent_ = this;
+        child->join_spatial_index_(spatial_index_);
+        child->join_transform_pass_(transform_pass_);
         child->mark_dirty_world_matrix_();
+        mark_dirty_hierarchy_();
         return true;
     }
 
@@ -217,7 +240,10 @@ namespace e2d
         child->remove_from_parent();
         children_.push_back(*child);
         child->parent_ = this;
+        child->join_spatial_index_(spatial_index_);
+        child->join_transform_pass_(transform_pass_);
         child->mark_dirty_world_matrix_();
+        mark_dirty_hierarchy_();
         return true;
     }
 
@@ -239,7 +265,10 @@ namespace e2d
             node_children::iterator_to(*before),
             *child);
         child->parent_ = this;
+        child->join_spatial_index_(spatial_index_);
+        child->join_transform_pass_(transform_pass_);
         child->mark_dirty_world_matrix_();
+        mark_dirty_hierarchy_();
         return true;
     }
 
@@ -261,7 +290,10 @@ namespace e2d
             ++node_children::iterator_to(*after),
             *child);
         child->parent_ = this;
+        child->join_spatial_index_(spatial_index_);
+        child->join_transform_pass_(transform_pass_);
         child->mark_dirty_world_matrix_();
+        mark_dirty_hierarchy_();
         return true;
     }
 
@@ -285,9 +317,12 @@ namespace e2d
             node_children::iterator_to(*child),
             [](node* n){
                 n->parent_ = nullptr;
+                n->leave_spatial_index_();
+                n->leave_transform_pass_();
                 n->mark_dirty_world_matrix_();
                 intrusive_ptr_release(n);
             });
+        mark_dirty_hierarchy_();
         return true;
     }
 
@@ -390,14 +425,86 @@ namespace e2d
 
 namespace e2d
 {
+    void node::mark_dirty_hierarchy_() noexcept {
+        for ( node* n = this; n; n = n->parent_ ) {
+            ++n->hierarchy_version_;
+        }
+    }
+
     void node::mark_dirty_local_matrix_() noexcept {
         if ( math::check_and_set_any_flags(flags_, fm_dirty_local_matrix) ) {
             mark_dirty_world_matrix_();
         }
     }
 
+    void node::join_spatial_index_(spatial_index* index) noexcept {
+        if ( !index || spatial_index_ ) {
+            return;
+        }
+        spatial_index_ = index;
+        spatial_index_->on_join_(this);
+        for ( node& child : children_ ) {
+            child.join_spatial_index_(index);
+        }
+    }
+
+    void node::leave_spatial_index_() noexcept {
+        if ( !spatial_index_ || spatial_index_->root_.get() == this ) {
+            return;
+        }
+        for ( node& child : children_ ) {
+            child.leave_spatial_index_();
+        }
+        spatial_index_->on_leave_(this);
+        spatial_index_ = nullptr;
+    }
+
+    void node::join_transform_pass_(transform_pass* pass) noexcept {
+        if ( !pass || transform_pass_ ) {
+            return;
+        }
+        transform_pass_ = pass;
+        transform_pass_->on_join_(this);
+        for ( node& child : children_ ) {
+            child.join_transform_pass_(pass);
+        }
+    }
+
+    void node::leave_transform_pass_() noexcept {
+        if ( !transform_pass_ || transform_pass_->root_.get() == this ) {
+            return;
+        }
+        for ( node& child : children_ ) {
+            child.leave_transform_pass_();
+        }
+        transform_pass_->on_leave_(this);
+        transform_pass_ = nullptr;
+        transform_index_ = std::numeric_limits<u32>::max();
+        // the matrices of the node are in the pass arrays
+        flags_ |= fm_dirty_local_matrix;
+        if ( math::check_and_set_any_flags(flags_, fm_dirty_world_matrix) && spatial_index_ ) {
+            spatial_index_->on_moved_(this);
+        }
+        for ( node& child : children_ ) {
+            child.mark_dirty_world_matrix_();
+        }
+    }
+
     void node::mark_dirty_world_matrix_() noexcept {
+        if ( transform_pass_ ) {
+            // descendants are updated by the next sweep of the pass
+            if ( math::check_and_set_any_flags(flags_, fm_dirty_world_matrix) ) {
+                transform_pass_->on_moved_(this);
+                if ( spatial_index_ ) {
+                    spatial_index_->on_moved_(this);
+                }
+            }
+            return;
+        }
         if ( math::check_and_set_any_flags(flags_, fm_dirty_world_matrix) ) {
+            if ( spatial_index_ ) {
+                spatial_index_->on_moved_(this);
+            }
             for ( node& child : children_ ) {
                 child.mark_dirty_world_matrix_();
             }
@@ -405,12 +512,12 @@ namespace e2d
     }
 
     void node::update_local_matrix_() const noexcept {
-        local_matrix_ = math::make_trs_matrix4(transform_);
+        local_affine_ = math::make_trs_affine3(transform_);
     }
 
     void node::update_world_matrix_() const noexcept {
-        world_matrix_ = parent_
-            ? parent_->world_matrix() * local_matrix()
-            : local_matrix();
+        world_affine_ = parent_
+            ? parent_->world_affine() * local_affine()
+            : local_affine();
     }
 }
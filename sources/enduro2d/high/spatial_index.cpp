@@ -0,0 +1,459 @@
+/*******************************************************************************
+ * This file is part of the "Enduro2D"
+ * For conditions of distribution and use, see copyright notice in LICENSE.md
+ * Copyright (C) 2018 Matvey Cherevko
+ ******************************************************************************/
+
+#include <enduro2d/high/spatial_index.hpp>
+#include <enduro2d/high/transform_pass.hpp>
+
+#include <enduro2d/high/components/model_renderer.hpp>
+#include <enduro2d/high/components/sprite_renderer.hpp>
+
+namespace
+{
+    using namespace e2d;
+
+    void expand_bounds(v3f& min, v3f& max, const v3f& p) noexcept {
+        min = math::minimized(min, p);
+        max = math::maximized(max, p);
+    }
+
+    void expand_bounds(v3f& min, v3f& max, const v3f& lmin, const v3f& lmax, const a3f& m) noexcept {
+        const v3f corners[] = {
+            math::transform_point(v3f(lmin.x, lmin.y, lmin.z), m),
+            math::transform_point(v3f(lmax.x, lmin.y, lmin.z), m),
+            math::transform_point(v3f(lmin.x, lmax.y, lmin.z), m),
+            math::transform_point(v3f(lmax.x, lmax.y, lmin.z), m),
+            math::transform_point(v3f(lmin.x, lmin.y, lmax.z), m),
+            math::transform_point(v3f(lmax.x, lmin.y, lmax.z), m),
+            math::transform_point(v3f(lmin.x, lmax.y, lmax.z), m),
+            math::transform_point(v3f(lmax.x, lmax.y, lmax.z), m)};
+        for ( const v3f& p : corners ) {
+            expand_bounds(min, max, p);
+        }
+    }
+
+    // world bounds of the node renderers or
+    // the node world position if it has no renderers
+    void calculate_world_bounds(const node& n, v3f& min, v3f& max) noexcept {
+        const a3f& m = n.world_affine();
+        min = v3f(std::numeric_limits<f32>::max());
+        max = v3f(std::numeric_limits<f32>::lowest());
+
+        ecs::const_entity e = n.entity();
+        if ( e.alive() ) {
+            const sprite_renderer* spr_r = e.find_component<sprite_renderer>();
+            if ( spr_r && spr_r->sprite() ) {
+                const sprite& spr = spr_r->sprite()->content();
+                const v2f lmin = -spr.size() * spr.pivot();
+                const v2f lmax = lmin + spr.size();
+                expand_bounds(min, max, v3f(lmin, 0.f), v3f(lmax, 0.f), m);
+            }
+            const model_renderer* mdl_r = e.find_component<model_renderer>();
+            if ( mdl_r && mdl_r->model() && mdl_r->model()->content().mesh() ) {
+                const b3f& mb = mdl_r->model()->content().mesh()->bounds();
+                expand_bounds(min, max, mb.position, mb.position + mb.size, m);
+            }
+        }
+
+        if ( min.x > max.x ) {
+            min = max = m[3];
+        }
+    }
+
+    f32 bounds_cost(const v3f& min, const v3f& max) noexcept {
+        const v3f d = max - min;
+        return d.x + d.y + d.z;
+    }
+
+    f32 merged_bounds_cost(const v3f& min1, const v3f& max1, const v3f& min2, const v3f& max2) noexcept {
+        return bounds_cost(
+            math::minimized(min1, min2),
+            math::maximized(max1, max2));
+    }
+}
+
+namespace e2d
+{
+    spatial_index::spatial_index(const node_iptr& root, f32 margin)
+    : root_(root)
+    , margin_(margin)
+    {
+        if ( !root || root->spatial_index_ ) {
+            throw bad_spatial_index_operation();
+        }
+        root->join_spatial_index_(this);
+    }
+
+    spatial_index::~spatial_index() noexcept {
+        const auto detach = [this](node& n, const auto& self) noexcept -> void {
+            if ( n.spatial_index_ != this ) {
+                return;
+            }
+            n.spatial_index_ = nullptr;
+            n.spatial_proxy_ = null_proxy;
+            for ( node& child : n.children_ ) {
+                self(child, self);
+            }
+        };
+        moved_.clear_and_dispose([](node* n) noexcept {
+            n->flags_ &= ~node::fm_spatial_moved;
+        });
+        detach(*root_, detach);
+    }
+
+    node_iptr spatial_index::root() noexcept {
+        return root_;
+    }
+
+    const_node_iptr spatial_index::root() const noexcept {
+        return root_;
+    }
+
+    void spatial_index::update() {
+        // world matrices are updated before the loop, transform passes
+        // report moved descendants to the back of the list
+        for ( const node& n : moved_ ) {
+            if ( n.transform_pass_ ) {
+                n.transform_pass_->update();
+            } else {
+                n.world_affine();
+            }
+        }
+
+        while ( !moved_.empty() ) {
+            node* n = &moved_.front();
+            moved_.pop_front();
+            n->flags_ &= ~node::fm_spatial_moved;
+
+            v3f min, max;
+            calculate_world_bounds(*n, min, max);
+
+            if ( n->spatial_proxy_ != null_proxy ) {
+                const tree_node& tn = nodes_[n->spatial_proxy_];
+                if ( min.x >= tn.min.x && min.y >= tn.min.y && min.z >= tn.min.z &&
+                     max.x <= tn.max.x && max.y <= tn.max.y && max.z <= tn.max.z )
+                {
+                    continue;
+                }
+                remove_leaf_(n->spatial_proxy_);
+            } else {
+                n->spatial_proxy_ = allocate_proxy_();
+                ++leaf_count_;
+            }
+
+            tree_node& tn = nodes_[n->spatial_proxy_];
+            tn.min = min - v3f(margin_);
+            tn.max = max + v3f(margin_);
+            tn.data = n;
+            tn.height = 0;
+            insert_leaf_(n->spatial_proxy_);
+        }
+    }
+
+    void spatial_index::invalidate(const node_iptr& node) {
+        if ( node && node->spatial_index_ == this ) {
+            on_moved_(node.get());
+        }
+    }
+
+    std::size_t spatial_index::node_count() const noexcept {
+        return leaf_count_;
+    }
+
+    std::size_t spatial_index::pending_count() const noexcept {
+        return moved_.size();
+    }
+
+    std::size_t spatial_index::tree_height() const noexcept {
+        return root_proxy_ != null_proxy
+            ? math::numeric_cast<std::size_t>(nodes_[root_proxy_].height) + 1u
+            : 0u;
+    }
+
+    bool spatial_index::find_bounds(const const_node_iptr& node, b3f& result) const noexcept {
+        if ( !node || node->spatial_index_ != this || node->spatial_proxy_ == null_proxy ) {
+            return false;
+        }
+        const tree_node& tn = nodes_[node->spatial_proxy_];
+        result = math::make_minmax_aabb(tn.min, tn.max);
+        return true;
+    }
+
+    void spatial_index::cull_frustum(const m4f& view_proj) {
+        if ( ++visible_stamp_ == 0u ) {
+            for ( tree_node& tn : nodes_ ) {
+                tn.visible_stamp = 0u;
+            }
+            visible_stamp_ = 1u;
+        }
+        query_frustum(view_proj, [this](node& n) noexcept {
+            nodes_[n.spatial_proxy_].visible_stamp = visible_stamp_;
+        });
+    }
+
+    bool spatial_index::is_visible(const node& node) const noexcept {
+        if ( node.spatial_index_ != this || node.spatial_proxy_ == null_proxy ) {
+            return true;
+        }
+        return nodes_[node.spatial_proxy_].visible_stamp == visible_stamp_;
+    }
+
+    spatial_index* spatial_index::find(const const_node_iptr& root) noexcept {
+        return root && root->spatial_index_ && root->spatial_index_->root_.get() == root.get()
+            ? root->spatial_index_
+            : nullptr;
+    }
+
+    void spatial_index::on_join_(node* n) noexcept {
+        on_moved_(n);
+    }
+
+    void spatial_index::on_leave_(node* n) noexcept {
+        if ( n->flags_ & node::fm_spatial_moved ) {
+            moved_.erase(node_spatial_moved::iterator_to(*n));
+            n->flags_ &= ~node::fm_spatial_moved;
+        }
+        if ( n->spatial_proxy_ != null_proxy ) {
+            remove_leaf_(n->spatial_proxy_);
+            free_proxy_(n->spatial_proxy_);
+            n->spatial_proxy_ = null_proxy;
+            --leaf_count_;
+        }
+    }
+
+    // intrusive list of moved nodes, so the noexcept node
+    // mutators that report here never allocate
+    void spatial_index::on_moved_(node* n) noexcept {
+        if ( math::check_and_set_any_flags(n->flags_, node::fm_spatial_moved) ) {
+            moved_.push_back(*n);
+        }
+    }
+
+    u32 spatial_index::allocate_proxy_() {
+        if ( free_list_ == null_proxy ) {
+            nodes_.emplace_back();
+            return math::numeric_cast<u32>(nodes_.size() - 1u);
+        }
+        const u32 proxy = free_list_;
+        free_list_ = nodes_[proxy].parent;
+        nodes_[proxy] = tree_node();
+        return proxy;
+    }
+
+    void spatial_index::free_proxy_(u32 proxy) noexcept {
+        nodes_[proxy] = tree_node();
+        nodes_[proxy].parent = free_list_;
+        free_list_ = proxy;
+    }
+
+    void spatial_index::insert_leaf_(u32 leaf) {
+        if ( root_proxy_ == null_proxy ) {
+            root_proxy_ = leaf;
+            nodes_[leaf].parent = null_proxy;
+            return;
+        }
+
+        // find the best sibling by the perimeter heuristic
+        const v3f leaf_min = nodes_[leaf].min;
+        const v3f leaf_max = nodes_[leaf].max;
+
+        u32 index = root_proxy_;
+        while ( !nodes_[index].is_leaf() ) {
+            const tree_node& tn = nodes_[index];
+            const tree_node& c1 = nodes_[tn.child1];
+            const tree_node& c2 = nodes_[tn.child2];
+
+            const f32 area = bounds_cost(tn.min, tn.max);
+            const f32 combined_area = merged_bounds_cost(tn.min, tn.max, leaf_min, leaf_max);
+
+            const f32 cost = 2.f * combined_area;
+            const f32 inheritance_cost = 2.f * (combined_area - area);
+
+            const f32 cost1 = merged_bounds_cost(c1.min, c1.max, leaf_min, leaf_max)
+                - (c1.is_leaf() ? 0.f : bounds_cost(c1.min, c1.max))
+                + inheritance_cost;
+
+            const f32 cost2 = merged_bounds_cost(c2.min, c2.max, leaf_min, leaf_max)
+                - (c2.is_leaf() ? 0.f : bounds_cost(c2.min, c2.max))
+                + inheritance_cost;
+
+            if ( cost < cost1 && cost < cost2 ) {
+                break;
+            }
+
+            index = cost1 < cost2 ? tn.child1 : tn.child2;
+        }
+
+        const u32 sibling = index;
+        const u32 old_parent = nodes_[sibling].parent;
+        const u32 new_parent = allocate_proxy_();
+
+        tree_node& np = nodes_[new_parent];
+        np.parent = old_parent;
+        np.min = math::minimized(leaf_min, nodes_[sibling].min);
+        np.max = math::maximized(leaf_max, nodes_[sibling].max);
+        np.height = nodes_[sibling].height + 1;
+        np.child1 = sibling;
+        np.child2 = leaf;
+        nodes_[sibling].parent = new_parent;
+        nodes_[leaf].parent = new_parent;
+
+        if ( old_parent != null_proxy ) {
+            if ( nodes_[old_parent].child1 == sibling ) {
+                nodes_[old_parent].child1 = new_parent;
+            } else {
+                nodes_[old_parent].child2 = new_parent;
+            }
+        } else {
+            root_proxy_ = new_parent;
+        }
+
+        // refit the ancestors
+        index = nodes_[leaf].parent;
+        while ( index != null_proxy ) {
+            index = balance_(index);
+            tree_node& tn = nodes_[index];
+            const tree_node& c1 = nodes_[tn.child1];
+            const tree_node& c2 = nodes_[tn.child2];
+            tn.height = 1 + math::max(c1.height, c2.height);
+            tn.min = math::minimized(c1.min, c2.min);
+            tn.max = math::maximized(c1.max, c2.max);
+            index = tn.parent;
+        }
+    }
+
+    void spatial_index::remove_leaf_(u32 leaf) noexcept {
+        if ( leaf == root_proxy_ ) {
+            root_proxy_ = null_proxy;
+            return;
+        }
+
+        const u32 parent = nodes_[leaf].parent;
+        const u32 grand_parent = nodes_[parent].parent;
+        const u32 sibling = nodes_[parent].child1 == leaf
+            ? nodes_[parent].child2
+            : nodes_[parent].child1;
+
+        if ( grand_parent != null_proxy ) {
+            if ( nodes_[grand_parent].child1 == parent ) {
+                nodes_[grand_parent].child1 = sibling;
+            } else {
+                nodes_[grand_parent].child2 = sibling;
+            }
+            nodes_[sibling].parent = grand_parent;
+            free_proxy_(parent);
+
+            u32 index = grand_parent;
+            while ( index != null_proxy ) {
+                index = balance_(index);
+                tree_node& tn = nodes_[index];
+                const tree_node& c1 = nodes_[tn.child1];
+                const tree_node& c2 = nodes_[tn.child2];
+                tn.height = 1 + math::max(c1.height, c2.height);
+                tn.min = math::minimized(c1.min, c2.min);
+                tn.max = math::maximized(c1.max, c2.max);
+                index = tn.parent;
+            }
+        } else {
+            root_proxy_ = sibling;
+            nodes_[sibling].parent = null_proxy;
+            free_proxy_(parent);
+        }
+
+        nodes_[leaf].parent = null_proxy;
+    }
+
+    u32 spatial_index::balance_(u32 ia) noexcept {
+        tree_node& a = nodes_[ia];
+        if ( a.is_leaf() || a.height < 2 ) {
+            return ia;
+        }
+
+        const u32 ib = a.child1;
+        const u32 ic = a.child2;
+        tree_node& b = nodes_[ib];
+        tree_node& c = nodes_[ic];
+
+        const i32 balance = c.height - b.height;
+
+        // rotate c up
+        if ( balance > 1 ) {
+            const u32 i_f = c.child1;
+            const u32 i_g = c.child2;
+            tree_node& f = nodes_[i_f];
+            tree_node& g = nodes_[i_g];
+
+            c.child1 = ia;
+            c.parent = a.parent;
+            a.parent = ic;
+
+            if ( c.parent != null_proxy ) {
+                if ( nodes_[c.parent].child1 == ia ) {
+                    nodes_[c.parent].child1 = ic;
+                } else {
+                    nodes_[c.parent].child2 = ic;
+                }
+            } else {
+                root_proxy_ = ic;
+            }
+
+            tree_node& up = f.height > g.height ? f : g;
+            tree_node& down = f.height > g.height ? g : f;
+            const u32 i_up = f.height > g.height ? i_f : i_g;
+            const u32 i_down = f.height > g.height ? i_g : i_f;
+
+            c.child2 = i_up;
+            a.child2 = i_down;
+            down.parent = ia;
+            a.min = math::minimized(b.min, down.min);
+            a.max = math::maximized(b.max, down.max);
+            c.min = math::minimized(a.min, up.min);
+            c.max = math::maximized(a.max, up.max);
+            a.height = 1 + math::max(b.height, down.height);
+            c.height = 1 + math::max(a.height, up.height);
+            return ic;
+        }
+
+        // rotate b up
+        if ( balance < -1 ) {
+            const u32 i_d = b.child1;
+            const u32 i_e = b.child2;
+            tree_node& d = nodes_[i_d];
+            tree_node& e = nodes_[i_e];
+
+            b.child1 = ia;
+            b.parent = a.parent;
+            a.parent = ib;
+
+            if ( b.parent != null_proxy ) {
+                if ( nodes_[b.parent].child1 == ia ) {
+                    nodes_[b.parent].child1 = ib;
+                } else {
+                    nodes_[b.parent].child2 = ib;
+                }
+            } else {
+                root_proxy_ = ib;
+            }
+
+            tree_node& up = d.height > e.height ? d : e;
+            tree_node& down = d.height > e.height ? e : d;
+            const u32 i_up = d.height > e.height ? i_d : i_e;
+            const u32 i_down = d.height > e.height ? i_e : i_d;
+
+            b.child2 = i_up;
+            a.child1 = i_down;
+            down.parent = ia;
+            a.min = math::minimized(c.min, down.min);
+            a.max = math::maximized(c.max, down.max);
+            b.min = math::minimized(a.min, up.min);
+            b.max = math::maximized(a.max, up.max);
+            a.height = 1 + math::max(c.height, down.height);
+            b.height = 1 + math::max(a.height, up.height);
+            return ib;
+        }
+
+        return ia;
+    }
+}
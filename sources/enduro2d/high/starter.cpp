@@ -20,6 +20,7 @@
 #include <enduro2d/high/assets/texture_asset.hpp>
 
 #include <enduro2d/high/systems/render_system.hpp>
+#include <enduro2d/high/systems/transform_system.hpp>
 
 namespace
 {
@@ -32,6 +33,17 @@ namespace
         }
     }
 
+    void show_asset_memory_counters(dbgui& d) {
+        const asset_memory_usage total = asset_cache_base::global_memory_usage();
+        d.counter("assets cpu kb", total.cpu_bytes / 1024u);
+        d.counter("assets gpu kb", total.gpu_bytes / 1024u);
+        for ( const asset_cache_base* cache : asset_cache_base::all_caches() ) {
+            const asset_memory_usage usage = cache->memory_usage();
+            d.counter(strings::rformat("%0 cpu kb", cache->asset_type_name()), usage.cpu_bytes / 1024u);
+            d.counter(strings::rformat("%0 gpu kb", cache->asset_type_name()), usage.gpu_bytes / 1024u);
+        }
+    }
+
     class starter_application final : public application {
     public:
         starter_application(high_application_uptr application)
@@ -39,6 +51,7 @@ namespace
 
         bool initialize() final {
             ecs::registry_filler(the<world>().registry())
+                .system<transform_system>(world::priority_pre_render)
                 .system<render_system>(world::priority_render);
             return !high_application_ || high_application_->initialize();
         }
@@ -53,8 +66,14 @@ namespace
             the<world>().registry().process_systems_in_range(
                 world::priority_update_section_begin,
                 world::priority_update_section_end);
-            return !the<window>().should_close()
+            const bool result = !the<window>().should_close()
                 || (high_application_ && !high_application_->on_should_close());
+            asset_cache_base::evict_all_over_budget_assets();
+            // the counters are formatted per cache, skip them while hidden
+            if ( modules::is_initialized<dbgui>() && the<dbgui>().visible() ) {
+                show_asset_memory_counters(the<dbgui>());
+            }
+            return result;
         }
 
         void frame_render() final {
@@ -101,6 +120,21 @@ namespace e2d
         return *this;
     }
 
+    starter::parameters& starter::parameters::use_texture_atlas(bool value) {
+        use_texture_atlas_ = value;
+        return *this;
+    }
+
+    starter::parameters& starter::parameters::texture_atlas_params(const texture_atlas::parameters& value) {
+        texture_atlas_params_ = value;
+        return *this;
+    }
+
+    starter::parameters& starter::parameters::asset_memory_budget(const asset_memory_usage& value) {
+        asset_memory_budget_ = value;
+        return *this;
+    }
+
     url& starter::parameters::library_root() noexcept {
         return library_root_;
     }
@@ -109,6 +143,18 @@ namespace e2d
         return engine_params_;
     }
 
+    bool& starter::parameters::use_texture_atlas() noexcept {
+        return use_texture_atlas_;
+    }
+
+    texture_atlas::parameters& starter::parameters::texture_atlas_params() noexcept {
+        return texture_atlas_params_;
+    }
+
+    asset_memory_usage& starter::parameters::asset_memory_budget() noexcept {
+        return asset_memory_budget_;
+    }
+
     const url& starter::parameters::library_root() const noexcept {
         return library_root_;
     }
@@ -117,6 +163,18 @@ namespace e2d
         return engine_params_;
     }
 
+    const bool& starter::parameters::use_texture_atlas() const noexcept {
+        return use_texture_atlas_;
+    }
+
+    const texture_atlas::parameters& starter::parameters::texture_atlas_params() const noexcept {
+        return texture_atlas_params_;
+    }
+
+    const asset_memory_usage& starter::parameters::asset_memory_budget() const noexcept {
+        return asset_memory_budget_;
+    }
+
     //
     // starter
     //
@@ -133,11 +191,16 @@ namespace e2d
         safe_module_initialize<asset_cache<sprite_asset>>(the<library>());
         safe_module_initialize<asset_cache<text_asset>>(the<library>());
         safe_module_initialize<asset_cache<texture_asset>>(the<library>());
+        if ( params.use_texture_atlas() ) {
+            safe_module_initialize<texture_atlas>(the<library>(), params.texture_atlas_params());
+        }
         safe_module_initialize<world>();
+        asset_cache_base::global_memory_budget(params.asset_memory_budget());
     }
 
     starter::~starter() noexcept {
         modules::shutdown<world>();
+        modules::shutdown<texture_atlas>();
         modules::shutdown<asset_cache<texture_asset>>();
         modules::shutdown<asset_cache<text_asset>>();
         modules::shutdown<asset_cache<sprite_asset>>();
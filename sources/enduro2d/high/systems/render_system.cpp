@@ -9,6 +9,7 @@
 #include <enduro2d/high/components/actor.hpp>
 #include <enduro2d/high/components/camera.hpp>
 #include <enduro2d/high/components/scene.hpp>
+#include <enduro2d/high/spatial_index.hpp>
 
 #include "render_system_impl/render_system_base.hpp"
 #include "render_system_impl/render_system_batcher.hpp"
@@ -19,39 +20,24 @@ namespace
     using namespace e2d;
     using namespace e2d::render_system_impl;
 
-    template < typename F >
-    void for_each_by_nodes(const const_node_iptr& root, F&& f) {
-        static vector<const_node_iptr> temp_nodes;
-        try {
-            if ( root ) {
-                root->extract_all_nodes(std::back_inserter(temp_nodes));
-                for ( const const_node_iptr& node : temp_nodes ) {
-                    f(node);
-                }
-            }
-        } catch (...) {
-            temp_nodes.clear();
-            throw;
-        }
-        temp_nodes.clear();
-    }
-
+    // components are sorted by pointers to the registry ones,
+    // so their caches are filled in place, not on temporary copies
     template < typename T, typename Comp, typename F >
     void for_each_by_sorted_components(ecs::registry& owner, Comp&& comp, F&& f) {
-        static vector<std::pair<ecs::const_entity,T>> temp_components;
+        static vector<std::pair<ecs::const_entity,const T*>> temp_components;
         try {
             temp_components.reserve(owner.component_count<T>());
             owner.for_each_component<T>([](const ecs::const_entity& e, const T& t){
-                temp_components.emplace_back(e, t);
+                temp_components.emplace_back(e, &t);
             });
             std::sort(
                 temp_components.begin(),
                 temp_components.end(),
                 [&comp](const auto& l, const auto& r){
-                    return comp(l.second, r.second);
+                    return comp(*l.second, *r.second);
                 });
             for ( auto& p : temp_components ) {
-                f(p.first, p.second);
+                f(p.first, *p.second);
             }
         } catch (...) {
             temp_components.clear();
@@ -65,9 +51,25 @@ namespace
             return l.depth() < r.depth();
         };
         const auto func = [&ctx](const ecs::const_entity&, const scene& scn) {
-            for_each_by_nodes(scn.root(), [&ctx](const const_node_iptr& node){
-                ctx.draw(node);
-            });
+            ctx.layer(scn.depth());
+            spatial_index* index = spatial_index::find(scn.root());
+            if ( !index ) {
+                for ( const node* n : scn.draw_list() ) {
+                    ctx.draw(*n);
+                }
+                return;
+            }
+            // scenes with a spatial index are culled by its tree,
+            // the draw list keeps the scene order of the visible nodes
+            index->update();
+            index->cull_frustum(ctx.view_proj());
+            for ( const node* n : scn.draw_list() ) {
+                if ( index->is_visible(*n) ) {
+                    ctx.draw(*n);
+                } else {
+                    ctx.cull(*n);
+                }
+            }
         };
         for_each_by_sorted_components<scene>(owner, comp, func);
     }
@@ -100,10 +102,36 @@ namespace e2d
         ~internal_state() noexcept = default;
 
         void process(ecs::registry& owner) {
-            for_all_cameras(drawer_, owner);
+            drawer_.reset_statistics();
+            try {
+                for_all_cameras(drawer_, owner);
+            } catch (...) {
+                drawer_.end_frame();
+                throw;
+            }
+            drawer_.end_frame();
+
+            const drawer::statistics stats = drawer_.current_statistics();
+            statistics_.batch_count = stats.batch_count;
+            statistics_.saved_batch_count = stats.saved_batch_count;
+            statistics_.visible_count = stats.visible_count;
+            statistics_.culled_count = stats.culled_count;
+
+            if ( modules::is_initialized<dbgui>() ) {
+                dbgui& d = the<dbgui>();
+                d.counter("render_system batches", stats.batch_count);
+                d.counter("render_system saved batches", stats.saved_batch_count);
+                d.counter("render_system visible", stats.visible_count);
+                d.counter("render_system culled", stats.culled_count);
+            }
+        }
+
+        const frame_statistics& last_frame_statistics() const noexcept {
+            return statistics_;
         }
     private:
         drawer drawer_;
+        frame_statistics statistics_;
     };
 
     //
@@ -117,4 +145,8 @@ namespace e2d
     void render_system::process(ecs::registry& owner) {
         state_->process(owner);
     }
+
+    const render_system::frame_statistics& render_system::last_frame_statistics() const noexcept {
+        return state_->last_frame_statistics();
+    }
 }
@@ -44,4 +44,20 @@ namespace e2d { namespace render_system_impl
                 .add_attribute<color32>("a_tint").normalized();
         }
     };
+
+    struct vertex_v3f_t2f_c32b_s1f {
+        struct type {
+            v3f v;
+            v2f t;
+            color32 c;
+            f32 s;
+        };
+        static vertex_declaration decl() noexcept {
+            return vertex_declaration()
+                .add_attribute<v3f>("a_vertex")
+                .add_attribute<v2f>("a_st")
+                .add_attribute<color32>("a_tint").normalized()
+                .add_attribute<f32>("a_texture_slot");
+        }
+    };
 }}
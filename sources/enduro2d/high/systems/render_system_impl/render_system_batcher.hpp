@@ -25,47 +25,161 @@ namespace e2d { namespace render_system_impl
         using index_type = typename Index::type;
         using vertex_type = typename Vertex::type;
 
-        batcher(debug& debug, render& render);
+        static constexpr std::size_t max_texture_slots = 8u;
+        static constexpr std::size_t max_quad_count = std::numeric_limits<index_type>::max() / 4u;
+
+        struct statistics {
+            std::size_t batch_count = 0;
+            std::size_t saved_batch_count = 0;
+        };
+
+        batcher(debug& debug, render& render, render_queue& queue);
 
         void batch(
+            u8 layer,
+            f32 depth,
             const material_asset::ptr& material,
             const render::property_block& properties,
             const index_type* indices, std::size_t index_count,
             const vertex_type* vertices, std::size_t vertex_count);
 
+        // reserves 'quad_count' quads for the caller to fill in place,
+        // end_quads() takes the number of filled ones. quads have their
+        // own vertex stream drawn with a static quad index buffer, so
+        // they never upload indices and are split into draw calls of
+        // 'max_quad_count' quads instead of flushing the batcher
+        vertex_type* begin_quads(
+            u8 layer,
+            f32 depth,
+            const material_asset::ptr& material,
+            const render::property_block& properties,
+            std::size_t quad_count);
+
+        // textures are bound to "u_texture0".."u_textureN" samplers,
+        // 'texture_slot' takes the slot of the texture in the batch
+        // for the caller to write into the filled vertices
+        vertex_type* begin_quads(
+            u8 layer,
+            f32 depth,
+            const material_asset::ptr& material,
+            const render::property_block& properties,
+            const render::sampler_state& texture,
+            std::size_t texture_slots,
+            std::size_t quad_count,
+            std::size_t& texture_slot);
+
+        void end_quads(std::size_t quad_count);
+
+        // uploads the batches to their own buffers and enqueues them,
+        // the buffers are kept until recycle_buffers() is called once
+        // per frame after all the queued commands of the frame are executed
         void flush();
         void clear() noexcept;
+        void recycle_buffers() noexcept;
+
+        const statistics& current_statistics() const noexcept;
+        void reset_statistics() noexcept;
+
+        // two triangles per quad of four consecutive vertices,
+        // the content of the static quad index buffer
+        static void generate_quad_indices(index_type* dst, std::size_t quad_count) noexcept;
     private:
+        // buffers of one flush, they are not overwritten
+        // until the buffers are recycled
+        struct buffer_set {
+            index_buffer_ptr indices;
+            vertex_buffer_ptr vertices;
+            vector<vertex_buffer_ptr> quad_vertices;
+        };
+    private:
+        void reserve_vertices_(std::size_t vertex_count);
+        void prepare_batch_(
+            u8 layer,
+            f32 depth,
+            const material_asset::ptr& material,
+            const render::property_block& properties,
+            bool quads);
+        std::size_t prepare_batch_(
+            u8 layer,
+            f32 depth,
+            const material_asset::ptr& material,
+            const render::property_block& properties,
+            const render::sampler_state& texture,
+            std::size_t texture_slots,
+            bool quads);
+        vertex_type* begin_quads_(std::size_t quad_count);
+        bool is_batching_available_(
+            u8 layer,
+            const material_asset::ptr& material,
+            const render::property_block& properties,
+            std::size_t texture_slots,
+            bool quads) const noexcept;
+        std::size_t next_batch_start_(bool quads) const noexcept;
+        void append_(
+            const index_type* indices, std::size_t index_count,
+            const vertex_type* vertices, std::size_t vertex_count);
         void update_buffers_();
         void render_buffers_();
         void update_index_buffer_();
-        void update_vertex_buffer_();
+        void update_quad_buffers_();
+        void acquire_buffer_set_();
+        buffer_set& current_buffer_set_() noexcept;
+        void update_vertex_buffer_(
+            vertex_buffer_ptr& vb,
+            const vertex_type* vertices,
+            std::size_t vertex_count);
+        void create_quad_index_buffer_();
     private:
+        // start and count are in indices, or in quads for quad batches
         struct batch_type {
             std::size_t start{0u};
             std::size_t count{0u};
+            bool quads{false};
+            u8 layer{0u};
+            f32 depth{0.f};
+            u32 sequence{0u};
             material_asset::ptr material;
             render::property_block properties;
+            std::size_t texture_slots{0u};
+            std::size_t texture_count{0u};
+            std::size_t last_texture{0u};
+            std::array<render::sampler_state, max_texture_slots> textures;
 
             batch_type(
                 std::size_t nstart,
+                bool nquads,
+                u8 nlayer,
+                f32 ndepth,
+                u32 nsequence,
                 const material_asset::ptr& nmaterial,
                 const render::property_block& nproperties)
             : start(nstart)
+            , quads(nquads)
+            , layer(nlayer)
+            , depth(ndepth)
+            , sequence(nsequence)
             , material(nmaterial)
             , properties(nproperties) {}
         };
     private:
         debug& debug_;
         render& render_;
+        render_queue& queue_;
         vector<batch_type> batches_;
         vector<index_type> indices_;
         vector<vertex_type> vertices_;
+        vector<vertex_type> quad_vertices_;
+        std::size_t quads_start_{0u};
         index_declaration index_decl_;
         vertex_declaration vertex_decl_;
-        index_buffer_ptr index_buffer_;
-        vertex_buffer_ptr vertex_buffer_;
+        render::buffer_streaming streaming_;
+        std::size_t buffer_index_{0u};
+        std::size_t used_buffer_sets_{0u};
+        std::array<vector<buffer_set>, 3> buffer_sets_;
+        index_buffer_ptr quad_index_buffer_;
+        statistics statistics_;
     private:
+        static str_hash texture_slot_sampler_hash(std::size_t slot) noexcept;
         static std::size_t calculate_new_buffer_size(
             std::size_t esize, std::size_t osize, std::size_t nsize);
     };
@@ -74,17 +188,21 @@ namespace e2d { namespace render_system_impl
 namespace e2d { namespace render_system_impl
 {
     template < typename Index, typename Vertex >
-    batcher<Index, Vertex>::batcher(debug& debug, render& render)
+    batcher<Index, Vertex>::batcher(debug& debug, render& render, render_queue& queue)
     : debug_(debug)
     , render_(render)
+    , queue_(queue)
     , index_decl_(Index::decl())
-    , vertex_decl_(Vertex::decl()) {
+    , vertex_decl_(Vertex::decl())
+    , streaming_(render.device_capabilities().buffer_streaming_strategy) {
         E2D_ASSERT(sizeof(index_type) == index_decl_.bytes_per_index());
         E2D_ASSERT(sizeof(vertex_type) == vertex_decl_.bytes_per_vertex());
     }
 
     template < typename Index, typename Vertex >
     void batcher<Index, Vertex>::batch(
+        u8 layer,
+        f32 depth,
         const material_asset::ptr& material,
         const render::property_block& properties,
         const index_type* indices, std::size_t index_count,
@@ -94,55 +212,81 @@ namespace e2d { namespace render_system_impl
         E2D_ASSERT(indices || !index_count);
         E2D_ASSERT(vertices || !vertex_count);
 
-        const std::size_t max_vertex_count = std::numeric_limits<index_type>::max();
+        reserve_vertices_(vertex_count);
 
-        if ( vertex_count > max_vertex_count ) {
-            throw bad_batcher_operation();
+        try {
+            prepare_batch_(layer, depth, material, properties, false);
+            append_(indices, index_count, vertices, vertex_count);
+        } catch (...) {
+            clear();
+            throw;
         }
+    }
 
-        if ( max_vertex_count - vertices_.size() < vertex_count ) {
-            flush();
-        }
+    template < typename Index, typename Vertex >
+    typename batcher<Index, Vertex>::vertex_type* batcher<Index, Vertex>::begin_quads(
+        u8 layer,
+        f32 depth,
+        const material_asset::ptr& material,
+        const render::property_block& properties,
+        std::size_t quad_count)
+    {
+        E2D_ASSERT(material);
 
         try {
-            const bool batching_available =
-                !batches_.empty() &&
-                (batches_.back().material == material || batches_.back().material->content() == material->content()) &&
-                batches_.back().properties == properties;
-
-            if ( !batching_available ) {
-                const std::size_t start = batches_.empty()
-                    ? 0u
-                    : batches_.back().start + batches_.back().count;
-                batches_.emplace_back(start, material, properties);
-            }
+            prepare_batch_(layer, depth, material, properties, true);
+            return begin_quads_(quad_count);
+        } catch (...) {
+            clear();
+            throw;
+        }
+    }
 
-            if ( indices && index_count ) {
-                auto iter = indices_.insert(
-                    indices_.end(),
-                    indices, indices + index_count);
-                std::transform(
-                    iter, indices_.end(), iter,
-                    [add = vertices_.size()](index_type v) noexcept {
-                        return static_cast<index_type>(v + add);
-                    });
-                batches_.back().count += index_count;
-            }
+    template < typename Index, typename Vertex >
+    typename batcher<Index, Vertex>::vertex_type* batcher<Index, Vertex>::begin_quads(
+        u8 layer,
+        f32 depth,
+        const material_asset::ptr& material,
+        const render::property_block& properties,
+        const render::sampler_state& texture,
+        std::size_t texture_slots,
+        std::size_t quad_count,
+        std::size_t& texture_slot)
+    {
+        E2D_ASSERT(material);
+        E2D_ASSERT(texture_slots > 0u && texture_slots <= max_texture_slots);
 
-            if ( vertices && vertex_count ) {
-                vertices_.insert(
-                    vertices_.end(),
-                    vertices, vertices + vertex_count);
-            }
+        try {
+            texture_slot = prepare_batch_(
+                layer, depth, material, properties, texture, texture_slots, true);
+            return begin_quads_(quad_count);
         } catch (...) {
             clear();
             throw;
         }
     }
 
+    template < typename Index, typename Vertex >
+    void batcher<Index, Vertex>::end_quads(std::size_t quad_count) {
+        E2D_ASSERT(!batches_.empty() && batches_.back().quads);
+        E2D_ASSERT(quads_start_ + quad_count * 4u <= quad_vertices_.size());
+
+        quad_vertices_.resize(quads_start_ + quad_count * 4u);
+        batches_.back().count += quad_count;
+
+        if ( !batches_.back().count ) {
+            batches_.pop_back();
+        }
+    }
+
     template < typename Index, typename Vertex >
     void batcher<Index, Vertex>::flush() {
+        if ( batches_.empty() ) {
+            clear();
+            return;
+        }
         try {
+            acquire_buffer_set_();
             update_buffers_();
             render_buffers_();
         } catch (...) {
@@ -157,51 +301,262 @@ namespace e2d { namespace render_system_impl
         batches_.clear();
         indices_.clear();
         vertices_.clear();
+        quad_vertices_.clear();
     }
 
     template < typename Index, typename Vertex >
-    void batcher<Index, Vertex>::update_buffers_() {
-        update_index_buffer_();
-        update_vertex_buffer_();
+    void batcher<Index, Vertex>::recycle_buffers() noexcept {
+        used_buffer_sets_ = 0u;
+        if ( streaming_ == render::buffer_streaming::triple_buffering ) {
+            buffer_index_ = (buffer_index_ + 1u) % buffer_sets_.size();
+        }
     }
 
     template < typename Index, typename Vertex >
-    void batcher<Index, Vertex>::render_buffers_() {
-        if ( !index_buffer_ || !vertex_buffer_ ) {
-            return;
+    const typename batcher<Index, Vertex>::statistics&
+    batcher<Index, Vertex>::current_statistics() const noexcept {
+        return statistics_;
+    }
+
+    template < typename Index, typename Vertex >
+    void batcher<Index, Vertex>::reset_statistics() noexcept {
+        statistics_ = statistics();
+    }
+
+    template < typename Index, typename Vertex >
+    void batcher<Index, Vertex>::generate_quad_indices(
+        index_type* dst,
+        std::size_t quad_count) noexcept
+    {
+        E2D_ASSERT(quad_count <= max_quad_count);
+        for ( std::size_t i = 0; i < quad_count; ++i ) {
+            const std::size_t v = i * 4u;
+            dst[i * 6u + 0u] = static_cast<index_type>(v + 0u);
+            dst[i * 6u + 1u] = static_cast<index_type>(v + 1u);
+            dst[i * 6u + 2u] = static_cast<index_type>(v + 2u);
+            dst[i * 6u + 3u] = static_cast<index_type>(v + 2u);
+            dst[i * 6u + 4u] = static_cast<index_type>(v + 3u);
+            dst[i * 6u + 5u] = static_cast<index_type>(v + 0u);
+        }
+    }
+
+    template < typename Index, typename Vertex >
+    void batcher<Index, Vertex>::reserve_vertices_(std::size_t vertex_count) {
+        const std::size_t max_vertex_count = std::numeric_limits<index_type>::max();
+
+        if ( vertex_count > max_vertex_count ) {
+            throw bad_batcher_operation();
+        }
+
+        if ( max_vertex_count - vertices_.size() < vertex_count ) {
+            flush();
         }
+    }
+
+    template < typename Index, typename Vertex >
+    void batcher<Index, Vertex>::prepare_batch_(
+        u8 layer,
+        f32 depth,
+        const material_asset::ptr& material,
+        const render::property_block& properties,
+        bool quads)
+    {
+        if ( !is_batching_available_(layer, material, properties, 0u, quads) ) {
+            batches_.emplace_back(
+                next_batch_start_(quads), quads, layer, depth,
+                queue_.next_sequence(), material, properties);
+        }
+    }
+
+    template < typename Index, typename Vertex >
+    std::size_t batcher<Index, Vertex>::prepare_batch_(
+        u8 layer,
+        f32 depth,
+        const material_asset::ptr& material,
+        const render::property_block& properties,
+        const render::sampler_state& texture,
+        std::size_t texture_slots,
+        bool quads)
+    {
+        std::size_t slot = 0u;
+        bool batching_available = is_batching_available_(
+            layer, material, properties, texture_slots, quads);
+
+        if ( batching_available ) {
+            batch_type& last = batches_.back();
+            const auto first = last.textures.begin();
+            const auto last_used = first + last.texture_count;
+            const auto iter = std::find(first, last_used, texture);
+            if ( iter != last_used ) {
+                slot = math::numeric_cast<std::size_t>(std::distance(first, iter));
+            } else if ( last.texture_count < last.texture_slots ) {
+                slot = last.texture_count++;
+                last.textures[slot] = texture;
+            } else {
+                batching_available = false;
+            }
+        }
+
+        if ( !batching_available ) {
+            batches_.emplace_back(
+                next_batch_start_(quads), quads, layer, depth,
+                queue_.next_sequence(), material, properties);
+            batches_.back().texture_slots = texture_slots;
+            batches_.back().texture_count = 1u;
+            batches_.back().textures[0] = texture;
+        } else if ( batches_.back().last_texture != slot ) {
+            // a texture switch that would have started a new batch
+            ++statistics_.saved_batch_count;
+        }
+        batches_.back().last_texture = slot;
+        return slot;
+    }
+
+    template < typename Index, typename Vertex >
+    typename batcher<Index, Vertex>::vertex_type* batcher<Index, Vertex>::begin_quads_(
+        std::size_t quad_count)
+    {
+        quads_start_ = quad_vertices_.size();
+        quad_vertices_.resize(quads_start_ + quad_count * 4u);
+        return quad_vertices_.data() + quads_start_;
+    }
+
+    template < typename Index, typename Vertex >
+    bool batcher<Index, Vertex>::is_batching_available_(
+        u8 layer,
+        const material_asset::ptr& material,
+        const render::property_block& properties,
+        std::size_t texture_slots,
+        bool quads) const noexcept
+    {
+        // nothing else may be enqueued between merged draws,
+        // otherwise their scene order would be lost
+        return !batches_.empty()
+            && batches_.back().sequence + 1u == queue_.sequence()
+            && batches_.back().quads == quads
+            && batches_.back().layer == layer
+            && batches_.back().texture_slots == texture_slots
+            && (batches_.back().material == material || batches_.back().material->content() == material->content())
+            && batches_.back().properties == properties;
+    }
+
+    template < typename Index, typename Vertex >
+    std::size_t batcher<Index, Vertex>::next_batch_start_(bool quads) const noexcept {
+        return quads
+            ? quad_vertices_.size() / 4u
+            : indices_.size();
+    }
+
+    template < typename Index, typename Vertex >
+    void batcher<Index, Vertex>::append_(
+        const index_type* indices, std::size_t index_count,
+        const vertex_type* vertices, std::size_t vertex_count)
+    {
+        if ( indices && index_count ) {
+            auto iter = indices_.insert(
+                indices_.end(),
+                indices, indices + index_count);
+            std::transform(
+                iter, indices_.end(), iter,
+                [add = vertices_.size()](index_type v) noexcept {
+                    return static_cast<index_type>(v + add);
+                });
+            batches_.back().count += index_count;
+        }
+
+        if ( vertices && vertex_count ) {
+            vertices_.insert(
+                vertices_.end(),
+                vertices, vertices + vertex_count);
+        }
+    }
 
-        const auto geo = render::geometry()
-            .indices(index_buffer_)
-            .add_vertices(vertex_buffer_);
+    template < typename Index, typename Vertex >
+    void batcher<Index, Vertex>::update_buffers_() {
+        if ( !indices_.empty() ) {
+            update_index_buffer_();
+            update_vertex_buffer_(
+                current_buffer_set_().vertices,
+                vertices_.data(),
+                vertices_.size());
+        }
+        update_quad_buffers_();
+    }
 
-        for ( const batch_type& batch : batches_ ) {
+    template < typename Index, typename Vertex >
+    void batcher<Index, Vertex>::render_buffers_() {
+        const buffer_set& set = current_buffer_set_();
+        const index_buffer_ptr& ib = set.indices;
+        const vertex_buffer_ptr& vb = set.vertices;
+        const vector<vertex_buffer_ptr>& quad_vbs = set.quad_vertices;
+
+        for ( batch_type& batch : batches_ ) {
+            for ( std::size_t i = 0; i < batch.texture_count; ++i ) {
+                batch.properties.sampler(
+                    texture_slot_sampler_hash(i),
+                    batch.textures[i]);
+            }
             const render::material& mat = batch.material->content();
-            render_.execute(render::draw_command(mat, geo, batch.properties)
-                .index_range(batch.start, batch.count));
+            const auto key = render_queue::make_key(
+                batch.layer, mat, batch.properties, batch.depth, batch.sequence);
+
+            if ( !batch.quads ) {
+                if ( ib && vb && batch.count ) {
+                    queue_.enqueue(key, render::draw_command(
+                        mat,
+                        render::geometry().indices(ib).add_vertices(vb),
+                        batch.properties
+                    ).index_range(batch.start, batch.count));
+                    ++statistics_.batch_count;
+                }
+                continue;
+            }
+
+            // the static index buffer addresses one page of quad vertices,
+            // so a batch crossing a page boundary is drawn in parts
+            const std::size_t last = batch.start + batch.count;
+            for ( std::size_t first = batch.start; first < last; ) {
+                const std::size_t page = first / max_quad_count;
+                const std::size_t page_first = first % max_quad_count;
+                const std::size_t count = math::min(
+                    last - first,
+                    max_quad_count - page_first);
+                if ( quad_index_buffer_ && page < quad_vbs.size() && quad_vbs[page] ) {
+                    queue_.enqueue(key, render::draw_command(
+                        mat,
+                        render::geometry().indices(quad_index_buffer_).add_vertices(quad_vbs[page]),
+                        batch.properties
+                    ).index_range(page_first * 6u, count * 6u));
+                    ++statistics_.batch_count;
+                }
+                first += count;
+            }
         }
     }
 
     template < typename Index, typename Vertex >
     void batcher<Index, Vertex>::update_index_buffer_() {
+        index_buffer_ptr& ib = current_buffer_set_().indices;
         const std::size_t min_ib_size = indices_.size() * sizeof(indices_[0]);
-        if ( index_buffer_ && index_buffer_->buffer_size() >= min_ib_size ) {
-            index_buffer_->update(buffer(indices_.data(), min_ib_size), 0u);
+        if ( ib && ib->buffer_size() >= min_ib_size ) {
+            if ( streaming_ == render::buffer_streaming::orphaning ) {
+                ib->orphan();
+            }
+            ib->update(indices_.data(), min_ib_size, 0u);
         } else {
             const std::size_t new_ib_size = calculate_new_buffer_size(
                 sizeof(Index),
-                index_buffer_ ? index_buffer_->buffer_size() : 0u,
+                ib ? ib->buffer_size() : 0u,
                 min_ib_size);
 
-            buffer new_ib_data(new_ib_size);
-            std::memcpy(new_ib_data.data(), indices_.data(), min_ib_size);
-
-            index_buffer_ = render_.create_index_buffer(
-                new_ib_data,
+            ib = render_.create_index_buffer(
+                new_ib_size,
                 index_decl_,
-                index_buffer::usage::dynamic_draw);
+                index_buffer::usage::stream_draw);
 
-            if ( !index_buffer_ ) {
+            if ( ib ) {
+                ib->update(indices_.data(), min_ib_size, 0u);
+            } else {
                 debug_.error("BATCHER: Failed to create index buffer:\n"
                     "--> Size: %0",
                     new_ib_size);
@@ -210,25 +565,58 @@ namespace e2d { namespace render_system_impl
     }
 
     template < typename Index, typename Vertex >
-    void batcher<Index, Vertex>::update_vertex_buffer_() {
-        const std::size_t min_vb_size = vertices_.size() * sizeof(vertices_[0]);
-        if ( vertex_buffer_ && vertex_buffer_->buffer_size() >= min_vb_size ) {
-            vertex_buffer_->update(buffer(vertices_.data(), min_vb_size), 0u);
+    void batcher<Index, Vertex>::update_quad_buffers_() {
+        if ( quad_vertices_.empty() ) {
+            return;
+        }
+
+        if ( !quad_index_buffer_ ) {
+            create_quad_index_buffer_();
+        }
+
+        const std::size_t page_size = max_quad_count * 4u;
+        const std::size_t page_count = (quad_vertices_.size() + page_size - 1u) / page_size;
+
+        vector<vertex_buffer_ptr>& vbs = current_buffer_set_().quad_vertices;
+        if ( vbs.size() < page_count ) {
+            vbs.resize(page_count);
+        }
+
+        for ( std::size_t i = 0; i < page_count; ++i ) {
+            const std::size_t first = i * page_size;
+            update_vertex_buffer_(
+                vbs[i],
+                quad_vertices_.data() + first,
+                math::min(page_size, quad_vertices_.size() - first));
+        }
+    }
+
+    template < typename Index, typename Vertex >
+    void batcher<Index, Vertex>::update_vertex_buffer_(
+        vertex_buffer_ptr& vb,
+        const vertex_type* vertices,
+        std::size_t vertex_count)
+    {
+        const std::size_t min_vb_size = vertex_count * sizeof(vertex_type);
+        if ( vb && vb->buffer_size() >= min_vb_size ) {
+            if ( streaming_ == render::buffer_streaming::orphaning ) {
+                vb->orphan();
+            }
+            vb->update(vertices, min_vb_size, 0u);
         } else {
             const std::size_t new_vb_size = calculate_new_buffer_size(
                 sizeof(Vertex),
-                vertex_buffer_ ? vertex_buffer_->buffer_size() : 0u,
+                vb ? vb->buffer_size() : 0u,
                 min_vb_size);
 
-            buffer new_vb_data(new_vb_size);
-            std::memcpy(new_vb_data.data(), vertices_.data(), min_vb_size);
-
-            vertex_buffer_ = render_.create_vertex_buffer(
-                new_vb_data,
+            vb = render_.create_vertex_buffer(
+                new_vb_size,
                 vertex_decl_,
-                vertex_buffer::usage::dynamic_draw);
+                vertex_buffer::usage::stream_draw);
 
-            if ( !vertex_buffer_ ) {
+            if ( vb ) {
+                vb->update(vertices, min_vb_size, 0u);
+            } else {
                 debug_.error("BATCHER: Failed to create vertex buffer:\n"
                     "--> Size: %0",
                     new_vb_size);
@@ -236,6 +624,48 @@ namespace e2d { namespace render_system_impl
         }
     }
 
+    template < typename Index, typename Vertex >
+    void batcher<Index, Vertex>::acquire_buffer_set_() {
+        vector<buffer_set>& sets = buffer_sets_[buffer_index_];
+        if ( used_buffer_sets_ == sets.size() ) {
+            sets.emplace_back();
+        }
+        ++used_buffer_sets_;
+    }
+
+    template < typename Index, typename Vertex >
+    typename batcher<Index, Vertex>::buffer_set& batcher<Index, Vertex>::current_buffer_set_() noexcept {
+        E2D_ASSERT(used_buffer_sets_ > 0u);
+        return buffer_sets_[buffer_index_][used_buffer_sets_ - 1u];
+    }
+
+    template < typename Index, typename Vertex >
+    void batcher<Index, Vertex>::create_quad_index_buffer_() {
+        vector<index_type> indices(max_quad_count * 6u);
+        generate_quad_indices(indices.data(), max_quad_count);
+
+        const std::size_t ib_size = indices.size() * sizeof(indices[0]);
+        quad_index_buffer_ = render_.create_index_buffer(
+            buffer(indices.data(), ib_size),
+            index_decl_,
+            index_buffer::usage::static_draw);
+
+        if ( !quad_index_buffer_ ) {
+            debug_.error("BATCHER: Failed to create quad index buffer:\n"
+                "--> Size: %0",
+                ib_size);
+        }
+    }
+
+    template < typename Index, typename Vertex >
+    str_hash batcher<Index, Vertex>::texture_slot_sampler_hash(std::size_t slot) noexcept {
+        static const str_hash hashes[max_texture_slots] = {
+            "u_texture0", "u_texture1", "u_texture2", "u_texture3",
+            "u_texture4", "u_texture5", "u_texture6", "u_texture7"};
+        E2D_ASSERT(slot < max_texture_slots);
+        return hashes[slot];
+    }
+
     template < typename Index, typename Vertex >
     std::size_t batcher<Index, Vertex>::calculate_new_buffer_size(
         std::size_t esize, std::size_t osize, std::size_t nsize)
@@ -13,12 +13,14 @@
 namespace
 {
     using namespace e2d;
+    using namespace e2d::render_system_impl;
 
     const str_hash matrix_v_property_hash = "u_matrix_v";
     const str_hash matrix_p_property_hash = "u_matrix_p";
     const str_hash matrix_vp_property_hash = "u_matrix_vp";
     const str_hash game_time_property_hash = "u_game_time";
     const str_hash sprite_texture_sampler_hash = "u_texture";
+    const str_hash sprite_texture_slots_property_hash = "u_texture_slots";
 }
 
 namespace e2d { namespace render_system_impl
@@ -32,17 +34,31 @@ namespace e2d { namespace render_system_impl
         const const_node_iptr& cam_n,
         engine& engine,
         render& render,
-        batcher_type& batcher)
+        render_queue& queue,
+        batcher_type& batcher,
+        sprite_run& sprites,
+        statistics& stats)
     : render_(render)
+    , queue_(queue)
     , batcher_(batcher)
+    , sprites_(sprites)
+    , statistics_(stats)
     {
-        const m4f& m_v = cam_n ? cam_n->world_matrix() : m4f::identity();
+        sprites_.clear();
+
+        const std::size_t max_batcher_slots = batcher_type::max_texture_slots;
+        max_texture_slots_ = math::min(
+            max_batcher_slots,
+            math::numeric_cast<std::size_t>(render.device_capabilities().max_texture_image_units));
+
+        const m4f m_v = cam_n ? cam_n->world_matrix() : m4f::identity();
         const m4f& m_p = cam.projection();
+        matrix_vp_ = m_v * m_p;
 
         internal_properties_
             .property(matrix_v_property_hash, m_v)
             .property(matrix_p_property_hash, m_p)
-            .property(matrix_vp_property_hash, m_v * m_p)
+            .property(matrix_vp_property_hash, matrix_vp_)
             .property(game_time_property_hash, engine.time());
 
         render.execute(render::command_block<3>()
@@ -52,14 +68,39 @@ namespace e2d { namespace render_system_impl
                 .color_value(cam.background())));
     }
 
+    void drawer::context::layer(i32 depth) {
+        if ( !has_layer_ ) {
+            has_layer_ = true;
+            layer_depth_ = depth;
+            layer_ = 0u;
+            return;
+        }
+
+        E2D_ASSERT(depth >= layer_depth_);
+        if ( depth == layer_depth_ ) {
+            return;
+        }
+
+        layer_depth_ = depth;
+        if ( layer_ < std::numeric_limits<u8>::max() ) {
+            ++layer_;
+            return;
+        }
+
+        // all the layers are taken, the previous scenes are drawn now
+        flush();
+        queue_.flush(render_);
+        layer_ = 0u;
+    }
+
     void drawer::context::draw(
-        const const_node_iptr& node)
+        const node& node)
     {
-        if ( !node || !node->entity().alive() ) {
+        if ( !node.entity().alive() ) {
             return;
         }
 
-        ecs::const_entity node_e = node->entity();
+        ecs::const_entity node_e = node.entity();
         const renderer* node_r = node_e.find_component<renderer>();
 
         if ( node_r && node_r->enabled() ) {
@@ -74,12 +115,36 @@ namespace e2d { namespace render_system_impl
         }
     }
 
+    void drawer::context::cull(
+        const node& node)
+    {
+        if ( !node.entity().alive() ) {
+            return;
+        }
+
+        ecs::const_entity node_e = node.entity();
+        const renderer* node_r = node_e.find_component<renderer>();
+
+        if ( node_r && node_r->enabled() ) {
+            if ( node_e.find_component<model_renderer>() ) {
+                ++statistics_.culled_count;
+            }
+            if ( node_e.find_component<sprite_renderer>() ) {
+                ++statistics_.culled_count;
+            }
+        }
+    }
+
+    const m4f& drawer::context::view_proj() const noexcept {
+        return matrix_vp_;
+    }
+
     void drawer::context::draw(
-        const const_node_iptr& node,
+        const node& node,
         const renderer& node_r,
         const model_renderer& mdl_r)
     {
-        if ( !node || !node_r.enabled() ) {
+        if ( !node_r.enabled() ) {
             return;
         }
 
@@ -87,14 +152,23 @@ namespace e2d { namespace render_system_impl
             return;
         }
 
-        batcher_.flush();
-
         const model& mdl = mdl_r.model()->content();
         const mesh& msh = mdl.mesh()->content();
+        const m4f mm = node.world_matrix();
+
+        if ( math::outside_clip_volume(mdl.mesh()->bounds(), mm * matrix_vp_) ) {
+            ++statistics_.culled_count;
+            return;
+        }
+        ++statistics_.visible_count;
+
+        // sprites drawn before the model must be enqueued before it
+        flush_sprites_();
 
         try {
+            const f32 depth = view_depth_(v3f(mm[3]));
             property_cache_
-                .property("u_matrix_m", node->world_matrix())
+                .property("u_matrix_m", mm)
                 .merge(internal_properties_);
 
             const std::size_t submesh_count = math::min(
@@ -105,11 +179,16 @@ namespace e2d { namespace render_system_impl
                 const std::size_t index_count = msh.indices(i).size();
                 const material_asset::ptr& mat = mdl.material(i);
                 if ( mat ) {
-                    render_.execute(render::draw_command(
-                        mat->content(),
-                        mdl.geometry(),
-                        property_cache_
-                    ).index_range(first_index, index_count));
+                    const u32 sequence = render_queue::is_ordered(mat->content())
+                        ? queue_.next_sequence()
+                        : 0u;
+                    queue_.enqueue(
+                        render_queue::make_key(layer_, mat->content(), property_cache_, depth, sequence),
+                        render::draw_command(
+                            mat->content(),
+                            mdl.geometry(),
+                            property_cache_
+                        ).index_range(first_index, index_count));
                 }
                 first_index += index_count;
             }
@@ -121,11 +200,11 @@ namespace e2d { namespace render_system_impl
     }
 
     void drawer::context::draw(
-        const const_node_iptr& node,
+        const node& node,
         const renderer& node_r,
         const sprite_renderer& spr_r)
     {
-        if ( !node || !node_r.enabled() ) {
+        if ( !node_r.enabled() ) {
             return;
         }
 
@@ -135,69 +214,198 @@ namespace e2d { namespace render_system_impl
 
         const sprite& spr = spr_r.sprite()->content();
 
-        const f32 sw = spr.size().x;
-        const f32 sh = spr.size().y;
-
-        const f32 hw = -sw * spr.pivot().x;
-        const f32 hh = -sh * spr.pivot().y;
-
-        const v4f p1{hw + 0.f, hh + 0.f, 0.f, 1.f};
-        const v4f p2{hw + sw,  hh + 0.f, 0.f, 1.f};
-        const v4f p3{hw + sw,  hh + sh,  0.f, 1.f};
-        const v4f p4{hw + 0.f, hh + sh,  0.f, 1.f};
-
-        const f32 tx = spr.texrect().position.x;
-        const f32 ty = spr.texrect().position.y;
-        const f32 tw = spr.texrect().size.x;
-        const f32 th = spr.texrect().size.y;
-
-        const m4f& sm = node->world_matrix();
-        const color& tn = spr_r.tint();
-
-        const batcher_type::index_type indices[] = {
-            0u, 1u, 2u, 2u, 3u, 0u};
-
-        const batcher_type::vertex_type vertices[] = {
-            { v3f(p1 * sm), {tx + 0.f, ty + 0.f}, color32(tn) },
-            { v3f(p2 * sm), {tx + tw,  ty + 0.f}, color32(tn) },
-            { v3f(p3 * sm), {tx + tw,  ty + th }, color32(tn) },
-            { v3f(p4 * sm), {tx + 0.f, ty + th }, color32(tn) }};
-
         const texture_ptr texture = spr.texture()
             ? spr.texture()->content()
             : nullptr;
 
-        const render::sampler_min_filter min_filter = spr_r.filtering()
-            ? render::sampler_min_filter::linear
-            : render::sampler_min_filter::nearest;
+        const render::sampler_state sampler = drawer::sprite_sampler(
+            texture,
+            spr_r.filtering());
 
-        const render::sampler_mag_filter mag_filter = spr_r.filtering()
-            ? render::sampler_mag_filter::linear
-            : render::sampler_mag_filter::nearest;
+        const std::size_t texture_slots = sprite_texture_slots_(
+            spr.material()->content());
 
         try {
-            batcher_.batch(
-                spr.material(),
+            if ( texture_slots > 0u ) {
+                property_cache_
+                    .merge(node_r.properties())
+                    .merge(internal_properties_);
+            } else {
                 property_cache_
-                    .sampler(sprite_texture_sampler_hash, render::sampler_state()
-                        .texture(texture)
-                        .min_filter(min_filter)
-                        .mag_filter(mag_filter))
+                    .sampler(sprite_texture_sampler_hash, sampler)
                     .merge(node_r.properties())
-                    .merge(internal_properties_),
-                indices, E2D_COUNTOF(indices),
-                vertices, E2D_COUNTOF(vertices));
+                    .merge(internal_properties_);
+            }
+
+            const bool same_run = sprites_.size()
+                && sprites_.layer == layer_
+                && sprites_.material == spr.material()
+                && sprites_.texture_slots == texture_slots
+                && sprites_.sampler == sampler
+                && sprites_.properties == property_cache_;
+
+            if ( !same_run ) {
+                flush_sprites_();
+                sprites_.layer = layer_;
+                sprites_.material = spr.material();
+                sprites_.properties = property_cache_;
+                sprites_.sampler = sampler;
+                sprites_.texture_slots = texture_slots;
+            }
+
+            sprites_.matrices.push_back(node.world_affine());
+            sprites_.pivots.push_back(spr.pivot());
+            sprites_.sizes.push_back(spr.size());
+            sprites_.texrects.push_back(spr.texrect());
+            sprites_.tints.push_back(color32(spr_r.tint()));
         } catch (...) {
             property_cache_.clear();
+            sprites_.clear();
             throw;
         }
         property_cache_.clear();
     }
 
     void drawer::context::flush() {
+        flush_sprites_();
         batcher_.flush();
     }
 
+    std::size_t drawer::context::sprite_texture_slots_(const render::material& mat) const noexcept {
+        // materials opt in to multi-texture batching by the "u_texture_slots"
+        // property: the number of "u_texture0".."u_textureN" samplers
+        // their shader selects from by the "a_texture_slot" attribute,
+        // zero means the material uses the single "u_texture" sampler
+        const i32* slots = mat.properties().property<i32>(sprite_texture_slots_property_hash);
+        if ( !slots || *slots <= 0 ) {
+            return 0u;
+        }
+        return math::clamp(
+            math::numeric_cast<std::size_t>(*slots),
+            std::size_t(1u),
+            math::max(max_texture_slots_, std::size_t(1u)));
+    }
+
+    f32 drawer::context::view_depth_(const v3f& position) const noexcept {
+        // depth in the clip space of the camera,
+        // so draws are sorted along the view direction
+        const v4f p = v4f(position, 1.f) * matrix_vp_;
+        return math::is_near_zero(p.w, 0.f)
+            ? p.z
+            : p.z / p.w;
+    }
+
+    void drawer::context::flush_sprites_() {
+        if ( !sprites_.size() ) {
+            return;
+        }
+        try {
+            const std::size_t count = sprites_.size();
+            const f32 depth = view_depth_(sprites_.matrices.front()[3]);
+
+            std::size_t texture_slot = 0u;
+            batcher_type::vertex_type* vertices = sprites_.texture_slots > 0u
+                ? batcher_.begin_quads(
+                    sprites_.layer,
+                    depth,
+                    sprites_.material,
+                    sprites_.properties,
+                    sprites_.sampler,
+                    sprites_.texture_slots,
+                    count,
+                    texture_slot)
+                : batcher_.begin_quads(
+                    sprites_.layer,
+                    depth,
+                    sprites_.material,
+                    sprites_.properties,
+                    count);
+
+            const std::size_t visible_count = sprites_.generate_vertices(
+                matrix_vp_,
+                static_cast<f32>(texture_slot),
+                vertices);
+            batcher_.end_quads(visible_count);
+
+            statistics_.visible_count += visible_count;
+            statistics_.culled_count += count - visible_count;
+        } catch (...) {
+            sprites_.clear();
+            throw;
+        }
+        sprites_.clear();
+    }
+
+    //
+    // drawer::sprite_run
+    //
+
+    std::size_t drawer::sprite_run::size() const noexcept {
+        return matrices.size();
+    }
+
+    void drawer::sprite_run::clear() noexcept {
+        material.reset();
+        properties.clear();
+        matrices.clear();
+        pivots.clear();
+        sizes.clear();
+        texrects.clear();
+        tints.clear();
+    }
+
+    // quad corners are the world origin of the sprite plus its edges,
+    // so each sprite costs one point and two direction transforms
+    std::size_t drawer::sprite_run::generate_vertices(
+        const m4f& vp,
+        f32 texture_slot,
+        batcher_type::vertex_type* dst) const noexcept
+    {
+        const a3f* const m_data = matrices.data();
+        const v2f* const p_data = pivots.data();
+        const v2f* const s_data = sizes.data();
+        const b2f* const t_data = texrects.data();
+        const color32* const c_data = tints.data();
+
+        batcher_type::vertex_type* v = dst;
+        for ( std::size_t i = 0, e = size(); i < e; ++i ) {
+            const a3f& m = m_data[i];
+            const v2f& sprite_size = s_data[i];
+            const v2f origin = -sprite_size * p_data[i];
+
+            const v3f p1 = m[0] * origin.x + m[1] * origin.y + m[3];
+            const v3f ex = m[0] * sprite_size.x;
+            const v3f ey = m[1] * sprite_size.y;
+
+            const v4f c1 = v4f(p1, 1.f) * vp;
+            const v4f cx = v4f(ex, 0.f) * vp;
+            const v4f cy = v4f(ey, 0.f) * vp;
+
+            const v4f clip_points[] = {
+                c1,
+                c1 + cx,
+                c1 + cx + cy,
+                c1 + cy};
+
+            if ( math::outside_clip_volume(clip_points, 4u) ) {
+                continue;
+            }
+
+            const f32 tx = t_data[i].position.x;
+            const f32 ty = t_data[i].position.y;
+            const f32 tw = t_data[i].size.x;
+            const f32 th = t_data[i].size.y;
+            const color32 tn = c_data[i];
+
+            v[0] = { p1,           {tx + 0.f, ty + 0.f}, tn, texture_slot };
+            v[1] = { p1 + ex,      {tx + tw,  ty + 0.f}, tn, texture_slot };
+            v[2] = { p1 + ex + ey, {tx + tw,  ty + th }, tn, texture_slot };
+            v[3] = { p1 + ey,      {tx + 0.f, ty + th }, tn, texture_slot };
+            v += 4;
+        }
+        return math::numeric_cast<std::size_t>(v - dst) / 4u;
+    }
+
     //
     // drawer
     //
@@ -205,5 +413,55 @@ namespace e2d { namespace render_system_impl
     drawer::drawer(engine& e, debug& d, render& r)
     : engine_(e)
     , render_(r)
-    , batcher_(d, r) {}
+    , batcher_(d, r, queue_) {}
+
+    render::sampler_min_filter drawer::sprite_min_filter(
+        bool filtering,
+        u32 mipmap_count) noexcept
+    {
+        if ( mipmap_count > 1u ) {
+            return filtering
+                ? render::sampler_min_filter::linear_mipmap_linear
+                : render::sampler_min_filter::nearest_mipmap_nearest;
+        }
+        return filtering
+            ? render::sampler_min_filter::linear
+            : render::sampler_min_filter::nearest;
+    }
+
+    render::sampler_state drawer::sprite_sampler(
+        const texture_ptr& texture,
+        bool filtering) noexcept
+    {
+        const render::sampler_mag_filter mag_filter = filtering
+            ? render::sampler_mag_filter::linear
+            : render::sampler_mag_filter::nearest;
+
+        return render::sampler_state()
+            .texture(texture)
+            .min_filter(sprite_min_filter(filtering, texture ? texture->mipmap_count() : 1u))
+            .mag_filter(mag_filter);
+    }
+
+    void drawer::end_frame() noexcept {
+        batcher_.recycle_buffers();
+    }
+
+    void drawer::end_camera_() noexcept {
+        queue_.clear();
+        batcher_.clear();
+        sprites_.clear();
+    }
+
+    drawer::statistics drawer::current_statistics() const noexcept {
+        statistics result = statistics_;
+        result.batch_count = batcher_.current_statistics().batch_count;
+        result.saved_batch_count = batcher_.current_statistics().saved_batch_count;
+        return result;
+    }
+
+    void drawer::reset_statistics() noexcept {
+        batcher_.reset_statistics();
+        statistics_ = statistics();
+    }
 }}
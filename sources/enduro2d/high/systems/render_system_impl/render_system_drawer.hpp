@@ -27,7 +27,40 @@ namespace e2d { namespace render_system_impl
     public:
         using batcher_type = batcher<
             index_u16,
-            vertex_v3f_t2f_c32b>;
+            vertex_v3f_t2f_c32b_s1f>;
+
+        struct statistics {
+            std::size_t batch_count = 0;
+            std::size_t saved_batch_count = 0;
+            std::size_t visible_count = 0;
+            std::size_t culled_count = 0;
+        };
+
+        // consecutive sprites with the same material, properties and
+        // texture, their vertices are generated in one pass
+        struct sprite_run {
+            u8 layer{0u};
+            material_asset::ptr material;
+            render::property_block properties;
+            render::sampler_state sampler;
+            std::size_t texture_slots{0u};
+
+            vector<a3f> matrices;
+            vector<v2f> pivots;
+            vector<v2f> sizes;
+            vector<b2f> texrects;
+            vector<color32> tints;
+
+            std::size_t size() const noexcept;
+            void clear() noexcept;
+
+            // writes four vertices per visible sprite into 'dst',
+            // returns the number of written sprites
+            std::size_t generate_vertices(
+                const m4f& vp,
+                f32 texture_slot,
+                batcher_type::vertex_type* dst) const noexcept;
+        };
 
         class context : noncopyable {
         public:
@@ -36,37 +69,84 @@ namespace e2d { namespace render_system_impl
                 const const_node_iptr& cam_n,
                 engine& engine,
                 render& render,
-                batcher_type& batcher);
+                render_queue& queue,
+                batcher_type& batcher,
+                sprite_run& sprites,
+                statistics& stats);
+
+            // scenes are passed in depth order, each distinct depth takes
+            // the next key layer, the queue is executed when they run out
+            void layer(i32 depth);
 
             void draw(
-                const const_node_iptr& node);
+                const node& node);
+
+            // counts the renderers of the node culled before drawing
+            void cull(
+                const node& node);
+
+            const m4f& view_proj() const noexcept;
 
             void draw(
-                const const_node_iptr& node,
+                const node& node,
                 const renderer& node_r,
                 const model_renderer& mdl_r);
 
             void draw(
-                const const_node_iptr& node,
+                const node& node,
                 const renderer& node_r,
                 const sprite_renderer& spr_r);
 
+            // enqueues pending sprites and batches,
+            // the queue is executed by the drawer
             void flush();
+        private:
+            std::size_t sprite_texture_slots_(const render::material& mat) const noexcept;
+            f32 view_depth_(const v3f& position) const noexcept;
+            void flush_sprites_();
         private:
             render& render_;
+            render_queue& queue_;
             batcher_type& batcher_;
+            sprite_run& sprites_;
+            statistics& statistics_;
+            m4f matrix_vp_;
+            u8 layer_ = 0u;
+            i32 layer_depth_ = 0;
+            bool has_layer_ = false;
+            std::size_t max_texture_slots_ = 1u;
             render::property_block property_cache_;
             render::property_block internal_properties_;
         };
     public:
         drawer(engine& e, debug& d, render& r);
 
+        // mipmapped textures of sprites are sampled through their chains
+        static render::sampler_min_filter sprite_min_filter(
+            bool filtering,
+            u32 mipmap_count) noexcept;
+
+        static render::sampler_state sprite_sampler(
+            const texture_ptr& texture,
+            bool filtering) noexcept;
+
         template < typename F >
         void with(const camera& cam, const const_node_iptr& cam_n, F&& f);
+
+        // buffers of all the cameras of the frame are kept until then
+        void end_frame() noexcept;
+
+        statistics current_statistics() const noexcept;
+        void reset_statistics() noexcept;
+    private:
+        void end_camera_() noexcept;
     private:
         engine& engine_;
         render& render_;
+        render_queue queue_;
         batcher_type batcher_;
+        sprite_run sprites_;
+        statistics statistics_;
     };
 }}
 
@@ -74,8 +154,17 @@ namespace e2d { namespace render_system_impl
 {
     template < typename F >
     void drawer::with(const camera& cam, const const_node_iptr& cam_n, F&& f) {
-        context ctx{cam, cam_n, engine_, render_, batcher_};
-        std::forward<F>(f)(ctx);
-        ctx.flush();
+        // the queue is sorted and executed once per camera,
+        // batcher buffers live until the end of the frame
+        try {
+            context ctx{cam, cam_n, engine_, render_, queue_, batcher_, sprites_, statistics_};
+            std::forward<F>(f)(ctx);
+            ctx.flush();
+            queue_.flush(render_);
+        } catch (...) {
+            end_camera_();
+            throw;
+        }
+        end_camera_();
     }
 }}
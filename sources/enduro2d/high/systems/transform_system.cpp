@@ -0,0 +1,100 @@
+/*******************************************************************************
+ * This file is part of the "Enduro2D"
+ * For conditions of distribution and use, see copyright notice in LICENSE.md
+ * Copyright (C) 2018 Matvey Cherevko
+ ******************************************************************************/
+
+#include <enduro2d/high/systems/transform_system.hpp>
+
+#include <enduro2d/high/transform_pass.hpp>
+#include <enduro2d/high/components/scene.hpp>
+
+namespace
+{
+    using namespace e2d;
+
+    std::size_t node_depth(const const_node_iptr& n) noexcept {
+        std::size_t depth = 0u;
+        for ( const_node_iptr p = n->parent(); p; p = p->parent() ) {
+            ++depth;
+        }
+        return depth;
+    }
+}
+
+namespace e2d
+{
+    //
+    // transform_system::internal_state
+    //
+
+    class transform_system::internal_state final : private noncopyable {
+    public:
+        internal_state() = default;
+        ~internal_state() noexcept = default;
+
+        void process(ecs::registry& owner) {
+            ++frame_;
+            owner.for_each_component<scene>([this](const ecs::entity&, scene& scn){
+                const node_iptr root = scn.root();
+                if ( !root ) {
+                    return;
+                }
+                const auto iter = passes_.find(root.get());
+                if ( iter != passes_.end() ) {
+                    iter->second.frame = frame_;
+                } else if ( !transform_pass::is_joined(root) ) {
+                    pass_info info;
+                    info.pass = std::make_unique<transform_pass>(root);
+                    info.frame = frame_;
+                    passes_.insert(std::make_pair(root.get(), std::move(info)));
+                }
+            });
+
+            // passes of nodes that are not scene roots anymore are dropped
+            for ( auto iter = passes_.begin(); iter != passes_.end(); ) {
+                if ( iter->second.frame != frame_ ) {
+                    iter = passes_.erase(iter);
+                } else {
+                    ++iter;
+                }
+            }
+
+            // roots of nested passes take world transforms from the outer ones
+            sorted_passes_.clear();
+            for ( auto& p : passes_ ) {
+                sorted_passes_.emplace_back(
+                    node_depth(p.second.pass->root()),
+                    p.second.pass.get());
+            }
+            std::sort(sorted_passes_.begin(), sorted_passes_.end(),
+                [](const auto& l, const auto& r) noexcept {
+                    return l.first < r.first;
+                });
+            for ( const auto& p : sorted_passes_ ) {
+                p.second->update();
+            }
+        }
+    private:
+        struct pass_info {
+            std::unique_ptr<transform_pass> pass;
+            u32 frame{0u};
+        };
+    private:
+        u32 frame_{0u};
+        hash_map<const node*, pass_info> passes_;
+        vector<std::pair<std::size_t, transform_pass*>> sorted_passes_;
+    };
+
+    //
+    // transform_system
+    //
+
+    transform_system::transform_system()
+    : state_(new internal_state()) {}
+    transform_system::~transform_system() noexcept = default;
+
+    void transform_system::process(ecs::registry& owner) {
+        state_->process(owner);
+    }
+}
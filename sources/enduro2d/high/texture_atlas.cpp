@@ -0,0 +1,346 @@
+/*******************************************************************************
+ * This file is part of the "Enduro2D"
+ * For conditions of distribution and use, see copyright notice in LICENSE.md
+ * Copyright (C) 2018 Matvey Cherevko
+ ******************************************************************************/
+
+#include <enduro2d/high/texture_atlas.hpp>
+#include <enduro2d/high/assets/image_asset.hpp>
+
+namespace
+{
+    using namespace e2d;
+
+    bool is_packable_image_format(image_data_format format) noexcept {
+        switch ( format ) {
+            case image_data_format::g8:
+            case image_data_format::ga8:
+            case image_data_format::rgb8:
+            case image_data_format::rgba8:
+                return true;
+            default:
+                return false;
+        }
+    }
+}
+
+namespace e2d
+{
+    //
+    // texture_atlas::parameters
+    //
+
+    texture_atlas::parameters& texture_atlas::parameters::page_size(const v2u& value) noexcept {
+        page_size_ = value;
+        return *this;
+    }
+
+    texture_atlas::parameters& texture_atlas::parameters::max_image_size(u32 value) noexcept {
+        max_image_size_ = value;
+        return *this;
+    }
+
+    texture_atlas::parameters& texture_atlas::parameters::padding(u32 value) noexcept {
+        padding_ = value;
+        return *this;
+    }
+
+    v2u& texture_atlas::parameters::page_size() noexcept {
+        return page_size_;
+    }
+
+    u32& texture_atlas::parameters::max_image_size() noexcept {
+        return max_image_size_;
+    }
+
+    u32& texture_atlas::parameters::padding() noexcept {
+        return padding_;
+    }
+
+    const v2u& texture_atlas::parameters::page_size() const noexcept {
+        return page_size_;
+    }
+
+    const u32& texture_atlas::parameters::max_image_size() const noexcept {
+        return max_image_size_;
+    }
+
+    const u32& texture_atlas::parameters::padding() const noexcept {
+        return padding_;
+    }
+
+    //
+    // texture_atlas::region
+    //
+
+    b2f texture_atlas::region::remap(const b2f& sprite_texrect) const noexcept {
+        return b2f(
+            texrect.position + sprite_texrect.position * texrect.size,
+            sprite_texrect.size * texrect.size);
+    }
+
+    //
+    // texture_atlas
+    //
+
+    texture_atlas::texture_atlas(library& l)
+    : texture_atlas(l, parameters()) {}
+
+    texture_atlas::texture_atlas(library& l, const parameters& params)
+    : library_(l)
+    , params_(params) {}
+
+    texture_atlas::~texture_atlas() noexcept = default;
+
+    stdex::promise<texture_atlas::region> texture_atlas::load_region_async(str_view address) {
+        const str_hash address_hash = make_hash(address);
+
+        region cached;
+        if ( find(address_hash, cached) ) {
+            return stdex::make_resolved_promise(std::move(cached));
+        }
+
+        return library_.load_asset_async<image_asset>(address)
+            .then([this, address_hash](const image_asset::load_result& image_data){
+                return the<deferrer>().do_upload_in_main_thread(
+                    image_data->cpu_memory_usage(),
+                    [this, address_hash, image_data](){
+                        region result;
+                        insert(address_hash, image_data->content(), result);
+                        return result;
+                    });
+            });
+    }
+
+    bool texture_atlas::find(str_hash address, region& result) const {
+        std::lock_guard<std::mutex> guard(mutex_);
+        return find_(address, result);
+    }
+
+    bool texture_atlas::insert(str_hash address, const image& image, region& result) {
+        E2D_ASSERT(is_in_main_thread());
+        std::lock_guard<std::mutex> guard(mutex_);
+
+        if ( find_(address, result) ) {
+            return true;
+        }
+
+        if ( image.empty()
+            || !is_packable_image_format(image.format())
+            || math::maximum(image.size()) > params_.max_image_size()
+            || !modules::is_initialized<render>() )
+        {
+            return false;
+        }
+
+        const v2u padded_size = padded_image_size(image.size(), params_.padding());
+
+        b2u packed_rect;
+        auto page_iter = pages_.begin();
+        for ( ; page_iter != pages_.end(); ++page_iter ) {
+            if ( page_iter->second.packer.insert(padded_size, packed_rect) ) {
+                break;
+            }
+        }
+
+        if ( page_iter == pages_.end() ) {
+            const texture_ptr page_texture = the<render>().create_texture(
+                params_.page_size(),
+                pixel_declaration::pixel_type::rgba8);
+            if ( !page_texture ) {
+                return false;
+            }
+
+            page_type page;
+            page.texture = texture_asset::create(page_texture);
+            page.packer.reset(params_.page_size());
+            if ( !page.packer.insert(padded_size, packed_rect) ) {
+                return false;
+            }
+
+            page_iter = pages_.emplace(next_page_id_++, std::move(page)).first;
+        }
+
+        page_iter->second.last_use = next_use_tick();
+        page_iter->second.texture->content()->update(
+            make_padded_image(image, params_.padding()),
+            packed_rect.position);
+
+        region_type new_region;
+        new_region.page_id = page_iter->first;
+        new_region.texrect = packed_image_texrect(
+            params_.page_size(),
+            packed_rect,
+            image.size(),
+            params_.padding());
+        regions_.emplace(address, new_region);
+
+        result.page = page_iter->second.texture;
+        result.texrect = new_region.texrect;
+        return true;
+    }
+
+    v2u texture_atlas::padded_image_size(const v2u& image_size, u32 padding) noexcept {
+        return image_size + v2u(padding * 2u);
+    }
+
+    // sprite shaders flip the t coordinate, so texrects
+    // go from the bottom row of the image to the top one
+    b2f texture_atlas::packed_image_texrect(
+        const v2u& page_size,
+        const b2u& packed_rect,
+        const v2u& image_size,
+        u32 padding) noexcept
+    {
+        const v2f page_sizef = page_size.cast_to<f32>();
+        const v2f image_sizef = image_size.cast_to<f32>();
+        const v2f image_pos = (packed_rect.position + v2u(padding)).cast_to<f32>();
+        return b2f(
+            image_pos.x / page_sizef.x,
+            1.f - (image_pos.y + image_sizef.y) / page_sizef.y,
+            image_sizef.x / page_sizef.x,
+            image_sizef.y / page_sizef.y);
+    }
+
+    // the extruded edges prevent filtering artifacts
+    image texture_atlas::make_padded_image(const image& src, u32 padding) {
+        const v2u src_size = src.size();
+        const v2u dst_size = padded_image_size(src_size, padding);
+        buffer dst_data(dst_size.x * dst_size.y * 4u);
+        u8* const dst_pixels = dst_data.data();
+
+        const bool is_rgba8 = src.format() == image_data_format::rgba8;
+        for ( u32 y = 0; y < dst_size.y; ++y ) {
+            const u32 sy = math::min(y - math::min(y, padding), src_size.y - 1u);
+            u8* const dst_row = dst_pixels + y * dst_size.x * 4u;
+            for ( u32 x = 0; x < dst_size.x; ++x ) {
+                const u32 sx = math::min(x - math::min(x, padding), src_size.x - 1u);
+                if ( is_rgba8 ) {
+                    std::memcpy(
+                        dst_row + x * 4u,
+                        src.data().data() + (sy * src_size.x + sx) * 4u,
+                        4u);
+                } else {
+                    const color32 c = src.pixel32(sx, sy);
+                    dst_row[x * 4u + 0u] = c.r;
+                    dst_row[x * 4u + 1u] = c.g;
+                    dst_row[x * 4u + 2u] = c.b;
+                    dst_row[x * 4u + 3u] = c.a;
+                }
+            }
+        }
+
+        return image(dst_size, image_data_format::rgba8, std::move(dst_data));
+    }
+
+    void texture_atlas::clear() noexcept {
+        std::lock_guard<std::mutex> guard(mutex_);
+        regions_.clear();
+        pages_.clear();
+    }
+
+    std::size_t texture_atlas::page_count() const noexcept {
+        std::lock_guard<std::mutex> guard(mutex_);
+        return pages_.size();
+    }
+
+    std::size_t texture_atlas::region_count() const noexcept {
+        std::lock_guard<std::mutex> guard(mutex_);
+        return regions_.size();
+    }
+
+    f32 texture_atlas::occupancy() const noexcept {
+        std::lock_guard<std::mutex> guard(mutex_);
+        if ( pages_.empty() ) {
+            return 0.f;
+        }
+        const f32 sum = std::accumulate(pages_.begin(), pages_.end(), 0.f,
+            [](f32 acc, const auto& p){
+                return acc + p.second.packer.occupancy();
+            });
+        return sum / static_cast<f32>(pages_.size());
+    }
+
+    const char* texture_atlas::asset_type_name() const noexcept {
+        return "texture_atlas";
+    }
+
+    stdex::promise<void> texture_atlas::prefetch_asset(str_view address) {
+        return load_region_async(address)
+            .then([](const region&){});
+    }
+
+    std::size_t texture_atlas::unload_self_unused_assets() noexcept {
+        std::lock_guard<std::mutex> guard(mutex_);
+        std::size_t result = 0u;
+        for ( auto iter = pages_.begin(); iter != pages_.end(); ) {
+            if ( 1 == iter->second.texture->use_count() ) {
+                erase_page_regions_(iter->first);
+                iter = pages_.erase(iter);
+                ++result;
+            } else {
+                ++iter;
+            }
+        }
+        return result;
+    }
+
+    asset_memory_usage texture_atlas::memory_usage() const noexcept {
+        std::lock_guard<std::mutex> guard(mutex_);
+        asset_memory_usage result;
+        for ( const auto& p : pages_ ) {
+            result.gpu_bytes += p.second.texture->gpu_memory_usage();
+        }
+        return result;
+    }
+
+    void texture_atlas::collect_eviction_candidates(
+        vector<eviction_candidate>& candidates)
+    {
+        std::lock_guard<std::mutex> guard(mutex_);
+        for ( const auto& p : pages_ ) {
+            if ( 1 == p.second.texture->use_count() ) {
+                eviction_candidate candidate;
+                candidate.last_use = p.second.last_use;
+                candidate.usage.gpu_bytes = p.second.texture->gpu_memory_usage();
+                candidates.push_back(candidate);
+            }
+        }
+    }
+
+    std::size_t texture_atlas::evict_unused_assets_until(u64 last_use) noexcept {
+        std::lock_guard<std::mutex> guard(mutex_);
+        std::size_t result = 0u;
+        for ( auto iter = pages_.begin(); iter != pages_.end(); ) {
+            if ( 1 == iter->second.texture->use_count() && iter->second.last_use <= last_use ) {
+                erase_page_regions_(iter->first);
+                iter = pages_.erase(iter);
+                ++result;
+            } else {
+                ++iter;
+            }
+        }
+        return result;
+    }
+
+    void texture_atlas::erase_page_regions_(u32 page_id) noexcept {
+        for ( auto iter = regions_.begin(); iter != regions_.end(); ) {
+            iter = iter->second.page_id == page_id
+                ? regions_.erase(iter)
+                : std::next(iter);
+        }
+    }
+
+    bool texture_atlas::find_(str_hash address, region& result) const {
+        const auto region_iter = regions_.find(address);
+        if ( region_iter == regions_.end() ) {
+            return false;
+        }
+        const auto page_iter = pages_.find(region_iter->second.page_id);
+        E2D_ASSERT(page_iter != pages_.end());
+        page_iter->second.last_use = next_use_tick();
+        result.page = page_iter->second.texture;
+        result.texrect = region_iter->second.texrect;
+        return true;
+    }
+}
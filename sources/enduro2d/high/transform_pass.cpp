@@ -0,0 +1,219 @@
+/*******************************************************************************
+ * This file is part of the "Enduro2D"
+ * For conditions of distribution and use, see copyright notice in LICENSE.md
+ * Copyright (C) 2018 Matvey Cherevko
+ ******************************************************************************/
+
+#include <enduro2d/high/transform_pass.hpp>
+#include <enduro2d/high/spatial_index.hpp>
+
+namespace e2d
+{
+    transform_pass::transform_pass(const node_iptr& root)
+    : root_(root)
+    {
+        if ( !root || root->transform_pass_ ) {
+            throw bad_transform_pass_operation();
+        }
+        root->join_transform_pass_(this);
+    }
+
+    transform_pass::~transform_pass() noexcept {
+        const auto detach = [this](node& n, const auto& self) noexcept -> void {
+            n.transform_pass_ = nullptr;
+            n.transform_index_ = null_index;
+            n.flags_ |= node::fm_dirty_local_matrix | node::fm_dirty_world_matrix;
+            for ( node& child : n.children_ ) {
+                if ( child.transform_pass_ == this ) {
+                    self(child, self);
+                } else {
+                    child.mark_dirty_world_matrix_();
+                }
+            }
+        };
+        detach(*root_, detach);
+    }
+
+    node_iptr transform_pass::root() noexcept {
+        return root_;
+    }
+
+    const_node_iptr transform_pass::root() const noexcept {
+        return root_;
+    }
+
+    void transform_pass::update() {
+        if ( dirty_hierarchy_ ) {
+            rebuild_();
+            moved_.clear();
+            last_updated_count_ = nodes_.size();
+            update_range_(0u, math::numeric_cast<u32>(nodes_.size()));
+            return;
+        }
+
+        update_moved_();
+    }
+
+    bool transform_pass::up_to_date() const noexcept {
+        return !dirty_hierarchy_ && moved_.empty();
+    }
+
+    bool transform_pass::is_joined(const const_node_iptr& node) noexcept {
+        return node && node->transform_pass_;
+    }
+
+    std::size_t transform_pass::node_count() const noexcept {
+        return nodes_.size();
+    }
+
+    std::size_t transform_pass::pending_count() const noexcept {
+        return moved_.size();
+    }
+
+    std::size_t transform_pass::last_updated_count() const noexcept {
+        return last_updated_count_;
+    }
+
+    void transform_pass::on_join_(node* n) noexcept {
+        E2D_UNUSED(n);
+        dirty_hierarchy_ = true;
+    }
+
+    void transform_pass::on_leave_(node* n) noexcept {
+        E2D_UNUSED(n);
+        dirty_hierarchy_ = true;
+    }
+
+    // every node is reported once until it is updated and the capacity
+    // is reserved by rebuild_(), so the noexcept node mutators never allocate
+    void transform_pass::on_moved_(node* n) noexcept {
+        if ( !dirty_hierarchy_ ) {
+            E2D_ASSERT(moved_.size() < moved_.capacity());
+            moved_.push_back(n);
+        }
+    }
+
+    // pending moves are swept on read, the arrays can't be rebuilt
+    // without allocations, so after hierarchy changes the matrices
+    // are computed through the parent chain until the next update()
+    const a3f& transform_pass::local_affine_(const node& n) noexcept {
+        if ( !dirty_hierarchy_ && !moved_.empty() ) {
+            update_moved_();
+        }
+        if ( !dirty_hierarchy_ && has_index_(n) ) {
+            return local_affines_[n.transform_index_];
+        }
+        n.local_affine_ = math::make_trs_affine3(n.transform_);
+        return n.local_affine_;
+    }
+
+    const a3f& transform_pass::world_affine_(const node& n) noexcept {
+        if ( !dirty_hierarchy_ && !moved_.empty() ) {
+            update_moved_();
+        }
+        if ( !dirty_hierarchy_ && has_index_(n) ) {
+            return world_affines_[n.transform_index_];
+        }
+        const a3f local = math::make_trs_affine3(n.transform_);
+        n.world_affine_ = n.parent_
+            ? n.parent_->world_affine() * local
+            : local;
+        return n.world_affine_;
+    }
+
+    bool transform_pass::has_index_(const node& n) const noexcept {
+        return n.transform_index_ < nodes_.size()
+            && nodes_[n.transform_index_] == &n;
+    }
+
+    // subtrees are contiguous in depth-first order, so moved nodes
+    // inside an already updated subtree are skipped
+    void transform_pass::update_moved_() noexcept {
+        E2D_ASSERT(!dirty_hierarchy_);
+        if ( moved_.empty() ) {
+            last_updated_count_ = 0u;
+            return;
+        }
+
+        std::sort(moved_.begin(), moved_.end(), [](const node* l, const node* r) noexcept {
+            return l->transform_index_ < r->transform_index_;
+        });
+
+        u32 updated_end = 0u;
+        last_updated_count_ = 0u;
+        for ( const node* n : moved_ ) {
+            if ( n->transform_index_ < updated_end ) {
+                continue;
+            }
+            const u32 first = n->transform_index_;
+            updated_end = subtree_ends_[first];
+            last_updated_count_ += updated_end - first;
+            update_range_(first, updated_end);
+        }
+        moved_.clear();
+    }
+
+    void transform_pass::rebuild_() {
+        nodes_.clear();
+        parents_.clear();
+        subtree_ends_.clear();
+        external_children_.clear();
+
+        const auto visit = [this](node& n, u32 parent, const auto& self) -> void {
+            const u32 index = math::numeric_cast<u32>(nodes_.size());
+            n.transform_index_ = index;
+            n.flags_ |= node::fm_dirty_local_matrix;
+            nodes_.push_back(&n);
+            parents_.push_back(parent);
+            subtree_ends_.push_back(index + 1u);
+            for ( node& child : n.children_ ) {
+                if ( child.transform_pass_ == this ) {
+                    self(child, index, self);
+                } else {
+                    external_children_.emplace_back(index, &child);
+                }
+            }
+            subtree_ends_[index] = math::numeric_cast<u32>(nodes_.size());
+        };
+        visit(*root_, null_index, visit);
+
+        local_affines_.resize(nodes_.size());
+        world_affines_.resize(nodes_.size());
+        moved_.reserve(nodes_.size());
+        dirty_hierarchy_ = false;
+    }
+
+    void transform_pass::update_range_(u32 first, u32 last) noexcept {
+        for ( u32 i = first; i < last; ++i ) {
+            node& n = *nodes_[i];
+            const u32 parent = parents_[i];
+
+            a3f& local = local_affines_[i];
+            if ( math::check_and_clear_any_flags(n.flags_, node::fm_dirty_local_matrix) ) {
+                local = math::make_trs_affine3(n.transform_);
+            }
+
+            a3f& world = world_affines_[i];
+            if ( parent != null_index ) {
+                world = world_affines_[parent] * local;
+            } else if ( n.parent_ ) {
+                world = n.parent_->world_affine() * local;
+            } else {
+                world = local;
+            }
+
+            n.flags_ &= ~node::fm_dirty_world_matrix;
+            if ( n.spatial_index_ ) {
+                n.spatial_index_->on_moved_(&n);
+            }
+        }
+
+        // roots of other passes and nodes joined to nothing
+        // are marked the same way as without a pass
+        for ( const auto& child : external_children_ ) {
+            if ( child.first >= first && child.first < last ) {
+                child.second->mark_dirty_world_matrix_();
+            }
+        }
+    }
+}
@@ -0,0 +1,75 @@
+/*******************************************************************************
+ * This file is part of the "Enduro2D"
+ * For conditions of distribution and use, see copyright notice in LICENSE.md
+ * Copyright (C) 2018 Matvey Cherevko
+ ******************************************************************************/
+
+#include <enduro2d/utils/buffer_view.hpp>
+#include <enduro2d/utils/buffer.hpp>
+
+namespace e2d
+{
+    buffer_view::buffer_view(const buffer& src) noexcept
+    : data_(src.data())
+    , size_(src.size()) {}
+
+    buffer_view::buffer_view(const void* src, std::size_t size) noexcept
+    : data_(static_cast<const u8*>(src))
+    , size_(size) {
+        E2D_ASSERT(!size || src);
+    }
+
+    void buffer_view::swap(buffer_view& other) noexcept {
+        using std::swap;
+        swap(data_, other.data_);
+        swap(size_, other.size_);
+    }
+
+    void buffer_view::clear() noexcept {
+        data_ = nullptr;
+        size_ = 0;
+    }
+
+    bool buffer_view::empty() const noexcept {
+        return !size_;
+    }
+
+    const u8* buffer_view::data() const noexcept {
+        return data_;
+    }
+
+    std::size_t buffer_view::size() const noexcept {
+        return size_;
+    }
+}
+
+namespace e2d
+{
+    void swap(buffer_view& l, buffer_view& r) noexcept {
+        l.swap(r);
+    }
+
+    bool operator<(const buffer_view& l, const buffer_view& r) noexcept {
+        const u8* ld = l.data();
+        const u8* rd = r.data();
+        const std::size_t ls = l.size();
+        const std::size_t rs = r.size();
+        return
+            (ls < rs) ||
+            (ls == rs && ls > 0 && std::memcmp(ld, rd, ls) < 0);
+    }
+
+    bool operator==(const buffer_view& l, const buffer_view& r) noexcept {
+        const u8* ld = l.data();
+        const u8* rd = r.data();
+        const std::size_t ls = l.size();
+        const std::size_t rs = r.size();
+        return
+            (ls == rs) &&
+            (ls == 0 || std::memcmp(ld, rd, ls) == 0);
+    }
+
+    bool operator!=(const buffer_view& l, const buffer_view& r) noexcept {
+        return !(l == r);
+    }
+}
@@ -0,0 +1,531 @@
+/*******************************************************************************
+ * This file is part of the "Enduro2D"
+ * For conditions of distribution and use, see copyright notice in LICENSE.md
+ * Copyright (C) 2018 Matvey Cherevko
+ ******************************************************************************/
+
+#include <enduro2d/utils/bundle.hpp>
+#include <enduro2d/utils/filesystem.hpp>
+#include <enduro2d/utils/path.hpp>
+#include <enduro2d/utils/strings.hpp>
+
+namespace
+{
+    using namespace e2d;
+
+    const u8 bundle_signature[8] = {'e', '2', 'd', 'b', 'n', 'd', 'l', '\0'};
+
+    // compressed entries are stored only
+    // when they are at least 1/8 smaller
+    bool is_compression_worth(std::size_t stored_size, std::size_t size) noexcept {
+        return stored_size < size - size / 8u;
+    }
+
+    std::size_t align_data_offset(std::size_t offset) noexcept {
+        const std::size_t mask = bundles::data_alignment - 1u;
+        return (offset + mask) & ~mask;
+    }
+
+    str normalize_entry_name(str_view name) {
+        str result = make_utf8(name);
+        std::replace(result.begin(), result.end(), '\\', '/');
+        while ( !result.empty() && result.back() == '/' ) {
+            result.pop_back();
+        }
+        return result;
+    }
+
+    //
+    // lz4 block format
+    //
+    // token: 4 bits of literal length and 4 bits of match length,
+    // lengths of 15 continue in following bytes, then literals,
+    // little-endian 16-bit match offset and match length minus 4.
+    // the last 5 bytes are always literals and the last match
+    // starts at least 12 bytes before the end of the block.
+    //
+
+    const std::size_t lz4_min_match = 4u;
+    const std::size_t lz4_last_literals = 5u;
+    const std::size_t lz4_match_limit = 12u;
+    const std::size_t lz4_max_offset = 65535u;
+    const std::size_t lz4_hash_log = 12u;
+
+    u32 lz4_read_u32(const u8* p) noexcept {
+        u32 v;
+        std::memcpy(&v, p, sizeof(v));
+        return v;
+    }
+
+    std::size_t lz4_hash(u32 v) noexcept {
+        return (v * 2654435761u) >> (32u - lz4_hash_log);
+    }
+
+    u8* lz4_write_length(u8* op, std::size_t length) noexcept {
+        for ( ; length >= 255u; length -= 255u ) {
+            *op++ = 255u;
+        }
+        *op++ = static_cast<u8>(length);
+        return op;
+    }
+
+    u8* lz4_write_sequence(
+        u8* op,
+        const u8* literals,
+        std::size_t literal_length,
+        std::size_t offset,
+        std::size_t match_length) noexcept
+    {
+        u8* token = op++;
+        *token = static_cast<u8>(math::min(literal_length, std::size_t(15u)) << 4u);
+        if ( literal_length >= 15u ) {
+            op = lz4_write_length(op, literal_length - 15u);
+        }
+        std::memcpy(op, literals, literal_length);
+        op += literal_length;
+
+        // the last sequence has no match
+        if ( match_length ) {
+            *op++ = static_cast<u8>(offset & 0xFFu);
+            *op++ = static_cast<u8>((offset >> 8u) & 0xFFu);
+            const std::size_t length = match_length - lz4_min_match;
+            *token |= static_cast<u8>(math::min(length, std::size_t(15u)));
+            if ( length >= 15u ) {
+                op = lz4_write_length(op, length - 15u);
+            }
+        }
+        return op;
+    }
+
+    bool lz4_read_length(const u8*& ip, const u8* iend, std::size_t& length) noexcept {
+        u8 b = 255u;
+        while ( b == 255u ) {
+            if ( ip == iend ) {
+                return false;
+            }
+            b = *ip++;
+            length += b;
+        }
+        return true;
+    }
+}
+
+namespace e2d
+{
+    //
+    // bundle
+    //
+
+    bundle::bundle(bundle&& other) noexcept {
+        assign(std::move(other));
+    }
+
+    bundle& bundle::operator=(bundle&& other) noexcept {
+        return assign(std::move(other));
+    }
+
+    bundle::bundle(const bundle& other) {
+        assign(other);
+    }
+
+    bundle& bundle::operator=(const bundle& other) {
+        return assign(other);
+    }
+
+    bundle& bundle::assign(bundle&& other) noexcept {
+        if ( this != &other ) {
+            swap(other);
+            other.clear();
+        }
+        return *this;
+    }
+
+    bundle& bundle::assign(const bundle& other) {
+        if ( this != &other ) {
+            entries_ = other.entries_;
+        }
+        return *this;
+    }
+
+    bool bundle::add_directory(str_view name) {
+        str entry_name = normalize_entry_name(name);
+        if ( entry_name.empty() || exists(entry_name) ) {
+            return false;
+        }
+        entry e;
+        e.name = std::move(entry_name);
+        e.directory = true;
+        entries_.push_back(std::move(e));
+        return true;
+    }
+
+    bool bundle::add_file(str_view name, buffer&& content, bool compress) {
+        str entry_name = normalize_entry_name(name);
+        if ( entry_name.empty() || exists(entry_name) ) {
+            return false;
+        }
+        entry e;
+        e.name = std::move(entry_name);
+        e.content = std::move(content);
+        e.compress = compress;
+        entries_.push_back(std::move(e));
+        return true;
+    }
+
+    bool bundle::add_file(str_view name, const buffer& content, bool compress) {
+        return add_file(name, buffer(content), compress);
+    }
+
+    void bundle::swap(bundle& other) noexcept {
+        using std::swap;
+        swap(entries_, other.entries_);
+    }
+
+    void bundle::clear() noexcept {
+        entries_.clear();
+    }
+
+    bool bundle::empty() const noexcept {
+        return entries_.empty();
+    }
+
+    bool bundle::exists(str_view name) const noexcept {
+        return entries_.end() != std::find_if(
+            entries_.begin(), entries_.end(),
+            [name](const entry& e) noexcept {
+                return e.name == name;
+            });
+    }
+
+    const vector<bundle::entry>& bundle::entries() const noexcept {
+        return entries_;
+    }
+
+    void swap(bundle& l, bundle& r) noexcept {
+        l.swap(r);
+    }
+}
+
+namespace e2d { namespace bundles
+{
+    bool is_valid_header(const file_header& header) noexcept {
+        return 0 == std::memcmp(header.signature, bundle_signature, sizeof(bundle_signature))
+            && header.version == file_version
+            && header.directory_offset == sizeof(file_header);
+    }
+
+    bool try_decompress_chunk(
+        const file_entry& entry,
+        buffer_view data,
+        std::size_t chunk,
+        u8* dst) noexcept
+    {
+        if ( !(entry.flags & file_entry_compressed) || chunk >= entry.chunk_count ) {
+            return false;
+        }
+
+        const std::size_t table_size = entry.chunk_count * sizeof(u32);
+        if ( data.size() < table_size ) {
+            return false;
+        }
+
+        u32 first = 0;
+        u32 last = 0;
+        if ( chunk ) {
+            std::memcpy(&first, data.data() + (chunk - 1u) * sizeof(u32), sizeof(u32));
+        }
+        std::memcpy(&last, data.data() + chunk * sizeof(u32), sizeof(u32));
+        if ( first > last || last > data.size() - table_size ) {
+            return false;
+        }
+
+        const std::size_t offset = chunk * entry.chunk_size;
+        if ( offset >= entry.size ) {
+            return false;
+        }
+
+        return lz4::try_decompress(
+            dst + offset,
+            math::min(std::size_t(entry.chunk_size), math::numeric_cast<std::size_t>(entry.size) - offset),
+            buffer_view(data.data() + table_size + first, last - first));
+    }
+
+    bool try_pack_directory(
+        bundle& dst,
+        str_view path,
+        bool compress)
+    {
+        bundle result;
+        bool success = true;
+        const bool traced = filesystem::trace_directory_recursive(path,
+            [&result, &success, path, compress](str_view filename, bool directory){
+                if ( directory ) {
+                    success = result.add_directory(filename);
+                } else {
+                    buffer content;
+                    success = filesystem::try_read_all(content, path::combine(path, filename))
+                        && result.add_file(filename, std::move(content), compress);
+                }
+                return success;
+            });
+        if ( !traced || !success ) {
+            return false;
+        }
+        dst = std::move(result);
+        return true;
+    }
+
+    bool try_save_bundle(
+        const bundle& src,
+        buffer& dst) noexcept
+    {
+        try {
+            struct prepared_entry {
+                const bundle::entry* source = nullptr;
+                buffer compressed;
+                file_entry desc = file_entry();
+            };
+
+            vector<prepared_entry> entries(src.entries().size());
+            for ( std::size_t i = 0; i < entries.size(); ++i ) {
+                prepared_entry& pe = entries[i];
+                const bundle::entry& e = src.entries()[i];
+                pe.source = &e;
+                pe.desc.name_hash = str_hash(e.name).hash();
+                pe.desc.name_size = math::numeric_cast<u32>(e.name.size());
+                pe.desc.size = e.content.size();
+                pe.desc.stored_size = e.content.size();
+                if ( e.directory ) {
+                    pe.desc.flags |= file_entry_directory;
+                    continue;
+                }
+                if ( !e.compress || e.content.empty() ) {
+                    continue;
+                }
+
+                // every chunk is an independent lz4 block,
+                // the table of their end offsets goes first
+                const std::size_t chunk_count = (e.content.size() + chunk_size - 1u) / chunk_size;
+                if ( chunk_count > std::numeric_limits<u32>::max() / sizeof(u32) ) {
+                    continue;
+                }
+                vector<u32> chunk_ends(chunk_count);
+                buffer blocks(lz4::compress_bound(chunk_size) * chunk_count);
+                std::size_t blocks_size = 0u;
+                buffer block;
+                for ( std::size_t c = 0; c < chunk_count; ++c ) {
+                    const std::size_t offset = c * chunk_size;
+                    const std::size_t size = math::min(chunk_size, e.content.size() - offset);
+                    if ( !lz4::try_compress(block, buffer_view(e.content.data() + offset, size)) ) {
+                        return false;
+                    }
+                    std::memcpy(blocks.data() + blocks_size, block.data(), block.size());
+                    blocks_size += block.size();
+                    if ( blocks_size > std::numeric_limits<u32>::max() ) {
+                        return false;
+                    }
+                    chunk_ends[c] = static_cast<u32>(blocks_size);
+                }
+
+                const std::size_t table_size = chunk_count * sizeof(u32);
+                if ( !is_compression_worth(table_size + blocks_size, e.content.size()) ) {
+                    continue;
+                }
+                pe.compressed.resize(table_size + blocks_size);
+                std::memcpy(pe.compressed.data(), chunk_ends.data(), table_size);
+                std::memcpy(pe.compressed.data() + table_size, blocks.data(), blocks_size);
+                pe.desc.flags |= file_entry_compressed;
+                pe.desc.stored_size = pe.compressed.size();
+                pe.desc.chunk_size = static_cast<u32>(chunk_size);
+                pe.desc.chunk_count = static_cast<u32>(chunk_count);
+            }
+
+            // the directory is sorted by hashes, names resolve collisions
+            std::sort(entries.begin(), entries.end(),
+                [](const prepared_entry& l, const prepared_entry& r){
+                    return l.desc.name_hash != r.desc.name_hash
+                        ? l.desc.name_hash < r.desc.name_hash
+                        : l.source->name < r.source->name;
+                });
+
+            file_header header = file_header();
+            std::memcpy(header.signature, bundle_signature, sizeof(bundle_signature));
+            header.version = file_version;
+            header.entry_count = math::numeric_cast<u32>(entries.size());
+            header.directory_offset = sizeof(file_header);
+            header.names_offset = header.directory_offset + entries.size() * sizeof(file_entry);
+
+            std::size_t names_size = 0u;
+            for ( prepared_entry& pe : entries ) {
+                pe.desc.name_offset = math::numeric_cast<u32>(names_size);
+                names_size += pe.desc.name_size;
+            }
+            header.names_size = names_size;
+
+            std::size_t data_offset = align_data_offset(
+                math::numeric_cast<std::size_t>(header.names_offset + names_size));
+            for ( prepared_entry& pe : entries ) {
+                pe.desc.data_offset = data_offset;
+                data_offset = align_data_offset(
+                    data_offset + math::numeric_cast<std::size_t>(pe.desc.stored_size));
+            }
+
+            buffer content(data_offset);
+            content.fill(0);
+            std::memcpy(content.data(), &header, sizeof(header));
+            for ( std::size_t i = 0; i < entries.size(); ++i ) {
+                const prepared_entry& pe = entries[i];
+                std::memcpy(
+                    content.data() + header.directory_offset + i * sizeof(file_entry),
+                    &pe.desc,
+                    sizeof(file_entry));
+                std::memcpy(
+                    content.data() + header.names_offset + pe.desc.name_offset,
+                    pe.source->name.data(),
+                    pe.source->name.size());
+                const buffer& data = (pe.desc.flags & file_entry_compressed)
+                    ? pe.compressed
+                    : pe.source->content;
+                if ( !data.empty() ) {
+                    std::memcpy(
+                        content.data() + pe.desc.data_offset,
+                        data.data(),
+                        data.size());
+                }
+            }
+
+            dst.swap(content);
+            return true;
+        } catch (...) {
+            return false;
+        }
+    }
+
+    bool try_save_bundle(
+        const bundle& src,
+        const output_stream_uptr& dst) noexcept
+    {
+        buffer file_data;
+        return try_save_bundle(src, file_data)
+            && streams::try_write_tail(file_data, dst);
+    }
+}}
+
+namespace e2d { namespace lz4
+{
+    std::size_t compress_bound(std::size_t size) noexcept {
+        return size + size / 255u + 16u;
+    }
+
+    bool try_compress(
+        buffer& dst,
+        buffer_view src)
+    {
+        buffer result(compress_bound(src.size()));
+        const u8* const istart = src.data();
+        const std::size_t isize = src.size();
+        u8* op = result.data();
+
+        std::size_t anchor = 0u;
+        if ( isize > lz4_match_limit ) {
+            // positions are stored plus one, zero is an empty slot
+            vector<u32> table(std::size_t(1u) << lz4_hash_log, 0u);
+            const std::size_t match_limit = isize - lz4_match_limit;
+            const std::size_t match_end_limit = isize - lz4_last_literals;
+            std::size_t ip = 0u;
+            while ( ip < match_limit ) {
+                const u32 sequence = lz4_read_u32(istart + ip);
+                u32& slot = table[lz4_hash(sequence)];
+                const std::size_t ref = slot;
+                slot = static_cast<u32>(ip + 1u);
+
+                if ( !ref
+                    || ip + 1u - ref > lz4_max_offset
+                    || lz4_read_u32(istart + ref - 1u) != sequence )
+                {
+                    ++ip;
+                    continue;
+                }
+
+                const std::size_t match = ref - 1u;
+                std::size_t length = lz4_min_match;
+                while ( ip + length < match_end_limit && istart[match + length] == istart[ip + length] ) {
+                    ++length;
+                }
+
+                op = lz4_write_sequence(op, istart + anchor, ip - anchor, ip - match, length);
+                ip += length;
+                anchor = ip;
+            }
+        }
+
+        op = lz4_write_sequence(op, istart + anchor, isize - anchor, 0u, 0u);
+        result.resize(math::numeric_cast<std::size_t>(op - result.data()));
+        dst.swap(result);
+        return true;
+    }
+
+    bool try_decompress(
+        u8* dst,
+        std::size_t dst_size,
+        buffer_view src) noexcept
+    {
+        const u8* ip = src.data();
+        const u8* const iend = ip + src.size();
+        u8* op = dst;
+        u8* const oend = dst + dst_size;
+
+        while ( ip < iend ) {
+            const u8 token = *ip++;
+
+            std::size_t literal_length = token >> 4u;
+            if ( literal_length == 15u && !lz4_read_length(ip, iend, literal_length) ) {
+                return false;
+            }
+            if ( literal_length > math::numeric_cast<std::size_t>(iend - ip)
+                || literal_length > math::numeric_cast<std::size_t>(oend - op) )
+            {
+                return false;
+            }
+            std::memcpy(op, ip, literal_length);
+            ip += literal_length;
+            op += literal_length;
+
+            // the last sequence ends with literals
+            if ( ip == iend ) {
+                break;
+            }
+
+            if ( iend - ip < 2 ) {
+                return false;
+            }
+            const std::size_t offset = ip[0] | (ip[1] << 8u);
+            ip += 2;
+            if ( !offset || offset > math::numeric_cast<std::size_t>(op - dst) ) {
+                return false;
+            }
+
+            std::size_t match_length = token & 15u;
+            if ( match_length == 15u && !lz4_read_length(ip, iend, match_length) ) {
+                return false;
+            }
+            match_length += lz4_min_match;
+            if ( match_length > math::numeric_cast<std::size_t>(oend - op) ) {
+                return false;
+            }
+
+            // matches may overlap their output
+            const u8* match = op - offset;
+            if ( offset >= match_length ) {
+                std::memcpy(op, match, match_length);
+                op += match_length;
+            } else {
+                for ( std::size_t i = 0; i < match_length; ++i ) {
+                    *op++ = *match++;
+                }
+            }
+        }
+
+        return op == oend;
+    }
+}}
@@ -33,4 +33,5 @@ namespace e2d { namespace impl
 {
     read_file_uptr make_read_file(str_view path) noexcept;
     write_file_uptr make_write_file(str_view path, bool append) noexcept;
+    mapped_input_stream_uptr make_mapped_file(str_view path) noexcept;
 }}
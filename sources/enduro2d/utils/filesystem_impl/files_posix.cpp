@@ -10,6 +10,8 @@
 
 #include <fcntl.h>
 #include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 
 namespace
 {
@@ -181,6 +183,60 @@ namespace
         str path_;
         int handle_ = -1;
     };
+
+    class mapped_file_posix final : public mapped_input_stream {
+    public:
+        mapped_file_posix(str path)
+        : path_(std::move(path))
+        {
+            if ( !open_() ) {
+                throw bad_stream_operation();
+            }
+        }
+
+        ~mapped_file_posix() noexcept final {
+            close_();
+        }
+    public:
+        buffer_view view() const noexcept final {
+            return buffer_view(data_, length_);
+        }
+    private:
+        bool open_() noexcept {
+            const int handle = ::open(path_.c_str(), O_RDONLY);
+            if ( handle < 0 ) {
+                return false;
+            }
+            struct stat st;
+            if ( 0 != ::fstat(handle, &st) || st.st_size < 0 ) {
+                ::close(handle);
+                return false;
+            }
+            length_ = math::numeric_cast<std::size_t>(st.st_size);
+            if ( length_ > 0 ) {
+                void* data = ::mmap(nullptr, length_, PROT_READ, MAP_PRIVATE, handle, 0);
+                if ( MAP_FAILED == data ) {
+                    ::close(handle);
+                    return false;
+                }
+                data_ = data;
+            }
+            // the mapping stays valid after closing the descriptor
+            ::close(handle);
+            return true;
+        }
+
+        void close_() noexcept {
+            if ( data_ ) {
+                ::munmap(data_, length_);
+                data_ = nullptr;
+            }
+        }
+    private:
+        str path_;
+        void* data_ = nullptr;
+        std::size_t length_ = 0;
+    };
 }
 
 namespace e2d { namespace impl
@@ -200,6 +256,14 @@ namespace e2d { namespace impl
             return nullptr;
         }
     }
+
+    mapped_input_stream_uptr make_mapped_file(str_view path) noexcept {
+        try {
+            return std::make_unique<mapped_file_posix>(path);
+        } catch (...) {
+            return nullptr;
+        }
+    }
 }}
 
 #endif
@@ -220,6 +220,74 @@ namespace
         str path_;
         HANDLE handle_ = INVALID_HANDLE_VALUE;
     };
+
+    class mapped_file_winapi final : public mapped_input_stream {
+    public:
+        mapped_file_winapi(str path)
+        : path_(std::move(path))
+        {
+            if ( !open_() ) {
+                throw bad_stream_operation();
+            }
+        }
+
+        ~mapped_file_winapi() noexcept final {
+            close_();
+        }
+    public:
+        buffer_view view() const noexcept final {
+            return buffer_view(data_, length_);
+        }
+    private:
+        bool open_() {
+            const wstr wide_path = make_wide(path_);
+            const HANDLE handle = ::CreateFileW(
+                wide_path.c_str(),
+                GENERIC_READ,
+                FILE_SHARE_READ,
+                NULL,
+                OPEN_EXISTING,
+                FILE_ATTRIBUTE_READONLY,
+                NULL);
+            if ( INVALID_HANDLE_VALUE == handle ) {
+                return false;
+            }
+            LARGE_INTEGER file_size;
+            if ( !::GetFileSizeEx(handle, &file_size) ) {
+                ::CloseHandle(handle);
+                return false;
+            }
+            length_ = math::numeric_cast<std::size_t>(file_size.QuadPart);
+            if ( length_ > 0 ) {
+                const HANDLE mapping = ::CreateFileMappingW(
+                    handle, NULL, PAGE_READONLY, 0, 0, NULL);
+                if ( !mapping ) {
+                    ::CloseHandle(handle);
+                    return false;
+                }
+                data_ = ::MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+                // the view keeps the mapping and the file alive
+                ::CloseHandle(mapping);
+                if ( !data_ ) {
+                    ::CloseHandle(handle);
+                    return false;
+                }
+            }
+            ::CloseHandle(handle);
+            return true;
+        }
+
+        void close_() noexcept {
+            if ( data_ ) {
+                ::UnmapViewOfFile(data_);
+                data_ = nullptr;
+            }
+        }
+    private:
+        str path_;
+        void* data_ = nullptr;
+        std::size_t length_ = 0;
+    };
 }
 
 namespace e2d { namespace impl
@@ -239,6 +307,14 @@ namespace e2d { namespace impl
             return nullptr;
         }
     }
+
+    mapped_input_stream_uptr make_mapped_file(str_view path) noexcept {
+        try {
+            return std::make_unique<mapped_file_winapi>(path);
+        } catch (...) {
+            return nullptr;
+        }
+    }
 }}
 
 #endif
@@ -14,26 +14,28 @@ namespace
         u32 bits_per_pixel;
         image_data_format format;
         bool compressed;
+        v2u block_size;
+        v2u min_size;
     };
 
     const data_format_description data_format_descriptions[] = {
-        { 8, image_data_format::g8,             false},
-        {16, image_data_format::ga8,            false},
-        {24, image_data_format::rgb8,           false},
-        {32, image_data_format::rgba8,          false},
-
-        { 4, image_data_format::rgb_dxt1,       true},
-        { 4, image_data_format::rgba_dxt1,      true},
-        { 8, image_data_format::rgba_dxt3,      true},
-        { 8, image_data_format::rgba_dxt5,      true},
-
-        { 2, image_data_format::rgb_pvrtc2,     true},
-        { 4, image_data_format::rgb_pvrtc4,     true},
-        { 2, image_data_format::rgba_pvrtc2,    true},
-        { 4, image_data_format::rgba_pvrtc4,    true},
-
-        { 2, image_data_format::rgba_pvrtc2_v2, true},
-        { 4, image_data_format::rgba_pvrtc4_v2, true}
+        { 8, image_data_format::g8,             false, {1,1}, { 1,1}},
+        {16, image_data_format::ga8,            false, {1,1}, { 1,1}},
+        {24, image_data_format::rgb8,           false, {1,1}, { 1,1}},
+        {32, image_data_format::rgba8,          false, {1,1}, { 1,1}},
+
+        { 4, image_data_format::rgb_dxt1,       true,  {4,4}, { 4,4}},
+        { 4, image_data_format::rgba_dxt1,      true,  {4,4}, { 4,4}},
+        { 8, image_data_format::rgba_dxt3,      true,  {4,4}, { 4,4}},
+        { 8, image_data_format::rgba_dxt5,      true,  {4,4}, { 4,4}},
+
+        { 2, image_data_format::rgb_pvrtc2,     true,  {8,4}, {16,8}},
+        { 4, image_data_format::rgb_pvrtc4,     true,  {4,4}, { 8,8}},
+        { 2, image_data_format::rgba_pvrtc2,    true,  {8,4}, {16,8}},
+        { 4, image_data_format::rgba_pvrtc4,    true,  {4,4}, { 8,8}},
+
+        { 2, image_data_format::rgba_pvrtc2_v2, true,  {8,4}, { 8,4}},
+        { 4, image_data_format::rgba_pvrtc4_v2, true,  {4,4}, { 4,4}}
     };
 
     const data_format_description& get_data_format_description(image_data_format format) noexcept {
@@ -43,6 +45,36 @@ namespace
         E2D_ASSERT(fdesc.format == format);
         return fdesc;
     }
+
+    u32 round_up(u32 value, u32 multiple) noexcept {
+        return (value + multiple - 1u) / multiple * multiple;
+    }
+
+    void downsample_mipmap(
+        u8* dst,
+        const u8* src,
+        const v2u& src_size,
+        std::size_t bytes_per_pixel) noexcept
+    {
+        const v2u dst_size = math::maximized(src_size / 2u, v2u::unit());
+        const std::size_t src_stride = src_size.x * bytes_per_pixel;
+        for ( u32 y = 0; y < dst_size.y; ++y ) {
+            const u32 y0 = math::min(y * 2u, src_size.y - 1u);
+            const u32 y1 = math::min(y * 2u + 1u, src_size.y - 1u);
+            for ( u32 x = 0; x < dst_size.x; ++x ) {
+                const u32 x0 = math::min(x * 2u, src_size.x - 1u);
+                const u32 x1 = math::min(x * 2u + 1u, src_size.x - 1u);
+                const u8* p00 = src + y0 * src_stride + x0 * bytes_per_pixel;
+                const u8* p01 = src + y0 * src_stride + x1 * bytes_per_pixel;
+                const u8* p10 = src + y1 * src_stride + x0 * bytes_per_pixel;
+                const u8* p11 = src + y1 * src_stride + x1 * bytes_per_pixel;
+                for ( std::size_t c = 0; c < bytes_per_pixel; ++c ) {
+                    *dst++ = static_cast<u8>(
+                        (u32(p00[c]) + p01[c] + p10[c] + p11[c] + 2u) / 4u);
+                }
+            }
+        }
+    }
 }
 
 namespace e2d
@@ -71,6 +103,14 @@ namespace e2d
         assign(size, format, data);
     }
 
+    image::image(const v2u& size, image_data_format format, u32 mipmap_count, buffer&& data) noexcept {
+        assign(size, format, mipmap_count, std::move(data));
+    }
+
+    image::image(const v2u& size, image_data_format format, u32 mipmap_count, const buffer& data) {
+        assign(size, format, mipmap_count, data);
+    }
+
     image& image::assign(image&& other) noexcept {
         if ( this != &other ) {
             swap(other);
@@ -84,21 +124,34 @@ namespace e2d
             data_.assign(other.data_);
             size_ = other.size_;
             format_ = other.format_;
+            mipmap_count_ = other.mipmap_count_;
         }
         return *this;
     }
 
     image& image::assign(const v2u& size, image_data_format format, buffer&& data) noexcept {
+        return assign(size, format, 1u, std::move(data));
+    }
+
+    image& image::assign(const v2u& size, image_data_format format, const buffer& data) {
+        return assign(size, format, 1u, data);
+    }
+
+    image& image::assign(const v2u& size, image_data_format format, u32 mipmap_count, buffer&& data) noexcept {
+        E2D_ASSERT(mipmap_count > 0u && mipmap_count <= images::max_mipmap_count(size));
         data_.assign(std::move(data));
         size_ = size;
         format_ = format;
+        mipmap_count_ = mipmap_count;
         return *this;
     }
 
-    image& image::assign(const v2u& size, image_data_format format, const buffer& data) {
+    image& image::assign(const v2u& size, image_data_format format, u32 mipmap_count, const buffer& data) {
+        E2D_ASSERT(mipmap_count > 0u && mipmap_count <= images::max_mipmap_count(size));
         data_.assign(data);
         size_ = size;
         format_ = format;
+        mipmap_count_ = mipmap_count;
         return *this;
     }
 
@@ -107,12 +160,14 @@ namespace e2d
         swap(data_, other.data_);
         swap(size_, other.size_);
         swap(format_, other.format_);
+        swap(mipmap_count_, other.mipmap_count_);
     }
 
     void image::clear() noexcept {
         data_.clear();
         size_ = v2u::zero();
         format_ = image_data_format::rgba8;
+        mipmap_count_ = 1u;
     }
 
     bool image::empty() const noexcept {
@@ -188,6 +243,25 @@ namespace e2d
     const buffer& image::data() const noexcept {
         return data_;
     }
+
+    u32 image::mipmap_count() const noexcept {
+        return mipmap_count_;
+    }
+
+    v2u image::mipmap_size(u32 level) const noexcept {
+        E2D_ASSERT(level < mipmap_count_);
+        return math::maximized(
+            v2u(size_.x >> level, size_.y >> level),
+            v2u::unit());
+    }
+
+    buffer_view image::mipmap_data(u32 level) const noexcept {
+        E2D_ASSERT(level < mipmap_count_);
+        const std::size_t offset = images::mipmap_chain_data_size(size_, format_, level);
+        const std::size_t size = images::mipmap_data_size(mipmap_size(level), format_);
+        E2D_ASSERT(offset + size <= data_.size());
+        return buffer_view(data_.data() + offset, size);
+    }
 }
 
 namespace e2d
@@ -199,6 +273,7 @@ namespace e2d
     bool operator==(const image& l, const image& r) noexcept {
         return l.format() == r.format()
             && l.size() == r.size()
+            && l.mipmap_count() == r.mipmap_count()
             && l.data() == r.data();
     }
 
@@ -209,9 +284,91 @@ namespace e2d
 
 namespace e2d { namespace images
 {
+    bool is_compressed_format(image_data_format format) noexcept {
+        return get_data_format_description(format).compressed;
+    }
+
+    std::size_t bits_per_pixel(image_data_format format) noexcept {
+        return get_data_format_description(format).bits_per_pixel;
+    }
+
+    std::size_t mipmap_data_size(const v2u& size, image_data_format format) noexcept {
+        const data_format_description& format_desc =
+            get_data_format_description(format);
+        if ( size.x == 0 || size.y == 0 ) {
+            return 0u;
+        }
+        const std::size_t width = round_up(
+            math::max(size.x, format_desc.min_size.x),
+            format_desc.block_size.x);
+        const std::size_t height = round_up(
+            math::max(size.y, format_desc.min_size.y),
+            format_desc.block_size.y);
+        return width * height * format_desc.bits_per_pixel / 8u;
+    }
+
+    std::size_t mipmap_chain_data_size(const v2u& size, image_data_format format, u32 mipmap_count) noexcept {
+        std::size_t result = 0u;
+        for ( u32 level = 0; level < mipmap_count; ++level ) {
+            result += mipmap_data_size(
+                math::maximized(v2u(size.x >> level, size.y >> level), v2u::unit()),
+                format);
+        }
+        return result;
+    }
+
+    u32 max_mipmap_count(const v2u& size) noexcept {
+        u32 result = 1u;
+        for ( u32 s = math::maximum(size); s > 1u; s >>= 1u ) {
+            ++result;
+        }
+        return result;
+    }
+
+    bool try_generate_mipmaps(
+        image& dst,
+        const image& src) noexcept
+    {
+        const data_format_description& format_desc =
+            get_data_format_description(src.format());
+        if ( src.empty() || format_desc.compressed ) {
+            return false;
+        }
+
+        try {
+            const u32 mipmap_count = max_mipmap_count(src.size());
+            buffer data(mipmap_chain_data_size(src.size(), src.format(), mipmap_count));
+
+            const buffer_view first = src.mipmap_data(0u);
+            std::memcpy(data.data(), first.data(), first.size());
+
+            const std::size_t bytes_per_pixel = format_desc.bits_per_pixel / 8u;
+            u8* src_level = data.data();
+            v2u src_size = src.size();
+            for ( u32 level = 1; level < mipmap_count; ++level ) {
+                u8* dst_level = src_level + mipmap_data_size(src_size, src.format());
+                downsample_mipmap(dst_level, src_level, src_size, bytes_per_pixel);
+                src_level = dst_level;
+                src_size = math::maximized(src_size / 2u, v2u::unit());
+            }
+
+            dst.assign(src.size(), src.format(), mipmap_count, std::move(data));
+            return true;
+        } catch (...) {
+            return false;
+        }
+    }
+
     bool try_load_image(
         image& dst,
         const buffer& src) noexcept
+    {
+        return try_load_image(dst, buffer_view(src));
+    }
+
+    bool try_load_image(
+        image& dst,
+        buffer_view src) noexcept
     {
         return impl::try_load_image_dds(dst, src)
             || impl::try_load_image_pvr(dst, src)
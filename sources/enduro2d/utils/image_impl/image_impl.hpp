@@ -8,12 +8,13 @@
 
 #include <enduro2d/utils/image.hpp>
 #include <enduro2d/utils/buffer.hpp>
+#include <enduro2d/utils/buffer_view.hpp>
 
 namespace e2d { namespace images { namespace impl
 {
-    bool try_load_image_dds(image& dst, const buffer& src) noexcept;
-    bool try_load_image_pvr(image& dst, const buffer& src) noexcept;
-    bool try_load_image_stb(image& dst, const buffer& src) noexcept;
+    bool try_load_image_dds(image& dst, buffer_view src) noexcept;
+    bool try_load_image_pvr(image& dst, buffer_view src) noexcept;
+    bool try_load_image_stb(image& dst, buffer_view src) noexcept;
 
     bool try_save_image_dds(const image& src, buffer& dst) noexcept;
     bool try_save_image_jpg(const image& src, buffer& dst) noexcept;
@@ -6,11 +6,180 @@
 
 #include "image_impl.hpp"
 
-namespace e2d { namespace images { namespace impl
+namespace
 {
-    bool try_load_image_dds(image& dst, const buffer& src) noexcept {
-        //TODO(BlackMat): implme
-        E2D_UNUSED(dst, src);
+    using namespace e2d;
+
+    constexpr u32 make_fourcc(char a, char b, char c, char d) noexcept {
+        return u32(u8(a))
+            | (u32(u8(b)) << 8u)
+            | (u32(u8(c)) << 16u)
+            | (u32(u8(d)) << 24u);
+    }
+
+    const u32 dds_magic = make_fourcc('D', 'D', 'S', ' ');
+
+    const u32 ddsd_mipmapcount = 0x20000u;
+
+    const u32 ddpf_alphapixels = 0x1u;
+    const u32 ddpf_fourcc = 0x4u;
+    const u32 ddpf_rgb = 0x40u;
+    const u32 ddpf_luminance = 0x20000u;
+
+    const u32 ddscaps2_cubemap = 0x200u;
+    const u32 ddscaps2_volume = 0x200000u;
+
+    struct dds_pixel_format {
+        u32 size;
+        u32 flags;
+        u32 fourcc;
+        u32 rgb_bit_count;
+        u32 r_mask;
+        u32 g_mask;
+        u32 b_mask;
+        u32 a_mask;
+    };
+
+    struct dds_header {
+        u32 size;
+        u32 flags;
+        u32 height;
+        u32 width;
+        u32 pitch_or_linear_size;
+        u32 depth;
+        u32 mipmap_count;
+        u32 reserved1[11];
+        dds_pixel_format pixel_format;
+        u32 caps;
+        u32 caps2;
+        u32 caps3;
+        u32 caps4;
+        u32 reserved2;
+    };
+
+    static_assert(sizeof(dds_pixel_format) == 32, "unexpected dds pixel format size");
+    static_assert(sizeof(dds_header) == 124, "unexpected dds header size");
+
+    enum class dds_swizzle : u8 {
+        none,
+        bgr
+    };
+
+    bool try_parse_data_format(
+        const dds_pixel_format& pf,
+        image_data_format& format,
+        dds_swizzle& swizzle) noexcept
+    {
+        swizzle = dds_swizzle::none;
+        if ( pf.flags & ddpf_fourcc ) {
+            if ( pf.fourcc == make_fourcc('D', 'X', 'T', '1') ) {
+                format = (pf.flags & ddpf_alphapixels)
+                    ? image_data_format::rgba_dxt1
+                    : image_data_format::rgb_dxt1;
+                return true;
+            }
+            if ( pf.fourcc == make_fourcc('D', 'X', 'T', '3') ) {
+                format = image_data_format::rgba_dxt3;
+                return true;
+            }
+            if ( pf.fourcc == make_fourcc('D', 'X', 'T', '5') ) {
+                format = image_data_format::rgba_dxt5;
+                return true;
+            }
+            return false;
+        }
+        if ( pf.flags & ddpf_luminance ) {
+            if ( pf.rgb_bit_count == 8 && !(pf.flags & ddpf_alphapixels) ) {
+                format = image_data_format::g8;
+                return true;
+            }
+            if ( pf.rgb_bit_count == 16 && (pf.flags & ddpf_alphapixels)
+                && pf.r_mask == 0xFFu && pf.a_mask == 0xFF00u )
+            {
+                format = image_data_format::ga8;
+                return true;
+            }
+            return false;
+        }
+        if ( pf.flags & ddpf_rgb ) {
+            const bool alpha = pf.flags & ddpf_alphapixels;
+            if ( pf.rgb_bit_count == 32 && alpha && pf.a_mask == 0xFF000000u ) {
+                format = image_data_format::rgba8;
+            } else if ( pf.rgb_bit_count == 24 && !alpha ) {
+                format = image_data_format::rgb8;
+            } else {
+                return false;
+            }
+            if ( pf.r_mask == 0xFFu && pf.g_mask == 0xFF00u && pf.b_mask == 0xFF0000u ) {
+                return true;
+            }
+            if ( pf.r_mask == 0xFF0000u && pf.g_mask == 0xFF00u && pf.b_mask == 0xFFu ) {
+                swizzle = dds_swizzle::bgr;
+                return true;
+            }
+            return false;
+        }
         return false;
     }
+
+    void swizzle_bgr_to_rgb(buffer& data, std::size_t bytes_per_pixel) noexcept {
+        u8* const pixels = data.data();
+        for ( std::size_t i = 0; i + bytes_per_pixel <= data.size(); i += bytes_per_pixel ) {
+            std::swap(pixels[i], pixels[i + 2]);
+        }
+    }
+}
+
+namespace e2d { namespace images { namespace impl
+{
+    bool try_load_image_dds(image& dst, buffer_view src) noexcept {
+        if ( src.size() < sizeof(u32) + sizeof(dds_header) ) {
+            return false;
+        }
+
+        u32 magic = 0;
+        std::memcpy(&magic, src.data(), sizeof(magic));
+        if ( magic != dds_magic ) {
+            return false;
+        }
+
+        dds_header header;
+        std::memcpy(&header, src.data() + sizeof(magic), sizeof(header));
+        if ( header.size != sizeof(dds_header)
+            || header.pixel_format.size != sizeof(dds_pixel_format)
+            || (header.caps2 & (ddscaps2_cubemap | ddscaps2_volume))
+            || header.width == 0
+            || header.height == 0 )
+        {
+            return false;
+        }
+
+        image_data_format format = image_data_format::rgba8;
+        dds_swizzle swizzle = dds_swizzle::none;
+        if ( !try_parse_data_format(header.pixel_format, format, swizzle) ) {
+            return false;
+        }
+
+        const v2u size(header.width, header.height);
+        const u32 mipmap_count = (header.flags & ddsd_mipmapcount) && header.mipmap_count
+            ? math::min(header.mipmap_count, max_mipmap_count(size))
+            : 1u;
+
+        const std::size_t data_offset = sizeof(magic) + sizeof(header);
+        const std::size_t data_size = mipmap_chain_data_size(size, format, mipmap_count);
+        if ( src.size() - data_offset < data_size ) {
+            return false;
+        }
+
+        try {
+            buffer data(src.data() + data_offset, data_size);
+            if ( swizzle == dds_swizzle::bgr ) {
+                swizzle_bgr_to_rgb(data, bits_per_pixel(format) / 8u);
+            }
+            dst.assign(size, format, mipmap_count, std::move(data));
+            return true;
+        } catch (...) {
+            return false;
+        }
+    }
 }}}
@@ -6,11 +6,160 @@
 
 #include "image_impl.hpp"
 
+namespace
+{
+    using namespace e2d;
+
+    const u32 pvr_version = 0x03525650u;
+
+    enum class pvr_compressed_format : u32 {
+        pvrtc_2bpp_rgb = 0,
+        pvrtc_2bpp_rgba = 1,
+        pvrtc_4bpp_rgb = 2,
+        pvrtc_4bpp_rgba = 3,
+        pvrtc_ii_2bpp = 4,
+        pvrtc_ii_4bpp = 5,
+        dxt1 = 7,
+        dxt3 = 9,
+        dxt5 = 11
+    };
+
+    // uncompressed formats store channel names in the low bytes
+    // and channel bit rates in the high bytes of the pixel format
+    constexpr u64 make_pixel_format(
+        char c0, char c1, char c2, char c3,
+        u8 r0, u8 r1, u8 r2, u8 r3) noexcept
+    {
+        return u64(u8(c0))
+            | (u64(u8(c1)) << 8u)
+            | (u64(u8(c2)) << 16u)
+            | (u64(u8(c3)) << 24u)
+            | (u64(r0) << 32u)
+            | (u64(r1) << 40u)
+            | (u64(r2) << 48u)
+            | (u64(r3) << 56u);
+    }
+
+    #pragma pack(push, 4)
+    struct pvr_header {
+        u32 version;
+        u32 flags;
+        u64 pixel_format;
+        u32 color_space;
+        u32 channel_type;
+        u32 height;
+        u32 width;
+        u32 depth;
+        u32 surface_count;
+        u32 face_count;
+        u32 mipmap_count;
+        u32 meta_data_size;
+    };
+    #pragma pack(pop)
+
+    static_assert(sizeof(pvr_header) == 52, "unexpected pvr header size");
+
+    bool try_parse_data_format(u64 pixel_format, image_data_format& format) noexcept {
+        if ( (pixel_format >> 32u) == 0 ) {
+            switch ( static_cast<pvr_compressed_format>(pixel_format) ) {
+                case pvr_compressed_format::pvrtc_2bpp_rgb:
+                    format = image_data_format::rgb_pvrtc2;
+                    return true;
+                case pvr_compressed_format::pvrtc_2bpp_rgba:
+                    format = image_data_format::rgba_pvrtc2;
+                    return true;
+                case pvr_compressed_format::pvrtc_4bpp_rgb:
+                    format = image_data_format::rgb_pvrtc4;
+                    return true;
+                case pvr_compressed_format::pvrtc_4bpp_rgba:
+                    format = image_data_format::rgba_pvrtc4;
+                    return true;
+                case pvr_compressed_format::pvrtc_ii_2bpp:
+                    format = image_data_format::rgba_pvrtc2_v2;
+                    return true;
+                case pvr_compressed_format::pvrtc_ii_4bpp:
+                    format = image_data_format::rgba_pvrtc4_v2;
+                    return true;
+                case pvr_compressed_format::dxt1:
+                    format = image_data_format::rgba_dxt1;
+                    return true;
+                case pvr_compressed_format::dxt3:
+                    format = image_data_format::rgba_dxt3;
+                    return true;
+                case pvr_compressed_format::dxt5:
+                    format = image_data_format::rgba_dxt5;
+                    return true;
+                default:
+                    return false;
+            }
+        }
+        switch ( pixel_format ) {
+            case make_pixel_format('l', 0, 0, 0, 8, 0, 0, 0):
+                format = image_data_format::g8;
+                return true;
+            case make_pixel_format('l', 'a', 0, 0, 8, 8, 0, 0):
+                format = image_data_format::ga8;
+                return true;
+            case make_pixel_format('r', 'g', 'b', 0, 8, 8, 8, 0):
+                format = image_data_format::rgb8;
+                return true;
+            case make_pixel_format('r', 'g', 'b', 'a', 8, 8, 8, 8):
+                format = image_data_format::rgba8;
+                return true;
+            default:
+                return false;
+        }
+    }
+}
+
 namespace e2d { namespace images { namespace impl
 {
-    bool try_load_image_pvr(image& dst, const buffer& src) noexcept {
-        //TODO(BlackMat): implme
-        E2D_UNUSED(dst, src);
-        return false;
+    bool try_load_image_pvr(image& dst, buffer_view src) noexcept {
+        if ( src.size() < sizeof(pvr_header) ) {
+            return false;
+        }
+
+        pvr_header header;
+        std::memcpy(&header, src.data(), sizeof(header));
+        if ( header.version != pvr_version
+            || header.width == 0
+            || header.height == 0
+            || header.depth > 1
+            || header.surface_count > 1
+            || header.face_count > 1 )
+        {
+            return false;
+        }
+
+        image_data_format format = image_data_format::rgba8;
+        if ( !try_parse_data_format(header.pixel_format, format) ) {
+            return false;
+        }
+
+        const v2u size(header.width, header.height);
+        const u32 mipmap_count = header.mipmap_count
+            ? math::min(header.mipmap_count, max_mipmap_count(size))
+            : 1u;
+
+        if ( src.size() - sizeof(header) < header.meta_data_size ) {
+            return false;
+        }
+
+        const std::size_t data_offset = sizeof(header) + header.meta_data_size;
+        const std::size_t data_size = mipmap_chain_data_size(size, format, mipmap_count);
+        if ( src.size() - data_offset < data_size ) {
+            return false;
+        }
+
+        try {
+            dst.assign(
+                size,
+                format,
+                mipmap_count,
+                buffer(src.data() + data_offset, data_size));
+            return true;
+        } catch (...) {
+            return false;
+        }
     }
 }}}
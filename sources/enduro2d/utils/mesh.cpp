@@ -297,6 +297,13 @@ namespace e2d { namespace meshes
     bool try_load_mesh(
         mesh& dst,
         const buffer& src) noexcept
+    {
+        return try_load_mesh(dst, buffer_view(src));
+    }
+
+    bool try_load_mesh(
+        mesh& dst,
+        buffer_view src) noexcept
     {
         return impl::try_load_mesh_e2d(dst, src);
     }
@@ -8,8 +8,9 @@
 
 #include <enduro2d/utils/mesh.hpp>
 #include <enduro2d/utils/buffer.hpp>
+#include <enduro2d/utils/buffer_view.hpp>
 
 namespace e2d { namespace meshes { namespace impl
 {
-    bool try_load_mesh_e2d(mesh& dst, const buffer& src) noexcept;
+    bool try_load_mesh_e2d(mesh& dst, buffer_view src) noexcept;
 }}}
@@ -114,9 +114,9 @@ namespace
 
 namespace e2d { namespace meshes { namespace impl
 {
-    bool try_load_mesh_e2d(mesh& dst, const buffer& src) noexcept {
+    bool try_load_mesh_e2d(mesh& dst, buffer_view src) noexcept {
         try {
-            auto stream = make_memory_stream(src);
+            input_stream_uptr stream = make_memory_view_stream(src);
             return stream
                 && check_signature(stream)
                 && load_mesh(dst, stream);
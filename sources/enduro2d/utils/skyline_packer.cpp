@@ -0,0 +1,176 @@
+/*******************************************************************************
+ * This file is part of the "Enduro2D"
+ * For conditions of distribution and use, see copyright notice in LICENSE.md
+ * Copyright (C) 2018 Matvey Cherevko
+ ******************************************************************************/
+
+#include <enduro2d/utils/skyline_packer.hpp>
+
+namespace e2d
+{
+    skyline_packer::skyline_packer(skyline_packer&& other) noexcept {
+        assign(std::move(other));
+    }
+
+    skyline_packer& skyline_packer::operator=(skyline_packer&& other) noexcept {
+        return assign(std::move(other));
+    }
+
+    skyline_packer::skyline_packer(const skyline_packer& other) {
+        assign(other);
+    }
+
+    skyline_packer& skyline_packer::operator=(const skyline_packer& other) {
+        return assign(other);
+    }
+
+    skyline_packer::skyline_packer(const v2u& size) {
+        reset(size);
+    }
+
+    skyline_packer& skyline_packer::assign(skyline_packer&& other) noexcept {
+        if ( this != &other ) {
+            swap(other);
+            other.clear();
+        }
+        return *this;
+    }
+
+    skyline_packer& skyline_packer::assign(const skyline_packer& other) {
+        if ( this != &other ) {
+            skyline_ = other.skyline_;
+            size_ = other.size_;
+            used_area_ = other.used_area_;
+        }
+        return *this;
+    }
+
+    void skyline_packer::swap(skyline_packer& other) noexcept {
+        using std::swap;
+        swap(skyline_, other.skyline_);
+        swap(size_, other.size_);
+        swap(used_area_, other.used_area_);
+    }
+
+    void skyline_packer::clear() noexcept {
+        skyline_.clear();
+        size_ = v2u::zero();
+        used_area_ = 0u;
+    }
+
+    void skyline_packer::reset(const v2u& size) {
+        skyline_.clear();
+        if ( size.x > 0u && size.y > 0u ) {
+            skyline_.push_back({0u, 0u, size.x});
+        }
+        size_ = size;
+        used_area_ = 0u;
+    }
+
+    bool skyline_packer::insert(const v2u& size, b2u& result) {
+        if ( !size.x || !size.y ) {
+            return false;
+        }
+
+        std::size_t best_index = skyline_.size();
+        u32 best_top = std::numeric_limits<u32>::max();
+        u32 best_width = std::numeric_limits<u32>::max();
+        u32 best_y = 0u;
+
+        for ( std::size_t i = 0; i < skyline_.size(); ++i ) {
+            u32 y = 0u;
+            if ( !fit_(i, size, y) ) {
+                continue;
+            }
+            const u32 top = y + size.y;
+            if ( top < best_top || (top == best_top && skyline_[i].width < best_width) ) {
+                best_index = i;
+                best_top = top;
+                best_width = skyline_[i].width;
+                best_y = y;
+            }
+        }
+
+        if ( best_index == skyline_.size() ) {
+            return false;
+        }
+
+        const b2u rect(skyline_[best_index].x, best_y, size.x, size.y);
+        place_(best_index, rect);
+        used_area_ += u64(size.x) * size.y;
+        result = rect;
+        return true;
+    }
+
+    const v2u& skyline_packer::size() const noexcept {
+        return size_;
+    }
+
+    u64 skyline_packer::used_area() const noexcept {
+        return used_area_;
+    }
+
+    f32 skyline_packer::occupancy() const noexcept {
+        const u64 area = u64(size_.x) * size_.y;
+        return area
+            ? static_cast<f32>(static_cast<f64>(used_area_) / static_cast<f64>(area))
+            : 0.f;
+    }
+
+    bool skyline_packer::fit_(std::size_t index, const v2u& size, u32& y) const noexcept {
+        const u32 x = skyline_[index].x;
+        if ( size.x > size_.x - x ) {
+            return false;
+        }
+        u32 width_left = size.x;
+        y = skyline_[index].y;
+        for ( std::size_t i = index; width_left > 0u; ++i ) {
+            E2D_ASSERT(i < skyline_.size());
+            y = math::max(y, skyline_[i].y);
+            if ( size.y > size_.y - y ) {
+                return false;
+            }
+            width_left -= math::min(width_left, skyline_[i].width);
+        }
+        return true;
+    }
+
+    void skyline_packer::place_(std::size_t index, const b2u& rect) {
+        const segment placed{rect.position.x, rect.position.y + rect.size.y, rect.size.x};
+        skyline_.insert(skyline_.begin() + math::numeric_cast<std::ptrdiff_t>(index), placed);
+
+        // shrink or remove segments covered by the placed one
+        const u32 placed_right = placed.x + placed.width;
+        for ( std::size_t i = index + 1; i < skyline_.size(); ) {
+            segment& seg = skyline_[i];
+            if ( seg.x >= placed_right ) {
+                break;
+            }
+            const u32 shrink = placed_right - seg.x;
+            if ( seg.width <= shrink ) {
+                skyline_.erase(skyline_.begin() + math::numeric_cast<std::ptrdiff_t>(i));
+            } else {
+                seg.x += shrink;
+                seg.width -= shrink;
+                break;
+            }
+        }
+
+        // merge the placed segment with its neighbours of the same height
+        if ( index + 1 < skyline_.size() && skyline_[index + 1].y == placed.y ) {
+            skyline_[index].width += skyline_[index + 1].width;
+            skyline_.erase(skyline_.begin() + math::numeric_cast<std::ptrdiff_t>(index + 1));
+        }
+        if ( index > 0 && skyline_[index - 1].y == placed.y ) {
+            skyline_[index - 1].width += skyline_[index].width;
+            skyline_.erase(skyline_.begin() + math::numeric_cast<std::ptrdiff_t>(index));
+        }
+    }
+}
+
+namespace e2d
+{
+    void swap(skyline_packer& l, skyline_packer& r) noexcept {
+        l.swap(r);
+    }
+}
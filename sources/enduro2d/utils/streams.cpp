@@ -11,54 +11,78 @@ namespace
 {
     using namespace e2d;
 
-    class memory_stream final : public input_stream {
+    class memory_stream final : public mapped_input_stream {
     public:
         memory_stream(buffer data) noexcept
         : data_(std::move(data)) {}
 
-        std::size_t read(void* dst, std::size_t size) final {
-            const std::size_t read_bytes = dst
-                ? math::min(size, data_.size() - pos_)
-                : 0;
-            if ( read_bytes > 0 ) {
-                std::memcpy(dst, data_.data() + pos_, read_bytes);
-                pos_ += read_bytes;
-            }
-            return read_bytes;
+        buffer_view view() const noexcept final {
+            return data_;
         }
+    private:
+        buffer data_;
+    };
 
-        std::size_t seek(std::ptrdiff_t offset, bool relative) final {
-            if ( offset < 0 ) {
-                const std::size_t uoffset = math::abs_to_unsigned(offset);
-                if ( !relative || uoffset > pos_ ) {
-                    throw bad_stream_operation();
-                }
-                pos_ -= uoffset;
-                return pos_;
-            } else {
-                const std::size_t uoffset = math::abs_to_unsigned(offset);
-                const std::size_t available_bytes = relative
-                    ? data_.size() - pos_
-                    : data_.size();
-                if ( uoffset > available_bytes ) {
-                    throw bad_stream_operation();
-                }
-                pos_ = uoffset + (data_.size() - available_bytes);
-                return pos_;
-            }
+    class memory_view_stream final : public mapped_input_stream {
+    public:
+        memory_view_stream(buffer_view data) noexcept
+        : data_(data) {}
+
+        buffer_view view() const noexcept final {
+            return data_;
         }
+    private:
+        buffer_view data_;
+    };
+}
 
-        std::size_t tell() const final {
-            return pos_;
+namespace e2d
+{
+    //
+    // mapped_input_stream
+    //
+
+    std::size_t mapped_input_stream::read(void* dst, std::size_t size) {
+        const buffer_view data = view();
+        const std::size_t read_bytes = dst
+            ? math::min(size, data.size() - pos_)
+            : 0;
+        if ( read_bytes > 0 ) {
+            std::memcpy(dst, data.data() + pos_, read_bytes);
+            pos_ += read_bytes;
         }
+        return read_bytes;
+    }
 
-        std::size_t length() const noexcept final {
-            return data_.size();
+    std::size_t mapped_input_stream::seek(std::ptrdiff_t offset, bool relative) {
+        const std::size_t data_size = view().size();
+        if ( offset < 0 ) {
+            const std::size_t uoffset = math::abs_to_unsigned(offset);
+            if ( !relative || uoffset > pos_ ) {
+                throw bad_stream_operation();
+            }
+            pos_ -= uoffset;
+            return pos_;
+        } else {
+            const std::size_t uoffset = math::abs_to_unsigned(offset);
+            const std::size_t available_bytes = relative
+                ? data_size - pos_
+                : data_size;
+            if ( uoffset > available_bytes ) {
+                throw bad_stream_operation();
+            }
+            pos_ = uoffset + (data_size - available_bytes);
+            return pos_;
         }
-    private:
-        buffer data_;
-        std::size_t pos_ = 0;
-    };
+    }
+
+    std::size_t mapped_input_stream::tell() const {
+        return pos_;
+    }
+
+    std::size_t mapped_input_stream::length() const noexcept {
+        return view().size();
+    }
 }
 
 namespace e2d
@@ -203,12 +227,24 @@ namespace e2d
 namespace e2d
 {
     input_stream_uptr make_memory_stream(buffer data) noexcept {
+        return make_mapped_memory_stream(std::move(data));
+    }
+
+    mapped_input_stream_uptr make_mapped_memory_stream(buffer data) noexcept {
         try {
             return std::make_unique<memory_stream>(std::move(data));
         } catch (...) {
             return nullptr;
         }
     }
+
+    mapped_input_stream_uptr make_memory_view_stream(buffer_view data) noexcept {
+        try {
+            return std::make_unique<memory_view_stream>(data);
+        } catch (...) {
+            return nullptr;
+        }
+    }
 }
 
 namespace e2d { namespace streams
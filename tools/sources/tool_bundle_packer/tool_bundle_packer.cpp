@@ -0,0 +1,62 @@
+/*******************************************************************************
+ * This file is part of the "Enduro2D"
+ * For conditions of distribution and use, see copyright notice in LICENSE.md
+ * Copyright (C) 2018 Matvey Cherevko
+ ******************************************************************************/
+
+#include <enduro2d/enduro2d.hpp>
+using namespace e2d;
+
+namespace
+{
+    void print_usage() {
+        std::printf(
+            "usage: tool_bundle_packer [--store] <directory> <bundle>\n"
+            "  --store  don't compress entries\n");
+    }
+}
+
+int e2d_main(int argc, char *argv[]) {
+    bool compress = true;
+    vector<str> paths;
+    for ( int i = 1; i < argc; ++i ) {
+        const str_view arg(argv[i]);
+        if ( arg == "--store" ) {
+            compress = false;
+        } else {
+            paths.push_back(arg);
+        }
+    }
+
+    if ( paths.size() != 2u ) {
+        print_usage();
+        return 1;
+    }
+
+    bundle content;
+    if ( !bundles::try_pack_directory(content, paths[0], compress) ) {
+        std::printf("failed to read directory: %s\n", paths[0].c_str());
+        return 1;
+    }
+
+    buffer file_data;
+    if ( !bundles::try_save_bundle(content, file_data) ) {
+        std::printf("failed to pack bundle\n");
+        return 1;
+    }
+
+    if ( !filesystem::try_write_all(file_data, paths[1], false) ) {
+        std::printf("failed to write bundle: %s\n", paths[1].c_str());
+        return 1;
+    }
+
+    std::size_t content_size = 0u;
+    for ( const bundle::entry& e : content.entries() ) {
+        content_size += e.content.size();
+    }
+    std::printf("packed %zu entries, %zu -> %zu bytes\n",
+        content.entries().size(),
+        content_size,
+        file_data.size());
+    return 0;
+}
@@ -0,0 +1,89 @@
+/*******************************************************************************
+ * This file is part of the "Enduro2D"
+ * For conditions of distribution and use, see copyright notice in LICENSE.md
+ * Copyright (C) 2018 Matvey Cherevko
+ ******************************************************************************/
+
+#include "_core.hpp"
+using namespace e2d;
+
+TEST_CASE("deferrer"){
+    SECTION("upload_bytes"){
+        deferrer d;
+        d.upload_budget(100u, 0.f);
+
+        vector<int> order;
+        vector<stdex::promise<int>> results;
+        for ( int i = 0; i < 5; ++i ) {
+            results.push_back(d.do_upload_in_main_thread(40u, [&order](int v){
+                order.push_back(v);
+                return v;
+            }, i));
+        }
+        REQUIRE(d.upload_queue_size() == 5u);
+
+        const deferrer::upload_statistics& stats1 = d.process_upload_tasks();
+        REQUIRE(stats1.processed_tasks == 2u);
+        REQUIRE(stats1.processed_bytes == 80u);
+        REQUIRE(stats1.queued_tasks == 3u);
+
+        const deferrer::upload_statistics& stats2 = d.process_upload_tasks();
+        REQUIRE(stats2.processed_tasks == 2u);
+        REQUIRE(d.last_upload_statistics().queued_tasks == 1u);
+
+        d.process_upload_tasks();
+        REQUIRE(d.upload_queue_size() == 0u);
+        REQUIRE(order == vector<int>{0, 1, 2, 3, 4});
+        for ( int i = 0; i < 5; ++i ) {
+            REQUIRE(results[i].get() == i);
+        }
+
+        const deferrer::upload_statistics& stats3 = d.process_upload_tasks();
+        REQUIRE(stats3.processed_tasks == 0u);
+        REQUIRE(stats3.queued_tasks == 0u);
+    }
+    SECTION("upload_oversized"){
+        deferrer d;
+        d.upload_budget(10u, 0.f);
+        auto p1 = d.do_upload_in_main_thread(100u, [](){ return 1; });
+        auto p2 = d.do_upload_in_main_thread(100u, [](){ return 2; });
+        REQUIRE(d.process_upload_tasks().processed_tasks == 1u);
+        REQUIRE(p1.get() == 1);
+        REQUIRE(d.process_upload_tasks().processed_tasks == 1u);
+        REQUIRE(p2.get() == 2);
+    }
+    SECTION("upload_time"){
+        deferrer d;
+        d.upload_budget(0u, 1.f);
+        for ( std::size_t i = 0; i < 3; ++i ) {
+            d.do_upload_in_main_thread(0u, [](){
+                std::this_thread::sleep_for(std::chrono::milliseconds(2));
+            });
+        }
+        const deferrer::upload_statistics& stats = d.process_upload_tasks();
+        REQUIRE(stats.processed_tasks == 1u);
+        REQUIRE(stats.processed_ms >= 1.f);
+        REQUIRE(stats.queued_tasks == 2u);
+    }
+    SECTION("upload_wait"){
+        deferrer d;
+        d.upload_budget(1u, 0.f);
+        auto p = d.do_in_worker_thread([](){ return 40; })
+            .then([&d](int v){
+                return d.do_upload_in_main_thread(100u, [v](){ return v + 2; });
+            });
+        d.active_safe_wait_promise(p);
+        REQUIRE(p.get() == 42);
+    }
+    SECTION("upload_errors"){
+        auto p = stdex::promise<int>();
+        {
+            deferrer d;
+            auto e = d.do_upload_in_main_thread(0u, [](){ throw std::logic_error("error"); });
+            d.process_upload_tasks();
+            REQUIRE_THROWS_AS(e.get(), std::logic_error);
+            p = d.do_upload_in_main_thread(0u, [](){ return 42; });
+        }
+        REQUIRE_THROWS_AS(p.get(), stdex::scheduler_cancelled_exception);
+    }
+}
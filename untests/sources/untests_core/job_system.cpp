@@ -0,0 +1,172 @@
+/*******************************************************************************
+ * This file is part of the "Enduro2D"
+ * For conditions of distribution and use, see copyright notice in LICENSE.md
+ * Copyright (C) 2018 Matvey Cherevko
+ ******************************************************************************/
+
+#include "_core.hpp"
+using namespace e2d;
+
+TEST_CASE("job_system"){
+    SECTION("async"){
+        job_system js(2u);
+        REQUIRE(js.thread_count() == 2u);
+
+        auto p1 = js.async([](int a, int b){ return a + b; }, 40, 2);
+        auto p2 = js.async([](){ throw std::logic_error("error"); });
+        auto p3 = js.async([](str s){ return s + "!"; }, str("hello"));
+        REQUIRE(p1.get() == 42);
+        REQUIRE_THROWS_AS(p2.get(), std::logic_error);
+        REQUIRE(p3.get() == "hello!");
+
+        js.wait_all();
+        REQUIRE(js.active_job_count() == 0u);
+    }
+    SECTION("children"){
+        job_system js(3u);
+        std::atomic<std::size_t> counter{0u};
+
+        auto parent = js.create_job([](){});
+        for ( std::size_t i = 0; i < 100; ++i ) {
+            js.run(js.create_child_job(parent, [&counter](){
+                std::this_thread::sleep_for(std::chrono::microseconds(10));
+                ++counter;
+            }));
+        }
+        REQUIRE_FALSE(parent->finished());
+
+        js.run(parent);
+        js.wait(parent);
+        REQUIRE(parent->finished());
+        REQUIRE(counter == 100u);
+    }
+    SECTION("nested"){
+        job_system js(2u);
+        std::atomic<std::size_t> counter{0u};
+        auto root = js.create_job([](){});
+        for ( std::size_t i = 0; i < 10; ++i ) {
+            auto child = js.create_child_job(root, [&counter](){ ++counter; });
+            for ( std::size_t j = 0; j < 10; ++j ) {
+                js.run(js.create_child_job(child, [&js, &counter](){
+                    auto inner = js.create_job([&counter](){ ++counter; });
+                    js.run(inner);
+                    js.wait(inner);
+                }));
+            }
+            js.run(child);
+        }
+        js.run(root);
+        js.wait(root);
+        REQUIRE(counter == 110u);
+    }
+    SECTION("unscheduled"){
+        job_system js(1u);
+        auto parent = js.create_job([](){});
+        {
+            auto child = js.create_child_job(parent, [](){});
+            REQUIRE_FALSE(parent->finished());
+        }
+        js.run(parent);
+        js.wait(parent);
+        REQUIRE(parent->finished());
+    }
+    SECTION("parallel_for"){
+        job_system js(4u);
+        vector<u32> values(10'000, 1u);
+        std::atomic<u32> sum{0u};
+        js.parallel_for(0u, values.size(), 64u, [&values, &sum](std::size_t first, std::size_t last){
+            sum += std::accumulate(values.begin() + first, values.begin() + last, 0u);
+        });
+        REQUIRE(sum == 10'000u);
+
+        sum = 0u;
+        js.parallel_for(0u, values.size(), 0u, [&values, &sum](std::size_t first, std::size_t last){
+            sum += std::accumulate(values.begin() + first, values.begin() + last, 0u);
+        });
+        REQUIRE(sum == 10'000u);
+
+        js.parallel_for(10u, 10u, 1u, [](std::size_t, std::size_t){
+            FAIL();
+        });
+
+        REQUIRE_THROWS_AS(
+            js.parallel_for(0u, 100u, 1u, [](std::size_t first, std::size_t){
+                if ( first == 50u ) {
+                    throw std::logic_error("error");
+                }
+            }),
+            std::logic_error);
+    }
+    SECTION("cancel"){
+        stdex::promise<int> p;
+        {
+            job_system js(1u);
+            std::atomic<bool> started{false};
+            js.async([&started](){
+                started = true;
+                std::this_thread::sleep_for(std::chrono::milliseconds(50));
+            });
+            while ( !started ) {
+                std::this_thread::yield();
+            }
+            p = js.async([](){ return 42; });
+        }
+        REQUIRE_THROWS_AS(p.get(), job_cancelled_exception);
+    }
+    SECTION("performance"){
+        std::printf("-= job_system::performance tests =-\n");
+    #if defined(E2D_BUILD_MODE) && E2D_BUILD_MODE == E2D_BUILD_MODE_DEBUG
+        const std::size_t task_n = 10'000;
+    #else
+        const std::size_t task_n = 100'000;
+    #endif
+        const std::size_t thread_n = math::max(2u, std::thread::hardware_concurrency()) - 1u;
+        {
+            stdex::jobber jb(thread_n);
+            std::atomic<std::size_t> result{0u};
+            e2d_untests::verbose_profiler_ms p("jobber::async");
+            for ( std::size_t i = 0; i < task_n; ++i ) {
+                jb.async([&result](){ ++result; });
+            }
+            jb.wait_all();
+            p.done(result.load());
+        }
+        {
+            job_system js(thread_n);
+            std::atomic<std::size_t> result{0u};
+            e2d_untests::verbose_profiler_ms p("job_system::async");
+            for ( std::size_t i = 0; i < task_n; ++i ) {
+                js.async([&result](){ ++result; });
+            }
+            js.wait_all();
+            p.done(result.load());
+        }
+        {
+            job_system js(thread_n);
+            std::atomic<std::size_t> result{0u};
+            std::size_t sub_task_n = task_n / 64u;
+            e2d_untests::verbose_profiler_ms p("job_system::run(fan out)");
+            auto root = js.create_job([&js, &result, sub_task_n](){
+                for ( std::size_t i = 0; i < 64; ++i ) {
+                    js.run(js.create_job([&js, &result, sub_task_n](){
+                        for ( std::size_t j = 0; j < sub_task_n; ++j ) {
+                            js.run(js.create_job([&result](){ ++result; }));
+                        }
+                    }));
+                }
+            });
+            js.run(root);
+            js.wait_all();
+            p.done(result.load());
+        }
+        {
+            job_system js(thread_n);
+            std::atomic<std::size_t> result{0u};
+            e2d_untests::verbose_profiler_ms p("job_system::parallel_for");
+            js.parallel_for(0u, task_n, 0u, [&result](std::size_t first, std::size_t last){
+                result += last - first;
+            });
+            p.done(result.load());
+        }
+    }
+}
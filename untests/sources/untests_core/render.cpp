@@ -90,6 +90,166 @@ TEST_CASE("render"){
             REQUIRE(*pb2.property<i32>("ii") == 20);
             REQUIRE(*pb2.property<f32>("f") == 1.f);
         }
+        {
+            render::property_block pb1;
+            render::property_block pb2;
+            for ( i32 i = 0; i < 20; ++i ) {
+                pb1.property(make_hash(strings::rformat("p%0", i)), i);
+                pb2.property(make_hash(strings::rformat("p%0", 19 - i)), 19 - i);
+            }
+            REQUIRE(pb1.property_count() == 20);
+            REQUIRE(pb1 == pb2);
+            REQUIRE(pb1.hash() == pb2.hash());
+            for ( i32 i = 0; i < 20; ++i ) {
+                REQUIRE(*pb1.property<i32>(make_hash(strings::rformat("p%0", i))) == i);
+            }
+            *pb2.property("p5") = 42;
+            REQUIRE(pb1 != pb2);
+            auto pb3 = render::property_block()
+                .property("p5", 42)
+                .property("p20", 20)
+                .merge(pb1);
+            REQUIRE(pb3.property_count() == 21);
+            REQUIRE(*pb3.property<i32>("p5") == 5);
+            REQUIRE(*pb3.property<i32>("p20") == 20);
+            pb1.merge(pb2);
+            REQUIRE(pb1 == pb2);
+            pb3 = std::move(pb1);
+            REQUIRE(pb3 == pb2);
+            REQUIRE(pb1.property_count() == 0);
+        }
+        {
+            const auto pb1 = render::property_block()
+                .property("f", 1.f)
+                .sampler("s", render::sampler_state());
+            auto pb2 = pb1;
+            REQUIRE(pb1 == pb2);
+            pb2.sampler("s")->wrap(render::sampler_wrap::clamp);
+            REQUIRE(pb1 != pb2);
+            pb2.sampler("s", render::sampler_state());
+            REQUIRE(pb1 == pb2);
+            pb2.property("f", 1.0001f);
+            REQUIRE(pb1 != pb2);
+        }
+        {
+            // writes through kept value references are seen by the hash
+            const auto pb1 = render::property_block()
+                .property("i", 1)
+                .sampler("s", render::sampler_state());
+            auto pb2 = pb1;
+            auto i = pb2.property("i");
+            auto s = pb2.sampler("s");
+            REQUIRE(i);
+            REQUIRE(s);
+            REQUIRE_FALSE(pb2.property("j"));
+            REQUIRE(pb1 == pb2);
+            REQUIRE(pb1 == pb2);
+            *i = 2;
+            REQUIRE(pb1 != pb2);
+            *i = 1;
+            REQUIRE(pb1 == pb2);
+            s->wrap(render::sampler_wrap::clamp);
+            REQUIRE(pb1.hash() != pb2.hash());
+            REQUIRE(pb1 != pb2);
+        }
+    }
+    SECTION("property_block_performance"){
+        std::printf("-= render::property_block performance tests =-\n");
+    #if defined(E2D_BUILD_MODE) && E2D_BUILD_MODE == E2D_BUILD_MODE_DEBUG
+        const std::size_t task_n = 10'000;
+    #else
+        const std::size_t task_n = 100'000;
+    #endif
+        struct hash_map_property_block {
+            hash_map<str_hash, render::sampler_state> samplers;
+            hash_map<str_hash, render::property_value> properties;
+
+            void merge(const hash_map_property_block& pb) {
+                for ( const auto& p : pb.properties ) {
+                    properties[p.first] = p.second;
+                }
+                for ( const auto& p : pb.samplers ) {
+                    samplers[p.first] = p.second;
+                }
+            }
+
+            bool equals(const hash_map_property_block& other) const {
+                return properties == other.properties
+                    && samplers == other.samplers;
+            }
+
+            void clear() noexcept {
+                properties.clear();
+                samplers.clear();
+            }
+        };
+
+        const str_hash names[] = {
+            "u_matrix_m", "u_matrix_vp", "u_game_time", "u_color", "u_texture"};
+
+        hash_map_property_block hpb_mat, hpb_props, hpb_main;
+        hpb_mat.samplers[names[4]] = render::sampler_state();
+        hpb_mat.properties[names[3]] = v4f::unit();
+        hpb_props.properties[names[0]] = m4f::identity();
+        hpb_props.properties[names[1]] = m4f::identity();
+        hpb_props.properties[names[2]] = 1.f;
+
+        const auto pb_mat = render::property_block()
+            .sampler(names[4], render::sampler_state())
+            .property(names[3], v4f::unit());
+        const auto pb_props = render::property_block()
+            .property(names[0], m4f::identity())
+            .property(names[1], m4f::identity())
+            .property(names[2], 1.f);
+        render::property_block pb_main;
+
+        {
+            std::size_t result = 0;
+            e2d_untests::verbose_profiler_ms p("hash_map property_block (merge, copy)");
+            for ( std::size_t i = 0; i < task_n; ++i ) {
+                hpb_main.merge(hpb_mat);
+                hpb_main.merge(hpb_props);
+                const hash_map_property_block copy = hpb_main;
+                result += copy.properties.size();
+                hpb_main.clear();
+            }
+            p.done(result);
+        }
+        {
+            std::size_t result = 0;
+            e2d_untests::verbose_profiler_ms p("flat property_block (merge, copy)");
+            for ( std::size_t i = 0; i < task_n; ++i ) {
+                pb_main.merge(pb_mat);
+                pb_main.merge(pb_props);
+                const render::property_block copy = pb_main;
+                result += copy.property_count();
+                pb_main.clear();
+            }
+            p.done(result);
+        }
+        {
+            hash_map_property_block hpb_other = hpb_props;
+            hpb_other.properties[names[2]] = 2.f;
+            std::size_t result = 0;
+            e2d_untests::verbose_profiler_ms p("hash_map property_block (equals)");
+            for ( std::size_t i = 0; i < task_n; ++i ) {
+                result += hpb_props.equals(hpb_props) ? 1u : 0u;
+                result += hpb_props.equals(hpb_other) ? 1u : 0u;
+            }
+            p.done(result);
+        }
+        {
+            const render::property_block pb_same = pb_props;
+            const render::property_block pb_other = render::property_block(pb_props)
+                .property(names[2], 2.f);
+            std::size_t result = 0;
+            e2d_untests::verbose_profiler_ms p("flat property_block (equals)");
+            for ( std::size_t i = 0; i < task_n; ++i ) {
+                result += pb_props.equals(pb_same) ? 1u : 0u;
+                result += pb_props.equals(pb_other) ? 1u : 0u;
+            }
+            p.done(result);
+        }
     }
     SECTION("index_declaration"){
         index_declaration id;
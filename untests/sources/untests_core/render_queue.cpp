@@ -0,0 +1,201 @@
+/*******************************************************************************
+ * This file is part of the "Enduro2D"
+ * For conditions of distribution and use, see copyright notice in LICENSE.md
+ * Copyright (C) 2018 Matvey Cherevko
+ ******************************************************************************/
+
+#include "_core.hpp"
+using namespace e2d;
+
+#include "../../../sources/enduro2d/core/render_impl/render.hpp"
+#include "../../../sources/enduro2d/core/window_impl/window.hpp"
+
+namespace
+{
+    render::material make_material(
+        const render::capabilities_state& caps)
+    {
+        return render::material()
+            .add_pass(render::pass_state()
+                .states(render::state_block()
+                    .capabilities(caps)));
+    }
+}
+
+TEST_CASE("render_queue"){
+    const render::material mat_a;
+    const render::material mat_b;
+    const render::geometry geo;
+    const render::property_block props;
+    SECTION("make_key"){
+        const auto k1 = render_queue::make_key(0u, mat_a, props, 10.f, 0u);
+        const auto k2 = render_queue::make_key(1u, mat_a, props, -10.f, 0u);
+        const auto k3 = render_queue::make_key(1u, mat_a, props, 5.f, 0u);
+        REQUIRE(k1 < k2);
+        REQUIRE(k2 < k3);
+        REQUIRE(k1 == render_queue::make_key(0u, mat_a, props, 10.f, 0u));
+        REQUIRE(render_queue::make_key(0u, mat_a, props, 0.f, 0u)
+             != render_queue::make_key(0u, mat_b, props, 0.f, 0u));
+    }
+    SECTION("sort"){
+        render_queue q;
+        REQUIRE(q.command_count() == 0u);
+        for ( std::size_t i = 0; i < 8; ++i ) {
+            const render::material& mat = (i % 2) ? mat_b : mat_a;
+            q.enqueue(
+                render_queue::make_key(0u, mat, props, f32(i), 0u),
+                render::draw_command(mat, geo, props));
+        }
+        REQUIRE(q.command_count() == 8u);
+        q.sort();
+        REQUIRE(q.last_statistics().command_count == 8u);
+        REQUIRE(q.last_statistics().material_switches == 2u);
+        REQUIRE(q.last_statistics().shader_switches == 1u);
+        REQUIRE(q.last_statistics().texture_switches == 1u);
+        q.clear();
+        REQUIRE(q.command_count() == 0u);
+    }
+    SECTION("layers"){
+        render_queue q;
+        for ( std::size_t i = 0; i < 8; ++i ) {
+            const render::material& mat = (i % 2) ? mat_b : mat_a;
+            q.enqueue(
+                render_queue::make_key(u8(i / 4), mat, props, 0.f, 0u),
+                render::draw_command(mat, geo, props));
+        }
+        q.sort();
+        REQUIRE(q.last_statistics().command_count == 8u);
+        REQUIRE(q.last_statistics().material_switches == 4u);
+    }
+    SECTION("blended"){
+        const render::material blend_a = make_material(
+            render::capabilities_state().blending(true));
+        const render::material blend_b = make_material(
+            render::capabilities_state().blending(true).depth_test(true));
+
+        REQUIRE(render_queue::make_key(0u, blend_a, props, 10.f, 0u)
+             == render_queue::make_key(0u, blend_b, props, -10.f, 0u));
+        REQUIRE(render_queue::make_key(0u, mat_a, props, 10.f, 0u)
+              < render_queue::make_key(0u, blend_a, props, 0.f, 0u));
+        REQUIRE(render_queue::make_key(0u, blend_a, props, 0.f, 0u)
+              < render_queue::make_key(1u, mat_a, props, 0.f, 0u));
+
+        render_queue q;
+        for ( std::size_t i = 0; i < 8; ++i ) {
+            const render::material& mat = (i % 2) ? blend_b : blend_a;
+            q.enqueue(
+                render_queue::make_key(0u, mat, props, 8.f - f32(i), 0u),
+                render::draw_command(mat, geo, props).index_range(i, 1u));
+        }
+        q.enqueue(
+            render_queue::make_key(0u, mat_a, props, 0.f, 0u),
+            render::draw_command(mat_a, geo, props).index_range(8u, 1u));
+
+        vector<std::size_t> order;
+        q.foreach_by_sorted_commands([&order](const render::draw_command& cmd){
+            order.push_back(cmd.first_index());
+        });
+        REQUIRE(order == vector<std::size_t>{8, 0, 1, 2, 3, 4, 5, 6, 7});
+        REQUIRE(q.last_statistics().material_switches == 9u);
+    }
+    SECTION("ordered"){
+        const render::material tested = make_material(
+            render::capabilities_state().depth_test(true));
+        const render::material untested = make_material(
+            render::capabilities_state().culling(true));
+        REQUIRE_FALSE(render_queue::is_ordered(tested));
+        REQUIRE(render_queue::is_ordered(untested));
+
+        render_queue q;
+        REQUIRE(q.next_sequence() == 0u);
+        REQUIRE(q.next_sequence() == 1u);
+        REQUIRE(q.sequence() == 2u);
+
+        // draws without depth testing are executed by their sequence numbers,
+        // depth tested ones go first in their layer
+        q.enqueue(
+            render_queue::make_key(0u, untested, props, 0.f, 1u),
+            render::draw_command(untested, geo, props).index_range(0u, 1u));
+        q.enqueue(
+            render_queue::make_key(0u, tested, props, 0.f, 0u),
+            render::draw_command(tested, geo, props).index_range(1u, 1u));
+        q.enqueue(
+            render_queue::make_key(0u, untested, props, 0.f, 0u),
+            render::draw_command(untested, geo, props).index_range(2u, 1u));
+
+        vector<std::size_t> order;
+        q.foreach_by_sorted_commands([&order](const render::draw_command& cmd){
+            order.push_back(cmd.first_index());
+        });
+        REQUIRE(order == vector<std::size_t>{1, 2, 0});
+
+        q.clear();
+        REQUIRE(q.sequence() == 0u);
+    }
+    SECTION("properties"){
+        render_queue q;
+        render::property_block pb;
+        for ( std::size_t i = 0; i < 4; ++i ) {
+            pb.property("i", i32(i / 2));
+            q.enqueue(
+                render_queue::make_key(0u, mat_a, props, 0.f, 0u),
+                render::draw_command(mat_a, geo, pb).index_range(i, 1u));
+        }
+        pb.clear();
+
+        // the queue keeps its own copies, equal blocks of
+        // consecutive commands are shared
+        vector<i32> values;
+        vector<const render::property_block*> blocks;
+        q.foreach_by_sorted_commands([&values, &blocks](const render::draw_command& cmd){
+            values.push_back(*cmd.properties_ref().property<i32>("i"));
+            blocks.push_back(&cmd.properties_ref());
+        });
+        REQUIRE(values == vector<i32>{0, 0, 1, 1});
+        REQUIRE(blocks[0] == blocks[1]);
+        REQUIRE(blocks[1] != blocks[2]);
+        REQUIRE(blocks[2] == blocks[3]);
+    }
+#if E2D_RENDER_MODE == E2D_RENDER_MODE_NONE && E2D_WINDOW_MODE == E2D_WINDOW_MODE_NONE
+    SECTION("render_none"){
+        debug d;
+        window w(v2u(640, 480), "render_queue", false, false);
+        render r(d, w);
+
+        const render::material opaque_a = make_material(
+            render::capabilities_state().depth_test(true));
+        const render::material opaque_b = make_material(
+            render::capabilities_state().culling(true));
+        const render::material blend_a = make_material(
+            render::capabilities_state().blending(true));
+        const render::material blend_b = make_material(
+            render::capabilities_state().blending(true).depth_test(true));
+
+        render_queue q;
+        const auto enqueue = [&q, &geo, &props](
+            const render::material& a, const render::material& b)
+        {
+            for ( std::size_t i = 0; i < 8; ++i ) {
+                const render::material& mat = (i % 2) ? b : a;
+                q.enqueue(
+                    render_queue::make_key(0u, mat, props, 0.f, 0u),
+                    render::draw_command(mat, geo, props));
+            }
+        };
+
+        enqueue(opaque_a, opaque_b);
+        q.flush(r);
+        r.frame_tick();
+        REQUIRE(r.last_frame_statistics().draw_calls == 8u);
+        REQUIRE(r.last_frame_statistics().applied_state_changes == 2u);
+        REQUIRE(r.last_frame_statistics().skipped_state_changes == 6u);
+
+        enqueue(blend_a, blend_b);
+        q.flush(r);
+        r.frame_tick();
+        REQUIRE(r.last_frame_statistics().draw_calls == 8u);
+        REQUIRE(r.last_frame_statistics().applied_state_changes == 8u);
+        REQUIRE(r.last_frame_statistics().skipped_state_changes == 0u);
+    }
+#endif
+}
@@ -7,6 +7,86 @@
 #include "_core.hpp"
 using namespace e2d;
 
+namespace
+{
+    class ordered_file_source final : public vfs::file_source {
+    public:
+        std::mutex mutex;
+        vector<str> read_order;
+        std::atomic<bool> blocked{true};
+        std::atomic<std::size_t> started{0u};
+    public:
+        bool valid() const noexcept final {
+            return true;
+        }
+
+        bool exists(str_view path) const final {
+            E2D_UNUSED(path);
+            return true;
+        }
+
+        input_stream_uptr read(str_view path) const final {
+            auto self = const_cast<ordered_file_source*>(this);
+            ++self->started;
+            while ( self->blocked ) {
+                std::this_thread::yield();
+            }
+            std::lock_guard<std::mutex> guard(self->mutex);
+            self->read_order.push_back(path);
+            return make_memory_stream(buffer(path.data(), path.size()));
+        }
+
+        output_stream_uptr write(str_view path, bool append) const final {
+            E2D_UNUSED(path, append);
+            return nullptr;
+        }
+
+        bool trace(str_view path, filesystem::trace_func func) const final {
+            E2D_UNUSED(path, func);
+            return false;
+        }
+    };
+
+    // single stored entry archive with the given checksum
+    buffer make_stored_archive(str_view name, const buffer& content, u32 crc) {
+        vector<u8> data;
+        const auto put_u16 = [&data](std::size_t v){
+            data.push_back(static_cast<u8>(v & 0xFFu));
+            data.push_back(static_cast<u8>((v >> 8u) & 0xFFu));
+        };
+        const auto put_u32 = [&put_u16](std::size_t v){
+            put_u16(v & 0xFFFFu);
+            put_u16((v >> 16u) & 0xFFFFu);
+        };
+        const auto put_bytes = [&data](const void* bytes, std::size_t size){
+            const u8* first = static_cast<const u8*>(bytes);
+            data.insert(data.end(), first, first + size);
+        };
+
+        put_u32(0x04034b50u);
+        put_u16(20u); put_u16(0u); put_u16(0u); put_u16(0u); put_u16(0u);
+        put_u32(crc); put_u32(content.size()); put_u32(content.size());
+        put_u16(name.size()); put_u16(0u);
+        put_bytes(name.data(), name.size());
+        put_bytes(content.data(), content.size());
+
+        const std::size_t directory_offset = data.size();
+        put_u32(0x02014b50u);
+        put_u16(20u); put_u16(20u); put_u16(0u); put_u16(0u); put_u16(0u); put_u16(0u);
+        put_u32(crc); put_u32(content.size()); put_u32(content.size());
+        put_u16(name.size()); put_u16(0u); put_u16(0u); put_u16(0u); put_u16(0u);
+        put_u32(0u); put_u32(0u);
+        put_bytes(name.data(), name.size());
+        const std::size_t directory_size = data.size() - directory_offset;
+
+        put_u32(0x06054b50u);
+        put_u16(0u); put_u16(0u); put_u16(1u); put_u16(1u);
+        put_u32(directory_size); put_u32(directory_offset);
+        put_u16(0u);
+        return buffer(data.data(), data.size());
+    }
+}
+
 TEST_CASE("vfs"){
     const str_view file_path = "vfs_file_name";
     const str_view nofile_path = "vfs_file_name2";
@@ -47,6 +127,20 @@ TEST_CASE("vfs"){
             auto b3 = v.load_as_string_async({"file", file_path}).get();
             REQUIRE(b3 == "hello");
         }
+        {
+            auto m = v.map({"file", file_path});
+            REQUIRE(m);
+            REQUIRE(m->view() == buffer_view("hello", 5));
+            REQUIRE_FALSE(v.map({"file2", file_path}));
+            REQUIRE_FALSE(v.map({"file", nofile_path}));
+
+            auto m1 = v.map_async({"file", file_path}).get();
+            REQUIRE(m1);
+            REQUIRE(m1->view() == buffer_view("hello", 5));
+            REQUIRE_THROWS_AS(
+                v.map_async({"file", nofile_path}).get(),
+                vfs_load_async_exception);
+        }
     }
     {
         vfs v;
@@ -149,6 +243,12 @@ TEST_CASE("vfs"){
                 auto b3 = v.load_as_string_async(url("archive://test.txt")).get();
                 REQUIRE(b3 == "hello");
             }
+            {
+                auto m = v.map(url("archive://folder/file.txt"));
+                REQUIRE(m);
+                REQUIRE(m->view() == buffer_view("world", 5));
+                REQUIRE_FALSE(v.map(url("archive://TEst.txt")));
+            }
             {
                 auto f = v.read(url("archive://folder/file.txt"));
                 REQUIRE(f);
@@ -190,6 +290,38 @@ TEST_CASE("vfs"){
                     v.load_as_string_async(url("archive://TEst.txt")).get(),
                     vfs_load_async_exception);
             }
+            {
+                auto f = v.read(url("archive://folder/file.txt"));
+                REQUIRE(f);
+                char buf[3] = {'\0'};
+                REQUIRE(f->seek(2, false) == 2);
+                REQUIRE(f->read(buf, 3) == 3);
+                REQUIRE(std::memcmp(buf, "rld", 3) == 0);
+                REQUIRE(f->seek(-4, true) == 1);
+                REQUIRE(f->read(buf, 3) == 3);
+                REQUIRE(std::memcmp(buf, "orl", 3) == 0);
+                REQUIRE_THROWS_AS(f->seek(2, true), bad_stream_operation);
+            }
+            {
+                REQUIRE(v.register_scheme<archive_file_source>(
+                    "mapped_archive",
+                    v.map(url("resources://bin/resources.zip"))));
+
+                auto m = v.map(url("mapped_archive://test.txt"));
+                REQUIRE(m);
+                REQUIRE(m->view() == buffer_view("hello", 5));
+
+                vector<stdex::promise<str>> results;
+                for ( std::size_t i = 0; i < 100; ++i ) {
+                    results.push_back(v.load_as_string_async(i % 2
+                        ? url("mapped_archive://folder/file.txt")
+                        : url("archive://test.txt")));
+                }
+                for ( std::size_t i = 0; i < results.size(); ++i ) {
+                    REQUIRE(results[i].get() == (i % 2 ? "world" : "hello"));
+                }
+                REQUIRE(v.unregister_scheme("mapped_archive"));
+            }
             {
                 auto f = v.read(url("archive://test.txt"));
                 REQUIRE(f);
@@ -200,4 +332,220 @@ TEST_CASE("vfs"){
             }
         }
     }
+    SECTION("archive_crc"){
+        const buffer content("hello", 5);
+        const u32 crc = 0x3610a686u;
+        {
+            archive_file_source good(make_memory_stream(make_stored_archive("test.txt", content, crc)));
+            REQUIRE(good.valid());
+            buffer b;
+            REQUIRE(streams::try_read_tail(b, good.read("test.txt")));
+            REQUIRE(b == content);
+
+            archive_file_source good_mapped(make_mapped_memory_stream(make_stored_archive("test.txt", content, crc)));
+            REQUIRE(good_mapped.valid());
+            auto m = good_mapped.map("test.txt");
+            REQUIRE(m);
+            REQUIRE(m->view() == buffer_view(content));
+
+            // the checksum is verified by the first open only
+            auto m2 = good_mapped.map("test.txt");
+            REQUIRE(m2);
+            REQUIRE(m2->view() == buffer_view(content));
+        }
+        {
+            archive_file_source bad(make_memory_stream(make_stored_archive("test.txt", content, ~crc)));
+            REQUIRE(bad.valid());
+            buffer b;
+            REQUIRE_FALSE(streams::try_read_tail(b, bad.read("test.txt")));
+
+            archive_file_source bad_mapped(make_mapped_memory_stream(make_stored_archive("test.txt", content, ~crc)));
+            REQUIRE(bad_mapped.valid());
+            REQUIRE_FALSE(bad_mapped.read("test.txt"));
+            REQUIRE_FALSE(bad_mapped.map("test.txt"));
+            REQUIRE_FALSE(bad_mapped.read("test.txt"));
+        }
+    }
+    SECTION("bundle"){
+        buffer big_file(300'000u);
+        for ( std::size_t i = 0; i < big_file.size(); ++i ) {
+            big_file.data()[i] = static_cast<u8>(i % 251u);
+        }
+
+        bundle b;
+        REQUIRE(b.add_file("test.txt", buffer("hello", 5), false));
+        REQUIRE(b.add_directory("folder"));
+        REQUIRE(b.add_file("folder/file.txt", buffer("world", 5), false));
+        REQUIRE(b.add_directory("folder/subfolder"));
+        REQUIRE(b.add_file("folder/subfolder/big.bin", big_file, true));
+
+        buffer file_data;
+        REQUIRE(bundles::try_save_bundle(b, file_data));
+        REQUIRE(file_data.size() < big_file.size());
+
+        vfs v;
+        REQUIRE_FALSE(v.register_scheme<bundle_file_source>(
+            "bundle",
+            make_memory_stream(buffer("hello", 5))));
+        REQUIRE(v.register_scheme<bundle_file_source>(
+            "bundle",
+            make_memory_stream(file_data)));
+        REQUIRE(v.register_scheme<bundle_file_source>(
+            "mapped_bundle",
+            make_memory_view_stream(file_data)));
+
+        for ( const str& scheme : {str("bundle"), str("mapped_bundle")} ) {
+            REQUIRE(v.exists({scheme, "test.txt"}));
+            REQUIRE(v.exists({scheme, "folder"}));
+            REQUIRE(v.exists({scheme, "folder/"}));
+            REQUIRE(v.exists({scheme, "folder/subfolder/big.bin"}));
+            REQUIRE_FALSE(v.exists({scheme, "TEst.txt"}));
+            REQUIRE_FALSE(v.exists({scheme, "folder/big.bin"}));
+            {
+                vector<std::pair<str,bool>> result;
+                REQUIRE(v.extract({scheme, ""}, std::back_inserter(result)));
+                REQUIRE(result == vector<std::pair<str, bool>>{
+                    {"folder", true},
+                    {"folder/file.txt", false},
+                    {"folder/subfolder", true},
+                    {"folder/subfolder/big.bin", false},
+                    {"test.txt", false}
+                });
+            }
+            {
+                vector<std::pair<str,bool>> result;
+                REQUIRE(v.extract({scheme, "folder/subfolder/"}, std::back_inserter(result)));
+                REQUIRE(result == vector<std::pair<str, bool>>{
+                    {"folder/subfolder/big.bin", false}
+                });
+                result.clear();
+                REQUIRE(v.extract({scheme, "folder"}, std::back_inserter(result)));
+                REQUIRE(result == vector<std::pair<str, bool>>{
+                    {"folder/file.txt", false},
+                    {"folder/subfolder", true},
+                    {"folder/subfolder/big.bin", false}
+                });
+                REQUIRE_FALSE(v.extract({scheme, "fold"}, std::back_inserter(result)));
+                REQUIRE_FALSE(v.extract({scheme, "test.txt"}, std::back_inserter(result)));
+            }
+            {
+                str s;
+                REQUIRE(v.load_as_string({scheme, "test.txt"}, s));
+                REQUIRE(s == "hello");
+                REQUIRE(v.load_as_string_async({scheme, "folder/file.txt"}).get() == "world");
+                REQUIRE_FALSE(v.read({scheme, "folder"}));
+                REQUIRE_FALSE(v.map({scheme, "folder"}));
+            }
+            {
+                auto f = v.read({scheme, "folder/file.txt"});
+                REQUIRE(f);
+                char buf[3] = {'\0'};
+                REQUIRE(f->seek(2, false) == 2);
+                REQUIRE(f->read(buf, 3) == 3);
+                REQUIRE(std::memcmp(buf, "rld", 3) == 0);
+            }
+            {
+                buffer b0;
+                REQUIRE(v.load({scheme, "folder/subfolder/big.bin"}, b0));
+                REQUIRE(b0 == big_file);
+
+                auto m = v.map({scheme, "folder/subfolder/big.bin"});
+                REQUIRE(m);
+                REQUIRE(m->view() == big_file);
+            }
+        }
+        {
+            // stored entries of mapped bundles are aligned views
+            auto m = v.map(url("mapped_bundle://folder/file.txt"));
+            REQUIRE(m);
+            REQUIRE(m->view() == buffer_view("world", 5));
+            REQUIRE(m->view().data() > file_data.data());
+            REQUIRE(m->view().data() < file_data.data() + file_data.size());
+            REQUIRE((m->view().data() - file_data.data()) % bundles::data_alignment == 0);
+        }
+        {
+            // compressed chunks are decompressed on the loading thread
+            modules::initialize<deferrer>();
+            buffer b0;
+            REQUIRE(v.load(url("bundle://folder/subfolder/big.bin"), b0));
+            REQUIRE(b0 == big_file);
+            REQUIRE(v.load_async(url("mapped_bundle://folder/subfolder/big.bin")).get() == big_file);
+            modules::shutdown<deferrer>();
+        }
+    }
+    SECTION("io_priority"){
+        vfs v(1u);
+        REQUIRE(v.io_thread_count() == 1u);
+
+        auto source = std::make_unique<ordered_file_source>();
+        ordered_file_source& ordered = *source;
+        REQUIRE(v.register_scheme("ordered", std::move(source)));
+
+        auto p0 = v.load_as_string_async(url("ordered://first"));
+        while ( ordered.started == 0u ) {
+            std::this_thread::yield();
+        }
+
+        auto p1 = v.load_as_string_async(url("ordered://low1"), vfs::io_priority::low);
+        auto p2 = v.load_as_string_async(url("ordered://normal"));
+        auto p3 = v.load_as_string_async(url("ordered://high"), vfs::io_priority::high);
+        auto p4 = v.load_as_string_async(url("ordered://low2"), vfs::io_priority::low);
+        ordered.blocked = false;
+
+        REQUIRE(p0.get() == "first");
+        REQUIRE(p1.get() == "low1");
+        REQUIRE(p2.get() == "normal");
+        REQUIRE(p3.get() == "high");
+        REQUIRE(p4.get() == "low2");
+        REQUIRE(ordered.read_order == vector<str>{
+            "first", "high", "normal", "low1", "low2"});
+    }
+    SECTION("io_pool"){
+        vfs v(4u);
+        REQUIRE(v.io_thread_count() == 4u);
+
+        auto source = std::make_unique<ordered_file_source>();
+        ordered_file_source& ordered = *source;
+        REQUIRE(v.register_scheme("ordered", std::move(source)));
+
+        vector<stdex::promise<str>> results;
+        for ( std::size_t i = 0; i < 4; ++i ) {
+            results.push_back(v.load_as_string_async(url("ordered://file") + std::to_string(i)));
+        }
+
+        // all readers are blocked at the same time
+        while ( ordered.started < 4u ) {
+            std::this_thread::yield();
+        }
+        ordered.blocked = false;
+
+        for ( std::size_t i = 0; i < 4; ++i ) {
+            REQUIRE(results[i].get() == "file" + std::to_string(i));
+        }
+    }
+    SECTION("io_cancel"){
+        stdex::promise<str> p0, p1;
+        std::thread unblocker;
+        {
+            vfs v(1u);
+            auto source = std::make_unique<ordered_file_source>();
+            ordered_file_source& ordered = *source;
+            REQUIRE(v.register_scheme("ordered", std::move(source)));
+
+            p0 = v.load_as_string_async(url("ordered://first"));
+            while ( ordered.started == 0u ) {
+                std::this_thread::yield();
+            }
+            p1 = v.load_as_string_async(url("ordered://second"));
+
+            // releases the reader while the vfs is being destroyed
+            unblocker = std::thread([&ordered](){
+                std::this_thread::sleep_for(std::chrono::milliseconds(50));
+                ordered.blocked = false;
+            });
+        }
+        unblocker.join();
+        REQUIRE(p0.get() == "first");
+        REQUIRE_THROWS_AS(p1.get(), vfs_load_async_exception);
+    }
 }
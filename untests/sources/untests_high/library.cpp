@@ -5,6 +5,7 @@
  ******************************************************************************/
 
 #include "_high.hpp"
+#include <future>
 using namespace e2d;
 
 namespace
@@ -15,13 +16,82 @@ namespace
             modules::initialize<starter>(0, nullptr,
                 starter::parameters(
                     engine::parameters("library_untests", "enduro2d")
-                        .without_graphics(true)));
+                        .without_graphics(true)
+                        .vfs_params(engine::vfs_parameters()
+                            .io_threads(1u))));
         }
 
         ~safe_starter_initializer() noexcept {
             modules::shutdown<starter>();
         }
     };
+
+    // holds reads of its scheme until it is opened,
+    // the gate is opened on destruction to not block the io threads
+    class io_gate final : private noncopyable {
+    public:
+        io_gate()
+        : future_(promise_.get_future().share()) {
+            the<vfs>().register_scheme<gate_file_source>("gate", future_);
+        }
+
+        ~io_gate() noexcept {
+            open();
+            the<vfs>().unregister_scheme("gate");
+        }
+
+        void open() noexcept {
+            if ( !opened_ ) {
+                opened_ = true;
+                promise_.set_value();
+            }
+        }
+    private:
+        class gate_file_source final : public vfs::file_source {
+        public:
+            gate_file_source(std::shared_future<void> future)
+            : future_(std::move(future)) {}
+
+            bool valid() const noexcept final {
+                return true;
+            }
+
+            bool exists(str_view path) const final {
+                E2D_UNUSED(path);
+                return true;
+            }
+
+            input_stream_uptr read(str_view path) const final {
+                E2D_UNUSED(path);
+                future_.wait();
+                return nullptr;
+            }
+
+            output_stream_uptr write(str_view path, bool append) const final {
+                E2D_UNUSED(path, append);
+                return nullptr;
+            }
+
+            bool trace(str_view path, filesystem::trace_func func) const final {
+                E2D_UNUSED(path, func);
+                return false;
+            }
+        private:
+            std::shared_future<void> future_;
+        };
+    private:
+        std::promise<void> promise_;
+        std::shared_future<void> future_;
+        bool opened_{false};
+    };
+
+    // the only io thread releases the promises of a finished request
+    // before it starts the next one, so this waits until the assets
+    // of finished loads are referenced by their owners only
+    void wait_io_requests() {
+        auto fence = the<vfs>().load_async(the<library>().root() / "missing_asset.txt");
+        the<deferrer>().active_safe_wait_promise(fence);
+    }
 }
 
 TEST_CASE("library"){
@@ -42,10 +112,39 @@ TEST_CASE("library"){
         text_res.reset();
         text_res_from_cache.reset();
 
-        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        wait_io_requests();
         REQUIRE(1u == the<asset_cache<text_asset>>().unload_self_unused_assets());
         REQUIRE(the<asset_cache<text_asset>>().asset_count() == 0);
     }
+    {
+        auto& cache = the<asset_cache<text_asset>>();
+        const std::size_t coalesced_count = cache.coalesced_count();
+
+        // the blocked io thread keeps the first request pending
+        io_gate gate;
+        auto blocked = the<vfs>().load_async(url("gate://blocked"));
+        auto text_res_p1 = l.load_asset_async<text_asset>("text_asset.txt");
+        auto text_res_p2 = l.load_asset_async<text_asset>("text_asset.txt");
+        REQUIRE(text_res_p1 == text_res_p2);
+        REQUIRE(cache.coalesced_count() == coalesced_count + 1u);
+        REQUIRE(cache.pending_count() == 1u);
+
+        gate.open();
+        the<deferrer>().active_safe_wait_promise(blocked);
+        the<deferrer>().active_safe_wait_promise(text_res_p1);
+        the<deferrer>().active_safe_wait_promise(text_res_p2);
+        REQUIRE(text_res_p1.get());
+        REQUIRE(text_res_p1.get() == text_res_p2.get());
+        REQUIRE(cache.pending_count() == 0u);
+        REQUIRE(cache.asset_count() == 1u);
+
+        REQUIRE_FALSE(l.load_asset<text_asset>("missing_asset.txt"));
+        REQUIRE(cache.pending_count() == 0u);
+
+        text_res_p1 = text_res_p2 = stdex::make_resolved_promise(text_asset::ptr());
+        wait_io_requests();
+        REQUIRE(1u == cache.unload_self_unused_assets());
+    }
     {
         auto text_res = l.load_asset<text_asset>("text_asset.txt");
         REQUIRE(text_res);
@@ -60,7 +159,7 @@ TEST_CASE("library"){
         text_res.reset();
         binary_res.reset();
 
-        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        wait_io_requests();
         REQUIRE(2u == l.unload_unused_assets());
     }
     {
@@ -73,7 +172,7 @@ TEST_CASE("library"){
         REQUIRE(!image_res->content().empty());
 
         REQUIRE(the<asset_cache<image_asset>>().find("image.png"));
-        REQUIRE(the<asset_cache<binary_asset>>().find("image.png"));
+        REQUIRE_FALSE(the<asset_cache<binary_asset>>().find("image.png"));
 
         the<deferrer>().worker().wait_all();
         the<asset_cache<binary_asset>>().unload_self_unused_assets();
@@ -231,3 +330,113 @@ TEST_CASE("library"){
         }
     }
 }
+
+TEST_CASE("library_dependencies"){
+    safe_starter_initializer initializer;
+    library& l = the<library>();
+    {
+        // shaders are not created without graphics, failed loads
+        // are not recorded, but the dependencies are recorded anyway
+        auto shader_res = l.load_asset<shader_asset>("shader.json");
+        REQUIRE(bool(shader_res) == modules::is_initialized<render>());
+
+        REQUIRE(l.asset_types("shader.json") == (modules::is_initialized<render>()
+            ? vector<str>{"shader_asset", "json_asset", "text_asset"}
+            : vector<str>{"json_asset", "text_asset"}));
+        REQUIRE(l.asset_dependencies("shader.json") == vector<str>{
+            "shader.vert", "shader.frag"});
+        REQUIRE(l.asset_types("shader.vert") == vector<str>{"text_asset"});
+        REQUIRE(l.asset_dependencies("shader.vert").empty());
+
+        REQUIRE_FALSE(l.load_asset<text_asset>("missing.json"));
+        REQUIRE_FALSE(l.load_asset<binary_asset>("missing.json"));
+        REQUIRE(l.asset_types("missing.json").empty());
+
+        shader_res.reset();
+        the<deferrer>().worker().wait_all();
+        l.unload_unused_assets();
+        REQUIRE_FALSE(the<asset_cache<text_asset>>().find("shader.vert"));
+    }
+    {
+        auto p = l.prefetch({"shader.json", "missing.json"});
+        the<deferrer>().active_safe_wait_promise(p);
+        REQUIRE(p.get() == (modules::is_initialized<render>() ? 4u : 3u));
+        REQUIRE(the<asset_cache<text_asset>>().find("shader.json"));
+        REQUIRE(the<asset_cache<text_asset>>().find("shader.vert"));
+        REQUIRE(the<asset_cache<text_asset>>().find("shader.frag"));
+
+        auto p2 = l.prefetch({"missing.json"});
+        REQUIRE(p2.get() == 0u);
+    }
+    {
+        const str_view manifest_path = "library_dependencies.json";
+        REQUIRE(l.save_dependency_manifest({"file", manifest_path}));
+
+        library l2(l.root());
+        REQUIRE(l2.asset_dependencies("shader.json").empty());
+        REQUIRE(l2.load_dependency_manifest({"file", manifest_path}));
+        REQUIRE(l2.asset_types("shader.json") == l.asset_types("shader.json"));
+        REQUIRE(l2.asset_dependencies("shader.json") == l.asset_dependencies("shader.json"));
+        REQUIRE(l2.asset_types("shader.frag") == vector<str>{"text_asset"});
+
+        REQUIRE_FALSE(l2.load_dependency_manifest({"file", "missing_manifest.json"}));
+        REQUIRE(filesystem::remove_file(manifest_path));
+    }
+}
+
+TEST_CASE("library_memory_budget"){
+    safe_starter_initializer initializer;
+    library& l = the<library>();
+    auto& cache = the<asset_cache<text_asset>>();
+    {
+        const std::size_t text_size = l.load_asset<text_asset>("text_asset.txt")->content().size();
+        const std::size_t vert_size = l.load_asset<text_asset>("shader.vert")->content().size();
+        const std::size_t frag_size = l.load_asset<text_asset>("shader.frag")->content().size();
+        REQUIRE(cache.asset_count() == 3u);
+        REQUIRE(cache.memory_usage().cpu_bytes == text_size + vert_size + frag_size);
+        REQUIRE(cache.memory_usage().gpu_bytes == 0u);
+
+        // shader.vert is the least recently used one now
+        REQUIRE(l.load_asset<text_asset>("text_asset.txt"));
+
+        asset_memory_usage budget;
+        budget.cpu_bytes = text_size + frag_size;
+        cache.memory_budget(budget);
+        REQUIRE(cache.evict_self_over_budget_assets() == 1u);
+        REQUIRE(cache.asset_count() == 2u);
+        REQUIRE_FALSE(cache.find(make_hash("shader.vert")));
+        REQUIRE(cache.memory_usage().cpu_bytes == text_size + frag_size);
+        REQUIRE(cache.evict_self_over_budget_assets() == 0u);
+        cache.memory_budget(asset_memory_usage());
+    }
+    {
+        auto text_res = l.load_asset<text_asset>("text_asset.txt");
+        auto binary_res = l.load_asset<binary_asset>("binary_asset.bin");
+        REQUIRE(text_res);
+        REQUIRE(binary_res);
+        REQUIRE(binary_res->cpu_memory_usage() == binary_res->content().size());
+
+        const asset_memory_usage usage = asset_cache_base::global_memory_usage();
+        REQUIRE(usage.cpu_bytes >= text_res->content().size() + binary_res->content().size());
+
+        asset_memory_usage budget;
+        budget.cpu_bytes = 1u;
+        asset_cache_base::global_memory_budget(budget);
+        REQUIRE(asset_cache_base::global_memory_budget().cpu_bytes == 1u);
+
+        // referenced assets are never evicted
+        REQUIRE(asset_cache_base::evict_all_over_budget_assets() == 1u);
+        REQUIRE(cache.asset_count() == 1u);
+        REQUIRE(the<asset_cache<binary_asset>>().asset_count() == 1u);
+
+        binary_res.reset();
+        REQUIRE(asset_cache_base::evict_all_over_budget_assets() == 1u);
+        REQUIRE(the<asset_cache<binary_asset>>().asset_count() == 0u);
+        REQUIRE(cache.find(make_hash("text_asset.txt")) == text_res);
+
+        asset_cache_base::global_memory_budget(asset_memory_usage());
+        text_res.reset();
+        REQUIRE(asset_cache_base::evict_all_over_budget_assets() == 0u);
+        REQUIRE(cache.asset_count() == 1u);
+    }
+}
@@ -627,6 +627,43 @@ TEST_CASE("node") {
                 REQUIRE(ns[i] == ns2[i]);
             }
         }
+        {
+            vector<const node*> ns2;
+            REQUIRE(4u == p->extract_all_node_pointers(std::back_inserter(ns2)));
+            REQUIRE(ns.size() == ns2.size());
+            for ( std::size_t i = 0; i < ns.size(); ++i ) {
+                REQUIRE(ns[i].get() == ns2[i]);
+            }
+        }
+    }
+    SECTION("hierarchy_version") {
+        auto p = node::create(w);
+        auto c1 = node::create(w, p);
+        auto c2 = node::create(w, c1);
+        auto c3 = node::create(w, p);
+
+        u32 pv = p->hierarchy_version();
+        u32 c1v = c1->hierarchy_version();
+        const u32 c3v = c3->hierarchy_version();
+
+        c2->translation(v3f(1.f, 2.f, 3.f));
+        REQUIRE(pv == p->hierarchy_version());
+
+        REQUIRE(c1->add_child(node::create(w)));
+        REQUIRE(pv != p->hierarchy_version());
+        REQUIRE(c1v != c1->hierarchy_version());
+        REQUIRE(c3v == c3->hierarchy_version());
+
+        pv = p->hierarchy_version();
+        c1v = c1->hierarchy_version();
+        REQUIRE(c3->send_backward());
+        REQUIRE(pv != p->hierarchy_version());
+        REQUIRE(c1v == c1->hierarchy_version());
+
+        pv = p->hierarchy_version();
+        REQUIRE(c2->remove_from_parent());
+        REQUIRE(pv != p->hierarchy_version());
+        REQUIRE(c1v != c1->hierarchy_version());
     }
     SECTION("destroy_node") {
         auto p1 = node::create(w);
@@ -731,6 +768,26 @@ TEST_CASE("node") {
                 math::make_translation_matrix4(60.f,0.f,0.f));
         }
     }
+    SECTION("world_affine") {
+        auto p = node::create(w);
+        p->translation({10.f,0.f,0.f});
+        p->rotation(math::make_quat_from_axis_angle(make_deg(90.f), v3f::unit_z()));
+
+        auto n = node::create(w, p);
+        n->translation({0.f,5.f,0.f});
+        n->scale({2.f,2.f,2.f});
+
+        REQUIRE(math::make_affine_matrix4(n->local_affine()) == n->local_matrix());
+        REQUIRE(math::make_affine_matrix4(n->world_affine()) == n->world_matrix());
+        REQUIRE(n->world_matrix() ==
+            math::make_trs_matrix4(p->transform()) *
+            math::make_trs_matrix4(n->transform()));
+
+        n->translation({0.f,6.f,0.f});
+        REQUIRE(n->world_matrix() ==
+            math::make_trs_matrix4(p->transform()) *
+            math::make_trs_matrix4(n->transform()));
+    }
     SECTION("lifetime") {
         {
             fake_node::reset_counters();
@@ -0,0 +1,554 @@
+/*******************************************************************************
+ * This file is part of the "Enduro2D"
+ * For conditions of distribution and use, see copyright notice in LICENSE.md
+ * Copyright (C) 2018 Matvey Cherevko
+ ******************************************************************************/
+
+#include "_high.hpp"
+using namespace e2d;
+
+#include "../../../sources/enduro2d/core/render_impl/render.hpp"
+#include "../../../sources/enduro2d/core/window_impl/window.hpp"
+#include "../../../sources/enduro2d/high/systems/render_system_impl/render_system_drawer.hpp"
+
+namespace
+{
+    using batcher_type = render_system_impl::drawer::batcher_type;
+
+    class safe_starter_initializer final : private noncopyable {
+    public:
+        safe_starter_initializer() {
+            modules::initialize<starter>(0, nullptr,
+                starter::parameters(
+                    engine::parameters("render_system_untests", "enduro2d")
+                        .without_graphics(true)));
+        }
+
+        ~safe_starter_initializer() noexcept {
+            modules::shutdown<starter>();
+        }
+    };
+
+    batcher_type::vertex_type make_vertex(f32 x, f32 y) {
+        return {v3f(x, y, 0.f), v2f(x, y), color32::white(), 0.f};
+    }
+
+    bool is_vertex_equal(
+        const batcher_type::vertex_type& v,
+        const v3f& position,
+        const v2f& st,
+        const color32& tint,
+        f32 texture_slot)
+    {
+        return v.v == position
+            && v.t == st
+            && v.c == tint
+            && math::approximately(v.s, texture_slot);
+    }
+}
+
+// the kernels run without a render device
+TEST_CASE("render_system_kernels") {
+    SECTION("quad_indices") {
+        u16 indices[12] = {0};
+        batcher_type::generate_quad_indices(indices, 2u);
+        const u16 expected[12] = {0, 1, 2, 2, 3, 0, 4, 5, 6, 6, 7, 4};
+        REQUIRE(std::equal(std::begin(indices), std::end(indices), std::begin(expected)));
+
+        // the last quad of a page addresses the last vertices of u16
+        const std::size_t max_quad_count = batcher_type::max_quad_count;
+        vector<u16> page(max_quad_count * 6u);
+        batcher_type::generate_quad_indices(page.data(), max_quad_count);
+        REQUIRE(page[page.size() - 2u] == 65531u);
+        REQUIRE(*std::max_element(page.begin(), page.end()) == 65531u);
+    }
+    SECTION("sprite_vertices") {
+        render_system_impl::drawer::sprite_run sprites;
+        const color32 red(255, 0, 0);
+        const auto add_sprite = [&sprites, &red](const a3f& m) {
+            sprites.matrices.push_back(m);
+            sprites.pivots.push_back(v2f(0.5f, 0.5f));
+            sprites.sizes.push_back(v2f(1.f, 0.5f));
+            sprites.texrects.push_back(b2f(0.25f, 0.5f, 0.5f, 0.5f));
+            sprites.tints.push_back(red);
+        };
+
+        add_sprite(a3f(
+            1.f, 0.f, 0.f,
+            0.f, 1.f, 0.f,
+            0.f, 0.f, 1.f,
+            0.5f, 0.f, 0.f));
+        add_sprite(a3f(
+            1.f, 0.f, 0.f,
+            0.f, 1.f, 0.f,
+            0.f, 0.f, 1.f,
+            5.f, 0.f, 0.f));
+        add_sprite(a3f(
+            2.f, 0.f, 0.f,
+            0.f, 1.f, 0.f,
+            0.f, 0.f, 1.f,
+            0.f, 0.f, 0.f));
+        REQUIRE(sprites.size() == 3u);
+
+        // the second sprite is out of the clip volume
+        batcher_type::vertex_type vertices[12];
+        REQUIRE(sprites.generate_vertices(m4f::identity(), 3.f, vertices) == 2u);
+
+        REQUIRE(is_vertex_equal(vertices[0], v3f(0.f, -0.25f, 0.f), v2f(0.25f, 0.5f), red, 3.f));
+        REQUIRE(is_vertex_equal(vertices[1], v3f(1.f, -0.25f, 0.f), v2f(0.75f, 0.5f), red, 3.f));
+        REQUIRE(is_vertex_equal(vertices[2], v3f(1.f,  0.25f, 0.f), v2f(0.75f, 1.0f), red, 3.f));
+        REQUIRE(is_vertex_equal(vertices[3], v3f(0.f,  0.25f, 0.f), v2f(0.25f, 1.0f), red, 3.f));
+
+        REQUIRE(is_vertex_equal(vertices[4], v3f(-1.f, -0.25f, 0.f), v2f(0.25f, 0.5f), red, 3.f));
+        REQUIRE(is_vertex_equal(vertices[5], v3f( 1.f, -0.25f, 0.f), v2f(0.75f, 0.5f), red, 3.f));
+        REQUIRE(is_vertex_equal(vertices[6], v3f( 1.f,  0.25f, 0.f), v2f(0.75f, 1.0f), red, 3.f));
+        REQUIRE(is_vertex_equal(vertices[7], v3f(-1.f,  0.25f, 0.f), v2f(0.25f, 1.0f), red, 3.f));
+
+        sprites.clear();
+        REQUIRE(sprites.size() == 0u);
+        REQUIRE(sprites.generate_vertices(m4f::identity(), 0.f, vertices) == 0u);
+    }
+    SECTION("sprite_sampler") {
+        using render_system_impl::drawer;
+
+        // mip chains are sampled only when they are there
+        REQUIRE(drawer::sprite_min_filter(true, 1u) == render::sampler_min_filter::linear);
+        REQUIRE(drawer::sprite_min_filter(false, 1u) == render::sampler_min_filter::nearest);
+        REQUIRE(drawer::sprite_min_filter(true, 8u) == render::sampler_min_filter::linear_mipmap_linear);
+        REQUIRE(drawer::sprite_min_filter(false, 8u) == render::sampler_min_filter::nearest_mipmap_nearest);
+
+        const render::sampler_state nearest = drawer::sprite_sampler(nullptr, false);
+        REQUIRE_FALSE(nearest.texture());
+        REQUIRE(nearest.min_filter() == render::sampler_min_filter::nearest);
+        REQUIRE(nearest.mag_filter() == render::sampler_mag_filter::nearest);
+    }
+}
+
+#if E2D_RENDER_MODE == E2D_RENDER_MODE_NONE && E2D_WINDOW_MODE == E2D_WINDOW_MODE_NONE
+
+namespace
+{
+    render::sampler_state make_sampler(render::sampler_wrap wrap) {
+        return render::sampler_state()
+            .wrap(wrap);
+    }
+}
+
+TEST_CASE("render_system") {
+    debug d;
+    window w(v2u(640,480), "render_system_untests", false, false);
+    render r(d, w);
+    render_queue q;
+    batcher_type b(d, r, q);
+    const material_asset::ptr mat = material_asset::create(
+        render::material().add_pass(render::pass_state()));
+    const render::property_block props;
+    const auto submit = [&q, &r, &b](){
+        q.flush(r);
+        b.recycle_buffers();
+    };
+    SECTION("batches") {
+        const u16 indices[] = {0, 1, 2, 2, 3, 0};
+        const batcher_type::vertex_type vertices[] = {
+            make_vertex(0.f, 0.f),
+            make_vertex(1.f, 0.f),
+            make_vertex(1.f, 1.f),
+            make_vertex(0.f, 1.f)};
+        const render::property_block other_props = render::property_block()
+            .property("u_other", 1.f);
+
+        // same layer, material and properties are merged into one batch
+        b.batch(0u, 0.f, mat, props, indices, 6u, vertices, 4u);
+        b.batch(0u, 0.f, mat, props, indices, 6u, vertices, 4u);
+        b.batch(0u, 0.f, mat, other_props, indices, 6u, vertices, 4u);
+        b.batch(1u, 0.f, mat, other_props, indices, 6u, vertices, 4u);
+        b.flush();
+        REQUIRE(b.current_statistics().batch_count == 3u);
+        REQUIRE(q.command_count() == 3u);
+        submit();
+        r.frame_tick();
+        REQUIRE(r.last_frame_statistics().draw_calls == 3u);
+
+        // every flush uploads only its own batches to its own buffers,
+        // they are all drawn by one submission
+        for ( std::size_t i = 0; i < 4; ++i ) {
+            b.batch(0u, 0.f, mat, props, indices, 6u, vertices, 4u);
+            b.flush();
+        }
+        REQUIRE(b.current_statistics().batch_count == 7u);
+        submit();
+        r.frame_tick();
+        REQUIRE(r.last_frame_statistics().draw_calls == 4u);
+
+        // other draws enqueued in between are not merged over
+        b.batch(0u, 0.f, mat, props, indices, 6u, vertices, 4u);
+        q.next_sequence();
+        b.batch(0u, 0.f, mat, props, indices, 6u, vertices, 4u);
+        b.flush();
+        REQUIRE(b.current_statistics().batch_count == 9u);
+        submit();
+
+        b.flush();
+        REQUIRE(b.current_statistics().batch_count == 9u);
+        b.reset_statistics();
+        REQUIRE(b.current_statistics().batch_count == 0u);
+    }
+    SECTION("buffer_sets") {
+        const u16 indices[] = {0, 1, 2};
+        const batcher_type::vertex_type vertices[] = {
+            make_vertex(0.f, 0.f),
+            make_vertex(1.f, 0.f),
+            make_vertex(1.f, 1.f)};
+        const auto draw_camera = [&](){
+            b.batch(0u, 0.f, mat, props, indices, 3u, vertices, 3u);
+            b.flush();
+            vertex_buffer_ptr vb;
+            q.foreach_by_sorted_commands([&vb](const render::draw_command& cmd){
+                vb = cmd.geometry_ref().vertices(0u);
+            });
+            q.flush(r);
+            return vb;
+        };
+
+        // cameras of one frame never share buffers
+        const vertex_buffer_ptr vb1 = draw_camera();
+        const vertex_buffer_ptr vb2 = draw_camera();
+        const vertex_buffer_ptr vb3 = draw_camera();
+        REQUIRE(vb1);
+        REQUIRE(vb1 != vb2);
+        REQUIRE(vb2 != vb3);
+        REQUIRE(vb1 != vb3);
+        b.recycle_buffers();
+        r.frame_tick();
+
+        const vertex_buffer_ptr vb4 = draw_camera();
+        REQUIRE(vb4);
+        b.recycle_buffers();
+    }
+    SECTION("quad_pages") {
+        const std::size_t max_quad_count = batcher_type::max_quad_count;
+        REQUIRE(max_quad_count == 16383u);
+
+        // quads are filled in place, only the filled ones are kept
+        batcher_type::vertex_type* vertices = b.begin_quads(0u, 0.f, mat, props, 4u);
+        REQUIRE(vertices);
+        for ( std::size_t i = 0; i < 8; ++i ) {
+            vertices[i] = make_vertex(f32(i), 0.f);
+        }
+        b.end_quads(2u);
+
+        // the same batch grows past one page of the static index buffer
+        const std::size_t quad_count = max_quad_count + 8u;
+        vertices = b.begin_quads(0u, 0.f, mat, props, quad_count);
+        REQUIRE(vertices);
+        std::fill(vertices, vertices + quad_count * 4u, make_vertex(1.f, 1.f));
+        b.end_quads(quad_count);
+
+        b.flush();
+        REQUIRE(b.current_statistics().batch_count == 2u);
+        submit();
+        r.frame_tick();
+        REQUIRE(r.last_frame_statistics().draw_calls == 2u);
+
+        // an empty quad batch is dropped
+        b.begin_quads(0u, 0.f, mat, props, 4u);
+        b.end_quads(0u);
+        b.flush();
+        REQUIRE(b.current_statistics().batch_count == 2u);
+
+        // quads and indexed geometry are separate batches
+        const u16 indices[] = {0, 1, 2};
+        const batcher_type::vertex_type triangle[] = {
+            make_vertex(0.f, 0.f),
+            make_vertex(1.f, 0.f),
+            make_vertex(1.f, 1.f)};
+        b.begin_quads(0u, 0.f, mat, props, 1u);
+        b.end_quads(1u);
+        b.batch(0u, 0.f, mat, props, indices, 3u, triangle, 3u);
+        b.begin_quads(0u, 0.f, mat, props, 1u);
+        b.end_quads(1u);
+        b.flush();
+        REQUIRE(b.current_statistics().batch_count == 5u);
+    }
+    SECTION("texture_slots") {
+        const render::sampler_state s0 = make_sampler(render::sampler_wrap::clamp);
+        const render::sampler_state s1 = make_sampler(render::sampler_wrap::repeat);
+        const render::sampler_state s2 = make_sampler(render::sampler_wrap::mirror);
+
+        // the second sampler takes the free slot, known samplers reuse theirs
+        std::size_t slot = 42u;
+        b.begin_quads(0u, 0.f, mat, props, s0, 2u, 1u, slot);
+        b.end_quads(1u);
+        REQUIRE(slot == 0u);
+        b.begin_quads(0u, 0.f, mat, props, s1, 2u, 1u, slot);
+        b.end_quads(1u);
+        REQUIRE(slot == 1u);
+        b.begin_quads(0u, 0.f, mat, props, s0, 2u, 1u, slot);
+        b.end_quads(1u);
+        REQUIRE(slot == 0u);
+        REQUIRE(b.current_statistics().saved_batch_count == 2u);
+
+        // all the slots are taken, so the third sampler starts a new batch
+        b.begin_quads(0u, 0.f, mat, props, s2, 2u, 1u, slot);
+        b.end_quads(1u);
+        REQUIRE(slot == 0u);
+        b.begin_quads(0u, 0.f, mat, props, s1, 2u, 1u, slot);
+        b.end_quads(1u);
+        REQUIRE(slot == 1u);
+        REQUIRE(b.current_statistics().saved_batch_count == 3u);
+
+        b.flush();
+        REQUIRE(b.current_statistics().batch_count == 2u);
+        submit();
+        r.frame_tick();
+        REQUIRE(r.last_frame_statistics().draw_calls == 2u);
+    }
+}
+
+TEST_CASE("render_system_drawer") {
+    // the null render without the rest of the graphics modules,
+    // the engine shuts them down with its own ones
+    safe_starter_initializer initializer;
+    modules::initialize<window>(v2u(640,480), "render_system_untests", false, false);
+    modules::initialize<render>(the<debug>(), the<window>());
+
+    render_queue q;
+    batcher_type b(the<debug>(), the<render>(), q);
+    render_system_impl::drawer::sprite_run sprites;
+    render_system_impl::drawer::statistics stats;
+    const camera cam;
+    SECTION("scene_order") {
+        const material_asset::ptr sprite_mat = material_asset::create(
+            render::material().add_pass(render::pass_state()));
+        const material_asset::ptr model_mat = material_asset::create(
+            render::material().add_pass(render::pass_state()
+                .states(render::state_block()
+                    .capabilities(render::capabilities_state()
+                        .blending(true)))));
+
+        const sprite_asset::ptr spr = sprite_asset::create(sprite()
+            .set_size(v2f(0.5f, 0.5f))
+            .set_material(sprite_mat));
+        const model_asset::ptr mdl = model_asset::create(model()
+            .set_mesh(mesh_asset::create(mesh()
+                .set_vertices({v3f(0.f, 0.f, 0.f), v3f(0.5f, 0.f, 0.f), v3f(0.f, 0.5f, 0.f)})
+                .set_indices(0u, {0u, 1u, 2u})))
+            .set_material(0u, model_mat));
+
+        const node_iptr n = node::create(the<world>());
+        const renderer node_r;
+
+        // the model is between the sprites, so they are not batched together
+        {
+            render_system_impl::drawer::context ctx(
+                cam, const_node_iptr(), the<engine>(), the<render>(), q, b, sprites, stats);
+            ctx.draw(*n, node_r, sprite_renderer(spr));
+            ctx.draw(*n, node_r, model_renderer(mdl));
+            ctx.draw(*n, node_r, sprite_renderer(spr));
+            ctx.flush();
+        }
+
+        vector<const render::material*> order;
+        q.foreach_by_sorted_commands([&order](const render::draw_command& cmd){
+            order.push_back(&cmd.material_ref());
+        });
+        REQUIRE(order == vector<const render::material*>{
+            &sprite_mat->content(),
+            &model_mat->content(),
+            &sprite_mat->content()});
+
+        q.clear();
+        b.recycle_buffers();
+    }
+    SECTION("view_depth") {
+        const material_asset::ptr mat = material_asset::create(
+            render::material().add_pass(render::pass_state()
+                .states(render::state_block()
+                    .capabilities(render::capabilities_state()
+                        .depth_test(true)))));
+        const model_asset::ptr mdl = model_asset::create(model()
+            .set_mesh(mesh_asset::create(mesh()
+                .set_vertices({v3f(0.f, 0.f, 0.f), v3f(0.5f, 0.f, 0.f), v3f(0.f, 0.5f, 0.f)})
+                .set_indices(0u, {0u, 1u, 2u})))
+            .set_material(0u, mat));
+
+        const node_iptr near_n = node::create(the<world>());
+        const node_iptr far_n = node::create(the<world>());
+        near_n->translation(v3f(0.f, 0.f, -0.5f));
+        far_n->translation(v3f(0.f, 0.f, 0.5f));
+        const renderer node_r;
+
+        const auto collect_depths = [&q](){
+            vector<f32> depths;
+            q.foreach_by_sorted_commands([&depths](const render::draw_command& cmd){
+                depths.push_back((*cmd.properties_ref().property<m4f>("u_matrix_m"))[3].z);
+            });
+            q.clear();
+            return depths;
+        };
+
+        // opaque draws are sorted by their depth along the camera view,
+        // not by their world z
+        for ( const f32 view_z : {1.f, -1.f} ) {
+            const camera view_cam = camera()
+                .projection(math::make_scale_matrix4(1.f, 1.f, view_z));
+            {
+                render_system_impl::drawer::context ctx(
+                    view_cam, const_node_iptr(), the<engine>(), the<render>(), q, b, sprites, stats);
+                ctx.draw(*far_n, node_r, model_renderer(mdl));
+                ctx.draw(*near_n, node_r, model_renderer(mdl));
+                ctx.flush();
+            }
+            REQUIRE(collect_depths() == vector<f32>{-0.5f * view_z, 0.5f * view_z});
+        }
+        b.recycle_buffers();
+    }
+    SECTION("scene_layers") {
+        const material_asset::ptr mat1 = material_asset::create(
+            render::material().add_pass(render::pass_state()));
+        const material_asset::ptr mat2 = material_asset::create(
+            render::material().add_pass(render::pass_state()));
+        const sprite_asset::ptr spr1 = sprite_asset::create(sprite()
+            .set_size(v2f(0.5f, 0.5f))
+            .set_material(mat1));
+        const sprite_asset::ptr spr2 = sprite_asset::create(sprite()
+            .set_size(v2f(0.5f, 0.5f))
+            .set_material(mat2));
+
+        const node_iptr n = node::create(the<world>());
+        const renderer node_r;
+
+        vector<const render::material*> order;
+        const auto collect_order = [&q, &order](){
+            order.clear();
+            q.foreach_by_sorted_commands([&order](const render::draw_command& cmd){
+                order.push_back(&cmd.material_ref());
+            });
+        };
+
+        // scene depths out of the key layer range keep their order
+        {
+            render_system_impl::drawer::context ctx(
+                cam, const_node_iptr(), the<engine>(), the<render>(), q, b, sprites, stats);
+            ctx.layer(-2000);
+            ctx.draw(*n, node_r, sprite_renderer(spr1));
+            ctx.layer(-1000);
+            ctx.draw(*n, node_r, sprite_renderer(spr2));
+            ctx.layer(1000);
+            ctx.draw(*n, node_r, sprite_renderer(spr2));
+            ctx.layer(1000);
+            ctx.draw(*n, node_r, sprite_renderer(spr2));
+            ctx.layer(2000);
+            ctx.draw(*n, node_r, sprite_renderer(spr1));
+            ctx.flush();
+        }
+        collect_order();
+        REQUIRE(order == vector<const render::material*>{
+            &mat1->content(),
+            &mat2->content(),
+            &mat2->content(),
+            &mat1->content()});
+        q.clear();
+        b.recycle_buffers();
+
+        // the queue is executed when the key layers run out
+        {
+            render_system_impl::drawer::context ctx(
+                cam, const_node_iptr(), the<engine>(), the<render>(), q, b, sprites, stats);
+            for ( i32 i = 0; i < 260; ++i ) {
+                ctx.layer(i * 10);
+                ctx.draw(*n, node_r, sprite_renderer(i % 2 ? spr2 : spr1));
+            }
+            ctx.flush();
+        }
+        collect_order();
+        REQUIRE(order == vector<const render::material*>{
+            &mat1->content(),
+            &mat2->content(),
+            &mat1->content(),
+            &mat2->content()});
+        q.clear();
+        b.recycle_buffers();
+    }
+    SECTION("spatial_index_culling") {
+        ecs::registry& owner = the<world>().registry();
+        const sprite_asset::ptr spr = sprite_asset::create(sprite()
+            .set_size(v2f(0.5f, 0.5f))
+            .set_material(material_asset::create(
+                render::material().add_pass(render::pass_state()))));
+
+        const node_iptr root = node::create(the<world>());
+        const node_iptr inside = node::create(the<world>(), root);
+        const node_iptr outside = node::create(the<world>(), root);
+        outside->translation(v3f(10.f, 0.f, 0.f));
+        for ( const node_iptr& n : {inside, outside} ) {
+            REQUIRE(n->entity().assign_component<renderer>());
+            REQUIRE(n->entity().assign_component<sprite_renderer>(sprite_renderer(spr)));
+        }
+
+        ecs::entity cam_e = owner.create_entity();
+        REQUIRE(cam_e.assign_component<camera>(camera()));
+        ecs::entity scn_e = owner.create_entity();
+        REQUIRE(scn_e.assign_component<scene>(scene(root)));
+
+        // the index of the scene root is updated and culls the scene
+        spatial_index index(root);
+        REQUIRE(index.pending_count() == 3u);
+        render_system system;
+        system.process(owner);
+        REQUIRE(index.pending_count() == 0u);
+        REQUIRE_FALSE(index.is_visible(*outside));
+        REQUIRE(system.last_frame_statistics().visible_count == 1u);
+        REQUIRE(system.last_frame_statistics().culled_count == 1u);
+
+        outside->translation(v3f(0.f, 0.f, 0.f));
+        system.process(owner);
+        REQUIRE(index.is_visible(*outside));
+        REQUIRE(system.last_frame_statistics().visible_count == 2u);
+        REQUIRE(system.last_frame_statistics().culled_count == 0u);
+
+        REQUIRE(owner.destroy_entity(cam_e));
+        REQUIRE(owner.destroy_entity(scn_e));
+    }
+    SECTION("sprite_sampler") {
+        using render_system_impl::drawer;
+
+        const texture_ptr tex = the<render>().create_texture(
+            v2u(64u, 64u),
+            pixel_declaration::pixel_type::rgba8);
+        REQUIRE(tex);
+        const render::sampler_state linear = drawer::sprite_sampler(tex, true);
+        REQUIRE(linear.texture() == tex);
+        REQUIRE(linear.min_filter() == drawer::sprite_min_filter(true, tex->mipmap_count()));
+        REQUIRE(linear.mag_filter() == render::sampler_mag_filter::linear);
+    }
+    SECTION("draw_list_cache") {
+        ecs::registry& owner = the<world>().registry();
+        const node_iptr root = node::create(the<world>());
+        const node_iptr child = node::create(the<world>(), root);
+
+        ecs::entity cam_e = owner.create_entity();
+        REQUIRE(cam_e.assign_component<camera>(camera()));
+        ecs::entity scn_e = owner.create_entity();
+        REQUIRE(scn_e.assign_component<scene>(scene(root)));
+        const scene& scn = scn_e.get_component<scene>();
+
+        // the draw list of the registry scene is kept between frames
+        render_system system;
+        system.process(owner);
+        REQUIRE_FALSE(scn.draw_list_outdated());
+        system.process(owner);
+        REQUIRE_FALSE(scn.draw_list_outdated());
+
+        REQUIRE(child->remove_from_parent());
+        REQUIRE(scn.draw_list_outdated());
+        system.process(owner);
+        REQUIRE_FALSE(scn.draw_list_outdated());
+        REQUIRE(scn.draw_list() == vector<const node*>{root.get()});
+
+        REQUIRE(owner.destroy_entity(cam_e));
+        REQUIRE(owner.destroy_entity(scn_e));
+    }
+}
+
+#endif
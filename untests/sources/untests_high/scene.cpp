@@ -0,0 +1,65 @@
+/*******************************************************************************
+ * This file is part of the "Enduro2D"
+ * For conditions of distribution and use, see copyright notice in LICENSE.md
+ * Copyright (C) 2018 Matvey Cherevko
+ ******************************************************************************/
+
+#include "_high.hpp"
+using namespace e2d;
+
+namespace
+{
+    class safe_starter_initializer final : private noncopyable {
+    public:
+        safe_starter_initializer() {
+            modules::initialize<starter>(0, nullptr,
+                starter::parameters(
+                    engine::parameters("scene_untests", "enduro2d")
+                        .without_graphics(true)));
+        }
+
+        ~safe_starter_initializer() noexcept {
+            modules::shutdown<starter>();
+        }
+    };
+}
+
+TEST_CASE("scene") {
+    safe_starter_initializer initializer;
+    world& w = the<world>();
+    SECTION("draw_list") {
+        REQUIRE(scene().draw_list().empty());
+
+        auto p = node::create(w);
+        auto c1 = node::create(w, p);
+        auto c2 = node::create(w, c1);
+        auto c3 = node::create(w, p);
+
+        const scene s(p);
+        const vector<const node*> ns1{p.get(), c1.get(), c2.get(), c3.get()};
+        REQUIRE(s.draw_list_outdated());
+        REQUIRE(s.draw_list() == ns1);
+        REQUIRE_FALSE(s.draw_list_outdated());
+
+        const scene s2 = s;
+        REQUIRE(&s.draw_list() != &s2.draw_list());
+        REQUIRE(s2.draw_list() == ns1);
+
+        c2->translation(v3f(1.f, 2.f, 3.f));
+        REQUIRE(s2.draw_list() == ns1);
+
+        REQUIRE(c3->send_backward());
+        const vector<const node*> ns2{p.get(), c3.get(), c1.get(), c2.get()};
+        REQUIRE(s.draw_list() == ns2);
+
+        REQUIRE(c2->remove_from_parent());
+        const vector<const node*> ns3{p.get(), c3.get(), c1.get()};
+        REQUIRE(s2.draw_list() == ns3);
+
+        scene s3 = s;
+        s3.root(c1);
+        const vector<const node*> ns4{c1.get()};
+        REQUIRE(s3.draw_list() == ns4);
+        REQUIRE(s.draw_list() == ns3);
+    }
+}
@@ -0,0 +1,249 @@
+/*******************************************************************************
+ * This file is part of the "Enduro2D"
+ * For conditions of distribution and use, see copyright notice in LICENSE.md
+ * Copyright (C) 2018 Matvey Cherevko
+ ******************************************************************************/
+
+#include "_high.hpp"
+using namespace e2d;
+
+#include <random>
+
+namespace
+{
+    class safe_starter_initializer final : private noncopyable {
+    public:
+        safe_starter_initializer() {
+            modules::initialize<starter>(0, nullptr,
+                starter::parameters(
+                    engine::parameters("spatial_index_untests", "enduro2d")
+                        .without_graphics(true)));
+        }
+
+        ~safe_starter_initializer() noexcept {
+            modules::shutdown<starter>();
+        }
+    };
+
+    template < typename Query >
+    std::size_t count_nodes(Query&& query) {
+        std::size_t count = 0u;
+        query([&count](node&){ ++count; });
+        return count;
+    }
+}
+
+TEST_CASE("spatial_index") {
+    safe_starter_initializer initializer;
+    world& w = the<world>();
+    SECTION("queries") {
+        auto root = node::create(w);
+        vector<node_iptr> children;
+        for ( std::size_t i = 0; i < 100; ++i ) {
+            auto n = node::create(w, root);
+            n->translation(v3f(static_cast<f32>(i + 1), 0.f, 0.f));
+            children.push_back(n);
+        }
+
+        spatial_index index(root);
+        REQUIRE(index.root() == root);
+        REQUIRE(index.node_count() == 0u);
+        REQUIRE(index.pending_count() == 101u);
+
+        index.update();
+        REQUIRE(index.node_count() == 101u);
+        REQUIRE(index.pending_count() == 0u);
+        REQUIRE(index.tree_height() < 20u);
+
+        b3f bounds;
+        REQUIRE(index.find_bounds(children[4], bounds));
+        REQUIRE(bounds == b3f(5.f, 0.f, 0.f, 0.f, 0.f, 0.f));
+
+        node* found = nullptr;
+        index.query_point(v3f(5.f, 0.f, 0.f), [&found](node& n){ found = &n; });
+        REQUIRE(found == children[4].get());
+
+        REQUIRE(count_nodes([&index](auto&& f){
+            index.query_rect(b2f(2.5f, -1.f, 5.f, 2.f), f); }) == 5u);
+        REQUIRE(count_nodes([&index](auto&& f){
+            index.query_aabb(b3f(2.5f, -1.f, 1.f, 5.f, 2.f, 2.f), f); }) == 0u);
+        REQUIRE(count_nodes([&index](auto&& f){
+            index.query_ray(v3f(-10.f, 0.f, 0.f), v3f(1.f, 0.f, 0.f), f); }) == 101u);
+        REQUIRE(count_nodes([&index](auto&& f){
+            index.query_ray(v3f(-10.f, 1.f, 0.f), v3f(1.f, 0.f, 0.f), f); }) == 0u);
+        REQUIRE(count_nodes([&index](auto&& f){
+            index.query_ray(v3f(50.f, 0.f, 0.f), v3f(-1.f, 0.f, 0.f), f); }) == 51u);
+        REQUIRE(count_nodes([&index](auto&& f){
+            index.query_frustum(m4f::identity(), f); }) == 2u);
+        REQUIRE(count_nodes([&index](auto&& f){
+            index.query_frustum(math::make_orthogonal_lh_matrix4(20.f, 20.f, -1.f, 1.f), f); }) == 11u);
+    }
+    SECTION("update") {
+        auto root = node::create(w);
+        auto n1 = node::create(w, root);
+        auto n2 = node::create(w, n1);
+        n1->translation(v3f(10.f, 0.f, 0.f));
+
+        spatial_index index(root);
+        index.update();
+        REQUIRE(index.node_count() == 3u);
+
+        n1->translation(v3f(20.f, 0.f, 0.f));
+        REQUIRE(index.pending_count() == 2u);
+        index.update();
+        REQUIRE(index.pending_count() == 0u);
+        REQUIRE(count_nodes([&index](auto&& f){
+            index.query_point(v3f(20.f, 0.f, 0.f), f); }) == 2u);
+        REQUIRE(count_nodes([&index](auto&& f){
+            index.query_point(v3f(10.f, 0.f, 0.f), f); }) == 0u);
+
+        REQUIRE(n1->remove_from_parent());
+        REQUIRE(index.node_count() == 1u);
+        REQUIRE(index.pending_count() == 0u);
+        REQUIRE(count_nodes([&index](auto&& f){
+            index.query_point(v3f(20.f, 0.f, 0.f), f); }) == 0u);
+
+        n1->translation(v3f(30.f, 0.f, 0.f));
+        REQUIRE(index.pending_count() == 0u);
+
+        REQUIRE(root->add_child(n1));
+        REQUIRE(index.pending_count() == 2u);
+        index.update();
+        REQUIRE(index.node_count() == 3u);
+        REQUIRE(count_nodes([&index](auto&& f){
+            index.query_point(v3f(30.f, 0.f, 0.f), f); }) == 2u);
+
+        index.invalidate(n2);
+        REQUIRE(index.pending_count() == 1u);
+        index.update();
+        REQUIRE(index.node_count() == 3u);
+    }
+    SECTION("cull_frustum") {
+        auto root = node::create(w);
+        auto inside = node::create(w, root);
+        auto outside = node::create(w, root);
+        outside->translation(v3f(10.f, 0.f, 0.f));
+
+        spatial_index index(root);
+        REQUIRE(spatial_index::find(root) == &index);
+        REQUIRE_FALSE(spatial_index::find(inside));
+        REQUIRE_FALSE(spatial_index::find(nullptr));
+
+        // nodes without bounds are visible
+        REQUIRE(index.is_visible(*inside));
+        REQUIRE(index.is_visible(*outside));
+
+        index.update();
+        index.cull_frustum(m4f::identity());
+        REQUIRE(index.is_visible(*root));
+        REQUIRE(index.is_visible(*inside));
+        REQUIRE_FALSE(index.is_visible(*outside));
+
+        outside->translation(v3f(0.5f, 0.f, 0.f));
+        inside->translation(v3f(-10.f, 0.f, 0.f));
+        index.update();
+        index.cull_frustum(m4f::identity());
+        REQUIRE_FALSE(index.is_visible(*inside));
+        REQUIRE(index.is_visible(*outside));
+    }
+    SECTION("margin") {
+        auto root = node::create(w);
+        auto n = node::create(w, root);
+
+        spatial_index index(root, 1.f);
+        index.update();
+
+        b3f bounds;
+        REQUIRE(index.find_bounds(n, bounds));
+        REQUIRE(bounds == b3f(-1.f, -1.f, -1.f, 2.f, 2.f, 2.f));
+
+        n->translation(v3f(0.5f, 0.f, 0.f));
+        index.update();
+        REQUIRE(index.find_bounds(n, bounds));
+        REQUIRE(bounds == b3f(-1.f, -1.f, -1.f, 2.f, 2.f, 2.f));
+
+        n->translation(v3f(2.f, 0.f, 0.f));
+        index.update();
+        REQUIRE(index.find_bounds(n, bounds));
+        REQUIRE(bounds == b3f(1.f, -1.f, -1.f, 2.f, 2.f, 2.f));
+    }
+    SECTION("lifetime") {
+        auto root = node::create(w);
+        auto n = node::create(w, root);
+        {
+            spatial_index index(root);
+            REQUIRE_THROWS_AS(spatial_index(root, 0.f), bad_spatial_index_operation);
+            REQUIRE_THROWS_AS(spatial_index(nullptr, 0.f), bad_spatial_index_operation);
+            index.update();
+        }
+        n->translation(v3f(1.f, 0.f, 0.f));
+        {
+            spatial_index index(root);
+            index.update();
+            REQUIRE(index.node_count() == 2u);
+            REQUIRE(n->remove_from_parent());
+            n.reset();
+            REQUIRE(index.node_count() == 1u);
+        }
+    }
+    SECTION("performance") {
+        std::printf("-= spatial_index::performance tests =-\n");
+    #if defined(E2D_BUILD_MODE) && E2D_BUILD_MODE == E2D_BUILD_MODE_DEBUG
+        const std::size_t node_n = 5'000;
+        const std::size_t task_n = 100;
+    #else
+        const std::size_t node_n = 50'000;
+        const std::size_t task_n = 1'000;
+    #endif
+        std::mt19937 engine(42u);
+        std::uniform_real_distribution<f32> dist(0.f, 10'000.f);
+
+        auto root = node::create(w);
+        vector<node_iptr> nodes;
+        nodes.reserve(node_n);
+        for ( std::size_t i = 0; i < node_n; ++i ) {
+            auto n = node::create(w, root);
+            n->translation(v3f(dist(engine), dist(engine), 0.f));
+            nodes.push_back(n);
+        }
+
+        spatial_index index(root, 10.f);
+        {
+            e2d_untests::verbose_profiler_ms p("build");
+            index.update();
+            p.done(index.node_count());
+        }
+        {
+            std::size_t result = 0;
+            e2d_untests::verbose_profiler_ms p("query_rect(500x500)");
+            for ( std::size_t i = 0; i < task_n; ++i ) {
+                index.query_rect(b2f(dist(engine), dist(engine), 500.f, 500.f), [&result](node&){
+                    ++result;
+                });
+            }
+            p.done(result);
+        }
+        {
+            std::size_t result = 0;
+            e2d_untests::verbose_profiler_ms p("linear_scan(500x500)");
+            for ( std::size_t i = 0; i < task_n; ++i ) {
+                const b2f rect(dist(engine), dist(engine), 500.f, 500.f);
+                for ( const node_iptr& n : nodes ) {
+                    const v3f& t = n->world_affine()[3];
+                    result += math::inside(rect, v2f(t.x, t.y)) ? 1u : 0u;
+                }
+            }
+            p.done(result);
+        }
+        {
+            e2d_untests::verbose_profiler_ms p("update(10% moved)");
+            for ( std::size_t i = 0; i < task_n; ++i ) {
+                for ( std::size_t j = i % 10; j < nodes.size(); j += 10 ) {
+                    nodes[j]->translation(nodes[j]->translation() + v3f(1.f, 0.f, 0.f));
+                }
+                index.update();
+            }
+            p.done(index.node_count());
+        }
+    }
+}
@@ -0,0 +1,168 @@
+/*******************************************************************************
+ * This file is part of the "Enduro2D"
+ * For conditions of distribution and use, see copyright notice in LICENSE.md
+ * Copyright (C) 2018 Matvey Cherevko
+ ******************************************************************************/
+
+#include "_high.hpp"
+using namespace e2d;
+
+#include "../../../sources/enduro2d/core/render_impl/render.hpp"
+#include "../../../sources/enduro2d/core/window_impl/window.hpp"
+
+namespace
+{
+    class safe_starter_initializer final : private noncopyable {
+    public:
+        safe_starter_initializer() {
+            modules::initialize<starter>(0, nullptr,
+                starter::parameters(
+                    engine::parameters("texture_atlas_untests", "enduro2d")
+                        .without_graphics(true))
+                .use_texture_atlas(true)
+                .texture_atlas_params(texture_atlas::parameters()
+                    .page_size(v2u(64u, 32u))
+                    .max_image_size(32u)
+                    .padding(1u)));
+        }
+
+        ~safe_starter_initializer() noexcept {
+            modules::shutdown<starter>();
+        }
+    };
+}
+
+TEST_CASE("texture_atlas"){
+    {
+        texture_atlas::region r;
+        r.texrect = b2f(0.5f, 0.25f, 0.5f, 0.25f);
+        REQUIRE(r.remap(b2f::unit()) == r.texrect);
+        REQUIRE(r.remap(b2f(0.5f, 0.5f, 0.5f, 0.5f)) == b2f(0.75f, 0.375f, 0.25f, 0.125f));
+    }
+    {
+        const auto params = texture_atlas::parameters()
+            .page_size(v2u(512u, 256u))
+            .max_image_size(64u)
+            .padding(2u);
+        REQUIRE(params.page_size() == v2u(512u, 256u));
+        REQUIRE(params.max_image_size() == 64u);
+        REQUIRE(params.padding() == 2u);
+    }
+    {
+        // the packing of insert() without a render device
+        const v2u page_size(64u, 32u);
+        const v2u small_size = texture_atlas::padded_image_size(v2u(4u, 4u), 1u);
+        const v2u large_size = texture_atlas::padded_image_size(v2u(30u, 30u), 1u);
+        REQUIRE(small_size == v2u(6u, 6u));
+        REQUIRE(large_size == v2u(32u, 32u));
+
+        skyline_packer page1(page_size);
+        b2u small_rect, large_rect, large2_rect;
+        REQUIRE(page1.insert(small_size, small_rect));
+        REQUIRE(small_rect.position == v2u(0u, 0u));
+        REQUIRE(texture_atlas::packed_image_texrect(page_size, small_rect, v2u(4u, 4u), 1u)
+            == b2f(1.f / 64.f, 1.f - 5.f / 32.f, 4.f / 64.f, 4.f / 32.f));
+
+        // the second image fits the free space of the page, the third one doesn't
+        REQUIRE(page1.insert(large_size, large_rect));
+        REQUIRE_FALSE(large_rect.position == small_rect.position);
+        REQUIRE(texture_atlas::packed_image_texrect(page_size, large_rect, v2u(30u, 30u), 1u)
+            == b2f(
+                f32(large_rect.position.x + 1u) / 64.f,
+                1.f - f32(large_rect.position.y + 31u) / 32.f,
+                30.f / 64.f,
+                30.f / 32.f));
+        REQUIRE_FALSE(page1.insert(large_size, large2_rect));
+
+        skyline_packer page2(page_size);
+        REQUIRE(page2.insert(large_size, large2_rect));
+    }
+    {
+        // edges are extruded into the padding
+        buffer data(2u * 2u * 3u);
+        for ( std::size_t i = 0; i < data.size(); ++i ) {
+            data.data()[i] = static_cast<u8>(i);
+        }
+        const image src(v2u(2u, 2u), image_data_format::rgb8, data);
+        const image padded = texture_atlas::make_padded_image(src, 1u);
+        REQUIRE(padded.size() == v2u(4u, 4u));
+        REQUIRE(padded.format() == image_data_format::rgba8);
+        REQUIRE(padded.pixel32(0u, 0u) == src.pixel32(0u, 0u));
+        REQUIRE(padded.pixel32(1u, 1u) == src.pixel32(0u, 0u));
+        REQUIRE(padded.pixel32(3u, 0u) == src.pixel32(1u, 0u));
+        REQUIRE(padded.pixel32(2u, 2u) == src.pixel32(1u, 1u));
+        REQUIRE(padded.pixel32(0u, 3u) == src.pixel32(0u, 1u));
+    }
+    {
+        safe_starter_initializer initializer;
+        REQUIRE(modules::is_initialized<texture_atlas>());
+        texture_atlas& a = the<texture_atlas>();
+
+        // without graphics images stay in their own textures
+        texture_atlas::region r;
+        const image img(v2u(4u,4u), image_data_format::rgba8, buffer(4u * 4u * 4u));
+        REQUIRE_FALSE(a.insert(make_hash("image.png"), img, r));
+        REQUIRE_FALSE(a.find(make_hash("image.png"), r));
+        REQUIRE(a.page_count() == 0u);
+        REQUIRE(a.region_count() == 0u);
+        REQUIRE(a.occupancy() == Approx(0.f));
+        REQUIRE(0u == a.unload_self_unused_assets());
+    }
+#if E2D_RENDER_MODE == E2D_RENDER_MODE_NONE && E2D_WINDOW_MODE == E2D_WINDOW_MODE_NONE
+    {
+        // the null render without the rest of the graphics modules,
+        // the engine shuts them down with its own ones
+        safe_starter_initializer initializer;
+        modules::initialize<window>(v2u(640,480), "texture_atlas_untests", false, false);
+        modules::initialize<render>(the<debug>(), the<window>());
+        texture_atlas& a = the<texture_atlas>();
+
+        const image small(v2u(4u,4u), image_data_format::rgba8, buffer(4u * 4u * 4u));
+        const image large(v2u(30u,30u), image_data_format::rgb8, buffer(30u * 30u * 3u));
+        const image oversized(v2u(40u,4u), image_data_format::rgba8, buffer(40u * 4u * 4u));
+
+        // the first image is packed into the corner of a new page
+        texture_atlas::region r1;
+        REQUIRE(a.insert(make_hash("small.png"), small, r1));
+        REQUIRE(r1.page);
+        REQUIRE(r1.page->content()->size() == v2u(64u, 32u));
+        REQUIRE(r1.texrect == b2f(1.f / 64.f, 1.f - 5.f / 32.f, 4.f / 64.f, 4.f / 32.f));
+        REQUIRE(a.page_count() == 1u);
+        REQUIRE(a.region_count() == 1u);
+
+        texture_atlas::region found;
+        REQUIRE(a.find(make_hash("small.png"), found));
+        REQUIRE(found.page == r1.page);
+        REQUIRE(found.texrect == r1.texrect);
+
+        // the second one fits the free space of the same page
+        texture_atlas::region r2;
+        REQUIRE(a.insert(make_hash("large.png"), large, r2));
+        REQUIRE(r2.page == r1.page);
+        REQUIRE(a.page_count() == 1u);
+        REQUIRE(a.region_count() == 2u);
+        REQUIRE_FALSE(r2.texrect.position == r1.texrect.position);
+
+        // a full page makes the atlas start a new one
+        texture_atlas::region r3;
+        REQUIRE(a.insert(make_hash("large2.png"), large, r3));
+        REQUIRE(r3.page);
+        REQUIRE(r3.page != r1.page);
+        REQUIRE(a.page_count() == 2u);
+        REQUIRE(a.region_count() == 3u);
+        REQUIRE(a.occupancy() > 0.f);
+
+        texture_atlas::region r4;
+        REQUIRE_FALSE(a.insert(make_hash("oversized.png"), oversized, r4));
+        REQUIRE(a.region_count() == 3u);
+
+        // pages are evicted with their regions when nobody uses them
+        r1 = r2 = found = texture_atlas::region();
+        REQUIRE(1u == a.unload_self_unused_assets());
+        REQUIRE(a.page_count() == 1u);
+        REQUIRE(a.region_count() == 1u);
+        REQUIRE_FALSE(a.find(make_hash("small.png"), r1));
+        REQUIRE(a.find(make_hash("large2.png"), r1));
+    }
+#endif
+}
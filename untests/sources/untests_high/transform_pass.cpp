@@ -0,0 +1,305 @@
+/*******************************************************************************
+ * This file is part of the "Enduro2D"
+ * For conditions of distribution and use, see copyright notice in LICENSE.md
+ * Copyright (C) 2018 Matvey Cherevko
+ ******************************************************************************/
+
+#include "_high.hpp"
+using namespace e2d;
+
+namespace
+{
+    class safe_starter_initializer final : private noncopyable {
+    public:
+        safe_starter_initializer() {
+            modules::initialize<starter>(0, nullptr,
+                starter::parameters(
+                    engine::parameters("transform_pass_untests", "enduro2d")
+                        .without_graphics(true)));
+        }
+
+        ~safe_starter_initializer() noexcept {
+            modules::shutdown<starter>();
+        }
+    };
+
+    m4f expected_world_matrix(const const_node_iptr& n) {
+        return n->parent()
+            ? expected_world_matrix(n->parent()) * math::make_trs_matrix4(n->transform())
+            : math::make_trs_matrix4(n->transform());
+    }
+
+    bool approximately(const m4f& l, const m4f& r) noexcept {
+        for ( std::size_t i = 0; i < 4; ++i ) {
+            for ( std::size_t j = 0; j < 4; ++j ) {
+                if ( !math::approximately(l[i][j], r[i][j], 0.001f) ) {
+                    return false;
+                }
+            }
+        }
+        return true;
+    }
+
+    // root -> chain of 'depth' nodes, each chain node has 'width' leaves
+    vector<node_iptr> make_hierarchy(world& w, const node_iptr& root, std::size_t depth, std::size_t width) {
+        vector<node_iptr> nodes;
+        node_iptr parent = root;
+        for ( std::size_t i = 0; i < depth; ++i ) {
+            node_iptr n = node::create(w, parent);
+            n->translation(v3f(1.f, 0.f, 0.f));
+            n->rotation(math::make_quat_from_axis_angle(make_deg(10.f), v3f::unit_z()));
+            nodes.push_back(n);
+            for ( std::size_t j = 0; j < width; ++j ) {
+                node_iptr leaf = node::create(w, n);
+                leaf->scale(v3f(2.f));
+                nodes.push_back(leaf);
+            }
+            parent = n;
+        }
+        return nodes;
+    }
+}
+
+TEST_CASE("transform_pass") {
+    safe_starter_initializer initializer;
+    world& w = the<world>();
+    SECTION("world_matrices") {
+        auto root = node::create(w);
+        root->translation(v3f(5.f, 0.f, 0.f));
+        const vector<node_iptr> nodes = make_hierarchy(w, root, 10, 3);
+
+        transform_pass pass(root);
+        REQUIRE(pass.root() == root);
+        REQUIRE_THROWS_AS(transform_pass(root), bad_transform_pass_operation);
+        REQUIRE_THROWS_AS(transform_pass(nullptr), bad_transform_pass_operation);
+
+        pass.update();
+        REQUIRE(pass.node_count() == 41u);
+        REQUIRE(pass.last_updated_count() == 41u);
+        for ( const node_iptr& n : nodes ) {
+            REQUIRE(approximately(n->world_matrix(), expected_world_matrix(n)));
+        }
+
+        nodes[20]->translation(v3f(0.f, 3.f, 0.f));
+        REQUIRE(pass.pending_count() == 1u);
+        nodes[20]->scale(v3f(0.5f));
+        REQUIRE(pass.pending_count() == 1u);
+
+        pass.update();
+        REQUIRE(pass.pending_count() == 0u);
+        REQUIRE(pass.last_updated_count() == nodes.size() - 20u);
+        for ( const node_iptr& n : nodes ) {
+            REQUIRE(approximately(n->world_matrix(), expected_world_matrix(n)));
+        }
+
+        // nested moved nodes are updated once with their subtree
+        nodes[32]->translation(v3f(1.f, 1.f, 1.f));
+        nodes[12]->translation(v3f(2.f, 2.f, 2.f));
+        nodes[13]->translation(v3f(3.f, 3.f, 3.f));
+        pass.update();
+        REQUIRE(pass.last_updated_count() == nodes.size() - 12u);
+
+        // nothing is swept without changes
+        pass.update();
+        REQUIRE(pass.last_updated_count() == 0u);
+    }
+    SECTION("up_to_date") {
+        auto root = node::create(w);
+        const vector<node_iptr> nodes = make_hierarchy(w, root, 5, 1);
+        transform_pass pass(root);
+        REQUIRE_FALSE(pass.up_to_date());
+        REQUIRE(transform_pass::is_joined(nodes.back()));
+
+        pass.update();
+        REQUIRE(pass.up_to_date());
+
+        root->translation(v3f(1.f, 2.f, 3.f));
+        REQUIRE_FALSE(pass.up_to_date());
+        REQUIRE(pass.pending_count() == 1u);
+        pass.update();
+        REQUIRE(pass.up_to_date());
+        REQUIRE(approximately(root->local_matrix(), math::make_trs_matrix4(root->transform())));
+        REQUIRE(approximately(nodes.back()->world_matrix(), expected_world_matrix(nodes.back())));
+
+        // local transforms of moved nodes are recomputed in the pass arrays
+        nodes[2]->rotation(math::make_quat_from_axis_angle(make_deg(45.f), v3f::unit_z()));
+        pass.update();
+        REQUIRE(approximately(nodes[2]->local_matrix(), math::make_trs_matrix4(nodes[2]->transform())));
+        REQUIRE(approximately(nodes.back()->world_matrix(), expected_world_matrix(nodes.back())));
+        REQUIRE(approximately(nodes[1]->world_matrix(), expected_world_matrix(nodes[1])));
+    }
+    SECTION("reads_after_setters") {
+        auto root = node::create(w);
+        const vector<node_iptr> nodes = make_hierarchy(w, root, 5, 1);
+        transform_pass pass(root);
+
+        // before the first update
+        REQUIRE(approximately(nodes.back()->world_matrix(), expected_world_matrix(nodes.back())));
+        pass.update();
+
+        // pending moves are swept on read
+        root->translation(v3f(1.f, 2.f, 3.f));
+        nodes[2]->rotation(math::make_quat_from_axis_angle(make_deg(45.f), v3f::unit_z()));
+        REQUIRE(approximately(nodes[2]->local_matrix(), math::make_trs_matrix4(nodes[2]->transform())));
+        REQUIRE(approximately(nodes.back()->world_matrix(), expected_world_matrix(nodes.back())));
+        REQUIRE(pass.up_to_date());
+
+        // joined nodes are computed through the parent chain until update()
+        auto child = node::create(w, nodes.back());
+        child->translation(v3f(0.f, 4.f, 0.f));
+        REQUIRE_FALSE(pass.up_to_date());
+        REQUIRE(approximately(child->world_matrix(), expected_world_matrix(child)));
+        nodes[0]->scale(v3f(3.f));
+        REQUIRE(approximately(child->world_matrix(), expected_world_matrix(child)));
+        REQUIRE(approximately(nodes[0]->local_matrix(), math::make_trs_matrix4(nodes[0]->transform())));
+        pass.update();
+        REQUIRE(approximately(child->world_matrix(), expected_world_matrix(child)));
+    }
+    SECTION("hierarchy_changes") {
+        auto root = node::create(w);
+        auto outside = node::create(w);
+        outside->translation(v3f(10.f, 0.f, 0.f));
+        const vector<node_iptr> nodes = make_hierarchy(w, root, 4, 2);
+
+        transform_pass pass(root);
+        pass.update();
+        REQUIRE(pass.node_count() == 13u);
+
+        // moved out of the pass
+        outside->add_child(nodes[3]);
+        REQUIRE(approximately(nodes[4]->world_matrix(), expected_world_matrix(nodes[4])));
+        pass.update();
+        REQUIRE(pass.node_count() == 4u);
+        nodes[3]->translation(v3f(0.f, 5.f, 0.f));
+        REQUIRE(approximately(nodes[4]->world_matrix(), expected_world_matrix(nodes[4])));
+        REQUIRE(pass.pending_count() == 0u);
+
+        // moved back into the pass
+        nodes[1]->add_child(nodes[3]);
+        REQUIRE(pass.node_count() == 4u);
+        pass.update();
+        REQUIRE(pass.node_count() == 13u);
+        REQUIRE(approximately(nodes[5]->world_matrix(), expected_world_matrix(nodes[5])));
+
+        // the root is kept in the pass, its outer parent is tracked
+        outside->add_child(root);
+        pass.update();
+        REQUIRE(approximately(nodes[11]->world_matrix(), expected_world_matrix(nodes[11])));
+        outside->translation(v3f(-10.f, 0.f, 0.f));
+        REQUIRE(pass.pending_count() == 1u);
+        pass.update();
+        REQUIRE(approximately(nodes[11]->world_matrix(), expected_world_matrix(nodes[11])));
+        REQUIRE(root->remove_from_parent());
+        pass.update();
+        REQUIRE(approximately(nodes[11]->world_matrix(), expected_world_matrix(nodes[11])));
+    }
+    SECTION("nested_passes") {
+        auto root = node::create(w);
+        const vector<node_iptr> nodes = make_hierarchy(w, root, 6, 0);
+        {
+            transform_pass inner(nodes[3]);
+            transform_pass outer(root);
+            outer.update();
+            inner.update();
+            REQUIRE(outer.node_count() == 4u);
+            REQUIRE(inner.node_count() == 3u);
+
+            nodes[1]->translation(v3f(0.f, 1.f, 0.f));
+            outer.update();
+            REQUIRE(inner.pending_count() == 1u);
+            inner.update();
+            REQUIRE(approximately(nodes[5]->world_matrix(), expected_world_matrix(nodes[5])));
+        }
+        nodes[0]->translation(v3f(0.f, 0.f, 1.f));
+        REQUIRE(approximately(nodes[5]->world_matrix(), expected_world_matrix(nodes[5])));
+    }
+    SECTION("transform_system") {
+        auto root = node::create(w);
+        const vector<node_iptr> nodes = make_hierarchy(w, root, 4, 1);
+        auto inner_root = node::create(w, nodes.back());
+        auto inner_leaf = node::create(w, inner_root);
+        inner_leaf->translation(v3f(0.f, 1.f, 0.f));
+
+        ecs::entity e = w.registry().create_entity();
+        REQUIRE(e.assign_component<scene>(scene(root)));
+        ecs::entity inner_e = w.registry().create_entity();
+        REQUIRE(inner_e.assign_component<scene>(scene(inner_root)));
+
+        transform_system system;
+        system.process(w.registry());
+        REQUIRE(transform_pass::is_joined(root));
+        REQUIRE(transform_pass::is_joined(inner_leaf));
+        REQUIRE_THROWS_AS(transform_pass(root), bad_transform_pass_operation);
+        REQUIRE(approximately(nodes.back()->world_matrix(), expected_world_matrix(nodes.back())));
+        REQUIRE(approximately(inner_leaf->world_matrix(), expected_world_matrix(inner_leaf)));
+
+        root->translation(v3f(3.f, 0.f, 0.f));
+        system.process(w.registry());
+        REQUIRE(approximately(inner_leaf->world_matrix(), expected_world_matrix(inner_leaf)));
+
+        // the pass is dropped with the scene
+        REQUIRE(w.registry().destroy_entity(e));
+        REQUIRE(w.registry().destroy_entity(inner_e));
+        system.process(w.registry());
+        REQUIRE_FALSE(transform_pass::is_joined(root));
+        REQUIRE(approximately(inner_leaf->world_matrix(), expected_world_matrix(inner_leaf)));
+    }
+    SECTION("spatial_index") {
+        auto root = node::create(w);
+        auto child = node::create(w, root);
+        auto leaf = node::create(w, child);
+        leaf->translation(v3f(1.f, 0.f, 0.f));
+
+        transform_pass pass(root);
+        spatial_index index(root);
+        index.update();
+
+        b3f bounds;
+        REQUIRE(index.find_bounds(leaf, bounds));
+        REQUIRE(bounds == b3f(1.f, 0.f, 0.f, 0.f, 0.f, 0.f));
+
+        child->translation(v3f(0.f, 100.f, 0.f));
+        index.update();
+        REQUIRE(index.find_bounds(leaf, bounds));
+        REQUIRE(bounds == b3f(1.f, 100.f, 0.f, 0.f, 0.f, 0.f));
+    }
+    SECTION("performance") {
+        std::printf("-= transform_pass::performance tests =-\n");
+    #if defined(E2D_BUILD_MODE) && E2D_BUILD_MODE == E2D_BUILD_MODE_DEBUG
+        const std::size_t frame_n = 10;
+    #else
+        const std::size_t frame_n = 100;
+    #endif
+        auto root = node::create(w);
+        const vector<node_iptr> nodes = make_hierarchy(w, root, 100, 50);
+        const auto animate = [&nodes](std::size_t frame){
+            for ( std::size_t i = 0; i < nodes.size(); i += 51 ) {
+                nodes[i]->translation(v3f(static_cast<f32>(frame), 0.f, 0.f));
+            }
+        };
+        {
+            f32 result = 0.f;
+            e2d_untests::verbose_profiler_ms p("lazy world matrices");
+            for ( std::size_t frame = 0; frame < frame_n; ++frame ) {
+                animate(frame);
+                for ( const node_iptr& n : nodes ) {
+                    result += n->world_affine()[3][0];
+                }
+            }
+            p.done(result);
+        }
+        {
+            f32 result = 0.f;
+            transform_pass pass(root);
+            e2d_untests::verbose_profiler_ms p("transform_pass world matrices");
+            for ( std::size_t frame = 0; frame < frame_n; ++frame ) {
+                animate(frame);
+                pass.update();
+                for ( const node_iptr& n : nodes ) {
+                    result += n->world_affine()[3][0];
+                }
+            }
+            p.done(result);
+        }
+    }
+}
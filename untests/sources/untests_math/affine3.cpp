@@ -0,0 +1,92 @@
+/*******************************************************************************
+ * This file is part of the "Enduro2D"
+ * For conditions of distribution and use, see copyright notice in LICENSE.md
+ * Copyright (C) 2018 Matvey Cherevko
+ ******************************************************************************/
+
+#include "_math.hpp"
+using namespace e2d;
+
+namespace
+{
+    bool approximately(const m4f& l, const m4f& r) noexcept {
+        for ( std::size_t i = 0; i < 4; ++i ) {
+            if ( !math::approximately(l[i], r[i], 0.0001f) ) {
+                return false;
+            }
+        }
+        return true;
+    }
+}
+
+TEST_CASE("affine3") {
+    {
+        auto m = a3i::identity();
+        REQUIRE(m.rows[0][0] == 1);
+        REQUIRE((m[0][0] == m[1][1] && m[1][1] == m[2][2]));
+        REQUIRE(m[3] == v3i::zero());
+        REQUIRE((m.data()[0] == m.data()[4] && m.data()[4] == m.data()[8]));
+        REQUIRE((m.data()[9] == 0 && m.data()[10] == 0 && m.data()[11] == 0));
+        m[3] = v3i(1,2,3);
+        REQUIRE((m.data()[9] == 1 && m.data()[10] == 2 && m.data()[11] == 3));
+        REQUIRE(a3i() == a3i::identity());
+        REQUIRE(a3i::zero() != a3i::identity());
+        REQUIRE(a3f(1.1f,0,0, 0,2.2f,0, 0,0,3.3f, 4.4f,0,0).cast_to<i32>() ==
+                a3i(1,0,0, 0,2,0, 0,0,3, 4,0,0));
+    }
+    {
+        const t3f t1 = make_trs3(
+            v3f(1.f, 2.f, 3.f),
+            math::make_quat_from_axis_angle(make_deg(30.f), math::normalized(v3f(1.f, 2.f, 3.f))),
+            v3f(2.f, 0.5f, 3.f));
+        const t3f t2 = make_trs3(
+            v3f(-4.f, 0.f, 1.f),
+            math::make_quat_from_axis_angle(make_deg(-70.f), v3f::unit_z()),
+            v3f(1.f, 3.f, 1.f));
+
+        const a3f a1 = math::make_trs_affine3(t1);
+        const a3f a2 = math::make_trs_affine3(t2);
+        const m4f m1 = math::make_trs_matrix4(t1);
+        const m4f m2 = math::make_trs_matrix4(t2);
+
+        REQUIRE(approximately(math::make_affine_matrix4(a1), m1));
+        REQUIRE(math::approximately(make_affine3(m1), a1, 0.0001f));
+        REQUIRE(approximately(math::make_affine_matrix4(a1 * a2), m1 * m2));
+
+        a3f a3 = a1;
+        a3 *= a2;
+        REQUIRE(a3 == a1 * a2);
+
+        const v3f p(5.f, -6.f, 7.f);
+        REQUIRE(math::approximately(
+            math::transform_point(p, a1),
+            v3f(v4f(p, 1.f) * m1),
+            0.0001f));
+        REQUIRE(math::approximately(
+            math::transform_direction(p, a1),
+            v3f(v4f(p, 0.f) * m1),
+            0.0001f));
+        REQUIRE(math::approximately(
+            math::transform_point(v2f(p), a1),
+            v3f(v4f(p.x, p.y, 0.f, 1.f) * m1),
+            0.0001f));
+        REQUIRE(math::approximately(v4f(p, 1.f) * a1, v4f(p, 1.f) * m1, 0.0001f));
+
+        const auto inv = math::inversed(a1);
+        REQUIRE(inv.second);
+        REQUIRE(math::approximately(inv.first * a1, a3f::identity(), 0.0001f));
+        REQUIRE(approximately(
+            math::make_affine_matrix4(inv.first),
+            math::inversed(m1).first));
+        REQUIRE_FALSE(math::inversed(a3f::zero()).second);
+    }
+    {
+        const t2f t = make_trs2(
+            v2f(10.f, 20.f),
+            math::to_rad(make_deg(45.f)),
+            v2f(2.f, 3.f));
+        REQUIRE(approximately(
+            math::make_affine_matrix4(math::make_trs_affine3(t)),
+            math::make_trs_matrix4(t)));
+    }
+}
@@ -165,4 +165,52 @@ TEST_CASE("mat4") {
         REQUIRE(m4i::identity() == m4i::identity());
         REQUIRE_FALSE(m4i::identity() != m4i::identity());
     }
+    {
+        const v4f inside[] = {{0.f, 0.f, 0.f, 1.f}, {2.f, 2.f, 2.f, 2.f}};
+        REQUIRE_FALSE(math::outside_clip_volume(inside, 2u));
+
+        const v4f straddling[] = {{-2.f, 0.f, 0.f, 1.f}, {2.f, 0.f, 0.f, 1.f}};
+        REQUIRE_FALSE(math::outside_clip_volume(straddling, 2u));
+
+        const v4f diagonal[] = {{-2.f, 0.f, 0.f, 1.f}, {0.f, 2.f, 0.f, 1.f}};
+        REQUIRE_FALSE(math::outside_clip_volume(diagonal, 2u));
+
+        const v4f outside[] = {{-2.f, 0.f, 0.f, 1.f}, {-3.f, 0.f, 0.f, 1.f}};
+        REQUIRE(math::outside_clip_volume(outside, 2u));
+    }
+    {
+        // maps [-1,1] x [-1,1] x [0,1] to the clip volume as is
+        const m4f ortho = math::make_orthogonal_lh_matrix4(2.f, 2.f, 0.f, 1.f);
+
+        REQUIRE_FALSE(math::outside_clip_volume(b3f(-0.5f, -0.5f, 0.1f, 1.f, 1.f, 0.5f), ortho));
+        REQUIRE_FALSE(math::outside_clip_volume(b3f(-2.f, -2.f, -2.f, 4.f, 4.f, 4.f), ortho));
+
+        REQUIRE_FALSE(math::outside_clip_volume(b3f( 0.5f, -0.5f, 0.1f, 1.f, 1.f, 0.5f), ortho));
+        REQUIRE_FALSE(math::outside_clip_volume(b3f(-1.5f, -0.5f, 0.1f, 1.f, 1.f, 0.5f), ortho));
+        REQUIRE_FALSE(math::outside_clip_volume(b3f(-0.5f,  0.5f, 0.1f, 1.f, 1.f, 0.5f), ortho));
+        REQUIRE_FALSE(math::outside_clip_volume(b3f(-0.5f, -1.5f, 0.1f, 1.f, 1.f, 0.5f), ortho));
+        REQUIRE_FALSE(math::outside_clip_volume(b3f(-0.5f, -0.5f, 0.5f, 1.f, 1.f, 1.f), ortho));
+        REQUIRE_FALSE(math::outside_clip_volume(b3f(-0.5f, -0.5f, -1.5f, 1.f, 1.f, 1.f), ortho));
+
+        REQUIRE(math::outside_clip_volume(b3f(-3.f, -0.5f, 0.1f, 1.f, 1.f, 0.5f), ortho));
+        REQUIRE(math::outside_clip_volume(b3f( 2.f, -0.5f, 0.1f, 1.f, 1.f, 0.5f), ortho));
+        REQUIRE(math::outside_clip_volume(b3f(-0.5f, -3.f, 0.1f, 1.f, 1.f, 0.5f), ortho));
+        REQUIRE(math::outside_clip_volume(b3f(-0.5f,  2.f, 0.1f, 1.f, 1.f, 0.5f), ortho));
+        REQUIRE(math::outside_clip_volume(b3f(-0.5f, -0.5f, -3.f, 1.f, 1.f, 1.f), ortho));
+        REQUIRE(math::outside_clip_volume(b3f(-0.5f, -0.5f,  2.f, 1.f, 1.f, 1.f), ortho));
+    }
+    {
+        const m4f persp = math::make_perspective_lh_matrix4(make_deg(90.f), 1.f, 1.f, 100.f);
+
+        REQUIRE_FALSE(math::outside_clip_volume(b3f(-1.f, -1.f, 5.f, 2.f, 2.f, 2.f), persp));
+        REQUIRE_FALSE(math::outside_clip_volume(b3f(-1.f, -1.f, -5.f, 2.f, 2.f, 10.f), persp));
+        REQUIRE_FALSE(math::outside_clip_volume(b3f(-1.f, -1.f, 90.f, 2.f, 2.f, 20.f), persp));
+
+        // behind the camera
+        REQUIRE(math::outside_clip_volume(b3f(-1.f, -1.f, -5.f, 2.f, 2.f, 2.f), persp));
+        REQUIRE(math::outside_clip_volume(b3f(-50.f, -50.f, -20.f, 100.f, 100.f, 10.f), persp));
+
+        REQUIRE(math::outside_clip_volume(b3f(20.f, -1.f, 5.f, 2.f, 2.f, 2.f), persp));
+        REQUIRE(math::outside_clip_volume(b3f(-1.f, -1.f, 200.f, 2.f, 2.f, 2.f), persp));
+    }
 }
@@ -0,0 +1,258 @@
+/*******************************************************************************
+ * This file is part of the "Enduro2D"
+ * For conditions of distribution and use, see copyright notice in LICENSE.md
+ * Copyright (C) 2018 Matvey Cherevko
+ ******************************************************************************/
+
+#include "_math.hpp"
+using namespace e2d;
+
+//
+// explicit template arguments skip the f32 overloads,
+// so 'operator*<f32>' and 'inversed<f32>' are the scalar versions
+//
+
+namespace
+{
+    class random_math final {
+    public:
+        f32 value() {
+            return dist_(engine_);
+        }
+
+        v3f vec3() {
+            return {value(), value(), value()};
+        }
+
+        v4f vec4() {
+            return {value(), value(), value(), value()};
+        }
+
+        q4f quat() {
+            return math::normalized(q4f(value(), value(), value(), value() + 2.f));
+        }
+
+        t3f trs3() {
+            return make_trs3(vec3(), quat(), vec3() + v3f(2.f));
+        }
+    private:
+        std::mt19937 engine_{42u};
+        std::uniform_real_distribution<f32> dist_{-1.f, 1.f};
+    };
+
+    bool approximately(const m4f& l, const m4f& r) noexcept {
+        for ( std::size_t i = 0; i < 4; ++i ) {
+            if ( !math::approximately(l[i], r[i], 0.0001f) ) {
+                return false;
+            }
+        }
+        return true;
+    }
+}
+
+TEST_CASE("simd") {
+    random_math rnd;
+    SECTION("mat4") {
+        for ( std::size_t i = 0; i < 100; ++i ) {
+            const m4f l = math::make_trs_matrix4(rnd.trs3());
+            const m4f r = math::make_trs_matrix4(rnd.trs3());
+            REQUIRE(approximately(l * r, operator*<f32>(l, r)));
+
+            const v4f v = rnd.vec4();
+            REQUIRE(math::approximately(v * l, operator*<f32>(v, l), 0.0001f));
+
+            const auto inv = math::inversed(l);
+            const auto scalar_inv = math::inversed<f32>(l);
+            REQUIRE(inv.second == scalar_inv.second);
+            REQUIRE(approximately(inv.first, scalar_inv.first));
+            REQUIRE(approximately(inv.first * l, m4f::identity()));
+        }
+        {
+            m4f m = math::make_translation_matrix4(1.f, 2.f, 3.f);
+            m = m * m;
+            REQUIRE(m == math::make_translation_matrix4(2.f, 4.f, 6.f));
+            m *= m;
+            REQUIRE(m == math::make_translation_matrix4(4.f, 8.f, 12.f));
+        }
+        {
+            REQUIRE_FALSE(math::inversed(m4f::zero()).second);
+            REQUIRE(math::inversed(m4f::zero()).first == m4f::identity());
+            REQUIRE_FALSE(math::inversed(math::make_scale_matrix4(1.f, 0.f, 1.f)).second);
+            // needs row exchanges
+            const m4f p(
+                0.f, 1.f, 0.f, 0.f,
+                1.f, 0.f, 0.f, 0.f,
+                0.f, 0.f, 0.f, 2.f,
+                0.f, 0.f, 4.f, 0.f);
+            REQUIRE(approximately(math::inversed(p).first * p, m4f::identity()));
+        }
+    }
+    SECTION("trs") {
+        for ( std::size_t i = 0; i < 100; ++i ) {
+            const t3f t = rnd.trs3();
+            REQUIRE(approximately(
+                math::make_trs_matrix4(t),
+                math::make_scale_matrix4(t.scale) *
+                math::make_rotation_matrix4(t.rotation) *
+                math::make_translation_matrix4(t.translation)));
+        }
+        {
+            const t2f t = make_trs2(v2f(1.f, 2.f), make_rad(0.5f), v2f(3.f, 4.f));
+            REQUIRE(approximately(
+                math::make_trs_matrix4(t),
+                math::make_scale_matrix4(t.scale, 1.f) *
+                math::make_rotation_matrix4(t.rotation, v3f::unit_z()) *
+                math::make_translation_matrix4(t.translation, 0.f)));
+        }
+    }
+    SECTION("quat") {
+        for ( std::size_t i = 0; i < 100; ++i ) {
+            const q4f l = rnd.quat();
+            const q4f r = rnd.quat();
+            REQUIRE(math::approximately(l * r, operator*<f32>(l, r), 0.0001f));
+        }
+        q4f q = math::make_quat_from_axis_angle(make_deg(90.f), v3f::unit_z());
+        q *= q;
+        REQUIRE(math::approximately(
+            q,
+            math::make_quat_from_axis_angle(make_deg(180.f), v3f::unit_z()),
+            0.0001f));
+    }
+    SECTION("affine3") {
+        for ( std::size_t i = 0; i < 100; ++i ) {
+            const a3f l = math::make_trs_affine3(rnd.trs3());
+            const a3f r = math::make_trs_affine3(rnd.trs3());
+            REQUIRE(math::approximately(l * r, operator*<f32>(l, r), 0.0001f));
+        }
+        a3f m = math::make_trs_affine3(make_trs3(v3f(1.f, 2.f, 3.f), q4f::identity(), v3f(2.f)));
+        m *= m;
+        REQUIRE(m == a3f(4,0,0, 0,4,0, 0,0,4, 3,6,9));
+    }
+    SECTION("transform_points") {
+        const m4f m = math::make_trs_matrix4(rnd.trs3());
+        const a3f a = math::make_trs_affine3(rnd.trs3());
+
+        vector<v4f> src4(17);
+        vector<v3f> src3(17);
+        vector<v2f> src2(17);
+        for ( std::size_t i = 0; i < src4.size(); ++i ) {
+            src4[i] = rnd.vec4();
+            src3[i] = rnd.vec3();
+            src2[i] = v2f(src3[i]);
+        }
+
+        vector<v4f> dst4(src4.size());
+        math::transform_points(src4.data(), dst4.data(), src4.size(), m);
+        for ( std::size_t i = 0; i < src4.size(); ++i ) {
+            REQUIRE(math::approximately(dst4[i], src4[i] * m, 0.0001f));
+        }
+
+        math::transform_points(src3.data(), dst4.data(), src3.size(), m);
+        for ( std::size_t i = 0; i < src3.size(); ++i ) {
+            REQUIRE(math::approximately(dst4[i], v4f(src3[i], 1.f) * m, 0.0001f));
+        }
+
+        vector<v3f> dst3(src3.size());
+        math::transform_points(src3.data(), dst3.data(), src3.size(), a);
+        for ( std::size_t i = 0; i < src3.size(); ++i ) {
+            REQUIRE(math::approximately(dst3[i], math::transform_point(src3[i], a), 0.0001f));
+        }
+
+        math::transform_points(src2.data(), dst3.data(), src2.size(), a);
+        for ( std::size_t i = 0; i < src2.size(); ++i ) {
+            REQUIRE(math::approximately(dst3[i], math::transform_point(src2[i], a), 0.0001f));
+        }
+
+        vector<v4f> inplace = src4;
+        math::transform_points(inplace.data(), inplace.data(), inplace.size(), m);
+        for ( std::size_t i = 0; i < src4.size(); ++i ) {
+            REQUIRE(math::approximately(inplace[i], src4[i] * m, 0.0001f));
+        }
+    }
+    SECTION("performance") {
+        std::printf("-= simd::performance tests =-\n");
+    #if defined(E2D_BUILD_MODE) && E2D_BUILD_MODE == E2D_BUILD_MODE_DEBUG
+        const std::size_t task_n = 100'000;
+    #else
+        const std::size_t task_n = 1'000'000;
+    #endif
+        vector<m4f> matrices(64);
+        vector<a3f> affines(64);
+        vector<q4f> quats(64);
+        for ( std::size_t i = 0; i < matrices.size(); ++i ) {
+            const t3f t = rnd.trs3();
+            matrices[i] = math::make_trs_matrix4(t);
+            affines[i] = math::make_trs_affine3(t);
+            quats[i] = t.rotation;
+        }
+        const std::size_t mask = matrices.size() - 1;
+
+        const auto bench = [task_n, mask](const char* name, const auto& get, const auto& op){
+            f32 result = 0.f;
+            e2d_untests::verbose_profiler_ms p(name);
+            for ( std::size_t i = 0; i < task_n; ++i ) {
+                result += op(get(i & mask), get((i + 1u) & mask)).data()[0];
+            }
+            p.done(result);
+        };
+
+        const auto get_m = [&matrices](std::size_t i){ return matrices[i]; };
+        const auto get_a = [&affines](std::size_t i){ return affines[i]; };
+        const auto get_q = [&quats](std::size_t i){ return quats[i]; };
+
+        bench("scalar m4f * m4f", get_m, [](const m4f& l, const m4f& r){
+            return operator*<f32>(l, r);
+        });
+        bench("simd m4f * m4f", get_m, [](const m4f& l, const m4f& r){
+            return l * r;
+        });
+
+        bench("scalar inversed(m4f)", get_m, [](const m4f& l, const m4f& r){
+            return operator*<f32>(math::inversed<f32>(r).first, l);
+        });
+        bench("simd inversed(m4f)", get_m, [](const m4f& l, const m4f& r){
+            return math::inversed(r).first * l;
+        });
+
+        bench("scalar a3f * a3f", get_a, [](const a3f& l, const a3f& r){
+            return operator*<f32>(l, r);
+        });
+        bench("simd a3f * a3f", get_a, [](const a3f& l, const a3f& r){
+            return l * r;
+        });
+
+        bench("scalar q4f * q4f", get_q, [](const q4f& l, const q4f& r){
+            return operator*<f32>(l, r);
+        });
+        bench("simd q4f * q4f", get_q, [](const q4f& l, const q4f& r){
+            return l * r;
+        });
+
+        {
+            vector<v4f> points(1024);
+            for ( v4f& p : points ) {
+                p = rnd.vec4();
+            }
+            vector<v4f> results(points.size());
+            const std::size_t batch_n = task_n / points.size();
+            {
+                e2d_untests::verbose_profiler_ms p("scalar transform_points(v4f)");
+                for ( std::size_t i = 0; i < batch_n; ++i ) {
+                    const m4f& m = matrices[i & mask];
+                    for ( std::size_t j = 0; j < points.size(); ++j ) {
+                        results[j] = operator*<f32>(points[j], m);
+                    }
+                }
+                p.done(results.back().x);
+            }
+            {
+                e2d_untests::verbose_profiler_ms p("simd transform_points(v4f)");
+                for ( std::size_t i = 0; i < batch_n; ++i ) {
+                    math::transform_points(
+                        points.data(), results.data(), points.size(), matrices[i & mask]);
+                }
+                p.done(results.back().x);
+            }
+        }
+    }
+}
@@ -0,0 +1,48 @@
+/*******************************************************************************
+ * This file is part of the "Enduro2D"
+ * For conditions of distribution and use, see copyright notice in LICENSE.md
+ * Copyright (C) 2018 Matvey Cherevko
+ ******************************************************************************/
+
+#include "_utils.hpp"
+using namespace e2d;
+
+TEST_CASE("buffer_view") {
+    {
+        REQUIRE(buffer_view().size() == 0);
+        REQUIRE(buffer_view().data() == nullptr);
+        REQUIRE(buffer_view().empty());
+    }
+    {
+        const buffer b("hello", 5);
+        buffer_view v(b);
+        REQUIRE(v.data() == b.data());
+        REQUIRE(v.size() == 5);
+        REQUIRE_FALSE(v.empty());
+        v.clear();
+        REQUIRE(v.data() == nullptr);
+        REQUIRE(v.size() == 0);
+    }
+    {
+        const char* s = "hello";
+        buffer_view v0(s, 5);
+        buffer_view v1(s + 1, 4);
+        REQUIRE(v0.data() == reinterpret_cast<const u8*>(s));
+        swap(v0, v1);
+        REQUIRE(v0.size() == 4);
+        REQUIRE(v1.size() == 5);
+        REQUIRE(v0 == buffer_view("ello", 4));
+        REQUIRE(v1 == buffer_view("hello", 5));
+    }
+    {
+        const buffer b("hello", 5);
+        REQUIRE(buffer_view(b) == buffer_view("hello", 5));
+        REQUIRE_FALSE(buffer_view(b) != buffer_view("hello", 5));
+        REQUIRE(buffer_view(b) != buffer_view("world", 5));
+        REQUIRE(buffer_view(b) != buffer_view());
+        REQUIRE(buffer_view() == buffer_view(nullptr, 0));
+        REQUIRE(buffer_view("aaaa", 4) < buffer_view("hello", 5));
+        REQUIRE(buffer_view("hello", 5) < buffer_view("world", 5));
+        REQUIRE_FALSE(buffer_view("world", 5) < buffer_view("hello", 5));
+    }
+}
@@ -0,0 +1,193 @@
+/*******************************************************************************
+ * This file is part of the "Enduro2D"
+ * For conditions of distribution and use, see copyright notice in LICENSE.md
+ * Copyright (C) 2018 Matvey Cherevko
+ ******************************************************************************/
+
+#include "_utils.hpp"
+using namespace e2d;
+
+#include <random>
+
+namespace
+{
+    buffer make_text_buffer(std::size_t size) {
+        const str_view words[] = {"hello ", "world ", "enduro2d ", "bundle "};
+        std::mt19937 engine(42u);
+        std::uniform_int_distribution<std::size_t> dist(0u, E2D_COUNTOF(words) - 1u);
+        buffer result(size);
+        for ( std::size_t i = 0; i < size; ) {
+            const str_view word = words[dist(engine)];
+            const std::size_t n = math::min(word.size(), size - i);
+            std::memcpy(result.data() + i, word.data(), n);
+            i += n;
+        }
+        return result;
+    }
+
+    buffer make_random_buffer(std::size_t size) {
+        std::mt19937 engine(42u);
+        std::uniform_int_distribution<u32> dist(0u, 255u);
+        buffer result(size);
+        for ( std::size_t i = 0; i < size; ++i ) {
+            result.data()[i] = static_cast<u8>(dist(engine));
+        }
+        return result;
+    }
+
+    bool lz4_round_trip(const buffer& src) {
+        buffer compressed;
+        if ( !lz4::try_compress(compressed, src) ) {
+            return false;
+        }
+        if ( compressed.size() > lz4::compress_bound(src.size()) ) {
+            return false;
+        }
+        buffer decompressed(src.size());
+        return lz4::try_decompress(decompressed.data(), decompressed.size(), compressed)
+            && decompressed == src;
+    }
+
+    bundles::file_header read_header(const buffer& src) {
+        bundles::file_header header;
+        std::memcpy(&header, src.data(), sizeof(header));
+        return header;
+    }
+
+    bundles::file_entry read_entry(const buffer& src, std::size_t index) {
+        bundles::file_entry entry;
+        std::memcpy(
+            &entry,
+            src.data() + sizeof(bundles::file_header) + index * sizeof(entry),
+            sizeof(entry));
+        return entry;
+    }
+}
+
+TEST_CASE("bundle") {
+    SECTION("bundle") {
+        bundle b;
+        REQUIRE(b.empty());
+        REQUIRE(b.add_directory("folder/"));
+        REQUIRE(b.add_file("folder\\file.txt", buffer("hello", 5), false));
+        REQUIRE_FALSE(b.add_file("folder/file.txt", buffer("world", 5), false));
+        REQUIRE_FALSE(b.add_directory("folder"));
+        REQUIRE_FALSE(b.add_file("", buffer(), false));
+        REQUIRE(b.exists("folder"));
+        REQUIRE(b.exists("folder/file.txt"));
+        REQUIRE_FALSE(b.exists("folder/"));
+        REQUIRE(b.entries().size() == 2u);
+        REQUIRE(b.entries()[1].content == buffer("hello", 5));
+
+        bundle b2 = b;
+        REQUIRE(b2.entries().size() == 2u);
+        bundle b3 = std::move(b2);
+        REQUIRE(b2.empty());
+        REQUIRE(b3.exists("folder/file.txt"));
+        b3.clear();
+        REQUIRE(b3.empty());
+    }
+    SECTION("lz4") {
+        REQUIRE(lz4_round_trip(buffer()));
+        REQUIRE(lz4_round_trip(buffer("hello", 5)));
+        REQUIRE(lz4_round_trip(buffer("hellohellohello", 15)));
+        REQUIRE(lz4_round_trip(buffer(1000u).fill(7u)));
+        REQUIRE(lz4_round_trip(make_text_buffer(100'000u)));
+        REQUIRE(lz4_round_trip(make_random_buffer(100'000u)));
+        {
+            const buffer src(buffer(100'000u).fill(7u));
+            buffer compressed;
+            REQUIRE(lz4::try_compress(compressed, src));
+            REQUIRE(compressed.size() < 1000u);
+
+            buffer dst(src.size());
+            REQUIRE_FALSE(lz4::try_decompress(
+                dst.data(), dst.size() - 1u, compressed));
+            REQUIRE_FALSE(lz4::try_decompress(
+                dst.data(), dst.size(), buffer_view(compressed.data(), compressed.size() - 1u)));
+        }
+        {
+            // match offset before the beginning of the output
+            const u8 src[] = {0x10, 'a', 0x05, 0x00, 0x00};
+            u8 dst[8] = {0};
+            REQUIRE_FALSE(lz4::try_decompress(dst, sizeof(dst), buffer_view(src, sizeof(src))));
+        }
+    }
+    SECTION("save") {
+        const buffer text = make_text_buffer(200'000u);
+        const buffer random = make_random_buffer(1'000u);
+
+        bundle b;
+        REQUIRE(b.add_directory("folder"));
+        REQUIRE(b.add_file("folder/text.txt", text, true));
+        REQUIRE(b.add_file("random.bin", random, true));
+        REQUIRE(b.add_file("empty.bin", buffer(), true));
+
+        buffer file_data;
+        REQUIRE(bundles::try_save_bundle(b, file_data));
+        REQUIRE(file_data.size() < text.size());
+
+        const bundles::file_header header = read_header(file_data);
+        REQUIRE(bundles::is_valid_header(header));
+        REQUIRE(header.entry_count == 4u);
+
+        std::size_t compressed_count = 0u;
+        for ( std::size_t i = 0; i < header.entry_count; ++i ) {
+            const bundles::file_entry entry = read_entry(file_data, i);
+            const str_view name(
+                reinterpret_cast<const char*>(file_data.data() + header.names_offset + entry.name_offset),
+                entry.name_size);
+            REQUIRE(entry.name_hash == str_hash(name).hash());
+            REQUIRE(entry.data_offset % bundles::data_alignment == 0u);
+            if ( i > 0u ) {
+                REQUIRE(read_entry(file_data, i - 1u).name_hash <= entry.name_hash);
+            }
+            if ( name == "folder" ) {
+                REQUIRE(entry.flags == bundles::file_entry_directory);
+            } else if ( name == "random.bin" ) {
+                REQUIRE(entry.flags == 0u);
+                REQUIRE(buffer_view(file_data.data() + entry.data_offset, entry.size) == random);
+            } else if ( name == "folder/text.txt" ) {
+                REQUIRE(entry.flags == bundles::file_entry_compressed);
+                REQUIRE(entry.chunk_count == (text.size() + bundles::chunk_size - 1u) / bundles::chunk_size);
+                const buffer_view data(file_data.data() + entry.data_offset, entry.stored_size);
+                buffer content(entry.size);
+                for ( std::size_t c = 0; c < entry.chunk_count; ++c ) {
+                    REQUIRE(bundles::try_decompress_chunk(entry, data, c, content.data()));
+                }
+                REQUIRE_FALSE(bundles::try_decompress_chunk(entry, data, entry.chunk_count, content.data()));
+                REQUIRE(content == text);
+                ++compressed_count;
+            }
+        }
+        REQUIRE(compressed_count == 1u);
+    }
+    SECTION("performance") {
+        std::printf("-= bundle::performance tests =-\n");
+    #if defined(E2D_BUILD_MODE) && E2D_BUILD_MODE == E2D_BUILD_MODE_DEBUG
+        const std::size_t task_n = 10;
+    #else
+        const std::size_t task_n = 100;
+    #endif
+        const buffer text = make_text_buffer(bundles::chunk_size);
+        buffer compressed;
+        {
+            std::size_t result = 0u;
+            e2d_untests::verbose_profiler_ms p("lz4::try_compress");
+            for ( std::size_t i = 0; i < task_n; ++i ) {
+                lz4::try_compress(compressed, text);
+                result += compressed.size();
+            }
+            p.done(result);
+        }
+        {
+            std::size_t result = 0u;
+            buffer dst(text.size());
+            e2d_untests::verbose_profiler_ms p("lz4::try_decompress");
+            for ( std::size_t i = 0; i < task_n; ++i ) {
+                result += lz4::try_decompress(dst.data(), dst.size(), compressed) ? 1u : 0u;
+            }
+            p.done(result);
+        }
+    }
+}
@@ -47,6 +47,25 @@ TEST_CASE("filesystem") {
             REQUIRE(f->tell() == 10);
             REQUIRE(std::memcmp(buf, "helloworld", 10) == 0);
         }
+        {
+            auto f = make_mapped_file("files_test");
+            REQUIRE(f);
+            REQUIRE(f->view() == buffer_view("helloworld", 10));
+            REQUIRE(f->length() == 10);
+            char buf[5] = {'\0'};
+            REQUIRE(f->seek(5, false) == 5);
+            REQUIRE(f->read(buf, 5) == 5);
+            REQUIRE(f->tell() == 10);
+            REQUIRE(std::memcmp(buf, "world", 5) == 0);
+            REQUIRE_FALSE(make_mapped_file("files_test2"));
+        }
+        {
+            REQUIRE(make_write_file("files_test", false));
+            auto f = make_mapped_file("files_test");
+            REQUIRE(f);
+            REQUIRE(f->view().empty());
+            REQUIRE(f->length() == 0);
+        }
     }
     SECTION("filesystem") {
         {
@@ -7,6 +7,52 @@
 #include "_utils.hpp"
 using namespace e2d;
 
+namespace
+{
+    template < typename T >
+    void append_pod(buffer& dst, const T& value) {
+        const std::size_t offset = dst.size();
+        dst.resize(offset + sizeof(value));
+        std::memcpy(dst.data() + offset, &value, sizeof(value));
+    }
+
+    buffer make_dds_file(const v2u& size, u32 fourcc, u32 mipmap_count, std::size_t data_size) {
+        const u32 header[] = {
+            0x20534444u, // magic
+            124u, 0x1007u | 0x20000u, size.y, size.x, 0u, 0u, mipmap_count,
+            0u, 0u, 0u, 0u, 0u, 0u, 0u, 0u, 0u, 0u, 0u,
+            32u, 0x4u, fourcc, 0u, 0u, 0u, 0u, 0u,
+            0x1000u, 0u, 0u, 0u, 0u};
+        buffer result;
+        for ( u32 v : header ) {
+            append_pod(result, v);
+        }
+        const std::size_t offset = result.size();
+        result.resize(offset + data_size);
+        for ( std::size_t i = 0; i < data_size; ++i ) {
+            result.data()[offset + i] = static_cast<u8>(i);
+        }
+        return result;
+    }
+
+    buffer make_pvr_file(const v2u& size, u64 pixel_format, u32 mipmap_count, std::size_t data_size) {
+        buffer result;
+        append_pod(result, u32(0x03525650u));
+        append_pod(result, u32(0u));
+        append_pod(result, pixel_format);
+        const u32 tail[] = {0u, 0u, size.y, size.x, 1u, 1u, 1u, mipmap_count, 4u, 0u};
+        for ( u32 v : tail ) {
+            append_pod(result, v);
+        }
+        const std::size_t offset = result.size();
+        result.resize(offset + data_size);
+        for ( std::size_t i = 0; i < data_size; ++i ) {
+            result.data()[offset + i] = static_cast<u8>(i);
+        }
+        return result;
+    }
+}
+
 TEST_CASE("images") {
     {
         image i;
@@ -130,3 +176,86 @@ TEST_CASE("images") {
         REQUIRE(math::approximately(img.pixel32(2,0), color32::blue(),  0));
     }
 }
+
+TEST_CASE("image_mipmaps") {
+    {
+        REQUIRE(images::max_mipmap_count(v2u(1,1)) == 1u);
+        REQUIRE(images::max_mipmap_count(v2u(8,2)) == 4u);
+        REQUIRE(images::max_mipmap_count(v2u(5,9)) == 4u);
+
+        REQUIRE(images::mipmap_data_size(v2u(3,2), image_data_format::rgb8) == 18u);
+        REQUIRE(images::mipmap_data_size(v2u(1,1), image_data_format::rgba_dxt1) == 8u);
+        REQUIRE(images::mipmap_data_size(v2u(5,4), image_data_format::rgba_dxt5) == 32u);
+        REQUIRE(images::mipmap_data_size(v2u(4,4), image_data_format::rgba_pvrtc4) == 32u);
+        REQUIRE(images::mipmap_data_size(v2u(4,4), image_data_format::rgba_pvrtc2) == 32u);
+        REQUIRE(images::mipmap_chain_data_size(v2u(4,2), image_data_format::g8, 3u) == 8u + 2u + 1u);
+    }
+    {
+        const u8 img_data[] = {
+            0,   0,   100, 100,
+            0,   0,   100, 100,
+            200, 200, 50,  50,
+            200, 200, 50,  52};
+        const image src(v2u(4,4), image_data_format::g8, buffer(img_data, sizeof(img_data)));
+        REQUIRE(src.mipmap_count() == 1u);
+        REQUIRE(src.mipmap_data(0u).size() == 16u);
+
+        image dst;
+        REQUIRE(images::try_generate_mipmaps(dst, src));
+        REQUIRE(dst.size() == v2u(4,4));
+        REQUIRE(dst.mipmap_count() == 3u);
+        REQUIRE(dst.data().size() == 16u + 4u + 1u);
+        REQUIRE(dst.mipmap_size(1u) == v2u(2,2));
+        REQUIRE(dst.mipmap_size(2u) == v2u(1,1));
+        REQUIRE(dst.mipmap_data(0u) == src.mipmap_data(0u));
+
+        const buffer_view level1 = dst.mipmap_data(1u);
+        REQUIRE(level1.size() == 4u);
+        REQUIRE(static_cast<const u8*>(level1.data())[0] == 0u);
+        REQUIRE(static_cast<const u8*>(level1.data())[1] == 100u);
+        REQUIRE(static_cast<const u8*>(level1.data())[2] == 200u);
+        REQUIRE(static_cast<const u8*>(level1.data())[3] == 51u);
+        REQUIRE(static_cast<const u8*>(dst.mipmap_data(2u).data())[0] == 88u);
+        REQUIRE(dst.pixel32(2,2) == src.pixel32(2,2));
+
+        image dst2 = dst;
+        REQUIRE(dst2 == dst);
+        REQUIRE(dst2 != src);
+
+        image compressed(v2u(4,4), image_data_format::rgba_dxt1, buffer(8u));
+        REQUIRE_FALSE(images::try_generate_mipmaps(dst, compressed));
+    }
+    {
+        const u32 dxt5 = 0x35545844u;
+        const std::size_t data_size = 64u + 16u + 16u + 16u;
+        image img;
+        REQUIRE(images::try_load_image(img, make_dds_file(v2u(8,8), dxt5, 4u, data_size)));
+        REQUIRE(img.size() == v2u(8,8));
+        REQUIRE(img.format() == image_data_format::rgba_dxt5);
+        REQUIRE(img.mipmap_count() == 4u);
+        REQUIRE(img.data().size() == data_size);
+        REQUIRE(img.mipmap_data(3u).size() == 16u);
+        REQUIRE(static_cast<const u8*>(img.mipmap_data(1u).data())[0] == 64u);
+
+        REQUIRE_FALSE(images::try_load_image(img, make_dds_file(v2u(8,8), dxt5, 4u, data_size - 1u)));
+        REQUIRE_FALSE(images::try_load_image(img, make_dds_file(v2u(8,8), 0x31313131u, 1u, data_size)));
+    }
+    {
+        const u64 rgba8 = 0x0808080861626772ull;
+        const std::size_t data_size = 4u * 4u * 4u + 2u * 2u * 4u + 4u;
+        image img;
+        REQUIRE(images::try_load_image(img, make_pvr_file(v2u(4,4), rgba8, 3u, data_size)));
+        REQUIRE(img.size() == v2u(4,4));
+        REQUIRE(img.format() == image_data_format::rgba8);
+        REQUIRE(img.mipmap_count() == 3u);
+        REQUIRE(img.pixel32(0,0) == color32(0,1,2,3));
+        REQUIRE(static_cast<const u8*>(img.mipmap_data(2u).data())[0] == 80u);
+
+        const u64 pvrtc4 = 3u;
+        REQUIRE(images::try_load_image(img, make_pvr_file(v2u(8,8), pvrtc4, 1u, 32u)));
+        REQUIRE(img.format() == image_data_format::rgba_pvrtc4);
+        REQUIRE(img.mipmap_count() == 1u);
+
+        REQUIRE_FALSE(images::try_load_image(img, make_pvr_file(v2u(4,4), rgba8, 3u, data_size - 1u)));
+    }
+}
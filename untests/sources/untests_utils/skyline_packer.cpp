@@ -0,0 +1,131 @@
+/*******************************************************************************
+ * This file is part of the "Enduro2D"
+ * For conditions of distribution and use, see copyright notice in LICENSE.md
+ * Copyright (C) 2018 Matvey Cherevko
+ ******************************************************************************/
+
+#include "_utils.hpp"
+using namespace e2d;
+
+#include <random>
+
+namespace
+{
+    bool is_overlapped(const b2u& l, const b2u& r) noexcept {
+        return l.position.x < r.position.x + r.size.x
+            && r.position.x < l.position.x + l.size.x
+            && l.position.y < r.position.y + r.size.y
+            && r.position.y < l.position.y + l.size.y;
+    }
+}
+
+TEST_CASE("skyline_packer") {
+    {
+        skyline_packer p;
+        b2u r;
+        REQUIRE_FALSE(p.insert(v2u(1u,1u), r));
+        REQUIRE(p.size() == v2u::zero());
+        REQUIRE(p.occupancy() == Approx(0.f));
+    }
+    {
+        skyline_packer p(v2u(64u,64u));
+        b2u r;
+        REQUIRE_FALSE(p.insert(v2u(0u,1u), r));
+        REQUIRE_FALSE(p.insert(v2u(65u,1u), r));
+        REQUIRE_FALSE(p.insert(v2u(1u,65u), r));
+
+        REQUIRE(p.insert(v2u(64u,64u), r));
+        REQUIRE(r == b2u(0u,0u,64u,64u));
+        REQUIRE(p.used_area() == 64u * 64u);
+        REQUIRE(p.occupancy() == Approx(1.f));
+        REQUIRE_FALSE(p.insert(v2u(1u,1u), r));
+
+        p.reset(v2u(64u,64u));
+        REQUIRE(p.used_area() == 0u);
+        REQUIRE(p.insert(v2u(1u,1u), r));
+    }
+    {
+        skyline_packer p(v2u(64u,64u));
+        vector<b2u> rects;
+        b2u r;
+        while ( p.insert(v2u(16u,16u), r) ) {
+            rects.push_back(r);
+        }
+        REQUIRE(rects.size() == 16u);
+        REQUIRE(p.occupancy() == Approx(1.f));
+        for ( std::size_t i = 0; i < rects.size(); ++i ) {
+            REQUIRE(rects[i].position.x + rects[i].size.x <= 64u);
+            REQUIRE(rects[i].position.y + rects[i].size.y <= 64u);
+            for ( std::size_t j = i + 1; j < rects.size(); ++j ) {
+                REQUIRE_FALSE(is_overlapped(rects[i], rects[j]));
+            }
+        }
+    }
+    {
+        skyline_packer p(v2u(128u,128u));
+        vector<b2u> rects;
+        std::mt19937 engine(42u);
+        std::uniform_int_distribution<u32> dist(1u, 40u);
+        for ( std::size_t i = 0; i < 200; ++i ) {
+            b2u r;
+            if ( p.insert(v2u(dist(engine), dist(engine)), r) ) {
+                rects.push_back(r);
+            }
+        }
+        REQUIRE_FALSE(rects.empty());
+        u64 area = 0u;
+        for ( std::size_t i = 0; i < rects.size(); ++i ) {
+            area += u64(rects[i].size.x) * rects[i].size.y;
+            REQUIRE(rects[i].position.x + rects[i].size.x <= 128u);
+            REQUIRE(rects[i].position.y + rects[i].size.y <= 128u);
+            for ( std::size_t j = i + 1; j < rects.size(); ++j ) {
+                REQUIRE_FALSE(is_overlapped(rects[i], rects[j]));
+            }
+        }
+        REQUIRE(area == p.used_area());
+    }
+    {
+        skyline_packer p1(v2u(32u,32u));
+        b2u r;
+        REQUIRE(p1.insert(v2u(8u,8u), r));
+
+        skyline_packer p2(p1);
+        REQUIRE(p2.used_area() == p1.used_area());
+
+        skyline_packer p3(std::move(p1));
+        REQUIRE(p3.size() == v2u(32u,32u));
+        REQUIRE(p1.size() == v2u::zero());
+
+        swap(p2, p3);
+        REQUIRE(p2.size() == v2u(32u,32u));
+    }
+    SECTION("performance") {
+        std::printf("-= skyline_packer::performance tests =-\n");
+    #if defined(E2D_BUILD_MODE) && E2D_BUILD_MODE == E2D_BUILD_MODE_DEBUG
+        const std::size_t task_n = 100;
+    #else
+        const std::size_t task_n = 1'000;
+    #endif
+        std::mt19937 engine(42u);
+        std::uniform_int_distribution<u32> dist(8u, 64u);
+        vector<v2u> sizes(1'000);
+        for ( v2u& size : sizes ) {
+            size = v2u(dist(engine), dist(engine));
+        }
+        {
+            f32 occupancy = 0.f;
+            std::size_t result = 0;
+            e2d_untests::verbose_profiler_ms p("insert(1024x1024)");
+            for ( std::size_t i = 0; i < task_n; ++i ) {
+                skyline_packer packer(v2u(1024u,1024u));
+                b2u r;
+                for ( const v2u& size : sizes ) {
+                    result += packer.insert(size, r) ? 1u : 0u;
+                }
+                occupancy += packer.occupancy();
+            }
+            p.done(result);
+            std::printf("occupancy: %.2f%%\n", occupancy / task_n * 100.f);
+        }
+    }
+}
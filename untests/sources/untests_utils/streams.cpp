@@ -55,6 +55,20 @@ TEST_CASE("streams") {
         REQUIRE(s->tell() == 5);
         REQUIRE(s->length() == 5);
     }
+    {
+        mapped_input_stream_uptr s0 = make_mapped_memory_stream(hello_data);
+        REQUIRE(s0->view() == buffer_view(hello_data));
+        REQUIRE(s0->view().data() != hello_data.data());
+
+        mapped_input_stream_uptr s1 = make_memory_view_stream(hello_data);
+        REQUIRE(s1->view().data() == hello_data.data());
+        REQUIRE(s1->length() == 5);
+        char buf[3] = {'\0'};
+        REQUIRE(s1->seek(2, false) == 2);
+        REQUIRE(s1->read(buf, 3) == 3);
+        REQUIRE(std::memcmp(buf, "llo", 3) == 0);
+        REQUIRE(s1->tell() == 5);
+    }
     {
         input_stream_uptr s = make_memory_stream(hello_data);
         char buf[10] = {'\0'};